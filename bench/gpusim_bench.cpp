@@ -0,0 +1,480 @@
+// gpusim_bench.cpp
+// Microbenchmarks for simulator hot paths with JSON output for regression tracking
+
+#include "sim_engine.h"
+#include "memory_model.h"
+#include "program_loader.h"
+#include "synthetic_workload.h"
+#include "logger.h"
+#include "utils.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+using namespace gpu_simulator;
+
+namespace {
+
+// Shared benchmark defaults (match the RTL defaults in SimConfig users)
+constexpr uint32_t CACHE_SIZE = 16 * 1024;
+constexpr uint32_t LINE_SIZE = 64;
+constexpr uint32_t MEMORY_LATENCY = 100;
+
+// Keeps the compiler from discarding benchmark results
+volatile uint64_t g_sink = 0;
+
+// One benchmark: body(iterations) performs roughly that many operations and
+// returns the number of items processed (events, accesses, lines ...)
+struct Benchmark {
+    std::string name;
+    std::string item_label;
+    std::function<uint64_t(uint64_t)> body;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string item_label;
+    uint64_t    iterations;
+    double      real_ns_per_op;
+    double      cpu_ns_per_op;
+    double      items_per_second;
+};
+
+struct Options {
+    std::string filter;
+    std::string json_file;
+    std::string compare_file;
+    double      min_time = 0.2;      // Seconds per repetition
+    uint32_t    repetitions = 3;
+    double      threshold = 10.0;    // Regression threshold in percent
+};
+
+// Median of repeated, auto-calibrated runs
+BenchResult run_benchmark(const Benchmark& bench, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t iterations = 1;
+    double elapsed = 0.0;
+    while (true) {
+        auto start = Clock::now();
+        bench.body(iterations);
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (elapsed >= options.min_time || iterations >= (1ULL << 40)) {
+            break;
+        }
+        double scale = elapsed > 0.0 ? options.min_time * 1.4 / elapsed : 10.0;
+        iterations = std::max<uint64_t>(iterations + 1,
+                                        static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+    }
+
+    std::vector<BenchResult> runs;
+    for (uint32_t r = 0; r < std::max<uint32_t>(options.repetitions, 1); ++r) {
+        std::clock_t cpu_start = std::clock();
+        auto start = Clock::now();
+        uint64_t items = bench.body(iterations);
+        double real = std::chrono::duration<double>(Clock::now() - start).count();
+        double cpu = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+        // Per-op times are per item, so batch-style bodies compare directly
+        double ops = static_cast<double>(std::max<uint64_t>(items, 1));
+        runs.push_back({bench.name, bench.item_label, iterations,
+                        real * 1e9 / ops, cpu * 1e9 / ops,
+                        real > 0.0 ? items / real : 0.0});
+    }
+
+    std::sort(runs.begin(), runs.end(), [](const BenchResult& a, const BenchResult& b) {
+        return a.real_ns_per_op < b.real_ns_per_op;
+    });
+    return runs[runs.size() / 2];
+}
+
+// Engine: event scheduling and the run loop
+
+// Includes draining the queue when the engine is destroyed
+uint64_t bench_schedule_event(uint64_t iterations) {
+    SimConfig config{4, 32, CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY, ""};
+    SimulationEngine engine(config);
+    utils::Random random(42);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        engine.schedule_event(EventType::INSTRUCTION_FETCH,
+                              static_cast<SimTime>(random.get_int(1, 64)),
+                              reinterpret_cast<void*>(static_cast<uintptr_t>(i % 4)));
+    }
+    return iterations;
+}
+
+uint64_t bench_engine_run(uint64_t iterations, bool batched) {
+    // Without injected traffic every event is a fetch, so events == instructions
+    SimConfig config{32, 32, CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY, ""};
+    SimulationEngine engine(config);
+    engine.initialize();
+    engine.set_cycle_batching(batched);
+
+    SimTime cycles = std::max<uint64_t>(iterations / 8, 1);   // 8 fetches per cycle
+    engine.run_until(std::min(cycles, SimulationEngine::MAX_SIMULATION_CYCLES));
+    return engine.get_statistics().instructions_executed;
+}
+
+// Memory model access patterns
+
+uint64_t bench_access_hit(uint64_t iterations) {
+    MemoryModel memory(CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY);
+    const uint32_t footprint = CACHE_SIZE / 4;
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        sum += memory.process_request(static_cast<uint32_t>((i * 4) % footprint), 0, false);
+    }
+    g_sink = sum;
+    return iterations;
+}
+
+uint64_t bench_access_miss(uint64_t iterations) {
+    // One access per line over 4x the cache: every access misses, victims are clean
+    MemoryModel memory(CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY);
+    const uint64_t lines = 4 * CACHE_SIZE / LINE_SIZE;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        memory.process_request(static_cast<uint32_t>((i % lines) * LINE_SIZE), 0, false);
+    }
+    return iterations;
+}
+
+uint64_t bench_access_eviction(uint64_t iterations) {
+    // Writes over 4x the cache: every access misses and writes back a dirty victim
+    MemoryModel memory(CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY);
+    const uint64_t lines = 4 * CACHE_SIZE / LINE_SIZE;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        memory.process_request(static_cast<uint32_t>((i % lines) * LINE_SIZE),
+                               static_cast<uint32_t>(i), true);
+    }
+    return iterations;
+}
+
+uint64_t bench_access_streaming(uint64_t iterations) {
+    // Sequential words: one miss per line, then hits
+    MemoryModel memory(CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY);
+    for (uint64_t i = 0; i < iterations; ++i) {
+        memory.process_request(static_cast<uint32_t>(i * 4), 0, false);
+    }
+    return iterations;
+}
+
+uint64_t bench_lookup_cache(uint64_t iterations) {
+    MemoryModel memory(CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY);
+    const uint32_t footprint = CACHE_SIZE / 2;
+    for (uint32_t address = 0; address < footprint; address += LINE_SIZE) {
+        memory.process_request(address, 0, false);
+    }
+
+    uint64_t sum = 0;
+    uint32_t data = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        sum += memory.lookup_cache(static_cast<uint32_t>((i * 4) % footprint), data);
+    }
+    g_sink = sum;
+    return iterations;
+}
+
+uint64_t bench_select_victim(uint64_t iterations) {
+    // All addresses map to set 0 and exceed its ways, so every access runs
+    // the victim search over a full set
+    MemoryModel memory(CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY);
+    const uint32_t set_stride = CACHE_SIZE / 8;   // 8-way: one way's worth of sets
+    for (uint64_t i = 0; i < iterations; ++i) {
+        memory.process_request(static_cast<uint32_t>((i % 16) * set_stride), 0, false);
+    }
+    return iterations;
+}
+
+// Synthetic stress loads. The pattern benchmarks feed the generated stream
+// straight into the memory model; the engine one goes through trace
+// injection and the event loop, where every response also restarts a
+// fetch chain, so it measures the engine as much as the memory system.
+
+uint64_t bench_synthetic(uint64_t iterations, AccessPattern pattern) {
+    SyntheticConfig synthetic = SyntheticConfig::defaults(pattern);
+    synthetic.num_requests = iterations;
+    SyntheticWorkloadGenerator generator(synthetic);
+
+    MemoryModel memory(CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY);
+    uint64_t latency = 0;
+    uint64_t requests = 0;
+    while (true) {
+        std::vector<TraceRecord> chunk = generator.next(65536);
+        if (chunk.empty()) {
+            break;
+        }
+        for (const auto& record : chunk) {
+            latency += memory.access(record.trans.address, record.trans.data,
+                                     record.trans.is_write).latency;
+        }
+        requests += chunk.size();
+    }
+    g_sink = latency;
+    return requests;
+}
+
+uint64_t bench_synthetic_engine(uint64_t iterations) {
+    SyntheticConfig synthetic = SyntheticConfig::defaults(AccessPattern::RANDOM);
+
+    // Only as many requests as issue and drain within the engine's cycle
+    // limit; the items reported are the requests actually simulated
+    uint64_t issue_cycles = SimulationEngine::MAX_SIMULATION_CYCLES - 2 * MEMORY_LATENCY;
+    synthetic.num_requests = std::min<uint64_t>(
+        iterations, issue_cycles / synthetic.issue_interval * synthetic.num_warps);
+
+    SimConfig config{synthetic.num_warps, 32, CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY, ""};
+    SimulationEngine engine(config);
+    engine.initialize();
+    SyntheticWorkloadGenerator generator(synthetic);
+    generator.run(engine, generator.end_time() + 2 * MEMORY_LATENCY);
+    return engine.get_statistics().memory_requests;
+}
+
+// Program loading
+
+uint64_t bench_program_loader(uint64_t iterations, const std::string& source) {
+    // The loader reports each load on stdout; keep the benchmark output clean
+    std::ostringstream discard;
+    std::streambuf* saved = std::cout.rdbuf(discard.rdbuf());
+
+    uint64_t lines = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        auto memory = std::make_shared<MemoryModel>(CACHE_SIZE, LINE_SIZE, MEMORY_LATENCY);
+        ProgramLoader loader(memory);
+        uint32_t start = loader.load_assembly(source);
+        lines += (loader.get_program_counter() - start) / 4;
+        discard.str("");
+    }
+
+    std::cout.rdbuf(saved);
+    return lines;
+}
+
+std::string write_loader_source() {
+    std::string filename = "gpusim_bench_program.asm";
+    std::ofstream file(filename);
+    file << "# Synthetic loader benchmark input\n"
+         << ".data\n"
+         << "buffer:\n"
+         << "    .space 4096\n"
+         << ".text\n";
+    for (int block = 0; block < 64; ++block) {
+        file << "block_" << block << ":\n";
+        for (int i = 0; i < 14; ++i) {
+            file << "    add     $r" << (i % 16) << ", $r" << ((i + 1) % 16) << ", $r"
+                 << ((i + 2) % 16) << "\n";
+        }
+        file << "    addiu   $r1, $r0, buffer\n"
+             << "    bne     $r1, $r2, block_" << ((block + 1) % 64) << "\n";
+    }
+    return filename;
+}
+
+// Logging
+
+uint64_t bench_logger(uint64_t iterations, bool filtered) {
+    auto& logger = utils::Logger::instance();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        logger.log(filtered ? utils::LogLevel::DEBUG : utils::LogLevel::INFO,
+                   "warp 3 issued instruction", "sim_engine.cpp", 42);
+    }
+    return iterations;
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+void write_json(const std::vector<BenchResult>& results, const Options& options) {
+    std::ofstream file(options.json_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open benchmark output file: " + options.json_file);
+    }
+
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    file << "{\n"
+         << "  \"context\": {\n"
+         << "    \"date\": \"" << date << "\",\n"
+         << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+         << "    \"min_time\": " << options.min_time << ",\n"
+         << "    \"repetitions\": " << options.repetitions << "\n"
+         << "  },\n"
+         << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        file << "    {\n"
+             << "      \"name\": \"" << json_escape(r.name) << "\",\n"
+             << "      \"iterations\": " << r.iterations << ",\n"
+             << "      \"real_time\": " << std::fixed << std::setprecision(3) << r.real_ns_per_op << ",\n"
+             << "      \"cpu_time\": " << std::fixed << std::setprecision(3) << r.cpu_ns_per_op << ",\n"
+             << "      \"time_unit\": \"ns\",\n"
+             << "      \"items_per_second\": " << std::fixed << std::setprecision(1)
+             << r.items_per_second << ",\n"
+             << "      \"item_label\": \"" << r.item_label << "\"\n"
+             << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+}
+
+// Reads name/real_time pairs back from a file written by write_json
+std::vector<std::pair<std::string, double>> read_baseline(const std::string& filename) {
+    std::vector<std::pair<std::string, double>> baseline;
+    std::string name;
+    for (const auto& raw : utils::FileUtils::read_lines(filename)) {
+        std::string line = utils::StringUtils::trim(raw);
+        if (utils::StringUtils::starts_with(line, "\"name\":")) {
+            size_t first = line.find('"', 7);
+            size_t last = line.rfind('"');
+            name = line.substr(first + 1, last - first - 1);
+        } else if (utils::StringUtils::starts_with(line, "\"real_time\":")) {
+            baseline.push_back({name, std::stod(line.substr(12))});
+        }
+    }
+    return baseline;
+}
+
+int compare_with_baseline(const std::vector<BenchResult>& results, const Options& options) {
+    auto baseline = read_baseline(options.compare_file);
+    int regressions = 0;
+
+    std::cout << "\nComparison with " << options.compare_file << ":\n"
+              << std::string(17 + options.compare_file.size(), '=') << "\n";
+    for (const auto& r : results) {
+        auto it = std::find_if(baseline.begin(), baseline.end(),
+                               [&](const auto& entry) { return entry.first == r.name; });
+        if (it == baseline.end() || it->second <= 0.0) {
+            continue;
+        }
+        double change = (r.real_ns_per_op - it->second) / it->second * 100.0;
+        bool regressed = change > options.threshold;
+        regressions += regressed;
+        std::cout << std::left << std::setw(36) << r.name << std::right
+                  << std::setw(9) << std::showpos << std::fixed << std::setprecision(1)
+                  << change << "%" << std::noshowpos
+                  << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    return regressions;
+}
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --filter=<substring>     Run only benchmarks whose name contains it\n"
+              << "  --json=<file>            Write results as JSON\n"
+              << "  --compare=<file>         Compare against an earlier JSON result\n"
+              << "  --threshold=<percent>    Slowdown reported as a regression (default 10)\n"
+              << "  --min-time=<seconds>     Minimum time per repetition (default 0.2)\n"
+              << "  --repetitions=<n>        Repetitions, median is reported (default 3)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+        if (utils::StringUtils::starts_with(arg, "--filter=")) {
+            options.filter = value("--filter=");
+        } else if (utils::StringUtils::starts_with(arg, "--json=")) {
+            options.json_file = value("--json=");
+        } else if (utils::StringUtils::starts_with(arg, "--compare=")) {
+            options.compare_file = value("--compare=");
+        } else if (utils::StringUtils::starts_with(arg, "--threshold=")) {
+            options.threshold = std::stod(value("--threshold="));
+        } else if (utils::StringUtils::starts_with(arg, "--min-time=")) {
+            options.min_time = std::stod(value("--min-time="));
+        } else if (utils::StringUtils::starts_with(arg, "--repetitions=")) {
+            options.repetitions = static_cast<uint32_t>(std::stoul(value("--repetitions=")));
+        } else {
+            print_usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::string loader_source = write_loader_source();
+    utils::Logger::instance().init(utils::LogDestination::FILE, "gpusim_bench.log",
+                                   utils::LogLevel::INFO);
+
+    std::vector<Benchmark> benchmarks = {
+        {"SimulationEngine/schedule_event", "events", bench_schedule_event},
+        {"SimulationEngine/run", "events",
+         [](uint64_t n) { return bench_engine_run(n, false); }},
+        {"SimulationEngine/run_batched", "events",
+         [](uint64_t n) { return bench_engine_run(n, true); }},
+        {"MemoryModel/process_request/hit", "accesses", bench_access_hit},
+        {"MemoryModel/process_request/miss", "accesses", bench_access_miss},
+        {"MemoryModel/process_request/eviction", "accesses", bench_access_eviction},
+        {"MemoryModel/process_request/streaming", "accesses", bench_access_streaming},
+        {"MemoryModel/lookup_cache", "lookups", bench_lookup_cache},
+        {"MemoryModel/select_victim", "accesses", bench_select_victim},
+        {"Synthetic/streaming", "requests",
+         [](uint64_t n) { return bench_synthetic(n, AccessPattern::STREAMING); }},
+        {"Synthetic/strided", "requests",
+         [](uint64_t n) { return bench_synthetic(n, AccessPattern::STRIDED); }},
+        {"Synthetic/random", "requests",
+         [](uint64_t n) { return bench_synthetic(n, AccessPattern::RANDOM); }},
+        {"Synthetic/pointer_chase", "requests",
+         [](uint64_t n) { return bench_synthetic(n, AccessPattern::POINTER_CHASE); }},
+        {"Synthetic/hot_set", "requests",
+         [](uint64_t n) { return bench_synthetic(n, AccessPattern::HOT_SET); }},
+        {"Synthetic/zipfian", "requests",
+         [](uint64_t n) { return bench_synthetic(n, AccessPattern::ZIPFIAN); }},
+        {"Synthetic/interleaved", "requests",
+         [](uint64_t n) { return bench_synthetic(n, AccessPattern::INTERLEAVED); }},
+        {"Synthetic/engine_random", "requests", bench_synthetic_engine},
+        {"ProgramLoader/load_assembly", "lines",
+         [&](uint64_t n) { return bench_program_loader(n, loader_source); }},
+        {"Logger/log", "messages", [](uint64_t n) { return bench_logger(n, false); }},
+        {"Logger/log_filtered", "messages", [](uint64_t n) { return bench_logger(n, true); }},
+    };
+
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+              << std::setw(14) << "Time(ns/op)" << std::setw(14) << "CPU(ns/op)"
+              << std::setw(14) << "Iterations" << std::setw(20) << "Throughput" << "\n"
+              << std::string(102, '-') << "\n";
+
+    std::vector<BenchResult> results;
+    for (const auto& bench : benchmarks) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        BenchResult r = run_benchmark(bench, options);
+        std::cout << std::left << std::setw(40) << r.name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(1) << r.real_ns_per_op
+                  << std::setw(14) << std::fixed << std::setprecision(1) << r.cpu_ns_per_op
+                  << std::setw(14) << r.iterations
+                  << std::setw(12) << std::fixed << std::setprecision(2)
+                  << r.items_per_second / 1e6 << "M " << r.item_label << "/s\n";
+        results.push_back(r);
+    }
+
+    utils::Logger::instance().close();
+    std::remove(loader_source.c_str());
+
+    if (!options.json_file.empty()) {
+        write_json(results, options);
+    }
+    if (!options.compare_file.empty()) {
+        return compare_with_baseline(results, options) > 0 ? 2 : 0;
+    }
+    return 0;
+}
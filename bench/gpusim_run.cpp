@@ -0,0 +1,654 @@
+// gpusim_run.cpp
+// End-to-end workload runs of the assembly programs through the C++ engine
+
+#include "sim_engine.h"
+#include "memory_model.h"
+#include "program_loader.h"
+#include "warp_executor.h"
+#include "cta_dispatcher.h"
+#include "utils.h"
+#include "host_profiler.h"
+#include "timeline_trace.h"
+#include "cache_attribution.h"
+#include "reuse_profiler.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define GPUSIM_HAVE_FORK 1
+#endif
+
+using namespace gpu_simulator;
+
+// Allocation counting: every operator new in the process, the simulator
+// library included, goes through these replacements
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// Machine configuration (matches the RTL defaults used by gpusim_bench)
+constexpr uint32_t THREADS_PER_WARP = 32;
+constexpr uint32_t CACHE_SIZE = 16 * 1024;
+constexpr uint32_t SHARED_MEM_SIZE = 16 * 1024;     // Unified with the L1 by --carveout
+constexpr uint32_t LINE_SIZE = 64;
+constexpr uint32_t MEMORY_LATENCY = 100;
+
+struct Options {
+    std::string programs_dir = "programs";
+    std::string filter;
+    std::string json_file;
+    std::string compare_file;
+    uint32_t    num_warps = 32;
+    uint32_t    repetitions = 5;
+    double      min_time = 0.5;      // Seconds of simulation per workload
+    double      threshold = 10.0;    // Regression threshold in percent
+    uint64_t    rss_tolerance_kb = 1024;  // Peak RSS growth allowed (page-granular, noisy)
+    bool        profile = false;     // Report host phase timers per workload
+    std::string timeline_dir;        // Write one timeline per workload here
+    uint32_t    hot_entries = 0;     // Top-N miss attribution report (0 = off)
+    bool        reuse = false;       // Report sampled reuse distances and working set
+    std::vector<uint32_t> carveouts; // Shared-memory splits to run (empty = separate L1)
+    uint32_t    grid_blocks = 0;     // Thread blocks per launch (0 = one block of --warps)
+    uint32_t    block_warps = 4;     // Warps per thread block with --grid
+    bool        occupancy = false;   // Report occupancy and kernel progress (--grid)
+};
+
+// Measurements of one workload; fixed-size so a child can send it back
+struct RunMetrics {
+    uint64_t cycles;
+    uint64_t instructions;           // Warp instructions
+    uint64_t thread_instructions;
+    uint64_t memory_requests;
+    uint64_t allocations;            // operator new calls during the run
+    uint64_t peak_rss_kb;
+    double   wall_ms;                // Median over repetitions
+    double   cache_hit_rate;
+    uint32_t shared_carveout;        // Bytes in effect (unified storage only)
+    uint8_t  completed;              // All warps exited before the cycle limit
+    uint8_t  ok;
+};
+
+struct WorkloadResult {
+    std::string name;
+    RunMetrics  metrics;
+
+    double kips() const {
+        return metrics.wall_ms > 0.0 ? metrics.instructions / metrics.wall_ms : 0.0;
+    }
+    double thread_mips() const {
+        return metrics.wall_ms > 0.0 ? metrics.thread_instructions / metrics.wall_ms / 1000.0 : 0.0;
+    }
+    double cycles_per_second() const {
+        return metrics.wall_ms > 0.0 ? metrics.cycles / (metrics.wall_ms / 1000.0) : 0.0;
+    }
+};
+
+uint64_t peak_rss_kb() {
+#ifdef GPUSIM_HAVE_FORK
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;   // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
+
+// Assembles the program and runs it to completion; the returned counts
+// cover the simulation only, not assembly
+RunMetrics run_once(const std::string& path, const Options& options,
+                    TimelineTrace* timeline = nullptr,
+                    CacheAttribution* attribution = nullptr,
+                    ReuseProfiler* reuse = nullptr,
+                    std::ostream* occupancy = nullptr) {
+    std::ostringstream discard;
+    std::streambuf* saved = std::cout.rdbuf(discard.rdbuf());
+    ProgramLoader loader(nullptr);
+    try {
+        loader.load_assembly(path);
+    } catch (...) {
+        std::cout.rdbuf(saved);
+        throw;
+    }
+    std::cout.rdbuf(saved);
+    auto program = loader.program();
+
+    SimConfig config{options.num_warps, THREADS_PER_WARP, CACHE_SIZE, LINE_SIZE,
+                     MEMORY_LATENCY, ""};
+    if (!options.carveouts.empty()) {
+        // The caller runs one split at a time
+        config.unified_storage_size = CACHE_SIZE + SHARED_MEM_SIZE;
+        config.shared_carveout = options.carveouts.front();
+    }
+    SimulationEngine engine(config);
+    std::unique_ptr<WarpExecutor> executor;
+    std::unique_ptr<CtaDispatcher> dispatcher;
+    if (options.grid_blocks > 0) {
+        // The dispatcher sizes the carveout and shared window per block
+        engine.initialize();
+        dispatcher = std::make_unique<CtaDispatcher>(std::vector<SimulationEngine*>{&engine});
+        dispatcher->launch(KernelLaunch{std::filesystem::path(path).stem().string(), program,
+                                        options.grid_blocks, options.block_warps});
+        dispatcher->start();
+    } else {
+        if (!options.carveouts.empty()) {
+            engine.set_shared_memory(program->shared_base, program->shared_size);
+        }
+        engine.initialize();
+        engine.attach_program(program->image);
+        executor = std::make_unique<WarpExecutor>(program, engine.memory_model(),
+                                                  options.num_warps, THREADS_PER_WARP, LINE_SIZE);
+        engine.set_executor(executor.get());
+    }
+    engine.set_timeline(timeline);
+    if (attribution) {
+        attribution->set_symbols(program->symbols);
+        engine.add_memory_observer(attribution);
+    }
+    if (reuse) {
+        engine.add_memory_observer(reuse);
+    }
+
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    engine.run();
+    double wall_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    SimStats stats = engine.get_statistics();
+    RunMetrics metrics{};
+    metrics.cycles = engine.get_current_time();
+    metrics.instructions = stats.instructions_executed;
+    metrics.thread_instructions = dispatcher ? dispatcher->thread_instructions()
+                                             : executor->thread_instructions();
+    metrics.memory_requests = stats.memory_requests;
+    metrics.allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+    metrics.wall_ms = wall_ms;
+    metrics.cache_hit_rate = stats.cache_hit_rate;
+    metrics.shared_carveout = engine.carveout().shared_size;
+    metrics.completed = dispatcher ? dispatcher->done() : executor->all_exited();
+    metrics.ok = 1;
+    if (occupancy && dispatcher) {
+        dispatcher->print_occupancy(*occupancy);
+        dispatcher->print_statistics(*occupancy);
+    }
+    return metrics;
+}
+
+RunMetrics run_workload(const std::string& path, const Options& options) {
+    if (options.profile) {
+        utils::HostProfiler::instance().set_enabled(true);
+        utils::HostProfiler::instance().reset();
+    }
+
+    // Short workloads repeat until min_time so the median is not noise
+    std::vector<RunMetrics> runs;
+    double total_ms = 0.0;
+    while (runs.size() < std::max<uint32_t>(options.repetitions, 1) ||
+           total_ms < options.min_time * 1000.0) {
+        runs.push_back(run_once(path, options));
+        total_ms += runs.back().wall_ms;
+    }
+    std::sort(runs.begin(), runs.end(), [](const RunMetrics& a, const RunMetrics& b) {
+        return a.wall_ms < b.wall_ms;
+    });
+    RunMetrics metrics = runs[runs.size() / 2];
+    metrics.peak_rss_kb = peak_rss_kb();
+
+    if (options.profile) {
+        // stderr: a forked child leaves without flushing std::cout
+        std::cerr << "\n" << std::filesystem::path(path).stem().string()
+                  << " (" << runs.size() << " runs)";
+        utils::HostProfiler::instance().print(std::cerr);
+    }
+
+    // One extra run, kept out of the measurements, records the timeline
+    if (!options.timeline_dir.empty()) {
+        std::filesystem::create_directories(options.timeline_dir);
+        auto file = std::filesystem::path(options.timeline_dir) /
+                    (std::filesystem::path(path).stem().string() + ".json");
+        TimelineTrace timeline(file.string());
+        run_once(path, options, &timeline);
+    }
+    if (options.hot_entries > 0) {
+        CacheAttribution attribution(LINE_SIZE);
+        run_once(path, options, nullptr, &attribution);
+        std::cerr << "\n" << std::filesystem::path(path).stem().string() << " (hot spots)";
+        attribution.print(std::cerr, options.hot_entries);
+    }
+    if (options.reuse) {
+        ReuseProfiler reuse(LINE_SIZE, options.num_warps);
+        run_once(path, options, nullptr, nullptr, &reuse);
+        std::cerr << "\n" << std::filesystem::path(path).stem().string() << " (reuse)";
+        reuse.print(std::cerr, true);
+    }
+    if (options.occupancy && options.grid_blocks > 0) {
+        run_once(path, options, nullptr, nullptr, nullptr, &std::cerr);
+    }
+    return metrics;
+}
+
+#ifdef GPUSIM_HAVE_FORK
+bool read_fully(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::read(fd, bytes, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void write_fully(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd, bytes, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+#endif
+
+// Each workload runs in its own process so peak RSS is its own
+RunMetrics run_isolated(const std::string& path, const Options& options) {
+#ifdef GPUSIM_HAVE_FORK
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        throw std::runtime_error("Could not create pipe for workload " + path);
+    }
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        throw std::runtime_error("fork() failed for workload " + path);
+    }
+    if (pid == 0) {
+        ::close(fds[0]);
+        int code = 0;
+        try {
+            RunMetrics metrics = run_workload(path, options);
+            write_fully(fds[1], &metrics, sizeof(metrics));
+        } catch (const std::exception& e) {
+            std::cerr << path << ": " << e.what() << "\n";
+            code = 1;
+        }
+        std::cerr.flush();
+        ::_exit(code);
+    }
+
+    ::close(fds[1]);
+    RunMetrics metrics{};
+    bool ok = read_fully(fds[0], &metrics, sizeof(metrics));
+    ::close(fds[0]);
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    metrics.ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return metrics;
+#else
+    return run_workload(path, options);
+#endif
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+void write_json(const std::vector<WorkloadResult>& results, const Options& options) {
+    std::ofstream file(options.json_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open results file: " + options.json_file);
+    }
+
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    file << "{\n"
+         << "  \"context\": {\n"
+         << "    \"date\": \"" << date << "\",\n"
+         << "    \"num_warps\": " << options.num_warps << ",\n"
+         << "    \"threads_per_warp\": " << THREADS_PER_WARP << ",\n"
+         << "    \"cache_size\": " << CACHE_SIZE << ",\n"
+         << "    \"cache_line_size\": " << LINE_SIZE << ",\n"
+         << "    \"memory_latency\": " << MEMORY_LATENCY << ",\n"
+         << "    \"repetitions\": " << options.repetitions << ",\n"
+         << "    \"min_time\": " << options.min_time << "\n"
+         << "  },\n"
+         << "  \"workloads\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        const auto& m = r.metrics;
+        file << "    {\n"
+             << "      \"name\": \"" << json_escape(r.name) << "\",\n"
+             << "      \"completed\": " << (m.completed ? "true" : "false") << ",\n"
+             << "      \"cycles\": " << m.cycles << ",\n"
+             << "      \"instructions\": " << m.instructions << ",\n"
+             << "      \"thread_instructions\": " << m.thread_instructions << ",\n"
+             << "      \"memory_requests\": " << m.memory_requests << ",\n"
+             << "      \"wall_ms\": " << std::fixed << std::setprecision(3) << m.wall_ms << ",\n"
+             << "      \"kips\": " << std::fixed << std::setprecision(1) << r.kips() << ",\n"
+             << "      \"thread_mips\": " << std::fixed << std::setprecision(3)
+             << r.thread_mips() << ",\n"
+             << "      \"cycles_per_second\": " << std::fixed << std::setprecision(1)
+             << r.cycles_per_second() << ",\n"
+             << "      \"peak_rss_kb\": " << m.peak_rss_kb << ",\n"
+             << "      \"allocations\": " << m.allocations << "\n"
+             << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+}
+
+// Baseline values per workload, read back from a file written by write_json
+struct Baseline {
+    std::string name;
+    uint64_t    cycles = 0;
+    double      cycles_per_second = 0.0;
+    uint64_t    peak_rss_kb = 0;
+    uint64_t    allocations = 0;
+};
+
+std::vector<Baseline> read_baseline(const std::string& filename) {
+    std::vector<Baseline> baseline;
+    for (const auto& raw : utils::FileUtils::read_lines(filename)) {
+        std::string line = utils::StringUtils::trim(raw);
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, colon);
+        std::string value = utils::StringUtils::trim(line.substr(colon + 1));
+        if (!value.empty() && value.back() == ',') {
+            value.pop_back();
+        }
+        if (key == "\"name\"") {
+            baseline.push_back({});
+            baseline.back().name = value.substr(1, value.size() - 2);
+        } else if (baseline.empty()) {
+            continue;
+        } else if (key == "\"cycles\"") {
+            baseline.back().cycles = std::stoull(value);
+        } else if (key == "\"cycles_per_second\"") {
+            baseline.back().cycles_per_second = std::stod(value);
+        } else if (key == "\"peak_rss_kb\"") {
+            baseline.back().peak_rss_kb = std::stoull(value);
+        } else if (key == "\"allocations\"") {
+            baseline.back().allocations = std::stoull(value);
+        }
+    }
+    return baseline;
+}
+
+double percent_change(double current, double base) {
+    return base > 0.0 ? (current - base) / base * 100.0 : 0.0;
+}
+
+// A different simulated cycle count means the model changed and always
+// fails. Throughput drops and allocation growth beyond the threshold are
+// regressions; peak RSS moves in whole pages, so its growth is judged
+// against an absolute tolerance instead.
+int compare_with_baseline(const std::vector<WorkloadResult>& results, const Options& options) {
+    auto baseline = read_baseline(options.compare_file);
+    int regressions = 0;
+
+    std::cout << "\nComparison with " << options.compare_file << ":\n"
+              << std::string(17 + options.compare_file.size(), '=') << "\n"
+              << std::left << std::setw(24) << "Workload" << std::right
+              << std::setw(12) << "Cycles/s" << std::setw(14) << "PeakRSS(KB)"
+              << std::setw(12) << "Allocs" << "\n";
+    for (const auto& r : results) {
+        auto it = std::find_if(baseline.begin(), baseline.end(),
+                               [&](const Baseline& b) { return b.name == r.name; });
+        if (it == baseline.end()) {
+            std::cout << std::left << std::setw(24) << r.name << std::right
+                      << "  not in baseline\n";
+            continue;
+        }
+        if (!r.metrics.ok) {
+            continue;
+        }
+        double speed = percent_change(r.cycles_per_second(), it->cycles_per_second);
+        int64_t rss = static_cast<int64_t>(r.metrics.peak_rss_kb) -
+                      static_cast<int64_t>(it->peak_rss_kb);
+        double allocs = percent_change(static_cast<double>(r.metrics.allocations),
+                                       static_cast<double>(it->allocations));
+        bool cycles_changed = r.metrics.cycles != it->cycles;
+        bool regressed = cycles_changed || -speed > options.threshold ||
+                         rss > static_cast<int64_t>(options.rss_tolerance_kb) ||
+                         allocs > options.threshold;
+        regressions += regressed;
+
+        std::cout << std::left << std::setw(24) << r.name << std::right << std::showpos
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(11) << speed << "%" << std::setw(14) << rss
+                  << std::setw(11) << allocs << "%" << std::noshowpos
+                  << (regressed ? "  REGRESSION" : "");
+        if (cycles_changed) {
+            std::cout << "  cycles " << it->cycles << " -> " << r.metrics.cycles;
+        }
+        std::cout << "\n";
+    }
+    return regressions;
+}
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --programs=<dir>         Directory of .asm workloads (default programs)\n"
+              << "  --filter=<substring>     Run only workloads whose name contains it\n"
+              << "  --warps=<n>              Warps per run (default 32)\n"
+              << "  --repetitions=<n>        Minimum repetitions, median is reported (default 5)\n"
+              << "  --min-time=<seconds>     Minimum simulation time per workload (default 0.5)\n"
+              << "  --json=<file>            Write results as JSON\n"
+              << "  --compare=<file>         Compare against an earlier JSON result\n"
+              << "  --threshold=<percent>    Change reported as a regression (default 10)\n"
+              << "  --rss-tolerance=<kb>     Peak RSS growth allowed by --compare (default 1024)\n"
+              << "  --profile                Print host time per simulator phase\n"
+              << "  --timeline=<dir>         Write a Chrome/Perfetto timeline per workload\n"
+              << "  --hot=<n>                Report the top n PCs, lines and symbols by misses\n"
+              << "  --reuse                  Report sampled reuse distances and working set\n"
+              << "  --carveout=<list>        Unify L1 and shared memory and run each split:\n"
+              << "                           shared bytes or auto, comma separated\n"
+              << "  --grid=<n>               Launch n thread blocks through the CTA dispatcher\n"
+              << "                           (--warps is then the warp slots per SM)\n"
+              << "  --block-warps=<n>        Warps per thread block with --grid (default 4)\n"
+              << "  --occupancy              Report occupancy and kernel progress with --grid\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+        if (utils::StringUtils::starts_with(arg, "--programs=")) {
+            options.programs_dir = value("--programs=");
+        } else if (utils::StringUtils::starts_with(arg, "--filter=")) {
+            options.filter = value("--filter=");
+        } else if (utils::StringUtils::starts_with(arg, "--warps=")) {
+            options.num_warps = static_cast<uint32_t>(std::stoul(value("--warps=")));
+        } else if (utils::StringUtils::starts_with(arg, "--repetitions=")) {
+            options.repetitions = static_cast<uint32_t>(std::stoul(value("--repetitions=")));
+        } else if (utils::StringUtils::starts_with(arg, "--min-time=")) {
+            options.min_time = std::stod(value("--min-time="));
+        } else if (utils::StringUtils::starts_with(arg, "--json=")) {
+            options.json_file = value("--json=");
+        } else if (utils::StringUtils::starts_with(arg, "--compare=")) {
+            options.compare_file = value("--compare=");
+        } else if (utils::StringUtils::starts_with(arg, "--threshold=")) {
+            options.threshold = std::stod(value("--threshold="));
+        } else if (utils::StringUtils::starts_with(arg, "--rss-tolerance=")) {
+            options.rss_tolerance_kb = std::stoull(value("--rss-tolerance="));
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (utils::StringUtils::starts_with(arg, "--timeline=")) {
+            options.timeline_dir = value("--timeline=");
+        } else if (utils::StringUtils::starts_with(arg, "--hot=")) {
+            options.hot_entries = static_cast<uint32_t>(std::stoul(value("--hot=")));
+        } else if (utils::StringUtils::starts_with(arg, "--carveout=")) {
+            for (const auto& token : utils::StringUtils::split(value("--carveout="), ',')) {
+                std::string split = utils::StringUtils::trim(token);
+                options.carveouts.push_back(split == "auto" ? SimConfig::AUTO_CARVEOUT
+                    : static_cast<uint32_t>(std::stoul(split, nullptr, 0)));
+            }
+        } else if (arg == "--reuse") {
+            options.reuse = true;
+        } else if (utils::StringUtils::starts_with(arg, "--grid=")) {
+            options.grid_blocks = static_cast<uint32_t>(std::stoul(value("--grid=")));
+        } else if (utils::StringUtils::starts_with(arg, "--block-warps=")) {
+            options.block_warps = static_cast<uint32_t>(std::stoul(value("--block-warps=")));
+        } else if (arg == "--occupancy") {
+            options.occupancy = true;
+        } else {
+            print_usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<std::filesystem::path> workloads;
+    for (const auto& entry : std::filesystem::directory_iterator(options.programs_dir)) {
+        const auto& path = entry.path();
+        if (path.extension() == ".asm" &&
+            (options.filter.empty() ||
+             path.stem().string().find(options.filter) != std::string::npos)) {
+            workloads.push_back(path);
+        }
+    }
+    std::sort(workloads.begin(), workloads.end());
+    if (workloads.empty()) {
+        std::cerr << "No workloads found in " << options.programs_dir << "\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(24) << "Workload" << std::right
+              << std::setw(10) << "Cycles" << std::setw(10) << "Instrs"
+              << std::setw(10) << "Wall(ms)" << std::setw(10) << "KIPS"
+              << std::setw(13) << "ThreadMIPS" << std::setw(12) << "Cycles/s"
+              << std::setw(12) << "PeakRSS(KB)" << std::setw(10) << "Allocs" << "\n"
+              << std::string(111, '-') << "\n";
+
+    // One run per workload, or per workload and split with --carveout
+    std::vector<std::pair<std::filesystem::path, Options>> points;
+    for (const auto& path : workloads) {
+        if (options.carveouts.empty()) {
+            points.emplace_back(path, options);
+        }
+        for (uint32_t carveout : options.carveouts) {
+            points.emplace_back(path, options);
+            points.back().second.carveouts = {carveout};
+        }
+    }
+
+    std::vector<WorkloadResult> results;
+    bool all_ok = true;
+    for (const auto& [path, point] : points) {
+        WorkloadResult result{path.stem().string(), run_isolated(path.string(), point)};
+        const auto& m = result.metrics;
+        all_ok &= m.ok && m.completed;
+        if (point.grid_blocks > 0) {
+            result.name += "@" + std::to_string(point.grid_blocks) + "x" +
+                           std::to_string(point.block_warps);
+        }
+        if (!point.carveouts.empty()) {
+            uint32_t requested = point.carveouts.front();
+            result.name += requested != SimConfig::AUTO_CARVEOUT
+                ? "@" + std::to_string(requested / 1024) + "K"
+                : "@auto:" + std::to_string(m.shared_carveout / 1024) + "K";
+        }
+
+        std::cout << std::left << std::setw(24) << result.name << std::right;
+        if (!m.ok) {
+            std::cout << "  failed\n";
+            continue;
+        }
+        std::cout << std::setw(10) << m.cycles << std::setw(10) << m.instructions
+                  << std::setw(10) << std::fixed << std::setprecision(2) << m.wall_ms
+                  << std::setw(10) << std::fixed << std::setprecision(1) << result.kips()
+                  << std::setw(13) << std::fixed << std::setprecision(2) << result.thread_mips()
+                  << std::setw(12) << std::fixed << std::setprecision(0)
+                  << result.cycles_per_second()
+                  << std::setw(12) << m.peak_rss_kb << std::setw(10) << m.allocations
+                  << (m.completed ? "" : "  (cycle limit)") << "\n";
+        results.push_back(result);
+    }
+
+    if (!options.json_file.empty()) {
+        write_json(results, options);
+    }
+    if (!options.compare_file.empty() && compare_with_baseline(results, options) > 0) {
+        return 2;
+    }
+    return all_ok ? 0 : 1;
+}
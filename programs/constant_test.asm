@@ -0,0 +1,59 @@
+# constant_test.asm
+# Test program for the constant cache and read-only load path
+#
+# This program tests the two non-coherent load paths:
+# 1. Warp-uniform constant loads (one fetch broadcast to all lanes)
+# 2. Divergent constant loads (one serialized fetch per distinct address)
+# 3. Read-only loads of an input array (ld.nc, coalesced per line)
+
+.data
+    .align 4
+# Kernel parameters, read by every thread
+params:
+    .word 1024, 3                 # Element count, scale factor
+# Small coefficient table indexed by lane group
+coefficients:
+    .word 1, 2, 3, 4
+
+# Input and output arrays
+input_array:
+    .space 4096                   # 1024 elements * 4 bytes
+output_array:
+    .space 4096                   # 1024 elements * 4 bytes
+
+.text
+.global main
+
+main:
+    # Uniform constant loads: every lane reads the same word
+    addiu   $r1, $r0, params
+    ld.c    $r2, $r1, 0            # r2 = element count
+    ld.c    $r3, $r1, 4            # r3 = scale factor
+
+    # Global thread ID
+    tid     $r4                    # r4 = thread ID within warp (0-31)
+    warpid  $r5                    # r5 = warp ID
+    shl     $r6, $r5, 5            # r6 = warp ID * 32
+    add     $r6, $r6, $r4          # r6 = global thread ID
+
+    cmp     $r7, $r6, $r2          # r7 = (global_thread_id < count) ? 1 : 0
+    beq     $r7, $r0, exit_thread
+
+    # Divergent constant load: four distinct addresses per warp
+    andi    $r8, $r4, 3            # r8 = thread ID & 3
+    shl     $r8, $r8, 2            # r8 = coefficient offset
+    addiu   $r9, $r0, coefficients
+    ld.c    $r10, $r9, $r8         # r10 = coefficients[thread ID & 3]
+
+    # Read-only load of the input, then a normal store of the result
+    shl     $r11, $r6, 2           # r11 = byte offset
+    addiu   $r12, $r0, input_array
+    ld.nc   $r13, $r12, $r11       # r13 = input_array[global_thread_id]
+    mul     $r13, $r13, $r3        # r13 = r13 * scale
+    add     $r13, $r13, $r10       # r13 = r13 + coefficient
+    addiu   $r14, $r0, output_array
+    st.w    $r13, $r14, $r11       # output_array[global_thread_id] = r13
+
+exit_thread:
+    barrier 0
+    exit
@@ -4,6 +4,7 @@
 #include "dpi_wrapper.h"
 #include "sim_engine.h"
 #include "memory_model.h"
+#include "host_profiler.h"
 #include <stdexcept>
 #include <cassert>
 #include <iostream>
@@ -60,6 +61,7 @@ void DPIWrapper::cleanup() {
 
 DPIError DPIWrapper::process_memory_request(const MemoryTransactionDPI& transaction) {
     if (!initialized_) return DPIError::SIMULATION_ERROR;
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
 
     try {
         validate_address(transaction.address);
@@ -111,6 +113,7 @@ DPIError DPIWrapper::get_memory_response(uint32_t& data) {
 
 DPIError DPIWrapper::process_instruction(const InstructionDPI& instruction) {
     if (!initialized_) return DPIError::SIMULATION_ERROR;
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
 
     try {
         validate_warp_id(instruction.warp_id);
@@ -130,6 +133,7 @@ DPIError DPIWrapper::process_instruction(const InstructionDPI& instruction) {
 
 DPIError DPIWrapper::get_next_instruction(uint32_t warp_id, InstructionDPI& instruction) {
     if (!initialized_) return DPIError::SIMULATION_ERROR;
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
 
     try {
         validate_warp_id(warp_id);
@@ -149,6 +153,7 @@ DPIError DPIWrapper::get_next_instruction(uint32_t warp_id, InstructionDPI& inst
 
 DPIError DPIWrapper::update_warp_state(uint32_t warp_id, const WarpStateDPI& state) {
     if (!initialized_) return DPIError::SIMULATION_ERROR;
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
 
     try {
         validate_warp_id(warp_id);
@@ -162,6 +167,7 @@ DPIError DPIWrapper::update_warp_state(uint32_t warp_id, const WarpStateDPI& sta
 
 DPIError DPIWrapper::get_warp_state(uint32_t warp_id, WarpStateDPI& state) {
     if (!initialized_) return DPIError::SIMULATION_ERROR;
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
 
     try {
         validate_warp_id(warp_id);
@@ -175,12 +181,14 @@ DPIError DPIWrapper::get_warp_state(uint32_t warp_id, WarpStateDPI& state) {
 
 DPIError DPIWrapper::get_cache_stats(CacheStatsDPI& stats) {
     if (!initialized_) return DPIError::SIMULATION_ERROR;
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
 
     try {
-        auto [hits, misses] = memory_model_->get_cache_stats();
-        stats.hits = hits;
-        stats.misses = misses;
-        // TODO: Get additional statistics from memory model
+        CacheStats cache = memory_model_->get_cache_statistics();
+        stats.hits = cache.hits;
+        stats.misses = cache.misses;
+        stats.evictions = cache.evictions;
+        stats.bank_conflicts = cache.bank_conflicts;
         return DPIError::SUCCESS;
     } catch (const std::exception& e) {
         std::cerr << "Error in get_cache_stats: " << e.what() << std::endl;
@@ -190,6 +198,7 @@ DPIError DPIWrapper::get_cache_stats(CacheStatsDPI& stats) {
 
 DPIError DPIWrapper::get_performance_counters(PerformanceCountersDPI& counters) {
     if (!initialized_) return DPIError::SIMULATION_ERROR;
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
 
     try {
         SimStats stats = sim_engine_->get_statistics();
@@ -224,16 +233,19 @@ void DPIWrapper::validate_address(uint32_t address) const {
     }
 }
 
+} // namespace dpi
+} // namespace gpu_simulator
+
 // DPI-C exported function implementations
 extern "C" {
 
 int initialize_simulator(const gpu_simulator::dpi::ConfigDPI* config) {
     try {
         gpu_simulator::dpi::DPIWrapper::instance().initialize(*config);
-        return static_cast<int>(DPIError::SUCCESS);
+        return static_cast<int>(gpu_simulator::dpi::DPIError::SUCCESS);
     } catch (const std::exception& e) {
         std::cerr << "Error initializing simulator: " << e.what() << std::endl;
-        return static_cast<int>(DPIError::SIMULATION_ERROR);
+        return static_cast<int>(gpu_simulator::dpi::DPIError::SIMULATION_ERROR);
     }
 }
 
@@ -0,0 +1,288 @@
+// batch_runner.cpp
+// Implementation of concurrent parameter sweeps
+
+#include "batch_runner.h"
+#include "thread_pool.h"
+#include "warp_executor.h"
+#include "utils.h"
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+
+namespace gpu_simulator {
+
+namespace {
+
+std::vector<uint32_t> parse_values(const std::string& key, const std::string& list) {
+    std::vector<uint32_t> values;
+    for (const auto& token : utils::StringUtils::split(list, ',')) {
+        std::string value = utils::StringUtils::trim(token);
+        if (value.empty()) {
+            continue;
+        }
+        if (key == "shared_carveout" && value == "auto") {
+            values.push_back(SimConfig::AUTO_CARVEOUT);
+            continue;
+        }
+        try {
+            values.push_back(static_cast<uint32_t>(std::stoul(value, nullptr, 0)));
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Invalid value '" + value + "' for " + key);
+        }
+    }
+    if (values.empty()) {
+        throw std::invalid_argument("No values given for " + key);
+    }
+    return values;
+}
+
+// Use the swept values, or the base value when the list is empty
+std::vector<uint32_t> or_base(const std::vector<uint32_t>& values, uint32_t base) {
+    return values.empty() ? std::vector<uint32_t>{base} : values;
+}
+
+// Shared-memory bytes of a resolved configuration (0 without unified storage)
+uint32_t carveout_bytes(const SimConfig& config) {
+    return config.unified_storage_size ? config.shared_carveout : 0;
+}
+
+// Quote a CSV field when it holds a separator, quote or line break
+std::string csv_quote(const std::string& field) {
+    if (field.find_first_of(",\"\n") == std::string::npos) {
+        return field;
+    }
+    std::string quoted = "\"";
+    for (char c : field) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+SweepSpec SweepSpec::parse(const std::string& text, const SimConfig& base) {
+    SweepSpec spec;
+    spec.base = base;
+
+    std::istringstream stream(text);
+    std::string line;
+    uint32_t line_num = 0;
+    while (std::getline(stream, line)) {
+        line_num++;
+        line = utils::StringUtils::trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Sweep spec line " + std::to_string(line_num) +
+                                        ": expected key = values");
+        }
+        std::string key = utils::StringUtils::trim(line.substr(0, eq));
+        std::vector<uint32_t> values = parse_values(key, line.substr(eq + 1));
+
+        if (key == "cache_size") {
+            spec.cache_sizes = values;
+        } else if (key == "cache_line_size") {
+            spec.cache_line_sizes = values;
+        } else if (key == "memory_latency") {
+            spec.memory_latencies = values;
+        } else if (key == "num_warps") {
+            spec.num_warps = values;
+        } else if (key == "shared_carveout") {
+            spec.shared_carveouts = values;
+        } else if (key == "threads_per_warp") {
+            spec.base.threads_per_warp = values.front();
+        } else if (key == "unified_storage_size") {
+            spec.base.unified_storage_size = values.front();
+        } else {
+            throw std::invalid_argument("Sweep spec line " + std::to_string(line_num) +
+                                        ": unknown key '" + key + "'");
+        }
+    }
+
+    return spec;
+}
+
+SweepSpec SweepSpec::load(const std::string& filename, const SimConfig& base) {
+    return parse(utils::FileUtils::read_file(filename), base);
+}
+
+std::vector<SimConfig> SweepSpec::expand() const {
+    std::vector<SimConfig> configs;
+    for (uint32_t size : or_base(cache_sizes, base.cache_size)) {
+        for (uint32_t line : or_base(cache_line_sizes, base.cache_line_size)) {
+            for (uint32_t latency : or_base(memory_latencies, base.memory_latency)) {
+                for (uint32_t warps : or_base(num_warps, base.num_warps)) {
+                    for (uint32_t carveout : or_base(shared_carveouts, base.shared_carveout)) {
+                        SimConfig config = base;
+                        config.cache_size = size;
+                        config.cache_line_size = line;
+                        config.memory_latency = latency;
+                        config.num_warps = warps;
+                        config.shared_carveout = carveout;
+                        configs.push_back(config);
+                    }
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+BatchRunner::BatchRunner(std::shared_ptr<const Workload> workload, uint32_t num_threads)
+    : workload_(std::move(workload))
+    , num_threads_(num_threads) {
+}
+
+std::vector<SweepResult> BatchRunner::run(const SweepSpec& spec) const {
+    return run(spec.expand());
+}
+
+std::vector<SweepResult> BatchRunner::run(const std::vector<SimConfig>& configs) const {
+    std::vector<SweepResult> results(configs.size());
+
+    // Points share nothing mutable, so each one is an independent job
+    utils::WorkStealingPool pool(num_threads_);
+    for (size_t i = 0; i < configs.size(); ++i) {
+        pool.submit([this, &configs, &results, i] {
+            // An exception escaping a pool job would terminate the sweep
+            try {
+                results[i] = run_point(configs[i]);
+            } catch (const std::exception& e) {
+                results[i] = SweepResult{configs[i], SimStats{}, 0.0, e.what()};
+            }
+        });
+    }
+    pool.wait();
+
+    return results;
+}
+
+SweepResult BatchRunner::run_point(const SimConfig& config) const {
+    utils::Timer timer;
+    timer.start();
+
+    SimulationEngine engine(config);
+    std::shared_ptr<const Program> kernel = workload_ ? workload_->kernel : nullptr;
+    if (kernel) {
+        if (kernel->shared_size > 0) {
+            engine.set_shared_memory(kernel->shared_base, kernel->shared_size);
+        }
+        engine.initialize();
+        engine.attach_program(kernel->image);
+
+        const SimConfig& carved = engine.get_config();
+        WarpExecutor executor(kernel, engine.memory_model(), carved.num_warps,
+                              carved.threads_per_warp, carved.cache_line_size);
+        engine.set_executor(&executor);
+        engine.run();
+        if (!executor.all_exited()) {
+            throw std::runtime_error("Kernel did not finish within " +
+                                     std::to_string(SimulationEngine::MAX_SIMULATION_CYCLES) +
+                                     " cycles");
+        }
+    } else {
+        if (workload_ && workload_->shared_size > 0) {
+            engine.set_shared_memory(workload_->shared_base, workload_->shared_size);
+        }
+        engine.initialize();
+        run_trace(engine);
+    }
+
+    timer.stop();
+    return SweepResult{engine.get_config(), engine.get_statistics(), timer.elapsed_ms(), ""};
+}
+
+void BatchRunner::run_trace(SimulationEngine& engine) const {
+    if (workload_ && workload_->program) {
+        engine.attach_program(workload_->program);
+    }
+    if (!workload_ || workload_->trace.empty()) {
+        engine.stop();
+        return;
+    }
+    engine.inject_trace(workload_->trace);
+
+    // Reads are profiled when answered and writes when issued, so the
+    // trace is drained once the profile holds one sample per request
+    uint64_t requests = workload_->trace.size();
+    auto drained = [&] { return engine.latency_profile().total().count() >= requests; };
+
+    SimTime last_issue = 0;
+    for (const auto& record : workload_->trace) {
+        last_issue = std::max(last_issue, record.time);
+    }
+    bool running = engine.run_until(last_issue + 1);
+    while (running && !drained() && engine.has_pending_events()) {
+        running = engine.run_until(engine.next_event_time() + 1);
+    }
+    if (!drained()) {
+        throw std::runtime_error("Trace did not drain within " +
+                                 std::to_string(SimulationEngine::MAX_SIMULATION_CYCLES) +
+                                 " cycles");
+    }
+    engine.stop();
+}
+
+void BatchRunner::print_table(const std::vector<SweepResult>& results, std::ostream& out) {
+    out << "\nParameter Sweep Results:\n"
+        << "========================\n"
+        << std::setw(10) << "CacheSize" << std::setw(8) << "Line"
+        << std::setw(9) << "MemLat" << std::setw(7) << "Warps" << std::setw(8) << "Shared"
+        << std::setw(12) << "Cycles" << std::setw(14) << "Instructions"
+        << std::setw(8) << "IPC" << std::setw(10) << "HitRate"
+        << std::setw(11) << "Wall(ms)" << "\n";
+
+    for (const auto& result : results) {
+        out << std::setw(10) << result.config.cache_size
+            << std::setw(8) << result.config.cache_line_size
+            << std::setw(9) << result.config.memory_latency
+            << std::setw(7) << result.config.num_warps
+            << std::setw(8) << carveout_bytes(result.config);
+        if (!result.error.empty()) {
+            out << "  failed: " << result.error << "\n";
+            continue;
+        }
+        out << std::setw(12) << result.stats.total_cycles
+            << std::setw(14) << result.stats.instructions_executed
+            << std::setw(8) << std::fixed << std::setprecision(2) << result.stats.ipc
+            << std::setw(9) << std::fixed << std::setprecision(2)
+            << (result.stats.cache_hit_rate * 100.0) << "%"
+            << std::setw(11) << std::fixed << std::setprecision(1) << result.wall_ms
+            << "\n";
+    }
+}
+
+void BatchRunner::write_csv(const std::vector<SweepResult>& results, const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open sweep results file: " + filename);
+    }
+
+    file << "cache_size,cache_line_size,memory_latency,num_warps,shared_carveout,total_cycles,"
+         << "instructions,memory_requests,cache_hits,cache_misses,ipc,cache_hit_rate,wall_ms,error\n";
+    for (const auto& result : results) {
+        file << result.config.cache_size << ","
+             << result.config.cache_line_size << ","
+             << result.config.memory_latency << ","
+             << result.config.num_warps << ","
+             << carveout_bytes(result.config) << ","
+             << result.stats.total_cycles << ","
+             << result.stats.instructions_executed << ","
+             << result.stats.memory_requests << ","
+             << result.stats.cache_hits << ","
+             << result.stats.cache_misses << ","
+             << result.stats.ipc << ","
+             << result.stats.cache_hit_rate << ","
+             << result.wall_ms << ","
+             << csv_quote(result.error) << "\n";
+    }
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,81 @@
+// batch_runner.h
+// Concurrent parameter sweeps over independent simulation engines
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include "sim_engine.h"
+#include "memory_model.h"
+#include "program_loader.h"
+
+namespace gpu_simulator {
+
+// Workload shared read-only by every sweep point. With a kernel, every
+// point executes it on its own WarpExecutor and ends when its warps exit;
+// otherwise the trace is injected and the point ends once every request
+// in it has been served (trace-driven warps never exit).
+struct Workload {
+    std::shared_ptr<const MemoryImage> program;   // Initial memory contents
+    std::vector<TraceRecord>           trace;     // Injected memory requests
+    uint32_t shared_base = 0;                     // Shared-memory window
+    uint32_t shared_size = 0;                     // (0 = none)
+    std::shared_ptr<const Program>     kernel;    // Executed instead of the trace
+                                                  // (its image and .shared section
+                                                  // replace the fields above)
+};
+
+// Sweep specification: the cartesian product of all value lists. An empty
+// list keeps the value from the base configuration.
+struct SweepSpec {
+    SimConfig             base;
+    std::vector<uint32_t> cache_sizes;
+    std::vector<uint32_t> cache_line_sizes;
+    std::vector<uint32_t> memory_latencies;
+    std::vector<uint32_t> num_warps;
+    std::vector<uint32_t> shared_carveouts;
+
+    // Parse "key = v1, v2, ..." lines ('#' starts a comment). Keys are
+    // cache_size, cache_line_size, memory_latency, num_warps,
+    // shared_carveout ("auto" for SimConfig::AUTO_CARVEOUT) and the single
+    // values threads_per_warp and unified_storage_size.
+    static SweepSpec parse(const std::string& text, const SimConfig& base);
+    static SweepSpec load(const std::string& filename, const SimConfig& base);
+
+    std::vector<SimConfig> expand() const;
+};
+
+// Result of one sweep point
+struct SweepResult {
+    SimConfig   config;       // As run: carveout resolved, cache_size the L1's
+    SimStats    stats;
+    double      wall_ms;
+    std::string error;        // Why the point failed (empty when it ran)
+};
+
+class BatchRunner {
+public:
+    // Constructor (num_threads = 0 uses all cores)
+    BatchRunner(std::shared_ptr<const Workload> workload, uint32_t num_threads = 0);
+
+    // Run every point of the sweep; results keep the expansion order. A
+    // point that throws is recorded with its error and the rest still run.
+    std::vector<SweepResult> run(const SweepSpec& spec) const;
+    std::vector<SweepResult> run(const std::vector<SimConfig>& configs) const;
+
+    // Consolidated reporting
+    static void print_table(const std::vector<SweepResult>& results, std::ostream& out);
+    static void write_csv(const std::vector<SweepResult>& results, const std::string& filename);
+
+private:
+    SweepResult run_point(const SimConfig& config) const;
+    void run_trace(SimulationEngine& engine) const;
+
+    std::shared_ptr<const Workload> workload_;
+    uint32_t num_threads_;
+};
+
+} // namespace gpu_simulator
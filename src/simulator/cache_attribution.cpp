@@ -0,0 +1,343 @@
+// cache_attribution.cpp
+// Implementation of heavy-hitter cache attribution
+
+#include "cache_attribution.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+SpaceSaving::SpaceSaving(uint32_t capacity)
+    : capacity_(capacity)
+    , table_mask_(0)
+    , min_bucket_(NONE)
+    , total_(0) {
+    if (capacity == 0) {
+        throw std::invalid_argument("Heavy-hitter capacity must be positive");
+    }
+    nodes_.reserve(capacity);
+    // A node moving to a new count holds its old bucket for a moment
+    buckets_.resize(capacity + 1);
+    free_buckets_.reserve(capacity + 1);
+
+    // At most half full, so probe runs stay short
+    uint32_t table_size = 1;
+    while (table_size < 2 * capacity) {
+        table_size *= 2;
+    }
+    table_.resize(table_size);
+    table_mask_ = table_size - 1;
+    reset();
+}
+
+void SpaceSaving::add(uint32_t key, uint64_t weight) {
+    if (weight == 0) {
+        return;
+    }
+    total_ += weight;
+
+    uint32_t slot = slot_of(key);
+    if (table_[slot] != NONE) {
+        raise(table_[slot], weight);
+        return;
+    }
+    if (nodes_.size() < capacity_) {
+        uint32_t node = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back({{key, weight, 0}, NONE, NONE, NONE});
+        table_[slot] = node;
+        attach(node, NONE);
+        return;
+    }
+
+    // Replace a lightest key; the newcomer may have been it all along
+    uint32_t node = buckets_[min_bucket_].head;
+    Item& item = nodes_[node].item;
+    erase_slot(slot_of(item.key));
+    table_[slot_of(key)] = node;
+    item.key = key;
+    item.error = item.count;
+    raise(node, weight);
+}
+
+void SpaceSaving::reset() {
+    nodes_.clear();
+    free_buckets_.clear();
+    for (uint32_t i = static_cast<uint32_t>(buckets_.size()); i > 0; --i) {
+        free_buckets_.push_back(i - 1);
+    }
+    std::fill(table_.begin(), table_.end(), NONE);
+    min_bucket_ = NONE;
+    total_ = 0;
+}
+
+std::vector<SpaceSaving::Item> SpaceSaving::top(uint32_t n) const {
+    std::vector<Item> items;
+    items.reserve(nodes_.size());
+    for (const Node& node : nodes_) {
+        items.push_back(node.item);
+    }
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    if (items.size() > n) {
+        items.resize(n);
+    }
+    return items;
+}
+
+uint32_t SpaceSaving::slot_of(uint32_t key) const {
+    uint32_t slot = static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & table_mask_;
+    while (table_[slot] != NONE && nodes_[table_[slot]].item.key != key) {
+        slot = (slot + 1) & table_mask_;
+    }
+    return slot;
+}
+
+void SpaceSaving::erase_slot(uint32_t slot) {
+    // Backward-shift deletion keeps every probe run unbroken
+    table_[slot] = NONE;
+    uint32_t next = slot;
+    while (true) {
+        next = (next + 1) & table_mask_;
+        if (table_[next] == NONE) {
+            return;
+        }
+        uint32_t key = nodes_[table_[next]].item.key;
+        uint32_t home = static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & table_mask_;
+        // Move the entry back unless its home lies cyclically in (slot, next]
+        bool stays = slot <= next ? (home > slot && home <= next)
+                                  : (home > slot || home <= next);
+        if (!stays) {
+            table_[slot] = table_[next];
+            table_[next] = NONE;
+            slot = next;
+        }
+    }
+}
+
+void SpaceSaving::link(uint32_t node, uint32_t bucket) {
+    Node& entry = nodes_[node];
+    entry.bucket = bucket;
+    entry.prev = NONE;
+    entry.next = buckets_[bucket].head;
+    if (entry.next != NONE) {
+        nodes_[entry.next].prev = node;
+    }
+    buckets_[bucket].head = node;
+}
+
+void SpaceSaving::unlink(uint32_t node) {
+    const Node& entry = nodes_[node];
+    if (entry.prev != NONE) {
+        nodes_[entry.prev].next = entry.next;
+    } else {
+        buckets_[entry.bucket].head = entry.next;
+    }
+    if (entry.next != NONE) {
+        nodes_[entry.next].prev = entry.prev;
+    }
+}
+
+// Puts a detached node in the bucket for its count, searching upwards from
+// bucket `from` (a lower count), or from the smallest count with NONE
+void SpaceSaving::attach(uint32_t node, uint32_t from) {
+    uint64_t count = nodes_[node].item.count;
+    uint32_t before = from;
+    uint32_t after = from == NONE ? min_bucket_ : buckets_[from].next;
+    while (after != NONE && buckets_[after].count < count) {
+        before = after;
+        after = buckets_[after].next;
+    }
+    if (after != NONE && buckets_[after].count == count) {
+        link(node, after);
+        return;
+    }
+
+    uint32_t bucket = free_buckets_.back();
+    free_buckets_.pop_back();
+    buckets_[bucket] = {count, NONE, before, after};
+    if (before != NONE) {
+        buckets_[before].next = bucket;
+    } else {
+        min_bucket_ = bucket;
+    }
+    if (after != NONE) {
+        buckets_[after].prev = bucket;
+    }
+    link(node, bucket);
+}
+
+void SpaceSaving::raise(uint32_t node, uint64_t weight) {
+    uint32_t old_bucket = nodes_[node].bucket;
+    nodes_[node].item.count += weight;
+    unlink(node);
+    attach(node, old_bucket);
+
+    const Bucket& old = buckets_[old_bucket];
+    if (old.head == NONE) {
+        if (old.prev != NONE) {
+            buckets_[old.prev].next = old.next;
+        } else {
+            min_bucket_ = old.next;
+        }
+        if (old.next != NONE) {
+            buckets_[old.next].prev = old.prev;
+        }
+        free_buckets_.push_back(old_bucket);
+    }
+}
+
+CacheAttribution::CacheAttribution(uint32_t line_size, uint32_t capacity)
+    : line_mask_(~(line_size - 1))
+    , pc_misses_(capacity)
+    , pc_evictions_(capacity)
+    , line_misses_(capacity)
+    , last_region_(0)
+    , accesses_(0) {
+    if (line_size == 0 || (line_size & (line_size - 1)) != 0) {
+        throw std::invalid_argument("Line size must be a power of two");
+    }
+    regions_.push_back({"(unnamed)", 0, 0, 0, 0, 0});
+}
+
+void CacheAttribution::set_symbols(const std::unordered_map<std::string, uint32_t>& symbols) {
+    std::vector<std::pair<uint32_t, std::string>> sorted;
+    sorted.reserve(symbols.size());
+    for (const auto& [name, address] : symbols) {
+        sorted.emplace_back(address, name);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    regions_.clear();
+    regions_.push_back({"(unnamed)", 0, 0, 0, 0, 0});
+    for (const auto& [address, name] : sorted) {
+        // Aliases of one address share a region under the first name
+        if (regions_.size() > 1 && regions_.back().base == address) {
+            continue;
+        }
+        regions_.push_back({name, address, 0, 0, 0, 0});
+    }
+    last_region_ = 0;
+}
+
+uint32_t CacheAttribution::region_index(uint32_t address) const {
+    // Accesses cluster, so the previous region usually matches
+    auto contains = [&](uint32_t index) {
+        return (index == 0 || address >= regions_[index].base) &&
+               (index + 1 == regions_.size() || address < regions_[index + 1].base);
+    };
+    if (contains(last_region_)) {
+        return last_region_;
+    }
+    auto it = std::upper_bound(regions_.begin() + 1, regions_.end(), address,
+                               [](uint32_t value, const RegionStats& region) {
+                                   return value < region.base;
+                               });
+    last_region_ = static_cast<uint32_t>(it - regions_.begin()) - 1;
+    return last_region_;
+}
+
+void CacheAttribution::record(uint32_t pc, uint32_t address, const MemoryResult& result) {
+    accesses_++;
+    RegionStats& region = regions_[region_index(address)];
+    region.accesses++;
+
+    if (!result.hit) {
+        region.misses++;
+        pc_misses_.add(pc);
+        line_misses_.add(address & line_mask_);
+    }
+    if (result.evicted) {
+        region.evictions++;
+        regions_[region_index(result.victim_address)].evicted++;
+        pc_evictions_.add(pc);
+    }
+}
+
+void CacheAttribution::on_memory_request(const MemoryTransaction& request,
+                                         const MemoryResult& result, SimTime time) {
+    (void)time;
+    record(request.pc, request.address, result);
+}
+
+void CacheAttribution::reset() {
+    pc_misses_.reset();
+    pc_evictions_.reset();
+    line_misses_.reset();
+    for (auto& region : regions_) {
+        region.accesses = region.misses = region.evictions = 0;
+        region.evicted = 0;
+    }
+    accesses_ = 0;
+}
+
+std::string CacheAttribution::describe(uint32_t address) const {
+    uint32_t index = region_index(address);
+    if (index == 0) {
+        return "";
+    }
+    const RegionStats& region = regions_[index];
+    std::ostringstream out;
+    out << region.name;
+    if (address != region.base) {
+        out << "+0x" << std::hex << (address - region.base);
+    }
+    return out.str();
+}
+
+void CacheAttribution::print(std::ostream& out, uint32_t top_n) const {
+    auto share = [](uint64_t part, uint64_t whole) {
+        return whole ? part * 100.0 / static_cast<double>(whole) : 0.0;
+    };
+    auto table = [&](const char* title, const char* key_name, const SpaceSaving& sketch) {
+        out << "\n" << title << "\n" << std::string(std::char_traits<char>::length(title), '=')
+            << "\n" << std::left << std::setw(12) << key_name << std::setw(24) << "Symbol"
+            << std::right << std::setw(12) << "Count" << std::setw(10) << "Error"
+            << std::setw(9) << "Share" << "\n";
+        for (const auto& item : sketch.top(top_n)) {
+            std::ostringstream key;
+            key << "0x" << std::hex << std::setw(8) << std::setfill('0') << item.key;
+            out << std::left << std::setw(12) << key.str() << std::setw(24) << describe(item.key)
+                << std::right << std::setw(12) << item.count << std::setw(10) << item.error
+                << std::setw(8) << std::fixed << std::setprecision(2)
+                << share(item.count, sketch.total()) << "%\n";
+        }
+    };
+
+    table("Cache Misses by PC:", "PC", pc_misses_);
+    table("Cache Misses by Line:", "Line", line_misses_);
+    if (pc_evictions_.total() > 0) {
+        table("Evictions by PC:", "PC", pc_evictions_);
+    }
+
+    std::vector<const RegionStats*> sorted;
+    for (const auto& region : regions_) {
+        if (region.accesses > 0 || region.evicted > 0) {
+            sorted.push_back(&region);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const RegionStats* a, const RegionStats* b) {
+        return a->misses != b->misses ? a->misses > b->misses : a->base < b->base;
+    });
+    if (sorted.size() > top_n) {
+        sorted.resize(top_n);
+    }
+
+    out << "\nCache Misses by Region:\n"
+        << "=======================\n"
+        << std::left << std::setw(24) << "Region" << std::right
+        << std::setw(12) << "Accesses" << std::setw(10) << "Misses"
+        << std::setw(10) << "Miss%" << std::setw(10) << "Evicts"
+        << std::setw(10) << "Evicted" << "\n";
+    for (const RegionStats* region : sorted) {
+        out << std::left << std::setw(24) << region->name << std::right
+            << std::setw(12) << region->accesses << std::setw(10) << region->misses
+            << std::setw(9) << std::fixed << std::setprecision(2)
+            << share(region->misses, region->accesses) << "%"
+            << std::setw(10) << region->evictions << std::setw(10) << region->evicted << "\n";
+    }
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,133 @@
+// cache_attribution.h
+// Attribution of cache misses and evictions to PCs, lines and symbols
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "memory_model.h"
+#include "sim_engine.h"
+
+namespace gpu_simulator {
+
+// Space-Saving heavy hitters (Metwally et al.): at most `capacity` keys are
+// tracked; an untracked key replaces the smallest one and inherits its
+// count as error. Any key with more than total/capacity weight is always
+// tracked, and a reported count overestimates the truth by at most its
+// error. Counters sit in the paper's stream-summary: a list of buckets in
+// count order, each holding the keys with that count, so a unit update is
+// O(1) (a weight w walks past at most w - 1 buckets). Keys are found through
+// an open-addressed table; nothing allocates after construction.
+class SpaceSaving {
+public:
+    struct Item {
+        uint32_t key;
+        uint64_t count;
+        uint64_t error;       // Upper bound on the overestimate
+    };
+
+    // Constructor
+    explicit SpaceSaving(uint32_t capacity);
+
+    void add(uint32_t key, uint64_t weight = 1);
+    void reset();
+
+    // Up to n items, heaviest first
+    std::vector<Item> top(uint32_t n) const;
+    uint64_t total() const { return total_; }
+    uint32_t capacity() const { return capacity_; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        Item     item;
+        uint32_t bucket;
+        uint32_t prev;        // Siblings in the bucket
+        uint32_t next;
+    };
+
+    struct Bucket {
+        uint64_t count;
+        uint32_t head;        // First node with this count
+        uint32_t prev;        // Neighbouring counts, ascending
+        uint32_t next;
+    };
+
+    uint32_t slot_of(uint32_t key) const;
+    void erase_slot(uint32_t slot);
+    void link(uint32_t node, uint32_t bucket);
+    void unlink(uint32_t node);
+    void attach(uint32_t node, uint32_t from);
+    void raise(uint32_t node, uint64_t weight);
+
+    uint32_t capacity_;
+    std::vector<Node> nodes_;
+    std::vector<Bucket> buckets_;
+    std::vector<uint32_t> free_buckets_;
+    std::vector<uint32_t> table_;       // Key -> node, linear probing
+    uint32_t table_mask_;
+    uint32_t min_bucket_;
+    uint64_t total_;
+};
+
+// Per-access attribution fed by the engine (a memory observer): misses and evictions are
+// charged to the issuing PC and to the cache line (bounded sketches), and
+// exactly to the program symbol whose range holds the address. A symbol's
+// range runs up to the next symbol, so data labels name data structures
+// and text labels name code regions.
+class CacheAttribution : public MemoryRequestObserver {
+public:
+    static constexpr uint32_t DEFAULT_CAPACITY = 256;
+
+    // Constructor
+    explicit CacheAttribution(uint32_t line_size, uint32_t capacity = DEFAULT_CAPACITY);
+
+    // Address regions from program symbols (Program::symbols)
+    void set_symbols(const std::unordered_map<std::string, uint32_t>& symbols);
+
+    // One timed access; pc is 0 when the issuing instruction is unknown
+    void record(uint32_t pc, uint32_t address, const MemoryResult& result);
+    void on_memory_request(const MemoryTransaction& request, const MemoryResult& result,
+                           SimTime time) override;
+    void reset();
+
+    struct RegionStats {
+        std::string name;
+        uint32_t base;
+        uint64_t accesses;
+        uint64_t misses;
+        uint64_t evictions;       // Valid lines this region's misses replaced
+        uint64_t evicted;         // This region's lines replaced by any miss
+    };
+
+    const SpaceSaving& pc_misses() const { return pc_misses_; }
+    const SpaceSaving& pc_evictions() const { return pc_evictions_; }
+    const SpaceSaving& line_misses() const { return line_misses_; }
+    const std::vector<RegionStats>& regions() const { return regions_; }
+    uint64_t accesses() const { return accesses_; }
+
+    // Top-N tables of hot PCs, hot lines and regions by misses
+    void print(std::ostream& out, uint32_t top_n = 10) const;
+
+    // "label+0x10" for the symbol at or below address ("" without symbols)
+    std::string describe(uint32_t address) const;
+
+private:
+    uint32_t region_index(uint32_t address) const;
+
+    uint32_t line_mask_;
+    SpaceSaving pc_misses_;
+    SpaceSaving pc_evictions_;
+    SpaceSaving line_misses_;
+
+    // Sorted by base; regions_[0] covers addresses below the first symbol
+    std::vector<RegionStats> regions_;
+    mutable uint32_t last_region_;
+    uint64_t accesses_;
+};
+
+} // namespace gpu_simulator
@@ -0,0 +1,171 @@
+// checkpoint.cpp
+// Implementation of binary checkpoint reading and writing
+
+#include "checkpoint.h"
+#include <fstream>
+#include <iterator>
+#include <cassert>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GPUSIM_HAVE_MMAP 1
+#endif
+
+namespace gpu_simulator {
+
+namespace {
+constexpr size_t SECTION_ALIGNMENT = 8;
+}
+
+CheckpointWriter::CheckpointWriter()
+    : section_start_(0)
+    , section_count_(0) {
+    CheckpointHeader header{};
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.byte_order = CHECKPOINT_BYTE_ORDER;
+    put(header);
+}
+
+void CheckpointWriter::begin_section(uint32_t tag) {
+    assert(section_start_ == 0 && "Checkpoint sections cannot nest");
+    section_start_ = buffer_.size();
+    put(SectionHeader{tag, 0, 0});
+}
+
+void CheckpointWriter::end_section() {
+    assert(section_start_ != 0 && "No open checkpoint section");
+
+    // Patch the payload size, then pad so the next header stays aligned
+    uint64_t size = buffer_.size() - section_start_ - sizeof(SectionHeader);
+    std::memcpy(buffer_.data() + section_start_ + offsetof(SectionHeader, size),
+                &size, sizeof(size));
+    buffer_.resize((buffer_.size() + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1), 0);
+
+    section_start_ = 0;
+    section_count_++;
+    std::memcpy(buffer_.data() + offsetof(CheckpointHeader, section_count),
+                &section_count_, sizeof(section_count_));
+}
+
+void CheckpointWriter::put_bytes(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+}
+
+void CheckpointWriter::write_file(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open checkpoint file for writing: " + filename);
+    }
+    file.write(reinterpret_cast<const char*>(buffer_.data()),
+               static_cast<std::streamsize>(buffer_.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to write checkpoint file: " + filename);
+    }
+}
+
+CheckpointReader::CheckpointReader(const std::string& filename)
+    : data_(nullptr)
+    , size_(0)
+    , mapped_(false) {
+#ifdef GPUSIM_HAVE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open checkpoint file: " + filename);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                            MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            data_ = static_cast<const uint8_t*>(addr);
+            size_ = static_cast<size_t>(st.st_size);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    if (!mapped_) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open checkpoint file: " + filename);
+        }
+        fallback_.assign(std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>());
+        data_ = fallback_.data();
+        size_ = fallback_.size();
+    }
+
+    parse();
+}
+
+CheckpointReader::~CheckpointReader() {
+#ifdef GPUSIM_HAVE_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+}
+
+void CheckpointReader::parse() {
+    if (size_ < sizeof(CheckpointHeader)) {
+        throw std::runtime_error("Checkpoint file too small");
+    }
+
+    CheckpointHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a simulator checkpoint");
+    }
+    if (header.byte_order != CHECKPOINT_BYTE_ORDER) {
+        throw std::runtime_error("Checkpoint was written on a host with a different byte order");
+    }
+    if (header.version != CHECKPOINT_VERSION) {
+        throw std::runtime_error("Unsupported checkpoint version " +
+                                 std::to_string(header.version));
+    }
+
+    size_t offset = sizeof(CheckpointHeader);
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        if (size_ - offset < sizeof(SectionHeader)) {
+            throw std::runtime_error("Checkpoint section table truncated");
+        }
+        SectionHeader section;
+        std::memcpy(&section, data_ + offset, sizeof(section));
+        offset += sizeof(SectionHeader);
+
+        if (section.size > size_ - offset) {
+            throw std::runtime_error("Checkpoint section payload truncated");
+        }
+        sections_.push_back({section.tag, data_ + offset, static_cast<size_t>(section.size)});
+        offset += (section.size + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+        if (offset > size_) {
+            throw std::runtime_error("Checkpoint section padding truncated");
+        }
+    }
+}
+
+bool CheckpointReader::has_section(uint32_t tag) const {
+    for (const auto& entry : sections_) {
+        if (entry.tag == tag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SectionReader CheckpointReader::section(uint32_t tag) const {
+    for (const auto& entry : sections_) {
+        if (entry.tag == tag) {
+            return SectionReader(entry.data, entry.size);
+        }
+    }
+    throw std::runtime_error("Checkpoint is missing a required section");
+}
+
+} // namespace gpu_simulator
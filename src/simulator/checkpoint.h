@@ -0,0 +1,145 @@
+// checkpoint.h
+// Versioned binary checkpoint format for simulator state
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace gpu_simulator {
+
+// File layout (host byte order, every section 8-byte aligned):
+//   CheckpointHeader
+//   { SectionHeader, payload, padding } * section_count
+// Payloads are flat arrays of fixed-width fields, so a mapped file can be
+// restored with plain copies and no parsing of variable-length records.
+constexpr char     CHECKPOINT_MAGIC[8]   = {'G', 'P', 'U', 'S', 'I', 'M', 'C', 'P'};
+constexpr uint32_t CHECKPOINT_VERSION    = 4;
+constexpr uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304;
+
+struct CheckpointHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t section_count;
+    uint32_t reserved;
+};
+
+struct SectionHeader {
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t size;      // Payload bytes, excluding padding
+};
+
+// Section tags (four-character codes)
+constexpr uint32_t make_section_tag(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+           (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+constexpr uint32_t SECTION_ENGINE = make_section_tag('E', 'N', 'G', 'N');
+constexpr uint32_t SECTION_WARPS  = make_section_tag('W', 'A', 'R', 'P');
+constexpr uint32_t SECTION_EVENTS = make_section_tag('E', 'V', 'N', 'T');
+constexpr uint32_t SECTION_CACHE  = make_section_tag('C', 'A', 'C', 'H');
+constexpr uint32_t SECTION_MEMORY = make_section_tag('M', 'E', 'M', 'P');
+constexpr uint32_t SECTION_CONSTANT_CACHE  = make_section_tag('K', 'C', 'A', 'C');
+constexpr uint32_t SECTION_CONSTANT_MEMORY = make_section_tag('K', 'M', 'E', 'M');
+constexpr uint32_t SECTION_READONLY_CACHE  = make_section_tag('R', 'C', 'A', 'C');
+constexpr uint32_t SECTION_READONLY_MEMORY = make_section_tag('R', 'M', 'E', 'M');
+
+// Builds a checkpoint image in memory and writes it out in one go
+class CheckpointWriter {
+public:
+    CheckpointWriter();
+
+    void begin_section(uint32_t tag);
+    void end_section();
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Checkpoint fields must be POD");
+        put_bytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void put_array(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "Checkpoint fields must be POD");
+        put_bytes(values, sizeof(T) * count);
+    }
+
+    void write_file(const std::string& filename) const;
+    const std::vector<uint8_t>& buffer() const { return buffer_; }
+
+private:
+    void put_bytes(const void* data, size_t size);
+
+    std::vector<uint8_t> buffer_;
+    size_t section_start_;
+    uint32_t section_count_;
+};
+
+// Bounds-checked cursor over one section payload
+class SectionReader {
+public:
+    SectionReader(const uint8_t* data, size_t size) : data_(data), size_(size), pos_(0) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        get_array(&value, 1);
+        return value;
+    }
+
+    template <typename T>
+    void get_array(T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "Checkpoint fields must be POD");
+        size_t bytes = sizeof(T) * count;
+        if (bytes > size_ - pos_) {
+            throw std::runtime_error("Checkpoint section truncated");
+        }
+        std::memcpy(values, data_ + pos_, bytes);
+        pos_ += bytes;
+    }
+
+    bool at_end() const { return pos_ == size_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+// Maps a checkpoint file read-only and hands out its sections
+class CheckpointReader {
+public:
+    explicit CheckpointReader(const std::string& filename);
+    ~CheckpointReader();
+
+    // Delete copy constructor and assignment
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    bool has_section(uint32_t tag) const;
+    SectionReader section(uint32_t tag) const;
+
+private:
+    struct SectionEntry {
+        uint32_t tag;
+        const uint8_t* data;
+        size_t size;
+    };
+
+    void parse();
+
+    const uint8_t* data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<uint8_t> fallback_;   // Used where mmap is unavailable
+    std::vector<SectionEntry> sections_;
+};
+
+} // namespace gpu_simulator
@@ -0,0 +1,530 @@
+// cta_dispatcher.cpp
+// Implementation of occupancy calculation and thread-block dispatch
+
+#include "cta_dispatcher.h"
+#include "warp_executor.h"
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+SmResources SmResources::from_config(const SimConfig& config) {
+    SmResources resources{};
+    resources.warp_slots = config.num_warps;
+    resources.registers = REGISTERS_PER_THREAD * config.threads_per_warp * config.num_warps;
+    resources.shared_memory = config.unified_storage_size
+        ? config.unified_storage_size - UnifiedStorage::GRANULE
+        : SHARED_MEMORY_SIZE;
+    resources.max_barriers = MAX_BARRIERS;
+    resources.max_blocks = MAX_BLOCKS;
+    return resources;
+}
+
+const char* occupancy_limit_name(OccupancyLimit limit) {
+    switch (limit) {
+        case OccupancyLimit::WARPS:         return "warp slots";
+        case OccupancyLimit::REGISTERS:     return "registers";
+        case OccupancyLimit::SHARED_MEMORY: return "shared memory";
+        case OccupancyLimit::BARRIERS:      return "barriers";
+        case OccupancyLimit::BLOCKS:        return "block slots";
+    }
+    return "unknown";
+}
+
+/* OccupancyCalculator */
+OccupancyCalculator::OccupancyCalculator(const SmResources& resources, const SimConfig& config)
+    : resources_(resources)
+    , config_(config) {
+}
+
+Occupancy OccupancyCalculator::compute(const KernelLaunch& kernel) const {
+    if (!kernel.program || kernel.program->text.empty()) {
+        throw std::invalid_argument("Kernel " + kernel.name + " has no assembled program");
+    }
+    if (kernel.warps_per_block == 0 ||
+        kernel.warps_per_block > SmResources::MAX_WARPS_PER_BLOCK) {
+        throw std::invalid_argument("Kernel " + kernel.name + ": warps per block must be between 1 and " +
+                                    std::to_string(SmResources::MAX_WARPS_PER_BLOCK));
+    }
+    uint32_t registers = kernel.registers_per_thread ? kernel.registers_per_thread
+                                                     : kernel.program->registers;
+    if (registers > SmResources::REGISTERS_PER_THREAD) {
+        throw std::invalid_argument("Kernel " + kernel.name + " uses " + std::to_string(registers) +
+                                    " registers per thread, the register file has " +
+                                    std::to_string(SmResources::REGISTERS_PER_THREAD));
+    }
+
+    Occupancy best{};
+    if (config_.unified_storage_size == 0) {
+        best = at_capacity(kernel, resources_.shared_memory);
+        best.carveout = Carveout{resources_.shared_memory, config_.cache_size};
+    } else {
+        // Splits ascend, so the first to reach the most blocks is the smallest
+        UnifiedStorage storage(config_.unified_storage_size, config_.cache_line_size);
+        std::vector<uint32_t> splits = config_.shared_carveout == SimConfig::AUTO_CARVEOUT
+            ? storage.split_points()
+            : std::vector<uint32_t>{config_.shared_carveout};
+        bool found = false;
+        for (uint32_t split : splits) {
+            Occupancy occupancy = at_capacity(kernel, split);
+            if (!found || occupancy.blocks_per_sm > best.blocks_per_sm) {
+                best = occupancy;
+                best.carveout = storage.carve(split);
+                found = true;
+            }
+        }
+    }
+
+    if (best.blocks_per_sm == 0) {
+        throw std::invalid_argument("Kernel " + kernel.name + " does not fit on an SM (limited by " +
+                                    occupancy_limit_name(best.limit) + ")");
+    }
+    return best;
+}
+
+Occupancy OccupancyCalculator::at_capacity(const KernelLaunch& kernel,
+                                           uint32_t shared_capacity) const {
+    const Program& program = *kernel.program;
+    Occupancy occupancy{};
+    occupancy.warps_per_block = kernel.warps_per_block;
+    occupancy.registers_per_thread = kernel.registers_per_thread ? kernel.registers_per_thread
+                                                                 : program.registers;
+    occupancy.shared_per_block = kernel.shared_per_block ? kernel.shared_per_block
+                                                         : program.shared_size;
+    occupancy.barriers_per_block = program.barriers;
+
+    // A resource the block does not use allows as many blocks as there are slots
+    uint32_t registers_per_block =
+        occupancy.registers_per_thread * config_.threads_per_warp * kernel.warps_per_block;
+    occupancy.by_warps = resources_.warp_slots / kernel.warps_per_block;
+    occupancy.by_registers = registers_per_block ? resources_.registers / registers_per_block
+                                                 : resources_.max_blocks;
+    occupancy.by_shared_memory = occupancy.shared_per_block
+        ? shared_capacity / occupancy.shared_per_block
+        : resources_.max_blocks;
+    occupancy.by_barriers = occupancy.barriers_per_block
+        ? resources_.max_barriers / occupancy.barriers_per_block
+        : resources_.max_blocks;
+    occupancy.by_blocks = resources_.max_blocks;
+
+    const std::pair<uint32_t, OccupancyLimit> limits[] = {
+        {occupancy.by_warps, OccupancyLimit::WARPS},
+        {occupancy.by_registers, OccupancyLimit::REGISTERS},
+        {occupancy.by_shared_memory, OccupancyLimit::SHARED_MEMORY},
+        {occupancy.by_barriers, OccupancyLimit::BARRIERS},
+        {occupancy.by_blocks, OccupancyLimit::BLOCKS},
+    };
+    occupancy.blocks_per_sm = limits[0].first;
+    occupancy.limit = limits[0].second;
+    for (const auto& [blocks, limit] : limits) {
+        if (blocks < occupancy.blocks_per_sm) {
+            occupancy.blocks_per_sm = blocks;
+            occupancy.limit = limit;
+        }
+    }
+    occupancy.warps_per_sm = occupancy.blocks_per_sm * kernel.warps_per_block;
+    occupancy.occupancy = resources_.warp_slots
+        ? static_cast<double>(occupancy.warps_per_sm) / resources_.warp_slots
+        : 0.0;
+    return occupancy;
+}
+
+void OccupancyCalculator::print(std::ostream& out, const std::string& name,
+                                const Occupancy& occupancy, bool unified) {
+    std::string title = "Occupancy of " + name + ":";
+    out << "\n" << title << "\n"
+        << std::string(title.size(), '=') << "\n"
+        << std::fixed << std::setprecision(2)
+        << "Blocks per SM: " << occupancy.blocks_per_sm
+        << " (limited by " << occupancy_limit_name(occupancy.limit) << ")\n"
+        << "Warps per SM: " << occupancy.warps_per_sm << " ("
+        << occupancy.occupancy * 100.0 << "% occupancy)\n"
+        << "Per Block: " << occupancy.warps_per_block << " warps, "
+        << occupancy.registers_per_thread << " registers/thread, "
+        << occupancy.shared_per_block << " bytes shared, "
+        << occupancy.barriers_per_block << " barriers\n"
+        << "Blocks Allowed: " << occupancy.by_warps << " by warp slots, "
+        << occupancy.by_registers << " by registers, "
+        << occupancy.by_shared_memory << " by shared memory, "
+        << occupancy.by_barriers << " by barriers, "
+        << occupancy.by_blocks << " by block slots\n";
+    if (unified) {
+        out << "Carveout: " << occupancy.carveout.shared_size << " shared / "
+            << occupancy.carveout.l1_size << " L1\n";
+    }
+}
+
+/* SmExecutor: one SM's warp slots, mapped to the blocks resident there */
+class CtaDispatcher::SmExecutor : public InstructionExecutor {
+public:
+    struct Block {
+        uint32_t kernel;
+        uint32_t slot;                    // Block slot, which picks the shared window
+        uint32_t live_warps;
+        std::unique_ptr<WarpExecutor> executor;
+    };
+
+    // Per-kernel tallies; written only by this SM's thread
+    struct Tally {
+        uint32_t blocks_completed = 0;
+        SimTime  last_retire = 0;
+        uint64_t thread_instructions = 0;
+    };
+
+    SmExecutor(CtaDispatcher& dispatcher, uint32_t id, SimulationEngine& engine)
+        : dispatcher(dispatcher)
+        , id(id)
+        , engine(engine)
+        , free_warps(dispatcher.resources_.warp_slots)
+        , free_registers(dispatcher.resources_.registers)
+        , used_shared(0)
+        , used_barriers(0)
+        , resident(0)
+        , shared_capacity(0)
+        , blocks(dispatcher.resources_.max_blocks)
+        , warp_block(engine.get_config().num_warps, nullptr)
+        , warp_local(engine.get_config().num_warps, 0) {
+    }
+
+    uint32_t entry_point() const override {
+        return dispatcher.kernels_.front().launch.program->entry_point;
+    }
+
+    ExecutionStep execute(uint32_t warp_id, uint32_t pc,
+                          std::vector<MemoryTransaction>& accesses) override {
+        // The block numbers its warps from zero; replies must find the slot
+        size_t first = accesses.size();
+        ExecutionStep step = warp_block[warp_id]->executor->execute(warp_local[warp_id], pc,
+                                                                    accesses);
+        for (size_t i = first; i < accesses.size(); ++i) {
+            accesses[i].warp_id = warp_id;
+        }
+        return step;
+    }
+
+    bool starts_warp(uint32_t warp_id) const override {
+        (void)warp_id;
+        return false;
+    }
+
+    void warp_retired(uint32_t warp_id) override {
+        Block* block = warp_block[warp_id];
+        if (!block || --block->live_warps > 0) {
+            return;
+        }
+
+        // The last warp frees the whole block
+        const Occupancy& occupancy = dispatcher.kernels_[block->kernel].occupancy;
+        Tally& tally = tallies[block->kernel];
+        tally.blocks_completed++;
+        tally.last_retire = engine.get_current_time();
+        tally.thread_instructions += block->executor->thread_instructions();
+
+        for (auto& owner : warp_block) {
+            if (owner == block) {
+                owner = nullptr;
+            }
+        }
+        free_warps += occupancy.warps_per_block;
+        free_registers += registers_per_block(occupancy);
+        used_shared -= occupancy.shared_per_block;
+        used_barriers -= occupancy.barriers_per_block;
+        resident--;
+        blocks[block->slot].reset();
+
+        if (!dispatcher.deferred_) {
+            dispatcher.dispatch_sm(id, engine.get_current_time() + LAUNCH_LATENCY);
+        } else if (dispatcher.blocks_left()) {
+            // Other SMs may want the same blocks; refill() settles the order
+            engine.pause();
+        }
+    }
+
+    uint32_t registers_per_block(const Occupancy& occupancy) const {
+        return occupancy.registers_per_thread * engine.get_config().threads_per_warp *
+               occupancy.warps_per_block;
+    }
+
+    CtaDispatcher& dispatcher;
+    uint32_t id;
+    SimulationEngine& engine;
+
+    // Resources left, and the shared memory of the current carveout
+    uint32_t free_warps;
+    uint32_t free_registers;
+    uint32_t used_shared;
+    uint32_t used_barriers;
+    uint32_t resident;
+    uint32_t shared_capacity;
+
+    std::vector<std::unique_ptr<Block>> blocks;   // By block slot
+    std::vector<Block*> warp_block;               // By warp slot; nullptr = free
+    std::vector<uint32_t> warp_local;             // Warp index within its block
+    std::vector<Tally> tallies;                   // By kernel
+};
+
+/* CtaDispatcher */
+namespace {
+
+SimConfig requested_config(const SimulationEngine& engine) {
+    SimConfig config = engine.get_config();
+    config.shared_carveout = engine.requested_carveout();
+    return config;
+}
+
+} // namespace
+
+CtaDispatcher::CtaDispatcher(std::vector<SimulationEngine*> sms)
+    : resources_(SmResources::from_config(sms.empty() ? SimConfig{} : sms.front()->get_config()))
+    , calculator_(resources_, sms.empty() ? SimConfig{} : requested_config(*sms.front()))
+    , shared_stride_(resources_.shared_memory)
+    , next_sm_(0)
+    , deferred_(false)
+    , started_(false) {
+    if (sms.empty()) {
+        throw std::invalid_argument("CtaDispatcher needs at least one SM");
+    }
+    const SimConfig& config = sms.front()->get_config();
+    for (uint32_t i = 0; i < sms.size(); ++i) {
+        const SimConfig& other = sms[i]->get_config();
+        if (other.num_warps != config.num_warps ||
+            other.threads_per_warp != config.threads_per_warp ||
+            other.unified_storage_size != config.unified_storage_size) {
+            throw std::invalid_argument("All SMs of a dispatcher must be configured alike");
+        }
+        sms_.push_back(std::make_unique<SmExecutor>(*this, i, *sms[i]));
+        sms_.back()->shared_capacity = resources_.shared_memory;
+    }
+}
+
+CtaDispatcher::~CtaDispatcher() = default;
+
+uint32_t CtaDispatcher::launch(const KernelLaunch& kernel) {
+    if (started_) {
+        throw std::runtime_error("Kernels must be launched before the dispatcher starts");
+    }
+    if (kernel.grid_blocks == 0) {
+        throw std::invalid_argument("Kernel " + kernel.name + " has an empty grid");
+    }
+    kernels_.push_back(KernelState{kernel, calculator_.compute(kernel), 0, 0});
+    for (auto& sm : sms_) {
+        sm->tallies.emplace_back();
+    }
+    return static_cast<uint32_t>(kernels_.size() - 1);
+}
+
+void CtaDispatcher::start() {
+    if (started_) {
+        throw std::runtime_error("Dispatcher already started");
+    }
+    if (kernels_.empty()) {
+        throw std::runtime_error("No kernels to dispatch");
+    }
+
+    // Every kernel's text and data in the one image an engine attaches
+    std::shared_ptr<const MemoryImage> image = kernels_.front().launch.program->image;
+    std::shared_ptr<MemoryImage> merged;
+    for (const auto& kernel : kernels_) {
+        const auto& kernel_image = kernel.launch.program->image;
+        if (!kernel_image || kernel_image == image) {
+            continue;
+        }
+        if (!merged) {
+            merged = image ? std::make_shared<MemoryImage>(*image) : std::make_shared<MemoryImage>();
+        }
+        for (const auto& [address, word] : *kernel_image) {
+            auto [it, inserted] = merged->emplace(address, word);
+            if (!inserted && it->second != word) {
+                throw std::invalid_argument("Kernel " + kernel.launch.name +
+                                            " overlaps another kernel in memory; load kernels "
+                                            "with one ProgramLoader");
+            }
+        }
+    }
+    if (merged) {
+        image = merged;
+    }
+
+    SimTime now = 0;
+    for (auto& sm : sms_) {
+        sm->engine.attach_program(image);
+        sm->engine.set_shared_window(SHARED_WINDOW_BASE, resources_.max_blocks * shared_stride_);
+        sm->engine.set_executor(sm.get());
+        now = std::max(now, sm->engine.get_current_time());
+    }
+    started_ = true;
+    dispatch(now);
+}
+
+void CtaDispatcher::dispatch(SimTime time) {
+    // Breadth first: consecutive blocks go to consecutive SMs with room
+    for (uint32_t kernel_id = 0; kernel_id < kernels_.size(); ++kernel_id) {
+        KernelState& kernel = kernels_[kernel_id];
+        while (kernel.next_block < kernel.launch.grid_blocks) {
+            SmExecutor* target = nullptr;
+            for (uint32_t i = 0; i < sms_.size() && !target; ++i) {
+                SmExecutor& sm = *sms_[(next_sm_ + i) % sms_.size()];
+                if (fits(sm, kernel)) {
+                    target = &sm;
+                }
+            }
+            if (!target) {
+                break;
+            }
+            place(*target, kernel_id, time);
+            next_sm_ = (target->id + 1) % sms_.size();
+        }
+    }
+}
+
+void CtaDispatcher::refill(uint32_t sm_id, SimTime time) {
+    dispatch_sm(sm_id, time + LAUNCH_LATENCY);
+}
+
+void CtaDispatcher::dispatch_sm(uint32_t sm_id, SimTime time) {
+    SmExecutor& sm = *sms_[sm_id];
+    for (uint32_t kernel_id = 0; kernel_id < kernels_.size(); ++kernel_id) {
+        KernelState& kernel = kernels_[kernel_id];
+        while (kernel.next_block < kernel.launch.grid_blocks && fits(sm, kernel)) {
+            place(sm, kernel_id, time);
+        }
+    }
+}
+
+bool CtaDispatcher::fits(const SmExecutor& sm, const KernelState& kernel) const {
+    // An empty SM can switch to the carveout the kernel was sized for
+    const Occupancy& occupancy = kernel.occupancy;
+    uint32_t shared_capacity = sm.resident == 0 ? occupancy.carveout.shared_size
+                                                : sm.shared_capacity;
+    return sm.resident < resources_.max_blocks &&
+           sm.free_warps >= occupancy.warps_per_block &&
+           sm.free_registers >= sm.registers_per_block(occupancy) &&
+           sm.used_shared + occupancy.shared_per_block <= shared_capacity &&
+           sm.used_barriers + occupancy.barriers_per_block <= resources_.max_barriers;
+}
+
+void CtaDispatcher::place(SmExecutor& sm, uint32_t kernel_id, SimTime time) {
+    KernelState& kernel = kernels_[kernel_id];
+    const Occupancy& occupancy = kernel.occupancy;
+    const Program& program = *kernel.launch.program;
+    const SimConfig& config = sm.engine.get_config();
+
+    if (sm.resident == 0) {
+        if (config.unified_storage_size &&
+            sm.engine.carveout().shared_size != occupancy.carveout.shared_size) {
+            sm.engine.set_carveout(occupancy.carveout.shared_size);
+        }
+        sm.shared_capacity = occupancy.carveout.shared_size;
+    }
+
+    uint32_t slot = 0;
+    while (sm.blocks[slot]) {
+        slot++;
+    }
+    if (kernel.next_block == 0) {
+        kernel.first_launch = time;
+    }
+    uint32_t block_id = kernel.next_block++;
+    uint32_t shared_base = SHARED_WINDOW_BASE + slot * shared_stride_;
+
+    auto block = std::make_unique<SmExecutor::Block>();
+    block->kernel = kernel_id;
+    block->slot = slot;
+    block->live_warps = occupancy.warps_per_block;
+    block->executor = std::make_unique<WarpExecutor>(
+        kernel.launch.program, sm.engine.memory_model(), occupancy.warps_per_block,
+        config.threads_per_warp, config.cache_line_size, block_id,
+        shared_base - program.shared_base);
+
+    sm.free_warps -= occupancy.warps_per_block;
+    sm.free_registers -= sm.registers_per_block(occupancy);
+    sm.used_shared += occupancy.shared_per_block;
+    sm.used_barriers += occupancy.barriers_per_block;
+    sm.resident++;
+
+    // Lowest free warp slots; each warp fetches from the entry point
+    SmExecutor::Block* placed = block.get();
+    sm.blocks[slot] = std::move(block);
+    uint32_t local = 0;
+    for (uint32_t warp_id = 0; local < occupancy.warps_per_block; ++warp_id) {
+        if (sm.warp_block[warp_id]) {
+            continue;
+        }
+        sm.warp_block[warp_id] = placed;
+        sm.warp_local[warp_id] = local++;
+        sm.engine.start_warp(warp_id, program.entry_point, time);
+    }
+}
+
+void CtaDispatcher::set_deferred(bool deferred) {
+    deferred_ = deferred;
+}
+
+bool CtaDispatcher::blocks_left() const {
+    return std::any_of(kernels_.begin(), kernels_.end(), [](const KernelState& kernel) {
+        return kernel.next_block < kernel.launch.grid_blocks;
+    });
+}
+
+bool CtaDispatcher::done() const {
+    return !blocks_left() && std::all_of(sms_.begin(), sms_.end(),
+                       [](const std::unique_ptr<SmExecutor>& sm) { return sm->resident == 0; });
+}
+
+uint32_t CtaDispatcher::num_kernels() const {
+    return static_cast<uint32_t>(kernels_.size());
+}
+
+const Occupancy& CtaDispatcher::occupancy(uint32_t kernel) const {
+    return kernels_.at(kernel).occupancy;
+}
+
+KernelStats CtaDispatcher::kernel_stats(uint32_t kernel) const {
+    KernelStats stats{};
+    stats.first_launch = kernels_.at(kernel).first_launch;
+    for (const auto& sm : sms_) {
+        const SmExecutor::Tally& tally = sm->tallies[kernel];
+        stats.blocks_completed += tally.blocks_completed;
+        stats.last_retire = std::max(stats.last_retire, tally.last_retire);
+        stats.thread_instructions += tally.thread_instructions;
+    }
+    return stats;
+}
+
+uint64_t CtaDispatcher::thread_instructions() const {
+    uint64_t total = 0;
+    for (uint32_t kernel = 0; kernel < kernels_.size(); ++kernel) {
+        total += kernel_stats(kernel).thread_instructions;
+    }
+    return total;
+}
+
+void CtaDispatcher::print_occupancy(std::ostream& out) const {
+    bool unified = sms_.front()->engine.get_config().unified_storage_size != 0;
+    for (const auto& kernel : kernels_) {
+        OccupancyCalculator::print(out, kernel.launch.name, kernel.occupancy, unified);
+    }
+}
+
+void CtaDispatcher::print_statistics(std::ostream& out) const {
+    out << "\nKernels:\n"
+        << "========\n"
+        << std::left << std::setw(24) << "Kernel" << std::right
+        << std::setw(12) << "Blocks" << std::setw(11) << "Blocks/SM"
+        << std::setw(11) << "Occupancy" << std::setw(10) << "Start"
+        << std::setw(10) << "End" << "\n";
+    for (uint32_t kernel = 0; kernel < kernels_.size(); ++kernel) {
+        const KernelState& state = kernels_[kernel];
+        KernelStats stats = kernel_stats(kernel);
+        std::string blocks = std::to_string(stats.blocks_completed) + "/" +
+                             std::to_string(state.launch.grid_blocks);
+        out << std::left << std::setw(24) << state.launch.name << std::right
+            << std::setw(12) << blocks << std::setw(11) << state.occupancy.blocks_per_sm
+            << std::fixed << std::setprecision(2)
+            << std::setw(10) << state.occupancy.occupancy * 100.0 << "%"
+            << std::setw(10) << stats.first_launch << std::setw(10) << stats.last_retire << "\n";
+    }
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,182 @@
+// cta_dispatcher.h
+// Thread-block (CTA) dispatch onto SMs with resource-limited occupancy
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "sim_engine.h"
+#include "program_loader.h"
+#include "unified_storage.h"
+
+namespace gpu_simulator {
+
+// One kernel launch: a grid of identical thread blocks
+struct KernelLaunch {
+    std::string name;
+    std::shared_ptr<const Program> program;
+    uint32_t grid_blocks;
+    uint32_t warps_per_block;
+    uint32_t registers_per_thread = 0;    // 0 = what the program uses
+    uint32_t shared_per_block = 0;        // Bytes (0 = the program's .shared section)
+};
+
+// Per-SM resources a resident block draws from
+struct SmResources {
+    static constexpr uint32_t REGISTERS_PER_THREAD = 32;    // register_file.sv NUM_REGISTERS
+    static constexpr uint32_t SHARED_MEMORY_SIZE = 16384;   // gpu_top.sv SHARED_MEM_SIZE
+    static constexpr uint32_t MAX_BARRIERS = 16;            // gpu_top.sv MAX_BARRIERS
+    static constexpr uint32_t MAX_BLOCKS = 32;              // barrier_controller.sv MAX_BLOCKS
+    static constexpr uint32_t MAX_WARPS_PER_BLOCK = 32;     // barrier_controller.sv WARPS_PER_BLOCK
+
+    uint32_t warp_slots;          // Warps the scheduler holds
+    uint32_t registers;           // 32-bit registers in the register file
+    uint32_t shared_memory;       // Bytes (largest carveout with unified storage)
+    uint32_t max_barriers;        // Hardware barriers
+    uint32_t max_blocks;          // Resident block slots
+
+    // The RTL's limits for an SM built from config
+    static SmResources from_config(const SimConfig& config);
+};
+
+// Resource that caps the number of resident blocks
+enum class OccupancyLimit {
+    WARPS,
+    REGISTERS,
+    SHARED_MEMORY,
+    BARRIERS,
+    BLOCKS
+};
+
+const char* occupancy_limit_name(OccupancyLimit limit);
+
+// Blocks of one kernel an SM holds at once, and why
+struct Occupancy {
+    uint32_t       blocks_per_sm;
+    uint32_t       warps_per_sm;
+    double         occupancy;             // Resident warps over warp slots
+    OccupancyLimit limit;                 // The tightest limit (first on a tie)
+    uint32_t       by_warps;              // Blocks each resource allows
+    uint32_t       by_registers;
+    uint32_t       by_shared_memory;
+    uint32_t       by_barriers;
+    uint32_t       by_blocks;
+    uint32_t       warps_per_block;       // Per-block demand
+    uint32_t       registers_per_thread;
+    uint32_t       shared_per_block;
+    uint32_t       barriers_per_block;
+    Carveout       carveout;              // Split the kernel runs with
+};
+
+// Occupancy from register, shared-memory, barrier and block-slot limits.
+// With unified storage and an automatic carveout, the kernel gets the
+// smallest carveout that still reaches its highest block count, so the L1
+// keeps everything the resident blocks cannot use.
+class OccupancyCalculator {
+public:
+    // Constructor
+    OccupancyCalculator(const SmResources& resources, const SimConfig& config);
+
+    // invalid_argument when a thread needs more registers than the file
+    // holds, or not even one block fits on an SM
+    Occupancy compute(const KernelLaunch& kernel) const;
+
+    static void print(std::ostream& out, const std::string& name, const Occupancy& occupancy,
+                      bool unified);
+
+private:
+    Occupancy at_capacity(const KernelLaunch& kernel, uint32_t shared_capacity) const;
+
+    SmResources resources_;
+    SimConfig config_;
+};
+
+// Per-kernel progress
+struct KernelStats {
+    uint32_t blocks_completed;
+    SimTime  first_launch;                // Cycle the first block launched
+    SimTime  last_retire;                 // Cycle the last block retired so far
+    uint64_t thread_instructions;         // Of completed blocks
+};
+
+// Launches the thread blocks of queued kernels onto SMs. A resident block
+// holds warp slots, registers, shared memory, barriers and a block slot
+// of its SM until its last warp retires; freed resources are refilled
+// from the oldest kernel with blocks left, then from younger ones, so
+// kernels run concurrently where their blocks fit. Each block runs on its
+// own WarpExecutor and gets a private copy of the .shared section in the
+// SM's scratchpad window. An SM changes carveout only while it is empty.
+//
+// An SM is refilled LAUNCH_LATENCY cycles after a block retires. Under a
+// MultiSMEngine the SMs run in parallel, so an SM that retires a block
+// while blocks are left pauses instead, and the engine calls refill() for
+// the paused SMs in order of retirement cycle, then SM: blocks go where a
+// sequential run would put them, whatever the thread count.
+class CtaDispatcher {
+public:
+    static constexpr uint32_t SHARED_WINDOW_BASE = 0xC0000000;
+    static constexpr SimTime LAUNCH_LATENCY = 1;
+
+    // Constructor and destructor. The engines (one per SM, same
+    // configuration) are not owned and must outlive the dispatcher.
+    explicit CtaDispatcher(std::vector<SimulationEngine*> sms);
+    ~CtaDispatcher();
+
+    // Delete copy constructor and assignment
+    CtaDispatcher(const CtaDispatcher&) = delete;
+    CtaDispatcher& operator=(const CtaDispatcher&) = delete;
+
+    // Queue a kernel before start(); returns its index. Kernels loaded by
+    // one ProgramLoader do not overlap in memory and can share the SMs.
+    uint32_t launch(const KernelLaunch& kernel);
+
+    // Take over the SMs' warp slots and launch the first blocks; call after
+    // the engines are initialized and before they run
+    void start();
+
+    // Refill an SM paused by a block retiring at cycle time
+    void refill(uint32_t sm_id, SimTime time);
+
+    // Pause SMs at retirements and leave refills to refill() calls (set by
+    // MultiSMEngine)
+    void set_deferred(bool deferred);
+
+    bool done() const;
+    uint32_t num_kernels() const;
+    const Occupancy& occupancy(uint32_t kernel) const;
+    KernelStats kernel_stats(uint32_t kernel) const;
+    uint64_t thread_instructions() const;
+
+    void print_occupancy(std::ostream& out) const;
+    void print_statistics(std::ostream& out) const;
+
+private:
+    class SmExecutor;
+
+    struct KernelState {
+        KernelLaunch launch;
+        Occupancy    occupancy;
+        uint32_t     next_block;          // Next block ID to launch
+        SimTime      first_launch;
+    };
+
+    void dispatch(SimTime time);
+    void dispatch_sm(uint32_t sm_id, SimTime time);
+    bool blocks_left() const;
+    bool fits(const SmExecutor& sm, const KernelState& kernel) const;
+    void place(SmExecutor& sm, uint32_t kernel_id, SimTime time);
+
+    std::vector<std::unique_ptr<SmExecutor>> sms_;
+    std::vector<KernelState> kernels_;
+    SmResources resources_;
+    OccupancyCalculator calculator_;
+    uint32_t shared_stride_;              // Scratchpad window of one block slot
+    uint32_t next_sm_;                    // Round-robin start of the next search
+    bool deferred_;
+    bool started_;
+};
+
+} // namespace gpu_simulator
@@ -0,0 +1,104 @@
+// determinism_checker.cpp
+// Implementation of cross-thread-count reproducibility check
+
+#include "determinism_checker.h"
+#include <iostream>
+#include <algorithm>
+#include <limits>
+
+namespace gpu_simulator {
+
+DeterminismChecker::DeterminismChecker(const MultiSMConfig& config, WorkloadSetup setup)
+    : config_(config)
+    , setup_(std::move(setup)) {
+}
+
+DeterminismChecker::RunHashes DeterminismChecker::run_once(uint32_t num_threads) const {
+    MultiSMConfig config = config_;
+    config.num_threads = num_threads;
+
+    MultiSMEngine engine(config);
+    engine.set_determinism_check(true);
+    engine.initialize();
+    if (setup_) {
+        setup_(engine);
+    }
+    engine.run();
+
+    RunHashes hashes;
+    hashes.reserve(engine.num_sms());
+    for (uint32_t sm_id = 0; sm_id < engine.num_sms(); ++sm_id) {
+        hashes.push_back(engine.sm(sm_id).cycle_hashes());
+    }
+    return hashes;
+}
+
+DeterminismReport DeterminismChecker::check(const std::vector<uint32_t>& thread_counts) const {
+    DeterminismReport report{};
+    report.deterministic = true;
+    if (thread_counts.empty()) {
+        return report;
+    }
+
+    report.reference_threads = thread_counts.front();
+    RunHashes reference = run_once(report.reference_threads);
+
+    for (size_t run = 1; run < thread_counts.size(); ++run) {
+        RunHashes hashes = run_once(thread_counts[run]);
+
+        // Report the earliest divergence over all SMs
+        SimTime first_cycle = std::numeric_limits<SimTime>::max();
+        uint32_t first_sm = 0;
+        for (uint32_t sm_id = 0; sm_id < reference.size(); ++sm_id) {
+            const auto& expected = reference[sm_id];
+            const auto& actual = hashes[sm_id];
+            size_t common = std::min(expected.size(), actual.size());
+
+            size_t i = 0;
+            while (i < common && expected[i].cycle == actual[i].cycle &&
+                   expected[i].hash == actual[i].hash) {
+                ++i;
+            }
+            report.cycles_compared += i;
+
+            if (i == expected.size() && i == actual.size()) {
+                continue;
+            }
+
+            // A missing cycle counts as diverging at the earlier of the two
+            SimTime cycle = std::numeric_limits<SimTime>::max();
+            if (i < expected.size()) cycle = std::min(cycle, expected[i].cycle);
+            if (i < actual.size()) cycle = std::min(cycle, actual[i].cycle);
+            if (cycle < first_cycle) {
+                first_cycle = cycle;
+                first_sm = sm_id;
+            }
+        }
+
+        if (first_cycle != std::numeric_limits<SimTime>::max()) {
+            report.deterministic = false;
+            report.divergent_threads = thread_counts[run];
+            report.divergent_sm = first_sm;
+            report.divergent_cycle = first_cycle;
+            return report;
+        }
+    }
+
+    return report;
+}
+
+void DeterminismChecker::print_report(const DeterminismReport& report) const {
+    std::cout << "\nDeterminism Check:\n"
+              << "==================\n"
+              << "Reference Threads: " << report.reference_threads << "\n"
+              << "Cycle Hashes Compared: " << report.cycles_compared << "\n";
+    if (report.deterministic) {
+        std::cout << "Result: PASS (identical event streams)\n";
+    } else {
+        std::cout << "Result: FAIL with " << report.divergent_threads << " threads, "
+                  << "SM " << report.divergent_sm << " diverges at cycle "
+                  << report.divergent_cycle << "\n";
+    }
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,45 @@
+// determinism_checker.h
+// Cross-thread-count reproducibility check for multi-SM simulation
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "multi_sm_engine.h"
+
+namespace gpu_simulator {
+
+// Outcome of comparing runs at several host thread counts
+struct DeterminismReport {
+    bool     deterministic;
+    uint32_t reference_threads;       // Thread count of the reference run
+    uint32_t divergent_threads;       // First thread count that disagreed
+    uint32_t divergent_sm;            // SM whose event stream disagreed
+    SimTime  divergent_cycle;         // First cycle with a differing hash
+    uint64_t cycles_compared;         // Per-SM cycle hashes compared in total
+};
+
+class DeterminismChecker {
+public:
+    // Called after initialize() to load the workload into a fresh engine
+    using WorkloadSetup = std::function<void(MultiSMEngine&)>;
+
+    // Constructor
+    DeterminismChecker(const MultiSMConfig& config, WorkloadSetup setup);
+
+    // Run the workload once per thread count and compare per-cycle event
+    // hashes against the first run
+    DeterminismReport check(const std::vector<uint32_t>& thread_counts) const;
+    void print_report(const DeterminismReport& report) const;
+
+private:
+    using RunHashes = std::vector<std::vector<CycleHash>>;  // Indexed by SM
+
+    RunHashes run_once(uint32_t num_threads) const;
+
+    MultiSMConfig config_;
+    WorkloadSetup setup_;
+};
+
+} // namespace gpu_simulator
@@ -0,0 +1,401 @@
+// interconnect.cpp
+// Implementation of the event-driven on-chip network
+
+#include "interconnect.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+namespace {
+
+std::string router_name(uint32_t router, uint32_t columns) {
+    return "(" + std::to_string(router % columns) + "," + std::to_string(router / columns) + ")";
+}
+
+} // namespace
+
+Interconnect::Interconnect(const InterconnectConfig& config, uint32_t num_sms,
+                           uint32_t num_partitions, bool to_sms)
+    : config_(config)
+    , num_sources_(to_sms ? num_partitions : num_sms)
+    , num_destinations_(to_sms ? num_sms : num_partitions)
+    , min_latency_(0)
+    , in_flight_(0) {
+    if (config_.topology == NocTopology::IDEAL) {
+        throw std::invalid_argument("An ideal interconnect has no network to model");
+    }
+    if (config_.link_latency == 0 || config_.link_bandwidth == 0 || config_.flit_size == 0 ||
+        config_.num_vcs == 0 || config_.vc_buffer_flits == 0) {
+        throw std::invalid_argument("Network latency, bandwidth, flit size, VCs and "
+                                    "buffers must be positive");
+    }
+    if (num_sms == 0 || num_partitions == 0) {
+        throw std::invalid_argument("Network needs at least one SM and one partition");
+    }
+
+    if (config_.topology == NocTopology::CROSSBAR) {
+        build_crossbar(num_sources_, num_destinations_,
+                       to_sms ? "l2p" : "sm", to_sms ? "sm" : "l2p");
+    } else {
+        build_mesh(num_sms, num_partitions, to_sms);
+    }
+
+    size_t shortest = std::numeric_limits<size_t>::max();
+    for (const auto& route : routes_) {
+        shortest = std::min(shortest, route.size());
+    }
+    min_latency_ = static_cast<SimTime>(shortest) * config_.link_latency;
+
+    reset();
+}
+
+Interconnect::~Interconnect() {
+    for (const auto& packet : packets_) {
+        delete packet.message.trans;
+    }
+    for (const auto& message : delivered_) {
+        delete message.trans;
+    }
+}
+
+uint32_t Interconnect::add_link(const std::string& name, int32_t destination) {
+    Link link{};
+    link.destination = destination;
+    link.stats.name = name;
+    links_.push_back(std::move(link));
+    return static_cast<uint32_t>(links_.size() - 1);
+}
+
+void Interconnect::build_crossbar(uint32_t num_sources, uint32_t num_destinations,
+                                  const std::string& source_name,
+                                  const std::string& destination_name) {
+    // Sources contend only for the output link of their destination
+    std::vector<uint32_t> outputs;
+    for (uint32_t d = 0; d < num_destinations; ++d) {
+        outputs.push_back(add_link("xbar->" + destination_name + std::to_string(d),
+                                   static_cast<int32_t>(d)));
+    }
+    for (uint32_t s = 0; s < num_sources; ++s) {
+        uint32_t input = add_link(source_name + std::to_string(s) + "->xbar");
+        for (uint32_t d = 0; d < num_destinations; ++d) {
+            routes_.push_back({input, outputs[d]});
+        }
+    }
+}
+
+void Interconnect::build_mesh(uint32_t num_sms, uint32_t num_partitions, bool to_sms) {
+    uint32_t endpoints = num_sms + num_partitions;
+    uint32_t columns = config_.mesh_columns;
+    if (columns == 0) {
+        columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(endpoints))));
+    }
+    uint32_t rows = (endpoints + columns - 1) / columns;
+    uint32_t routers = rows * columns;
+
+    // One endpoint per router: partitions spread evenly, SMs fill the rest
+    std::vector<uint32_t> partition_router(num_partitions);
+    std::vector<bool> taken(routers, false);
+    for (uint32_t p = 0; p < num_partitions; ++p) {
+        partition_router[p] = p * endpoints / num_partitions + endpoints / (2 * num_partitions);
+        taken[partition_router[p]] = true;
+    }
+    std::vector<uint32_t> sm_router;
+    for (uint32_t r = 0; r < routers && sm_router.size() < num_sms; ++r) {
+        if (!taken[r]) {
+            sm_router.push_back(r);
+        }
+    }
+
+    // Router-to-router links, indexed [router * 4 + direction]: E, W, S, N
+    const int32_t dx[4] = {1, -1, 0, 0};
+    const int32_t dy[4] = {0, 0, 1, -1};
+    std::vector<uint32_t> router_links(routers * 4, 0);
+    for (uint32_t r = 0; r < routers; ++r) {
+        int32_t x = static_cast<int32_t>(r % columns);
+        int32_t y = static_cast<int32_t>(r / columns);
+        for (uint32_t dir = 0; dir < 4; ++dir) {
+            int32_t nx = x + dx[dir];
+            int32_t ny = y + dy[dir];
+            if (nx < 0 || ny < 0 || nx >= static_cast<int32_t>(columns) ||
+                ny >= static_cast<int32_t>(rows)) {
+                continue;
+            }
+            uint32_t neighbour = static_cast<uint32_t>(ny) * columns + static_cast<uint32_t>(nx);
+            router_links[r * 4 + dir] = add_link(router_name(r, columns) + "->" +
+                                                 router_name(neighbour, columns));
+        }
+    }
+
+    const std::vector<uint32_t>& source_router = to_sms ? partition_router : sm_router;
+    const std::vector<uint32_t>& destination_router = to_sms ? sm_router : partition_router;
+    const std::string source_name = to_sms ? "l2p" : "sm";
+    const std::string destination_name = to_sms ? "sm" : "l2p";
+
+    std::vector<uint32_t> ejection;
+    for (uint32_t d = 0; d < num_destinations_; ++d) {
+        ejection.push_back(add_link(router_name(destination_router[d], columns) + "->" +
+                                    destination_name + std::to_string(d),
+                                    static_cast<int32_t>(d)));
+    }
+    for (uint32_t s = 0; s < num_sources_; ++s) {
+        uint32_t injection = add_link(source_name + std::to_string(s) + "->" +
+                                      router_name(source_router[s], columns));
+        for (uint32_t d = 0; d < num_destinations_; ++d) {
+            // X first, then Y: no cyclic channel dependence, so no deadlock
+            std::vector<uint32_t> route{injection};
+            uint32_t r = source_router[s];
+            uint32_t target = destination_router[d];
+            while (r % columns != target % columns) {
+                uint32_t dir = r % columns < target % columns ? 0 : 1;
+                route.push_back(router_links[r * 4 + dir]);
+                r = dir == 0 ? r + 1 : r - 1;
+            }
+            while (r != target) {
+                uint32_t dir = r < target ? 2 : 3;
+                route.push_back(router_links[r * 4 + dir]);
+                r = dir == 2 ? r + columns : r - columns;
+            }
+            route.push_back(ejection[d]);
+            routes_.push_back(std::move(route));
+        }
+    }
+}
+
+void Interconnect::reset() {
+    for (auto& packet : packets_) {
+        delete packet.message.trans;
+    }
+    for (auto& message : delivered_) {
+        delete message.trans;
+    }
+    packets_.clear();
+    free_packets_.clear();
+    delivered_.clear();
+    events_ = {};
+    injected_.assign(num_sources_, 0);
+    in_flight_ = 0;
+
+    for (auto& link : links_) {
+        link.busy_until = 0;
+        link.wake_scheduled = false;
+        link.credits.assign(config_.num_vcs, config_.vc_buffer_flits);
+        link.waiting.clear();
+        link.stats.packets = link.stats.flits = 0;
+        link.stats.busy_cycles = link.stats.credit_stalls = 0;
+    }
+    drain_free_.assign(num_destinations_, 0);
+    ejection_depth_.assign(num_destinations_, 0);
+
+    packets_delivered_ = 0;
+    flits_delivered_ = 0;
+    total_latency_ = 0;
+    max_latency_ = 0;
+    peak_injection_queue_ = 0;
+    peak_ejection_queue_ = 0;
+    horizon_ = 0;
+}
+
+uint32_t Interconnect::max_packet_bytes() const {
+    return config_.vc_buffer_flits * config_.flit_size;
+}
+
+void Interconnect::inject(const Message& message) {
+    if (message.source >= num_sources_ || message.destination >= num_destinations_) {
+        throw std::out_of_range("Network endpoint out of range");
+    }
+    uint32_t flits = std::max<uint32_t>(1, (message.bytes + config_.flit_size - 1) /
+                                           config_.flit_size);
+    if (flits > config_.vc_buffer_flits) {
+        throw std::invalid_argument("Packet of " + std::to_string(message.bytes) +
+                                    " bytes does not fit a VC buffer");
+    }
+
+    uint32_t id;
+    if (!free_packets_.empty()) {
+        id = free_packets_.back();
+        free_packets_.pop_back();
+    } else {
+        id = static_cast<uint32_t>(packets_.size());
+        packets_.emplace_back();
+    }
+    packets_[id] = Packet{message, injected_[message.source]++ * num_sources_ + message.source,
+                          message.source * num_destinations_ + message.destination,
+                          0, 0, flits};
+    in_flight_++;
+    schedule(message.time, EventType::READY, routes_[packets_[id].route][0], id);
+}
+
+void Interconnect::schedule(SimTime time, EventType type, uint32_t link, uint32_t packet,
+                            uint32_t vc, uint32_t flits) {
+    uint64_t order = type == EventType::LINK_FREE ? 0 : packets_[packet].order;
+    events_.push(Event{time, type, link, order, packet, vc, flits});
+}
+
+void Interconnect::advance(SimTime end_time) {
+    while (!events_.empty() && events_.top().time < end_time) {
+        Event event = events_.top();
+        events_.pop();
+        Link& link = links_[event.link];
+
+        switch (event.type) {
+            case EventType::READY:
+                link.waiting.push_back(event.packet);
+                if (packets_[event.packet].hop == 0) {
+                    peak_injection_queue_ = std::max<uint64_t>(peak_injection_queue_,
+                                                               link.waiting.size());
+                }
+                break;
+            case EventType::LINK_FREE:
+                link.wake_scheduled = false;
+                break;
+            case EventType::CREDIT:
+                link.credits[event.vc] += event.flits;
+                if (link.destination >= 0) {
+                    ejection_depth_[static_cast<uint32_t>(link.destination)]--;
+                }
+                break;
+        }
+        try_send(event.link, event.time);
+    }
+}
+
+void Interconnect::try_send(uint32_t link_id, SimTime now) {
+    Link& link = links_[link_id];
+    while (!link.waiting.empty()) {
+        if (link.busy_until > now) {
+            if (!link.wake_scheduled) {
+                link.wake_scheduled = true;
+                schedule(link.busy_until, EventType::LINK_FREE, link_id);
+            }
+            return;
+        }
+
+        // VC allocation: the first VC with room for the whole packet
+        uint32_t packet_id = link.waiting.front();
+        Packet& packet = packets_[packet_id];
+        auto vc = std::find_if(link.credits.begin(), link.credits.end(),
+                               [&](uint32_t credits) { return credits >= packet.flits; });
+        if (vc == link.credits.end()) {
+            link.stats.credit_stalls++;     // A returning credit retries
+            return;
+        }
+        link.waiting.pop_front();
+        *vc -= packet.flits;
+
+        uint64_t bytes = static_cast<uint64_t>(packet.flits) * config_.flit_size;
+        SimTime occupancy = (bytes + config_.link_bandwidth - 1) / config_.link_bandwidth;
+        link.busy_until = now + occupancy;
+        horizon_ = std::max(horizon_, link.busy_until);
+        link.stats.packets++;
+        link.stats.flits += packet.flits;
+        link.stats.busy_cycles += occupancy;
+
+        // The upstream buffer frees once the tail has left it
+        const std::vector<uint32_t>& route = routes_[packet.route];
+        if (packet.hop > 0) {
+            schedule(now + occupancy, EventType::CREDIT, route[packet.hop - 1], packet_id,
+                     packet.vc, packet.flits);
+        }
+        packet.vc = static_cast<uint32_t>(vc - link.credits.begin());
+        packet.hop++;
+
+        // Cut-through: the head moves on while the tail is serialized
+        if (packet.hop == route.size()) {
+            eject(packet_id, now + config_.link_latency + occupancy - 1);
+        } else {
+            schedule(now + config_.link_latency, EventType::READY, route[packet.hop], packet_id);
+        }
+    }
+}
+
+void Interconnect::eject(uint32_t packet_id, SimTime tail_time) {
+    Packet& packet = packets_[packet_id];
+    uint32_t destination = packet.message.destination;
+
+    SimTime delivery = std::max(tail_time, drain_free_[destination]);
+    drain_free_[destination] = delivery + 1;
+    ejection_depth_[destination]++;
+    peak_ejection_queue_ = std::max(peak_ejection_queue_, ejection_depth_[destination]);
+    schedule(delivery, EventType::CREDIT, routes_[packet.route].back(), packet_id,
+             packet.vc, packet.flits);
+
+    SimTime latency = delivery - packet.message.time;
+    packets_delivered_++;
+    flits_delivered_ += packet.flits;
+    total_latency_ += latency;
+    max_latency_ = std::max(max_latency_, latency);
+
+    Message message = packet.message;
+    message.time = delivery;
+    delivered_.push_back(message);
+    release(packet_id);
+}
+
+void Interconnect::release(uint32_t packet_id) {
+    packets_[packet_id].message.trans = nullptr;
+    free_packets_.push_back(packet_id);
+    in_flight_--;
+}
+
+SimTime Interconnect::next_event_time() const {
+    return events_.empty() ? NO_EVENT : events_.top().time;
+}
+
+SimTime Interconnect::next_output_time() const {
+    // Every delivery follows a link traversal started by some event
+    return events_.empty() ? NO_EVENT : events_.top().time + config_.link_latency;
+}
+
+InterconnectStats Interconnect::get_statistics() const {
+    InterconnectStats stats{};
+    stats.packets = packets_delivered_;
+    stats.flits = flits_delivered_;
+    stats.total_latency = total_latency_;
+    stats.max_latency = max_latency_;
+    stats.peak_injection_queue = peak_injection_queue_;
+    stats.peak_ejection_queue = peak_ejection_queue_;
+    stats.links.reserve(links_.size());
+    for (const auto& link : links_) {
+        stats.links.push_back(link.stats);
+    }
+    return stats;
+}
+
+void Interconnect::print_statistics(std::ostream& out, const std::string& title,
+                                    SimTime cycles, uint32_t top_links) const {
+    double average = packets_delivered_
+        ? static_cast<double>(total_latency_) / static_cast<double>(packets_delivered_) : 0.0;
+    out << "\n" << title << ":\n" << std::string(title.size() + 1, '=') << "\n"
+        << "Packets: " << packets_delivered_ << " (" << flits_delivered_ << " flits)\n"
+        << "Latency: " << std::fixed << std::setprecision(2) << average
+        << " avg, " << max_latency_ << " max (zero-load min " << min_latency_ << ")\n"
+        << "Peak Injection Queue: " << peak_injection_queue_
+        << ", Peak Ejection Queue: " << peak_ejection_queue_ << "\n";
+
+    std::vector<const LinkStats*> busiest;
+    for (const auto& link : links_) {
+        if (link.stats.packets > 0) {
+            busiest.push_back(&link.stats);
+        }
+    }
+    std::sort(busiest.begin(), busiest.end(), [](const LinkStats* a, const LinkStats* b) {
+        return a->busy_cycles != b->busy_cycles ? a->busy_cycles > b->busy_cycles
+                                                : a->name < b->name;
+    });
+    if (busiest.size() > top_links) {
+        busiest.resize(top_links);
+    }
+    // Traffic may outlast the cycles the caller counted
+    SimTime span = std::max(cycles, horizon_);
+    for (const LinkStats* link : busiest) {
+        double utilization = span ? link->busy_cycles * 100.0 / static_cast<double>(span) : 0.0;
+        out << "  " << std::left << std::setw(20) << link->name << std::right
+            << std::setw(8) << std::setprecision(2) << utilization << "% busy, "
+            << link->packets << " packets, " << link->credit_stalls << " credit stalls\n";
+    }
+}
+
+} // namespace gpu_simulator
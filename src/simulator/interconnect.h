@@ -0,0 +1,190 @@
+// interconnect.h
+// Event-driven on-chip network between SMs and L2 partitions
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <vector>
+#include "sim_engine.h"
+
+namespace gpu_simulator {
+
+// Network between SMs and memory partitions
+enum class NocTopology {
+    IDEAL,          // Fixed interconnect_latency, no contention
+    CROSSBAR,       // Injection link -> one switch -> output link per endpoint
+    MESH            // 2D mesh of routers, dimension-order (XY) routing
+};
+
+// Network configuration; every field but the topology is ignored for IDEAL
+struct InterconnectConfig {
+    NocTopology topology;
+    uint32_t    link_latency;         // Cycles for a head flit to cross a link
+    uint32_t    link_bandwidth;       // Bytes per cycle per link
+    uint32_t    flit_size;            // Bytes per flit
+    uint32_t    num_vcs;              // Virtual channels per link
+    uint32_t    vc_buffer_flits;      // Input buffer per VC, in flits (credits)
+    uint32_t    mesh_columns;         // MESH: routers per row (0 = square)
+};
+
+// Traffic counters of one unidirectional link
+struct LinkStats {
+    std::string name;
+    uint64_t    packets;
+    uint64_t    flits;
+    uint64_t    busy_cycles;          // Cycles spent serializing flits
+    uint64_t    credit_stalls;        // Head packet found no VC with room
+};
+
+// Statistics of one network
+struct InterconnectStats {
+    uint64_t packets;                 // Delivered
+    uint64_t flits;
+    uint64_t total_latency;           // Injection to delivery, summed
+    uint64_t max_latency;
+    uint64_t peak_injection_queue;    // Packets waiting at one source
+    uint64_t peak_ejection_queue;     // Packets buffered at one destination
+    std::vector<LinkStats> links;
+};
+
+// One direction of traffic: SM -> L2 requests or L2 -> SM replies (two
+// networks, so replies can never be blocked behind requests). Packets use
+// virtual cut-through: a packet claims a downstream VC only when the whole
+// packet fits, and the credits return once its tail has moved on. Each link
+// serializes one packet at a time at its bandwidth. Only packets generate
+// events, so an idle link costs nothing; a message is delivered after its
+// tail crosses the ejection link and the endpoint drains one packet per
+// cycle from its ejection queue.
+class Interconnect {
+public:
+    static constexpr SimTime NO_EVENT = std::numeric_limits<SimTime>::max();
+
+    struct Message {
+        SimTime            time;      // Injection cycle; delivery cycle once delivered
+        uint32_t           source;
+        uint32_t           destination;
+        uint32_t           bytes;
+        MemoryTransaction* trans;
+    };
+
+    // Constructor and destructor. SMs and partitions are the endpoints;
+    // to_sms selects the reply direction (partitions inject, SMs receive).
+    Interconnect(const InterconnectConfig& config, uint32_t num_sms,
+                 uint32_t num_partitions, bool to_sms);
+    ~Interconnect();      // Deletes transactions still in flight
+
+    // Delete copy constructor and assignment
+    Interconnect(const Interconnect&) = delete;
+    Interconnect& operator=(const Interconnect&) = delete;
+
+    void reset();
+    void inject(const Message& message);
+
+    // Process every event before end_time; deliveries may lie beyond it
+    void advance(SimTime end_time);
+    std::vector<Message>& delivered() { return delivered_; }
+
+    bool idle() const { return in_flight_ == 0; }
+    SimTime next_event_time() const;
+    // No message still inside can be delivered before this cycle
+    SimTime next_output_time() const;
+    // Zero-load latency of the shortest route
+    SimTime min_latency() const { return min_latency_; }
+    uint32_t max_packet_bytes() const;
+
+    InterconnectStats get_statistics() const;
+    void print_statistics(std::ostream& out, const std::string& title, SimTime cycles,
+                          uint32_t top_links = 5) const;
+
+private:
+    enum class EventType : uint8_t {
+        READY,          // Packet waits for its next link
+        LINK_FREE,      // Link finished serializing a packet
+        CREDIT          // Downstream buffer space returned
+    };
+
+    // Same-cycle events are ordered by what they are, never by when they
+    // were scheduled, so the outcome does not depend on how far each
+    // advance() call runs or how injections are batched
+    struct Event {
+        SimTime   time;
+        EventType type;
+        uint32_t  link;
+        uint64_t  order;      // Packet order (READY, CREDIT)
+        uint32_t  packet;     // READY
+        uint32_t  vc;         // CREDIT
+        uint32_t  flits;      // CREDIT
+
+        // Comparison operator for priority queue
+        bool operator>(const Event& other) const {
+            if (time != other.time) return time > other.time;
+            if (type != other.type) return type > other.type;
+            if (link != other.link) return link > other.link;
+            return order > other.order;
+        }
+    };
+
+    struct Packet {
+        Message  message;
+        uint64_t order;       // Per-source injection count, then source
+        uint32_t route;       // Index into routes_
+        uint32_t hop;         // Next link on the route
+        uint32_t vc;          // VC held in the current buffer
+        uint32_t flits;
+    };
+
+    struct Link {
+        SimTime                busy_until;
+        bool                   wake_scheduled;
+        int32_t                destination;   // Ejection links only, else -1
+        std::vector<uint32_t>  credits;       // Free flits per downstream VC
+        std::deque<uint32_t>   waiting;       // Packets queued, oldest first
+        LinkStats              stats;
+    };
+
+    uint32_t add_link(const std::string& name, int32_t destination = -1);
+    void build_crossbar(uint32_t num_sources, uint32_t num_destinations,
+                        const std::string& source_name, const std::string& destination_name);
+    void build_mesh(uint32_t num_sms, uint32_t num_partitions, bool to_sms);
+
+    void schedule(SimTime time, EventType type, uint32_t link, uint32_t packet = 0,
+                  uint32_t vc = 0, uint32_t flits = 0);
+    void try_send(uint32_t link_id, SimTime now);
+    void eject(uint32_t packet_id, SimTime tail_time);
+    void release(uint32_t packet_id);
+
+    InterconnectConfig config_;
+    uint32_t num_sources_;
+    uint32_t num_destinations_;
+    SimTime min_latency_;
+
+    std::vector<Link> links_;
+    std::vector<std::vector<uint32_t>> routes_;     // [source * destinations + destination]
+
+    std::vector<Packet> packets_;
+    std::vector<uint32_t> free_packets_;
+    uint64_t in_flight_;
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    std::vector<uint64_t> injected_;                // Packets per source
+
+    // Ejection side: endpoints drain one packet per cycle
+    std::vector<SimTime> drain_free_;
+    std::vector<uint64_t> ejection_depth_;
+    std::vector<Message> delivered_;
+
+    uint64_t packets_delivered_;
+    uint64_t flits_delivered_;
+    uint64_t total_latency_;
+    uint64_t max_latency_;
+    uint64_t peak_injection_queue_;
+    uint64_t peak_ejection_queue_;
+    SimTime horizon_;             // Latest cycle any link is busy until
+};
+
+} // namespace gpu_simulator
@@ -0,0 +1,166 @@
+// latency_histogram.cpp
+// Implementation of log-linear latency histograms
+
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace gpu_simulator {
+
+LatencyHistogram::LatencyHistogram(uint32_t significant_bits, uint32_t max_bits)
+    : significant_bits_(significant_bits)
+    , sub_count_(1u << significant_bits)
+    , half_count_(1u << (significant_bits - 1))
+    , limit_(0)
+    , count_(0)
+    , sum_(0)
+    , min_(std::numeric_limits<uint64_t>::max())
+    , max_(0) {
+    if (significant_bits < 1 || significant_bits > 16 ||
+        max_bits <= significant_bits || max_bits > 63) {
+        throw std::invalid_argument("Latency histogram needs 1-16 significant bits "
+                                    "and a larger max_bits of at most 63");
+    }
+    limit_ = (uint64_t{1} << max_bits) - 1;
+    counts_.assign(bucket_index(limit_) + 1, 0);
+}
+
+uint64_t LatencyHistogram::bucket_low(uint32_t index) const {
+    if (index < sub_count_) {
+        return index;
+    }
+    uint32_t shift = (index - sub_count_) / half_count_ + 1;
+    uint64_t top = half_count_ + (index - sub_count_) % half_count_;
+    return top << shift;
+}
+
+uint64_t LatencyHistogram::bucket_high(uint32_t index) const {
+    if (index < sub_count_) {
+        return index;
+    }
+    uint32_t shift = (index - sub_count_) / half_count_ + 1;
+    return bucket_low(index) + (uint64_t{1} << shift) - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    double clamped = std::clamp(percent, 0.0, 100.0);
+    uint64_t rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(count_))));
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            return std::min(bucket_high(i), max_);
+        }
+    }
+    return max_;
+}
+
+double LatencyHistogram::mean() const {
+    return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.counts_.size() != counts_.size() ||
+        other.significant_bits_ != significant_bits_) {
+        throw std::invalid_argument("Cannot merge latency histograms of different layout");
+    }
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    count_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+MemoryLatencyProfile::MemoryLatencyProfile(uint32_t num_warps)
+    : levels_(NUM_LEVELS)
+    , warps_(num_warps) {
+}
+
+const LatencyHistogram& MemoryLatencyProfile::level(MemoryLevel level) const {
+    return levels_[static_cast<uint32_t>(level)];
+}
+
+const LatencyHistogram& MemoryLatencyProfile::warp(uint32_t warp_id) const {
+    if (warp_id >= warps_.size()) {
+        throw std::out_of_range("Warp ID out of range");
+    }
+    return warps_[warp_id];
+}
+
+void MemoryLatencyProfile::reset() {
+    total_.reset();
+    for (auto& histogram : levels_) {
+        histogram.reset();
+    }
+    reads_.reset();
+    writes_.reset();
+    for (auto& histogram : warps_) {
+        histogram.reset();
+    }
+}
+
+const char* MemoryLatencyProfile::level_name(MemoryLevel level) {
+    switch (level) {
+        case MemoryLevel::UNTRACKED: return "untracked";
+        case MemoryLevel::L1:        return "l1";
+        case MemoryLevel::L2:        return "l2";
+        case MemoryLevel::DRAM:      return "dram";
+    }
+    return "unknown";
+}
+
+void MemoryLatencyProfile::print(std::ostream& out, bool per_warp) const {
+    auto row = [&](const std::string& scope, const LatencyHistogram& histogram) {
+        out << std::left << std::setw(12) << scope << std::right
+            << std::setw(12) << histogram.count()
+            << std::setw(10) << std::fixed << std::setprecision(2) << histogram.mean()
+            << std::setw(8) << histogram.percentile(50.0)
+            << std::setw(8) << histogram.percentile(99.0)
+            << std::setw(8) << histogram.percentile(99.9)
+            << std::setw(8) << histogram.max() << "\n";
+    };
+
+    out << "\nMemory Latency (cycles):\n"
+        << "========================\n"
+        << std::left << std::setw(12) << "Scope" << std::right
+        << std::setw(12) << "Requests" << std::setw(10) << "Mean"
+        << std::setw(8) << "p50" << std::setw(8) << "p99"
+        << std::setw(8) << "p99.9" << std::setw(8) << "Max" << "\n";
+
+    row("all", total_);
+    for (uint32_t i = 1; i < NUM_LEVELS; ++i) {
+        if (levels_[i].count() > 0) {
+            row(level_name(static_cast<MemoryLevel>(i)), levels_[i]);
+        }
+    }
+    row("reads", reads_);
+    row("writes", writes_);
+    if (per_warp) {
+        for (uint32_t warp = 0; warp < warps_.size(); ++warp) {
+            if (warps_[warp].count() > 0) {
+                row("warp " + std::to_string(warp), warps_[warp]);
+            }
+        }
+    }
+}
+
+} // namespace gpu_simulator
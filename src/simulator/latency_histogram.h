@@ -0,0 +1,118 @@
+// latency_histogram.h
+// Log-linear (HDR-style) latency histograms for memory requests
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
+
+namespace gpu_simulator {
+
+// Level of the hierarchy that answered a memory request
+enum class MemoryLevel : uint8_t {
+    UNTRACKED = 0,   // Issue time unknown (e.g. restored from a checkpoint)
+    L1,              // Hit in the SM's cache
+    L2,              // Hit in the shared L2
+    DRAM             // Missed every cache level
+};
+
+// Fixed-size histogram with bounded relative error: values below
+// 2^significant_bits are exact, larger ones fall into buckets whose width is
+// 1/2^(significant_bits-1) of their magnitude. Recording is O(1) and never
+// allocates; values at or above 2^max_bits land in the last bucket.
+class LatencyHistogram {
+public:
+    // Constructor
+    explicit LatencyHistogram(uint32_t significant_bits = 5, uint32_t max_bits = 24);
+
+    void record(uint64_t value) {
+        counts_[bucket_index(value)]++;
+        count_++;
+        sum_ += value;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+    }
+
+    // Value at or below which the given percentage of samples fall (upper
+    // edge of its bucket, capped at the largest sample); 0 when empty
+    uint64_t percentile(double percent) const;
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const;
+
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    // Bucket layout
+    uint32_t num_buckets() const { return static_cast<uint32_t>(counts_.size()); }
+    uint64_t bucket_count(uint32_t index) const { return counts_[index]; }
+    uint64_t bucket_low(uint32_t index) const;
+    uint64_t bucket_high(uint32_t index) const;
+
+private:
+    uint32_t bucket_index(uint64_t value) const {
+        if (value < sub_count_) {
+            return static_cast<uint32_t>(value);
+        }
+        if (value > limit_) {
+            value = limit_;
+        }
+        uint32_t msb = 63 - static_cast<uint32_t>(__builtin_clzll(value));
+        uint32_t shift = msb - (significant_bits_ - 1);
+        return sub_count_ + (shift - 1) * half_count_ +
+               static_cast<uint32_t>((value >> shift) - half_count_);
+    }
+
+    uint32_t significant_bits_;
+    uint32_t sub_count_;     // 2^significant_bits
+    uint32_t half_count_;    // Sub-buckets per power of two above sub_count_
+    uint64_t limit_;         // Largest value with its own bucket
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+// Memory request latency (issue to retirement) broken down by answering
+// level, by read/write and by warp. All histograms are sized up front.
+class MemoryLatencyProfile {
+public:
+    static constexpr uint32_t NUM_LEVELS = 4;
+
+    // Constructor
+    explicit MemoryLatencyProfile(uint32_t num_warps);
+
+    void record(MemoryLevel level, bool is_write, uint32_t warp_id, uint64_t latency) {
+        total_.record(latency);
+        levels_[static_cast<uint32_t>(level)].record(latency);
+        (is_write ? writes_ : reads_).record(latency);
+        if (warp_id < warps_.size()) {
+            warps_[warp_id].record(latency);
+        }
+    }
+
+    const LatencyHistogram& total() const { return total_; }
+    const LatencyHistogram& level(MemoryLevel level) const;
+    const LatencyHistogram& reads() const { return reads_; }
+    const LatencyHistogram& writes() const { return writes_; }
+    const LatencyHistogram& warp(uint32_t warp_id) const;
+    uint32_t num_warps() const { return static_cast<uint32_t>(warps_.size()); }
+
+    void reset();
+    void print(std::ostream& out, bool per_warp = false) const;
+
+    static const char* level_name(MemoryLevel level);
+
+private:
+    LatencyHistogram total_;
+    std::vector<LatencyHistogram> levels_;
+    LatencyHistogram reads_;
+    LatencyHistogram writes_;
+    std::vector<LatencyHistogram> warps_;
+};
+
+} // namespace gpu_simulator
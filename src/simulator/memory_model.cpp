@@ -2,32 +2,53 @@
 // Implementation of memory subsystem simulation
 
 #include "memory_model.h"
+#include "checkpoint.h"
+#include "host_profiler.h"
 #include <cassert>
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
+#include <map>
+#include <stdexcept>
 
 namespace gpu_simulator {
 
-MemoryModel::MemoryModel(uint32_t cache_size, uint32_t line_size, uint32_t memory_latency)
-    : current_cycle_(0) {
+namespace {
+
+// Fixed-width checkpoint records
+struct CacheLineRecord {
+    uint64_t last_access;
+    uint32_t tag;
+    uint8_t  valid;
+    uint8_t  dirty;
+    uint8_t  reserved[2];
+};
+
+struct MemoryWordRecord {
+    uint32_t address;
+    uint32_t data;
+};
+
+constexpr uint32_t PAGE_WORDS = 1024;   // 4KB main memory pages
+constexpr uint32_t PAGE_BITMAP_WORDS = PAGE_WORDS / 32;
+
+} // namespace
+
+MemoryModel::MemoryModel(uint32_t cache_size, uint32_t line_size, uint32_t memory_latency,
+                         StatsRegistry* registry, const std::string& stats_prefix)
+    : owned_registry_(registry ? nullptr : std::make_unique<StatsRegistry>())
+    , registry_(registry ? registry : owned_registry_.get())
+    , stats_prefix_(stats_prefix)
+    , current_cycle_(0) {
     // Initialize configuration
-    config_.total_size = cache_size;
     config_.line_size = line_size;
-    config_.associativity = 8;  // 8-way set associative
     config_.num_banks = 8;      // 8 memory banks
     config_.memory_latency = memory_latency;
-
-    // Calculate number of sets
-    uint32_t num_sets = cache_size / (line_size * config_.associativity);
-    sets_.reserve(num_sets);
-    for (uint32_t i = 0; i < num_sets; ++i) {
-        sets_.emplace_back(config_.associativity, config_.line_size);
-    }
+    build_sets(cache_size);
 
     // Initialize statistics
-    stats_ = CacheStats{};
+    register_statistics();
 
     // Reserve space for access history
     access_history_.reserve(MAX_HISTORY_SIZE);
@@ -35,6 +56,38 @@ MemoryModel::MemoryModel(uint32_t cache_size, uint32_t line_size, uint32_t memor
 
 MemoryModel::~MemoryModel() = default;
 
+void MemoryModel::build_sets(uint32_t cache_size) {
+    // 8-way set associative. The set index is a bit field, so the set count
+    // stays a power of two; other capacities (carveouts) get more ways.
+    uint32_t lines = cache_size / config_.line_size;
+    uint32_t num_sets = 1;
+    while (lines % (num_sets * 2) == 0 && lines / (num_sets * 2) >= 8) {
+        num_sets *= 2;
+    }
+    config_.total_size = cache_size;
+    config_.associativity = std::max<uint32_t>(lines / num_sets, 1);
+
+    sets_.clear();
+    sets_.reserve(num_sets);
+    for (uint32_t i = 0; i < num_sets; ++i) {
+        sets_.emplace_back(config_.associativity, config_.line_size);
+    }
+}
+
+void MemoryModel::set_capacity(uint32_t cache_size) {
+    for (uint32_t set_index = 0; set_index < sets_.size(); ++set_index) {
+        for (const auto& way : sets_[set_index].ways) {
+            if (way.valid && way.dirty) {
+                uint32_t base_address = line_address(way.tag, set_index);
+                for (uint32_t i = 0; i < way.data.size(); ++i) {
+                    main_memory_[base_address + i * 4] = way.data[i];
+                }
+            }
+        }
+    }
+    build_sets(cache_size);
+}
+
 void MemoryModel::initialize() {
     // Clear cache state
     for (auto& set : sets_) {
@@ -51,22 +104,68 @@ void MemoryModel::initialize() {
     main_memory_.clear();
 
     // Reset statistics
-    stats_ = CacheStats{};
+    registry_->reset(stats_prefix_);
     current_cycle_ = 0;
     access_history_.clear();
 }
 
 uint64_t MemoryModel::process_request(uint32_t address, uint32_t data, bool is_write) {
-    // Record access
-    if (access_history_.size() < MAX_HISTORY_SIZE) {
-        access_history_.push_back({address, data, is_write, current_cycle_});
+    access(address, data, is_write);
+    return current_cycle_;
+}
+
+MemoryResult MemoryModel::access(uint32_t address, uint32_t data, bool is_write) {
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::MEMORY_MODEL);
+    return access_line(address, data, is_write, true);
+}
+
+MemoryResult MemoryModel::read_noncoherent(uint32_t address) {
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::MEMORY_MODEL);
+    return access_line(address, 0, false, true, false);
+}
+
+void MemoryModel::warm(uint32_t address, uint32_t data, bool is_write) {
+    access_line(address, data, is_write, false);
+}
+
+uint32_t MemoryModel::functional_read(uint32_t address) {
+    uint32_t data;
+    if (lookup_cache(address, data)) {
+        return data;
     }
+    return read_backing(address);
+}
 
-    // Update statistics
-    if (is_write) {
-        stats_.writes++;
-    } else {
-        stats_.reads++;
+void MemoryModel::functional_write(uint32_t address, uint32_t data) {
+    uint32_t set_index = get_set_index(address);
+    uint32_t tag = get_tag(address);
+    uint32_t offset = get_offset(address);
+
+    // A resident line holds the newest copy; leave its LRU position alone
+    for (auto& way : sets_[set_index].ways) {
+        if (way.valid && way.tag == tag) {
+            way.data[offset/4] = data;
+            way.dirty = true;
+            return;
+        }
+    }
+    main_memory_[address] = data;
+}
+
+MemoryResult MemoryModel::access_line(uint32_t address, uint32_t data, bool is_write,
+                                      bool timed, bool coherent) {
+    if (timed) {
+        // Record access
+        if (access_history_.size() < MAX_HISTORY_SIZE) {
+            access_history_.push_back({address, data, is_write, current_cycle_});
+        }
+
+        // Update statistics
+        if (is_write) {
+            stats_.writes++;
+        } else {
+            stats_.reads++;
+        }
     }
 
     // Check alignment
@@ -94,16 +193,29 @@ uint64_t MemoryModel::process_request(uint32_t address, uint32_t data, bool is_w
     }
 
     // Update statistics
-    if (hit) {
-        stats_.hits++;
-    } else {
-        stats_.misses++;
-    }
+    uint32_t latency = 1;   // Untimed accesses still advance the LRU clock
+    if (timed) {
+        if (hit) {
+            stats_.hits++;
+        } else {
+            stats_.misses++;
+        }
+        for (AccessObserver* observer : observers_) {
+            observer->on_access(address, is_write, hit);
+        }
 
-    // Calculate access latency
-    uint32_t latency = calculate_access_latency(physical_address, hit);
-    latency += check_bank_conflicts(physical_address);
+        // Calculate access latency
+        latency = calculate_access_latency(physical_address, hit);
+        uint32_t conflict_cycles = check_bank_conflicts(physical_address);
+        if (conflict_cycles > 0) {
+            stats_.bank_conflicts++;
+            latency += conflict_cycles;
+        }
+        stats_.latency.sample(latency);
+    }
 
+    bool evicted = false;
+    uint32_t victim_line = 0;
     if (hit) {
         // Cache hit
         CacheLine& line = set.ways[hit_way];
@@ -121,23 +233,27 @@ uint64_t MemoryModel::process_request(uint32_t address, uint32_t data, bool is_w
         // Cache miss
         uint32_t victim_way = select_victim(set);
         CacheLine& victim = set.ways[victim_way];
+        if (victim.valid) {
+            evicted = true;
+            victim_line = line_address(victim.tag, set_index);
+        }
 
         // Handle eviction if necessary
         if (victim.valid && victim.dirty) {
             // Write back dirty line
-            uint32_t victim_address = (victim.tag << (32 - get_tag(0xFFFFFFFF))) | 
-                                    (set_index << get_offset(0xFFFFFFFF));
             for (uint32_t i = 0; i < victim.data.size(); ++i) {
-                main_memory_[victim_address + i*4] = victim.data[i];
+                main_memory_[victim_line + i*4] = victim.data[i];
+            }
+            if (timed) {
+                stats_.evictions++;
             }
-            stats_.evictions++;
         }
 
         // Load new line from memory
         uint32_t base_address = physical_address & ~(config_.line_size - 1);
         for (uint32_t i = 0; i < config_.line_size/4; ++i) {
             uint32_t addr = base_address + i*4;
-            victim.data[i] = main_memory_[addr];
+            victim.data[i] = read_backing(addr);
         }
 
         victim.tag = tag;
@@ -153,15 +269,21 @@ uint64_t MemoryModel::process_request(uint32_t address, uint32_t data, bool is_w
     }
 
     // Handle cache coherence
-    handle_coherence(physical_address);
+    if (coherent) {
+        handle_coherence(physical_address);
+    }
 
     // Update cycle count
     current_cycle_ += latency;
 
-    return current_cycle_;
+    MemoryResult result{hit, timed ? latency : 0, data};
+    result.evicted = evicted;
+    result.victim_address = victim_line;
+    return result;
 }
 
 uint32_t MemoryModel::read_instruction(uint32_t address) {
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::MEMORY_MODEL);
     uint32_t data;
     if (lookup_cache(address, data)) {
         return data;
@@ -173,6 +295,33 @@ uint32_t MemoryModel::read_instruction(uint32_t address) {
     }
 }
 
+void MemoryModel::add_observer(AccessObserver* observer) {
+    observers_.push_back(observer);
+}
+
+void MemoryModel::remove_observer(AccessObserver* observer) {
+    observers_.erase(std::remove(observers_.begin(), observers_.end(), observer),
+                     observers_.end());
+}
+
+void MemoryModel::attach_image(std::shared_ptr<const MemoryImage> image) {
+    image_ = std::move(image);
+}
+
+uint32_t MemoryModel::read_backing(uint32_t address) const {
+    auto it = main_memory_.find(address);
+    if (it != main_memory_.end()) {
+        return it->second;
+    }
+    if (image_) {
+        auto image_it = image_->find(address);
+        if (image_it != image_->end()) {
+            return image_it->second;
+        }
+    }
+    return 0;
+}
+
 bool MemoryModel::lookup_cache(uint32_t address, uint32_t& data) {
     uint32_t set_index = get_set_index(address);
     uint32_t tag = get_tag(address);
@@ -258,6 +407,13 @@ uint32_t MemoryModel::get_tag(uint32_t address) const {
     return address >> (offset_bits + set_bits);
 }
 
+uint32_t MemoryModel::line_address(uint32_t tag, uint32_t set_index) const {
+    uint32_t num_sets = config_.total_size / (config_.line_size * config_.associativity);
+    uint32_t set_bits = static_cast<uint32_t>(std::log2(num_sets));
+    uint32_t offset_bits = static_cast<uint32_t>(std::log2(config_.line_size));
+    return (tag << (offset_bits + set_bits)) | (set_index << offset_bits);
+}
+
 uint32_t MemoryModel::get_offset(uint32_t address) const {
     return address & (config_.line_size - 1);
 }
@@ -267,7 +423,43 @@ uint32_t MemoryModel::get_bank_index(uint32_t address) const {
 }
 
 std::pair<uint64_t, uint64_t> MemoryModel::get_cache_stats() const {
-    return {stats_.hits, stats_.misses};
+    return {stats_.hits.value(), stats_.misses.value()};
+}
+
+CacheStats MemoryModel::get_cache_statistics() const {
+    return CacheStats{stats_.reads.value(), stats_.writes.value(),
+                      stats_.hits.value(), stats_.misses.value(),
+                      stats_.evictions.value(), stats_.bank_conflicts.value()};
+}
+
+StatsRegistry& MemoryModel::stats_registry() {
+    return *registry_;
+}
+
+void MemoryModel::register_statistics() {
+    StatGroup group = registry_->group(stats_prefix_);
+    stats_.reads = group.counter("reads", "Timed read accesses");
+    stats_.writes = group.counter("writes", "Timed write accesses");
+    stats_.hits = group.counter("hits", "Cache hits");
+    stats_.misses = group.counter("misses", "Cache misses");
+    stats_.evictions = group.counter("evictions", "Dirty lines written back");
+    stats_.bank_conflicts = group.counter("bank_conflicts", "Accesses delayed by a bank conflict");
+    stats_.latency = group.histogram("access_latency", "Access latency in cycles", 32, 8);
+
+    CacheCounters* counters = &stats_;
+    group.formula("hit_rate", "Hits per access", [counters]() {
+        uint64_t accesses = counters->hits.value() + counters->misses.value();
+        return accesses ? static_cast<double>(counters->hits.value()) / accesses : 0.0;
+    });
+}
+
+void MemoryModel::set_memory_latency(uint32_t memory_latency) {
+    config_.memory_latency = memory_latency;
+}
+
+uint32_t MemoryModel::min_access_latency() const {
+    // Lower bound on any access, used as lookahead by parallel schedulers
+    return calculate_access_latency(0, true);
 }
 
 void MemoryModel::print_cache_state() const {
@@ -279,16 +471,17 @@ void MemoryModel::print_cache_state() const {
     std::cout << "  Associativity: " << config_.associativity << "-way\n";
     std::cout << "  Number of Banks: " << config_.num_banks << "\n\n";
 
+    CacheStats stats = get_cache_statistics();
     std::cout << "Statistics:\n";
-    std::cout << "  Reads: " << stats_.reads << "\n";
-    std::cout << "  Writes: " << stats_.writes << "\n";
-    std::cout << "  Hits: " << stats_.hits << "\n";
-    std::cout << "  Misses: " << stats_.misses << "\n";
-    std::cout << "  Evictions: " << stats_.evictions << "\n";
-    std::cout << "  Bank Conflicts: " << stats_.bank_conflicts << "\n";
-
-    double hit_rate = static_cast<double>(stats_.hits) / 
-                     static_cast<double>(stats_.hits + stats_.misses);
+    std::cout << "  Reads: " << stats.reads << "\n";
+    std::cout << "  Writes: " << stats.writes << "\n";
+    std::cout << "  Hits: " << stats.hits << "\n";
+    std::cout << "  Misses: " << stats.misses << "\n";
+    std::cout << "  Evictions: " << stats.evictions << "\n";
+    std::cout << "  Bank Conflicts: " << stats.bank_conflicts << "\n";
+
+    double hit_rate = static_cast<double>(stats.hits) / 
+                     static_cast<double>(stats.hits + stats.misses);
     std::cout << "  Hit Rate: " << std::fixed << std::setprecision(2) 
               << (hit_rate * 100.0) << "%\n\n";
 
@@ -336,7 +529,8 @@ void MemoryModel::verify_state() const {
     assert(access_history_.size() <= MAX_HISTORY_SIZE && "Access history overflow");
 
     // Verify statistics consistency
-    assert(stats_.hits + stats_.misses == stats_.reads + stats_.writes && 
+    assert(stats_.hits.value() + stats_.misses.value() ==
+           stats_.reads.value() + stats_.writes.value() && 
            "Hit/miss count mismatch with access count");
 }
 
@@ -379,8 +573,7 @@ void MemoryModel::invalidate_cache_line(uint32_t address) {
         if (way.valid && way.tag == tag) {
             if (way.dirty) {
                 // Write back dirty data before invalidating
-                uint32_t base_address = (way.tag << (32 - get_tag(0xFFFFFFFF))) | 
-                                      (set_index << get_offset(0xFFFFFFFF));
+                uint32_t base_address = line_address(way.tag, set_index);
                 for (uint32_t i = 0; i < way.data.size(); ++i) {
                     main_memory_[base_address + i*4] = way.data[i];
                 }
@@ -398,8 +591,7 @@ void MemoryModel::evict_cache_line(uint32_t set_index, uint32_t way) {
     CacheLine& line = sets_[set_index].ways[way];
     if (line.valid && line.dirty) {
         // Write back dirty data
-        uint32_t base_address = (line.tag << (32 - get_tag(0xFFFFFFFF))) | 
-                               (set_index << get_offset(0xFFFFFFFF));
+        uint32_t base_address = line_address(line.tag, set_index);
         for (uint32_t i = 0; i < line.data.size(); ++i) {
             main_memory_[base_address + i*4] = line.data[i];
         }
@@ -411,4 +603,135 @@ void MemoryModel::evict_cache_line(uint32_t set_index, uint32_t way) {
     stats_.evictions++;
 }
 
+void MemoryModel::save_state(CheckpointWriter& writer, uint32_t cache_tag,
+                             uint32_t memory_tag) const {
+    writer.begin_section(cache_tag);
+    writer.put(config_.total_size);
+    writer.put(config_.line_size);
+    writer.put(config_.associativity);
+    writer.put(config_.num_banks);
+    writer.put(current_cycle_);
+    writer.put(get_cache_statistics());
+
+    // Line metadata first, then all line data, so restore is two bulk copies
+    for (const auto& set : sets_) {
+        for (const auto& way : set.ways) {
+            CacheLineRecord record{way.last_access, way.tag,
+                                   static_cast<uint8_t>(way.valid),
+                                   static_cast<uint8_t>(way.dirty), {0, 0}};
+            writer.put(record);
+        }
+    }
+    for (const auto& set : sets_) {
+        for (const auto& way : set.ways) {
+            writer.put_array(way.data.data(), way.data.size());
+        }
+    }
+    writer.end_section();
+
+    // Main memory as sorted 4KB pages with a presence bitmap, so words that
+    // were never written still fall through to the attached image. Functional
+    // writes keep the address they were given, so a trace may leave words at
+    // unaligned addresses; those few entries follow the pages as raw
+    // address/data pairs.
+    std::map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> pages;
+    std::vector<MemoryWordRecord> unaligned;
+    for (const auto& [address, data] : main_memory_) {
+        if (address % 4 != 0) {
+            unaligned.push_back({address, data});
+        } else {
+            pages[address / (PAGE_WORDS * 4)].push_back({(address / 4) % PAGE_WORDS, data});
+        }
+    }
+    std::sort(unaligned.begin(), unaligned.end(),
+              [](const MemoryWordRecord& a, const MemoryWordRecord& b) {
+                  return a.address < b.address;
+              });
+
+    writer.begin_section(memory_tag);
+    writer.put(static_cast<uint32_t>(pages.size()));
+    writer.put(static_cast<uint32_t>(unaligned.size()));
+    for (auto& [page, words] : pages) {
+        std::sort(words.begin(), words.end());
+        uint32_t bitmap[PAGE_BITMAP_WORDS] = {};
+        for (const auto& word : words) {
+            bitmap[word.first / 32] |= 1u << (word.first % 32);
+        }
+        writer.put(page);
+        writer.put(static_cast<uint32_t>(words.size()));
+        writer.put_array(bitmap, PAGE_BITMAP_WORDS);
+        for (const auto& word : words) {
+            writer.put(word.second);
+        }
+    }
+    writer.put_array(unaligned.data(), unaligned.size());
+    writer.end_section();
+}
+
+void MemoryModel::restore_state(const CheckpointReader& reader, uint32_t cache_tag,
+                                uint32_t memory_tag) {
+    SectionReader cache = reader.section(cache_tag);
+    uint32_t total_size = cache.get<uint32_t>();
+    uint32_t line_size = cache.get<uint32_t>();
+    uint32_t associativity = cache.get<uint32_t>();
+    uint32_t num_banks = cache.get<uint32_t>();
+    if (total_size != config_.total_size || line_size != config_.line_size ||
+        associativity != config_.associativity || num_banks != config_.num_banks) {
+        throw std::runtime_error("Checkpoint cache geometry does not match this model");
+    }
+
+    current_cycle_ = cache.get<uint64_t>();
+    CacheStats stats = cache.get<CacheStats>();
+    stats_.reads.set(stats.reads);
+    stats_.writes.set(stats.writes);
+    stats_.hits.set(stats.hits);
+    stats_.misses.set(stats.misses);
+    stats_.evictions.set(stats.evictions);
+    stats_.bank_conflicts.set(stats.bank_conflicts);
+    registry_->reset(stats_prefix_ + ".access_latency");
+
+    for (auto& set : sets_) {
+        for (auto& way : set.ways) {
+            CacheLineRecord record = cache.get<CacheLineRecord>();
+            way.last_access = record.last_access;
+            way.tag = record.tag;
+            way.valid = record.valid != 0;
+            way.dirty = record.dirty != 0;
+        }
+    }
+    for (auto& set : sets_) {
+        for (auto& way : set.ways) {
+            cache.get_array(way.data.data(), way.data.size());
+        }
+    }
+
+    SectionReader memory = reader.section(memory_tag);
+    main_memory_.clear();
+    uint32_t num_pages = memory.get<uint32_t>();
+    uint32_t num_unaligned = memory.get<uint32_t>();
+    for (uint32_t p = 0; p < num_pages; ++p) {
+        uint32_t page = memory.get<uint32_t>();
+        uint32_t count = memory.get<uint32_t>();
+        uint32_t bitmap[PAGE_BITMAP_WORDS];
+        memory.get_array(bitmap, PAGE_BITMAP_WORDS);
+
+        uint32_t restored = 0;
+        for (uint32_t w = 0; w < PAGE_WORDS; ++w) {
+            if (bitmap[w / 32] & (1u << (w % 32))) {
+                main_memory_[(page * PAGE_WORDS + w) * 4] = memory.get<uint32_t>();
+                restored++;
+            }
+        }
+        if (restored != count) {
+            throw std::runtime_error("Checkpoint memory page is inconsistent");
+        }
+    }
+    for (uint32_t i = 0; i < num_unaligned; ++i) {
+        MemoryWordRecord record = memory.get<MemoryWordRecord>();
+        main_memory_[record.address] = record.data;
+    }
+
+    access_history_.clear();
+}
+
 } // namespace gpu_simulator
\ No newline at end of file
@@ -8,12 +8,16 @@
 #include <unordered_map>
 #include <utility>
 #include <memory>
+#include <string>
+#include "stats_registry.h"
 
 namespace gpu_simulator {
 
 // Forward declarations
 class CacheLine;
 class CacheSet;
+class CheckpointWriter;
+class CheckpointReader;
 
 // Cache configuration and statistics
 struct CacheConfig {
@@ -24,6 +28,7 @@ struct CacheConfig {
     uint32_t memory_latency;    // DRAM access latency in cycles
 };
 
+// Snapshot of the cache counters (checkpoint layout and reporting API)
 struct CacheStats {
     uint64_t reads;
     uint64_t writes;
@@ -33,17 +38,34 @@ struct CacheStats {
     uint64_t bank_conflicts;
 };
 
+// Read-only memory contents shared between model instances (word address -> data)
+using MemoryImage = std::unordered_map<uint32_t, uint32_t>;
+
 // Memory access result
 struct MemoryResult {
     bool hit;
     uint32_t latency;
     uint32_t data;
+
+    // Side effects of the access (for attribution)
+    bool     evicted = false;         // A valid line was replaced
+    uint32_t victim_address = 0;      // Base address of that line
+};
+
+// Observer notified of every cache access (analysis and profiling hooks)
+class AccessObserver {
+public:
+    virtual ~AccessObserver() = default;
+    virtual void on_access(uint32_t address, bool is_write, bool hit) = 0;
 };
 
 class MemoryModel {
 public:
-    // Constructor and destructor
-    MemoryModel(uint32_t cache_size, uint32_t line_size, uint32_t memory_latency);
+    // Constructor and destructor. Counters are registered under stats_prefix
+    // in the given registry, or in a private one when none is passed.
+    MemoryModel(uint32_t cache_size, uint32_t line_size, uint32_t memory_latency,
+                StatsRegistry* registry = nullptr,
+                const std::string& stats_prefix = "memory");
     ~MemoryModel();
 
     // Delete copy constructor and assignment
@@ -53,15 +75,50 @@ public:
     // Core memory operations
     void initialize();
     uint64_t process_request(uint32_t address, uint32_t data, bool is_write);
+    MemoryResult access(uint32_t address, uint32_t data, bool is_write);
+    // Timed read for caches outside the coherence domain (constant and
+    // read-only data): no coherence pass, so lines never turn dirty
+    MemoryResult read_noncoherent(uint32_t address);
     uint32_t read_instruction(uint32_t address);
 
+    // Untimed operations for fast-forwarding: no statistics, observers or
+    // latency. warm() updates cache contents and LRU order like access();
+    // functional_read/write only move data.
+    void warm(uint32_t address, uint32_t data, bool is_write);
+    uint32_t functional_read(uint32_t address);
+    void functional_write(uint32_t address, uint32_t data);
+
+    // Backing store: words not yet written fall through to the shared image
+    void attach_image(std::shared_ptr<const MemoryImage> image);
+
     // Cache management
     bool lookup_cache(uint32_t address, uint32_t& data);
     void update_cache(uint32_t address, uint32_t data);
     void evict_cache_line(uint32_t set_index, uint32_t way);
 
+    // Timing parameters that can change without rebuilding the cache
+    void set_memory_latency(uint32_t memory_latency);
+
+    // Resize the cache (e.g. a new L1 / shared-memory carveout). Dirty lines
+    // are written back and the cache restarts empty; counters are kept.
+    void set_capacity(uint32_t cache_size);
+
+    // Checkpointing (cache contents, main memory pages, counters) into a
+    // cache and a memory section; models sharing a checkpoint use their own
+    // pair of section tags. The latency histogram is not saved and restarts
+    // empty on restore.
+    void save_state(CheckpointWriter& writer, uint32_t cache_tag, uint32_t memory_tag) const;
+    void restore_state(const CheckpointReader& reader, uint32_t cache_tag, uint32_t memory_tag);
+
+    // Analysis hooks (observers are not owned)
+    void add_observer(AccessObserver* observer);
+    void remove_observer(AccessObserver* observer);
+
     // Statistics and monitoring
     std::pair<uint64_t, uint64_t> get_cache_stats() const;
+    CacheStats get_cache_statistics() const;
+    StatsRegistry& stats_registry();
+    uint32_t min_access_latency() const;
     void print_cache_state() const;
     void verify_state() const;
 
@@ -98,14 +155,34 @@ private:
     
     // Main memory simulation
     std::unordered_map<uint32_t, uint32_t> main_memory_;
+    std::shared_ptr<const MemoryImage> image_;
+    uint32_t read_backing(uint32_t address) const;
     
-    // Statistics
-    CacheStats stats_;
+    // Statistics (slots in the registry)
+    struct CacheCounters {
+        Counter reads;
+        Counter writes;
+        Counter hits;
+        Counter misses;
+        Counter evictions;
+        Counter bank_conflicts;
+        Histogram latency;
+    };
+    std::unique_ptr<StatsRegistry> owned_registry_;
+    StatsRegistry* registry_;
+    std::string stats_prefix_;
+    CacheCounters stats_;
+    void register_statistics();
+    std::vector<AccessObserver*> observers_;
     uint64_t current_cycle_;
 
     // Internal methods
+    void build_sets(uint32_t cache_size);
+    MemoryResult access_line(uint32_t address, uint32_t data, bool is_write, bool timed,
+                             bool coherent = true);
     uint32_t get_set_index(uint32_t address) const;
     uint32_t get_tag(uint32_t address) const;
+    uint32_t line_address(uint32_t tag, uint32_t set_index) const;
     uint32_t get_offset(uint32_t address) const;
     uint32_t get_bank_index(uint32_t address) const;
     
@@ -0,0 +1,344 @@
+// metrics_server.cpp
+// Implementation of the live metrics snapshot and its HTTP endpoint
+
+#include "metrics_server.h"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define GPUSIM_HAVE_SOCKETS 1
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace gpu_simulator {
+
+namespace {
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+LiveMetrics::LiveMetrics() : sequence_(0) {
+    for (auto& field : fields_) {
+        field.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LiveMetrics::publish(const LiveSnapshot& snapshot) {
+    uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const uint64_t values[NUM_FIELDS] = {
+        snapshot.cycles, snapshot.instructions, snapshot.memory_requests,
+        snapshot.cache_hits, snapshot.cache_misses, snapshot.events,
+        snapshot.queue_depth, snapshot.published_ns, snapshot.running
+    };
+    for (size_t i = 0; i < NUM_FIELDS; ++i) {
+        fields_[i].store(values[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+LiveSnapshot LiveMetrics::read() const {
+    uint64_t values[NUM_FIELDS];
+    while (true) {
+        uint64_t before = sequence_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < NUM_FIELDS; ++i) {
+            values[i] = fields_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = sequence_.load(std::memory_order_relaxed);
+        if (before == after && (before & 1) == 0) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    return LiveSnapshot{values[0], values[1], values[2], values[3], values[4],
+                        values[5], values[6], values[7], values[8] != 0};
+}
+
+MetricsServer::MetricsServer()
+    : stop_(false)
+    , listen_fd_(-1)
+    , port_(0) {
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+void MetricsServer::add_source(const std::string& label, const LiveMetrics* metrics) {
+    if (running()) {
+        throw std::runtime_error("Metrics sources must be added before the server starts");
+    }
+    if (!metrics) {
+        throw std::invalid_argument("Metrics source cannot be null");
+    }
+    auto source = std::make_unique<Source>();
+    source->label = label;
+    source->metrics = metrics;
+    source->last = LiveSnapshot{};
+    source->last_ns = 0;
+    source->events_per_second.store(0.0);
+    source->cycles_per_second.store(0.0);
+    source->instructions_per_second.store(0.0);
+    sources_.push_back(std::move(source));
+}
+
+#ifdef GPUSIM_HAVE_SOCKETS
+
+void MetricsServer::start_tcp(uint16_t port) {
+    if (running()) {
+        throw std::runtime_error("Metrics server is already running");
+    }
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Could not create metrics socket");
+    }
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Loopback only: the endpoint has no authentication
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not bind metrics port " + std::to_string(port));
+    }
+    socklen_t length = sizeof(address);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+    start(fd);
+}
+
+void MetricsServer::start_unix(const std::string& path) {
+    if (running()) {
+        throw std::runtime_error("Metrics server is already running");
+    }
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid metrics socket path: " + path);
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Could not create metrics socket");
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not bind metrics socket " + path);
+    }
+    unix_path_ = path;
+    start(fd);
+}
+
+void MetricsServer::start(int fd) {
+    if (::listen(fd, 8) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not listen on metrics socket");
+    }
+    listen_fd_ = fd;
+    stop_.store(false);
+    thread_ = std::thread([this] { serve(); });
+}
+
+void MetricsServer::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    stop_.store(true);
+    thread_.join();
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    if (!unix_path_.empty()) {
+        ::unlink(unix_path_.c_str());
+        unix_path_.clear();
+    }
+}
+
+void MetricsServer::serve() {
+    uint64_t next_sample = 0;
+    while (!stop_.load()) {
+        uint64_t now = steady_ns();
+        if (now >= next_sample) {
+            sample_rates();
+            next_sample = now + RATE_WINDOW_NS;
+        }
+
+        pollfd listener{listen_fd_, POLLIN, 0};
+        if (::poll(&listener, 1, POLL_TIMEOUT_MS) <= 0 || !(listener.revents & POLLIN)) {
+            continue;
+        }
+        int client = ::accept(listen_fd_, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        answer(client);
+        ::close(client);
+    }
+}
+
+void MetricsServer::answer(int client) const {
+    // Read the request head (its content does not matter: every path gets
+    // the metrics). One deadline covers the whole head, so a silent or
+    // trickling client holds the server thread for READ_TIMEOUT_MS at most.
+    uint64_t deadline = steady_ns() + READ_TIMEOUT_MS * 1000000ULL;
+    std::string request;
+    char chunk[1024];
+    while (request.size() < 8192 && request.find("\r\n\r\n") == std::string::npos) {
+        uint64_t now = steady_ns();
+        if (now >= deadline) {
+            break;
+        }
+        pollfd readable{client, POLLIN, 0};
+        int wait_ms = static_cast<int>((deadline - now + 999999) / 1000000);
+        if (::poll(&readable, 1, wait_ms) <= 0) {
+            break;
+        }
+        ssize_t n = ::recv(client, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        request.append(chunk, static_cast<size_t>(n));
+    }
+
+    std::string body = render();
+    std::string response = "HTTP/1.0 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+    const char* data = response.data();
+    size_t remaining = response.size();
+    while (remaining > 0) {
+        ssize_t n = ::send(client, data, remaining, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        data += n;
+        remaining -= static_cast<size_t>(n);
+    }
+}
+
+#else
+
+void MetricsServer::start_tcp(uint16_t) {
+    throw std::runtime_error("Metrics server needs POSIX sockets");
+}
+
+void MetricsServer::start_unix(const std::string&) {
+    throw std::runtime_error("Metrics server needs POSIX sockets");
+}
+
+void MetricsServer::start(int) {
+}
+
+void MetricsServer::stop() {
+}
+
+void MetricsServer::serve() {
+}
+
+void MetricsServer::answer(int) const {
+}
+
+#endif
+
+void MetricsServer::sample_rates() {
+    uint64_t now = steady_ns();
+    for (auto& source : sources_) {
+        LiveSnapshot current = source->metrics->read();
+        if (source->last_ns != 0 && now > source->last_ns) {
+            double seconds = static_cast<double>(now - source->last_ns) / 1e9;
+            auto rate = [&](uint64_t value, uint64_t previous) {
+                return static_cast<double>(value - previous) / seconds;
+            };
+            source->events_per_second.store(rate(current.events, source->last.events));
+            source->cycles_per_second.store(rate(current.cycles, source->last.cycles));
+            source->instructions_per_second.store(
+                rate(current.instructions, source->last.instructions));
+        }
+        source->last = current;
+        source->last_ns = now;
+    }
+}
+
+std::string MetricsServer::render() const {
+    std::vector<LiveSnapshot> snapshots;
+    snapshots.reserve(sources_.size());
+    for (const auto& source : sources_) {
+        snapshots.push_back(source->metrics->read());
+    }
+    uint64_t now = steady_ns();
+
+    std::ostringstream out;
+    out << std::setprecision(6);
+    auto metric = [&](const char* name, const char* type, const char* help, auto value) {
+        out << "# HELP " << name << " " << help << "\n"
+            << "# TYPE " << name << " " << type << "\n";
+        for (size_t i = 0; i < sources_.size(); ++i) {
+            out << name << "{sim=\"" << sources_[i]->label << "\"} "
+                << value(*sources_[i], snapshots[i]) << "\n";
+        }
+    };
+
+    metric("gpusim_cycles", "counter", "Simulated cycles",
+           [](const Source&, const LiveSnapshot& s) { return s.cycles; });
+    metric("gpusim_instructions_total", "counter", "Warp instructions executed",
+           [](const Source&, const LiveSnapshot& s) { return s.instructions; });
+    metric("gpusim_memory_requests_total", "counter", "Memory requests issued",
+           [](const Source&, const LiveSnapshot& s) { return s.memory_requests; });
+    metric("gpusim_cache_hits_total", "counter", "Cache hits",
+           [](const Source&, const LiveSnapshot& s) { return s.cache_hits; });
+    metric("gpusim_cache_misses_total", "counter", "Cache misses",
+           [](const Source&, const LiveSnapshot& s) { return s.cache_misses; });
+    metric("gpusim_events_total", "counter", "Simulation events processed",
+           [](const Source&, const LiveSnapshot& s) { return s.events; });
+    metric("gpusim_ipc", "gauge", "Instructions per cycle",
+           [](const Source&, const LiveSnapshot& s) {
+               return s.cycles ? static_cast<double>(s.instructions) / s.cycles : 0.0;
+           });
+    metric("gpusim_cache_hit_rate", "gauge", "Cache hit rate",
+           [](const Source&, const LiveSnapshot& s) {
+               uint64_t total = s.cache_hits + s.cache_misses;
+               return total ? static_cast<double>(s.cache_hits) / total : 0.0;
+           });
+    metric("gpusim_event_queue_depth", "gauge", "Pending simulation events",
+           [](const Source&, const LiveSnapshot& s) { return s.queue_depth; });
+    metric("gpusim_events_per_second", "gauge", "Events processed per host second",
+           [](const Source& src, const LiveSnapshot&) { return src.events_per_second.load(); });
+    metric("gpusim_cycles_per_second", "gauge", "Simulated cycles per host second",
+           [](const Source& src, const LiveSnapshot&) { return src.cycles_per_second.load(); });
+    metric("gpusim_instructions_per_second", "gauge", "Instructions per host second",
+           [](const Source& src, const LiveSnapshot&) {
+               return src.instructions_per_second.load();
+           });
+    metric("gpusim_running", "gauge", "Whether the engine is inside a run",
+           [](const Source&, const LiveSnapshot& s) { return s.running ? 1 : 0; });
+    metric("gpusim_seconds_since_update", "gauge", "Host seconds since the last publish",
+           [now](const Source&, const LiveSnapshot& s) {
+               return s.published_ns && now > s.published_ns
+                   ? static_cast<double>(now - s.published_ns) / 1e9 : 0.0;
+           });
+    return out.str();
+}
+
+} // namespace gpu_simulator
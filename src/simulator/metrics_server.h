@@ -0,0 +1,104 @@
+// metrics_server.h
+// Live Prometheus metrics for long-running simulations
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gpu_simulator {
+
+// Values one engine publishes while it runs
+struct LiveSnapshot {
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t memory_requests;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t events;            // Events processed since the metrics were attached
+    uint64_t queue_depth;       // Pending events
+    uint64_t published_ns;      // steady_clock time of this snapshot
+    bool     running;
+};
+
+// Single-writer snapshot behind a sequence lock: the simulation thread
+// publishes with plain stores and never waits; readers retry while a
+// publish is in progress, so they always see one consistent snapshot.
+class LiveMetrics {
+public:
+    LiveMetrics();
+
+    // Delete copy constructor and assignment
+    LiveMetrics(const LiveMetrics&) = delete;
+    LiveMetrics& operator=(const LiveMetrics&) = delete;
+
+    void publish(const LiveSnapshot& snapshot);
+    LiveSnapshot read() const;
+
+private:
+    static constexpr size_t NUM_FIELDS = 9;
+    std::atomic<uint64_t> sequence_;
+    std::atomic<uint64_t> fields_[NUM_FIELDS];
+};
+
+// Background thread answering every HTTP request on a localhost TCP port
+// or a Unix domain socket with the Prometheus text format, one labelled
+// series per source. Throughput gauges are measured by the server itself
+// about once a second; gpusim_seconds_since_update shows a stalled run.
+class MetricsServer {
+public:
+    // Constructor and destructor
+    MetricsServer();
+    ~MetricsServer();
+
+    // Delete copy constructor and assignment
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // Sources must be added before start and outlive the server
+    void add_source(const std::string& label, const LiveMetrics* metrics);
+
+    // Port 0 picks a free port; see port()
+    void start_tcp(uint16_t port);
+    void start_unix(const std::string& path);
+    void stop();
+    bool running() const { return thread_.joinable(); }
+    uint16_t port() const { return port_; }
+
+    // Current exposition text (what a scrape returns)
+    std::string render() const;
+
+private:
+    struct Source {
+        std::string label;
+        const LiveMetrics* metrics;
+        // Throughput sampling, owned by the server thread
+        LiveSnapshot last;
+        uint64_t last_ns;
+        std::atomic<double> events_per_second;
+        std::atomic<double> cycles_per_second;
+        std::atomic<double> instructions_per_second;
+    };
+
+    void start(int fd);
+    void serve();
+    void sample_rates();
+    void answer(int client) const;
+
+    std::vector<std::unique_ptr<Source>> sources_;
+    std::thread thread_;
+    std::atomic<bool> stop_;
+    int listen_fd_;
+    uint16_t port_;
+    std::string unix_path_;
+
+    static constexpr int POLL_TIMEOUT_MS = 200;
+    static constexpr uint64_t READ_TIMEOUT_MS = 1000;    // Whole request head
+    static constexpr uint64_t RATE_WINDOW_NS = 1000000000ULL;
+};
+
+} // namespace gpu_simulator
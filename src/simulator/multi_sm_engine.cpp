@@ -0,0 +1,580 @@
+// multi_sm_engine.cpp
+// Implementation of multi-SM simulation engine
+
+#include "multi_sm_engine.h"
+#include "cta_dispatcher.h"
+#include "thread_pool.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cassert>
+
+namespace gpu_simulator {
+
+namespace {
+constexpr SimTime NO_EVENT = std::numeric_limits<SimTime>::max();
+constexpr uint32_t HEADER_BYTES = 8;      // Address and control of one packet
+}
+
+MultiSMEngine::MultiSMEngine(const MultiSMConfig& config)
+    : config_(config)
+    , stats_{}
+    , current_time_(0)
+    , dispatcher_(nullptr)
+    , pool_(std::make_unique<utils::ThreadPool>(config.num_threads)) {
+    assert(config_.num_sms > 0 && "At least one SM is required");
+
+    if (config_.num_l2_partitions == 0) {
+        config_.num_l2_partitions = 1;
+    }
+    if (config_.l2_hash_mask != 0 &&
+        (config_.num_l2_partitions & (config_.num_l2_partitions - 1)) != 0) {
+        throw std::invalid_argument("Hashed L2 slicing requires a power-of-two partition count");
+    }
+    if (config_.sync_mode == SyncMode::CONSERVATIVE &&
+        config_.noc.topology == NocTopology::IDEAL && config_.interconnect_latency == 0) {
+        // SM -> L2 messages are the lookahead of an SM process
+        throw std::invalid_argument("Conservative sync requires a non-zero interconnect latency");
+    }
+
+    // Each SM owns its warp state and L1; misses are forwarded to the L2
+    sms_.reserve(config_.num_sms);
+    for (uint32_t i = 0; i < config_.num_sms; ++i) {
+        sms_.push_back(std::make_unique<SimulationEngine>(config_.sm_config));
+        sms_.back()->set_remote_misses(true);
+    }
+    sm_active_.assign(config_.num_sms, false);
+    sm_sequence_.assign(config_.num_sms, 0);
+
+    // Each partition is an independent slice of the L2 capacity
+    partitions_.resize(config_.num_l2_partitions);
+    for (auto& partition : partitions_) {
+        partition.cache = std::make_unique<MemoryModel>(
+            config_.l2_size / config_.num_l2_partitions,
+            config_.l2_line_size,
+            config_.sm_config.memory_latency);
+    }
+
+    // A modelled network replaces the fixed latency in both directions
+    if (config_.noc.topology != NocTopology::IDEAL) {
+        request_network_ = std::make_unique<Interconnect>(
+            config_.noc, config_.num_sms, config_.num_l2_partitions, false);
+        reply_network_ = std::make_unique<Interconnect>(
+            config_.noc, config_.num_sms, config_.num_l2_partitions, true);
+        if (HEADER_BYTES + config_.sm_config.cache_line_size > reply_network_->max_packet_bytes()) {
+            throw std::invalid_argument("A reply carrying one L1 line must fit a VC buffer");
+        }
+    }
+
+    if (config_.quantum == 0) {
+        config_.quantum = request_network_
+            ? config_.noc.link_latency
+            : exact_quantum(config_.interconnect_latency);
+    }
+}
+
+MultiSMEngine::~MultiSMEngine() {
+    for (auto& partition : partitions_) {
+        while (!partition.inbox.empty()) {
+            delete partition.inbox.top().trans;
+            partition.inbox.pop();
+        }
+        for (auto& reply : partition.replies) {
+            delete reply.trans;
+        }
+    }
+}
+
+void MultiSMEngine::set_determinism_check(bool enabled) {
+    for (auto& engine : sms_) {
+        engine->set_determinism_check(enabled);
+    }
+}
+
+void MultiSMEngine::set_dispatcher(CtaDispatcher* dispatcher) {
+    if (dispatcher_) {
+        dispatcher_->set_deferred(false);
+    }
+    dispatcher_ = dispatcher;
+    if (dispatcher_) {
+        dispatcher_->set_deferred(true);
+    }
+}
+
+SimTime MultiSMEngine::exact_quantum(uint32_t interconnect_latency) {
+    // An L1 miss issued at cycle t cannot return before t + 2 hops + an L2
+    // hit, so quanta no longer than that never clamp a reply.
+    return 2 * static_cast<SimTime>(interconnect_latency) + 1;
+}
+
+void MultiSMEngine::initialize() {
+    current_time_ = 0;
+    stats_ = MultiSMStats{};
+
+    for (auto& partition : partitions_) {
+        partition.cache->initialize();
+        partition.requests = 0;
+        partition.hits = 0;
+        partition.misses = 0;
+        partition.late_responses = 0;
+    }
+    if (request_network_) {
+        request_network_->reset();
+        reply_network_->reset();
+    }
+
+    for (uint32_t i = 0; i < config_.num_sms; ++i) {
+        sms_[i]->initialize();
+        sm_active_[i] = true;
+        sm_sequence_[i] = 0;
+    }
+}
+
+void MultiSMEngine::run() {
+    if (config_.sync_mode == SyncMode::CONSERVATIVE) {
+        run_conservative();
+    } else {
+        run_quantum();
+    }
+
+    calculate_performance_metrics();
+}
+
+void MultiSMEngine::run_quantum() {
+    // With a network, quanta no longer than one link are fixed PDES
+    // windows: a packet leaves its last link at least a link latency before
+    // it is delivered, so at each boundary the networks have already handed
+    // over everything due in the next quantum, and nothing sent in a
+    // quantum arrives within it. Partitions and networks then stop at the
+    // boundary. Longer quanta run the networks one quantum ahead instead.
+    const bool windowed = request_network_ && config_.quantum <= config_.noc.link_latency;
+
+    while (any_sm_active() || !partitions_idle() || !networks_idle()) {
+        // Skip quanta in which no SM has anything to do
+        SimTime next = next_activity_time();
+        if (next >= current_time_ + config_.quantum) {
+            current_time_ = next - (next - current_time_) % config_.quantum;
+        }
+
+        SimTime end_time = current_time_ + config_.quantum;
+
+        // SMs only interact through the L2, so a quantum runs them independently
+        pool_->parallel_for(sms_.size(), [&](size_t i) { step_sm(i, end_time); });
+        refill_blocks(end_time);
+
+        // Service every request issued this quantum (windowed: every one
+        // due before the boundary); partitions are disjoint. Otherwise
+        // networks run one quantum ahead, far enough to deliver every reply
+        // the next quantum needs; traffic injected later may queue behind
+        // packets that were scheduled within that quantum.
+        SimTime network_end = windowed ? end_time : end_time + config_.quantum;
+        collect_l2_requests(network_end);
+        pool_->parallel_for(partitions_.size(), [&](size_t p) {
+            process_partition(partitions_[p], windowed ? end_time : NO_EVENT, end_time);
+        });
+        deliver_replies(network_end, end_time);
+
+        current_time_ = end_time;
+        stats_.quanta++;
+    }
+}
+
+void MultiSMEngine::run_conservative() {
+    // Every SM and L2 partition is a logical process with its own queue.
+    // A window ends at the earliest cycle any process could send a message,
+    // so no message can land inside the window that produced it and each
+    // process may run the whole window without hearing from the others.
+    // Modelled networks run after the window, when all of its traffic is
+    // known; their minimum latency is the lookahead of what they deliver.
+    const size_t num_processes = sms_.size() + partitions_.size();
+
+    while (any_sm_active() || !partitions_idle() || !networks_idle()) {
+        SimTime end_time = next_window_end();
+        if (end_time == NO_EVENT) {
+            break;
+        }
+
+        pool_->parallel_for(num_processes, [&](size_t i) {
+            if (i < sms_.size()) {
+                step_sm(i, end_time);
+            } else {
+                process_partition(partitions_[i - sms_.size()], end_time, end_time);
+            }
+        });
+        refill_blocks(end_time);
+
+        // Exchange messages in a fixed order so results match any thread count
+        collect_l2_requests(end_time);
+        deliver_replies(end_time, end_time);
+
+        current_time_ = end_time;
+        stats_.quanta++;
+    }
+}
+
+SimTime MultiSMEngine::next_window_end() const {
+    SimTime end_time = NO_EVENT;
+
+    // An SM's earliest output is an L1 miss crossing the interconnect
+    for (uint32_t i = 0; i < sms_.size(); ++i) {
+        if (sm_active_[i] && sms_[i]->has_pending_events()) {
+            end_time = std::min(end_time, sms_[i]->next_event_time() + request_lookahead());
+        }
+    }
+
+    // A partition's earliest output is a reply after at least an L2 hit
+    for (const auto& partition : partitions_) {
+        if (!partition.inbox.empty()) {
+            SimTime lookahead = partition.cache->min_access_latency() + reply_lookahead();
+            end_time = std::min(end_time, partition.inbox.top().time + lookahead);
+        }
+    }
+
+    // Packets already inside a network
+    if (request_network_) {
+        end_time = std::min({end_time, request_network_->next_output_time(),
+                             reply_network_->next_output_time()});
+    }
+
+    return end_time;
+}
+
+bool MultiSMEngine::partitions_idle() const {
+    return std::all_of(partitions_.begin(), partitions_.end(),
+                       [](const L2Partition& p) { return p.inbox.empty(); });
+}
+
+bool MultiSMEngine::networks_idle() const {
+    return !request_network_ || (request_network_->idle() && reply_network_->idle());
+}
+
+void MultiSMEngine::step_sm(size_t sm_id, SimTime end_time) {
+    if (!sm_active_[sm_id]) {
+        return;
+    }
+
+    SimulationEngine& engine = *sms_[sm_id];
+    bool running = engine.run_until(end_time);
+    if (engine.paused()) {
+        return;                           // Waits for refill_blocks()
+    }
+    if (!running || (!engine.has_pending_events() &&
+                     engine.outstanding_remote_reads() == 0)) {
+        sm_active_[sm_id] = false;
+    }
+}
+
+void MultiSMEngine::collect_l2_requests(SimTime end_time) {
+    // Route misses to their partitions; the (arrival, SM, sequence) key
+    // orders each partition independently of host thread scheduling
+    for (uint32_t sm_id = 0; sm_id < sms_.size(); ++sm_id) {
+        auto& requests = sms_[sm_id]->remote_requests();
+        for (const auto& request : requests) {
+            uint32_t address = request.trans->address;
+            if (request_network_) {
+                uint32_t bytes = HEADER_BYTES + (request.trans->is_write ? request.trans->size : 0);
+                request_network_->inject({request.time, sm_id, partition_index(address),
+                                          bytes, request.trans});
+                continue;
+            }
+            partitions_[partition_index(address)].inbox.push(L2Request{
+                request.time + config_.interconnect_latency,
+                sm_id,
+                sm_sequence_[sm_id]++,
+                partition_local_address(address),
+                request.trans
+            });
+        }
+        requests.clear();
+    }
+
+    if (request_network_) {
+        request_network_->advance(end_time);
+        for (const auto& message : request_network_->delivered()) {
+            partitions_[message.destination].inbox.push(L2Request{
+                message.time,
+                message.source,
+                sm_sequence_[message.source]++,
+                partition_local_address(message.trans->address),
+                message.trans
+            });
+        }
+        request_network_->delivered().clear();
+    }
+}
+
+void MultiSMEngine::process_partition(L2Partition& partition, SimTime end_time,
+                                      SimTime clamp_time) {
+    while (!partition.inbox.empty() && partition.inbox.top().time < end_time) {
+        L2Request request = partition.inbox.top();
+        partition.inbox.pop();
+
+        MemoryTransaction* trans = request.trans;
+        MemoryResult result = partition.cache->access(request.local_address,
+                                                      trans->data,
+                                                      trans->is_write);
+        partition.requests++;
+        if (result.hit) {
+            partition.hits++;
+        } else {
+            partition.misses++;
+            trans->level = MemoryLevel::DRAM;
+        }
+
+        if (trans->is_write) {
+            delete trans;
+            continue;
+        }
+
+        SimTime ready = request.time + result.latency;
+        if (reply_network_) {
+            // Clamped, if at all, when the network delivers it
+            partition.replies.push_back({ready, request.sm_id, trans});
+            continue;
+        }
+        SimTime arrival = ready + config_.interconnect_latency;
+        if (arrival < clamp_time) {
+            // The SM has already simulated past this cycle
+            arrival = clamp_time;
+            partition.late_responses++;
+        }
+        partition.replies.push_back({arrival, request.sm_id, trans});
+    }
+}
+
+void MultiSMEngine::deliver_replies(SimTime end_time, SimTime clamp_time) {
+    auto deliver = [&](uint32_t sm_id, SimTime time, MemoryTransaction* trans) {
+        sms_[sm_id]->deliver_response(time, trans);
+        if (!sm_active_[sm_id] && sms_[sm_id]->is_running()) {
+            sm_active_[sm_id] = true;
+        }
+    };
+
+    uint32_t reply_bytes = HEADER_BYTES + config_.sm_config.cache_line_size;
+    for (uint32_t p = 0; p < partitions_.size(); ++p) {
+        for (const auto& reply : partitions_[p].replies) {
+            if (reply_network_) {
+                reply_network_->inject({reply.time, p, reply.sm_id, reply_bytes, reply.trans});
+            } else {
+                deliver(reply.sm_id, reply.time, reply.trans);
+            }
+        }
+        partitions_[p].replies.clear();
+    }
+
+    if (reply_network_) {
+        reply_network_->advance(end_time);
+        for (const auto& message : reply_network_->delivered()) {
+            SimTime arrival = message.time;
+            if (arrival < clamp_time) {
+                arrival = clamp_time;
+                partitions_[message.source].late_responses++;
+            }
+            deliver(message.destination, arrival, message.trans);
+        }
+        reply_network_->delivered().clear();
+    }
+}
+
+uint32_t MultiSMEngine::partition_index(uint32_t address) const {
+    uint32_t line = address / config_.l2_line_size;
+    uint32_t slices = config_.num_l2_partitions;
+    if (config_.l2_hash_mask == 0 || slices == 1) {
+        return line % slices;
+    }
+
+    // Fold the selected upper bits onto the slice bits, so strides that
+    // are multiples of the slice count still spread over every slice. The
+    // slice bits enter once, so for fixed upper bits each slice holds one
+    // line and line / slices stays a unique local address.
+    uint32_t bits = static_cast<uint32_t>(__builtin_ctz(slices));
+    uint32_t index = line & (slices - 1);
+    for (uint32_t upper = (line >> bits) & config_.l2_hash_mask; upper; upper >>= bits) {
+        index ^= upper & (slices - 1);
+    }
+    return index;
+}
+
+uint32_t MultiSMEngine::partition_local_address(uint32_t address) const {
+    // Drop the partition-select bits so each slice indexes all of its sets
+    uint32_t line = address / config_.l2_line_size;
+    uint32_t offset = address % config_.l2_line_size;
+    return (line / config_.num_l2_partitions) * config_.l2_line_size + offset;
+}
+
+SimTime MultiSMEngine::request_lookahead() const {
+    return request_network_ ? request_network_->min_latency() : config_.interconnect_latency;
+}
+
+SimTime MultiSMEngine::reply_lookahead() const {
+    return reply_network_ ? reply_network_->min_latency() : config_.interconnect_latency;
+}
+
+bool MultiSMEngine::any_sm_active() const {
+    return std::any_of(sm_active_.begin(), sm_active_.end(),
+                       [](uint8_t active) { return active != 0; });
+}
+
+void MultiSMEngine::refill_blocks(SimTime end_time) {
+    if (!dispatcher_) {
+        return;
+    }
+    // Serial, earliest retirement first (ties by SM), as a sequential run
+    // would refill; a refilled SM runs on and may retire and pause again
+    while (true) {
+        uint32_t next = num_sms();
+        for (uint32_t i = 0; i < sms_.size(); ++i) {
+            if (sm_active_[i] && sms_[i]->paused() &&
+                (next == num_sms() ||
+                 sms_[i]->get_current_time() < sms_[next]->get_current_time())) {
+                next = i;
+            }
+        }
+        if (next == num_sms()) {
+            return;
+        }
+        dispatcher_->refill(next, sms_[next]->get_current_time());
+        step_sm(next, end_time);
+    }
+}
+
+SimTime MultiSMEngine::next_activity_time() const {
+    SimTime next = SimulationEngine::MAX_SIMULATION_CYCLES;
+    for (uint32_t i = 0; i < sms_.size(); ++i) {
+        if (sm_active_[i] && sms_[i]->has_pending_events()) {
+            next = std::min(next, sms_[i]->next_event_time());
+        }
+    }
+    for (const auto& partition : partitions_) {
+        if (!partition.inbox.empty()) {
+            next = std::min(next, partition.inbox.top().time);
+        }
+    }
+    if (request_network_) {
+        next = std::min({next, request_network_->next_event_time(),
+                         reply_network_->next_event_time()});
+    }
+    return std::max(next, current_time_);
+}
+
+void MultiSMEngine::calculate_performance_metrics() {
+    stats_.total = SimStats{};
+    stats_.per_sm.clear();
+
+    for (auto& engine : sms_) {
+        engine->stop();
+        SimStats sm_stats = engine->get_statistics();
+        stats_.per_sm.push_back(sm_stats);
+
+        stats_.total.instructions_executed += sm_stats.instructions_executed;
+        stats_.total.memory_requests += sm_stats.memory_requests;
+        stats_.total.cache_hits += sm_stats.cache_hits;
+        stats_.total.cache_misses += sm_stats.cache_misses;
+        stats_.total.total_cycles = std::max(stats_.total.total_cycles,
+                                             sm_stats.total_cycles);
+    }
+
+    stats_.total.ipc = static_cast<double>(stats_.total.instructions_executed) /
+                       static_cast<double>(stats_.total.total_cycles);
+    stats_.total.cache_hit_rate = static_cast<double>(stats_.total.cache_hits) /
+                                  static_cast<double>(stats_.total.cache_hits +
+                                                      stats_.total.cache_misses);
+
+    stats_.l2_requests = 0;
+    stats_.l2_hits = 0;
+    stats_.l2_misses = 0;
+    stats_.late_responses = 0;
+    stats_.per_partition_requests.clear();
+    stats_.per_partition_hits.clear();
+    uint64_t busiest = 0;
+    for (const auto& partition : partitions_) {
+        stats_.l2_requests += partition.requests;
+        stats_.l2_hits += partition.hits;
+        stats_.l2_misses += partition.misses;
+        stats_.late_responses += partition.late_responses;
+        stats_.per_partition_requests.push_back(partition.requests);
+        stats_.per_partition_hits.push_back(partition.hits);
+        busiest = std::max(busiest, partition.requests);
+    }
+    stats_.partition_imbalance = stats_.l2_requests
+        ? static_cast<double>(busiest) * partitions_.size() / static_cast<double>(stats_.l2_requests)
+        : 1.0;
+
+    if (request_network_) {
+        stats_.request_network = request_network_->get_statistics();
+        stats_.reply_network = reply_network_->get_statistics();
+    }
+}
+
+MultiSMStats MultiSMEngine::get_statistics() const {
+    return stats_;
+}
+
+void MultiSMEngine::print_statistics() const {
+    double l2_hit_rate = static_cast<double>(stats_.l2_hits) /
+                         static_cast<double>(stats_.l2_requests);
+
+    std::cout << "\nMulti-SM Simulation Statistics:\n"
+              << "===============================\n"
+              << "SMs: " << config_.num_sms
+              << " (host threads: " << pool_->size() << ")\n";
+    if (config_.sync_mode == SyncMode::CONSERVATIVE) {
+        std::cout << "Sync: conservative PDES (" << stats_.quanta << " windows)\n";
+    } else {
+        std::cout << "Sync: quantum " << config_.quantum << " cycles ("
+                  << stats_.quanta << " executed)\n";
+    }
+    std::cout << "Total Cycles: " << stats_.total.total_cycles << "\n"
+              << "Instructions Executed: " << stats_.total.instructions_executed << "\n"
+              << "IPC: " << std::fixed << std::setprecision(2) << stats_.total.ipc << "\n"
+              << "Memory Requests: " << stats_.total.memory_requests << "\n"
+              << "L1 Hit Rate: " << std::fixed << std::setprecision(2)
+              << (stats_.total.cache_hit_rate * 100.0) << "%\n"
+              << "L2 Requests: " << stats_.l2_requests
+              << " (" << config_.num_l2_partitions << " partitions)\n"
+              << "L2 Hit Rate: " << std::fixed << std::setprecision(2)
+              << (l2_hit_rate * 100.0) << "%\n"
+              << "L2 Slice Imbalance: " << std::fixed << std::setprecision(2)
+              << stats_.partition_imbalance << "x mean"
+              << (config_.l2_hash_mask ? " (XOR-hashed)" : " (interleaved)") << "\n"
+              << "Late L2 Responses: " << stats_.late_responses << "\n";
+
+    for (uint32_t i = 0; i < stats_.per_sm.size(); ++i) {
+        const SimStats& sm_stats = stats_.per_sm[i];
+        std::cout << "  SM " << i << ": instructions " << sm_stats.instructions_executed
+                  << ", memory requests " << sm_stats.memory_requests
+                  << ", IPC " << std::fixed << std::setprecision(2) << sm_stats.ipc << "\n";
+    }
+
+    for (uint32_t p = 0; p < stats_.per_partition_requests.size(); ++p) {
+        uint64_t requests = stats_.per_partition_requests[p];
+        std::cout << "  L2 slice " << p << ": requests " << requests
+                  << ", hit rate " << std::fixed << std::setprecision(2)
+                  << (requests ? stats_.per_partition_hits[p] * 100.0 / requests : 0.0) << "%\n";
+    }
+
+    if (request_network_) {
+        std::string topology = config_.noc.topology == NocTopology::MESH ? "mesh" : "crossbar";
+        request_network_->print_statistics(std::cout, "Request Network (" + topology + ")",
+                                           stats_.total.total_cycles);
+        reply_network_->print_statistics(std::cout, "Reply Network (" + topology + ")",
+                                         stats_.total.total_cycles);
+    }
+}
+
+uint32_t MultiSMEngine::num_sms() const {
+    return static_cast<uint32_t>(sms_.size());
+}
+
+SimulationEngine& MultiSMEngine::sm(uint32_t sm_id) {
+    assert(sm_id < sms_.size() && "Invalid SM index");
+    return *sms_[sm_id];
+}
+
+const MultiSMConfig& MultiSMEngine::get_config() const {
+    return config_;
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,183 @@
+// multi_sm_engine.h
+// Multi-SM GPU simulation with a shared L2 and parallel synchronization
+
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <memory>
+#include <cstdint>
+#include "sim_engine.h"
+#include "memory_model.h"
+#include "interconnect.h"
+
+namespace gpu_simulator {
+
+// Forward declarations
+namespace utils {
+class ThreadPool;
+}
+class CtaDispatcher;
+
+// How SMs and L2 partitions are kept in step
+enum class SyncMode {
+    QUANTUM,        // Fixed quanta; L2 serviced at each boundary
+    CONSERVATIVE    // PDES windows bounded by per-process lookahead
+};
+
+// Multi-SM configuration
+struct MultiSMConfig {
+    SimConfig sm_config;              // Per-SM warps and L1 configuration
+    uint32_t  num_sms;                // Number of streaming multiprocessors
+    uint32_t  num_threads;            // Host worker threads (0 = all cores)
+    SyncMode  sync_mode;              // Synchronization scheme
+    SimTime   quantum;                // QUANTUM mode: cycles per step (0 = exact).
+                                      // With a network, quanta longer than one
+                                      // link latency approximate contention.
+    uint32_t  l2_size;                // Shared L2 size in bytes (all partitions)
+    uint32_t  l2_line_size;           // Shared L2 line size in bytes
+    uint32_t  num_l2_partitions;      // Address-sliced L2 partitions (0 = 1)
+    uint32_t  l2_hash_mask;           // Line bits above the slice bits XORed into
+                                      // the slice index (0 = plain interleave)
+    uint32_t  interconnect_latency;   // One-way SM <-> L2 latency in cycles (IDEAL)
+    InterconnectConfig noc;           // Modelled network (IDEAL = fixed latency)
+};
+
+// Aggregate statistics across SMs
+struct MultiSMStats {
+    SimStats              total;          // Summed over all SMs
+    std::vector<SimStats> per_sm;
+    uint64_t              l2_requests;
+    uint64_t              l2_hits;
+    uint64_t              l2_misses;
+    std::vector<uint64_t> per_partition_requests;
+    std::vector<uint64_t> per_partition_hits;
+    double                partition_imbalance;  // Busiest slice over the mean (1 = even)
+    uint64_t              quanta;         // Quanta or PDES windows executed
+    uint64_t              late_responses; // Replies clamped to a quantum boundary
+    InterconnectStats     request_network;  // Empty for an IDEAL interconnect
+    InterconnectStats     reply_network;
+};
+
+// SMs run in parallel and meet at quantum or PDES window boundaries. The
+// shared L2 models timing only: every SM keeps its own functional memory,
+// so a store on one SM is never visible to loads on another, and kernels
+// whose blocks communicate through global memory are not supported.
+class MultiSMEngine {
+public:
+    // Constructor and destructor
+    explicit MultiSMEngine(const MultiSMConfig& config);
+    ~MultiSMEngine();
+
+    // Delete copy constructor and assignment
+    MultiSMEngine(const MultiSMEngine&) = delete;
+    MultiSMEngine& operator=(const MultiSMEngine&) = delete;
+
+    // Core simulation methods
+    void initialize();
+    void run();
+
+    // Record per-cycle event hashes on every SM
+    void set_determinism_check(bool enabled);
+
+    // Refill SMs from a block dispatcher (not owned; nullptr turns it off).
+    // SMs pause where a block retires and are refilled in retirement order.
+    void set_dispatcher(CtaDispatcher* dispatcher);
+
+    // Smallest quantum that never delays an L2 reply past its true arrival
+    static SimTime exact_quantum(uint32_t interconnect_latency);
+
+    // Statistics and reporting
+    MultiSMStats get_statistics() const;
+    void print_statistics() const;
+
+    // Accessors
+    uint32_t num_sms() const;
+    SimulationEngine& sm(uint32_t sm_id);
+    const MultiSMConfig& get_config() const;
+
+private:
+    // Pending L1 miss tagged with its source SM for deterministic ordering
+    struct L2Request {
+        SimTime            time;      // Arrival cycle at the L2 partition
+        uint32_t           sm_id;
+        uint64_t           sequence;
+        uint32_t           local_address;
+        MemoryTransaction* trans;
+
+        // Comparison operator for priority queue
+        bool operator>(const L2Request& other) const {
+            if (time != other.time) return time > other.time;
+            if (sm_id != other.sm_id) return sm_id > other.sm_id;
+            return sequence > other.sequence;
+        }
+    };
+
+    // L2 reply travelling back to an SM
+    struct L2Reply {
+        SimTime            time;
+        uint32_t           sm_id;
+        MemoryTransaction* trans;
+    };
+
+    // Memory partition: an L2 slice with its own event queue (one PDES
+    // logical process). Banks within a slice are not modelled: MemoryModel
+    // charges no bank conflicts, so a slice's only contention is its queue.
+    struct L2Partition {
+        std::unique_ptr<MemoryModel> cache;
+        std::priority_queue<L2Request, std::vector<L2Request>,
+                            std::greater<L2Request>> inbox;
+        std::vector<L2Reply> replies;
+        uint64_t requests;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t late_responses;
+    };
+
+    // Quantum scheme
+    void run_quantum();
+    void step_sm(size_t sm_id, SimTime end_time);
+    void collect_l2_requests(SimTime end_time);
+    void process_partition(L2Partition& partition, SimTime end_time,
+                           SimTime clamp_time);
+    void deliver_replies(SimTime end_time, SimTime clamp_time);
+
+    // Conservative PDES scheme
+    void run_conservative();
+    SimTime next_window_end() const;
+    bool partitions_idle() const;
+    bool networks_idle() const;
+
+    // Internal methods
+    uint32_t partition_index(uint32_t address) const;
+    uint32_t partition_local_address(uint32_t address) const;
+    SimTime request_lookahead() const;
+    SimTime reply_lookahead() const;
+    bool any_sm_active() const;
+    void refill_blocks(SimTime end_time);
+    SimTime next_activity_time() const;
+    void calculate_performance_metrics();
+
+    // Configuration and state
+    MultiSMConfig config_;
+    MultiSMStats stats_;
+    SimTime current_time_;
+
+    // Per-SM engines (own warp state and L1) and shared L2 partitions
+    std::vector<std::unique_ptr<SimulationEngine>> sms_;
+    std::vector<uint8_t> sm_active_;   // Not vector<bool>: written from worker threads
+    std::vector<uint64_t> sm_sequence_;
+    std::vector<L2Partition> partitions_;
+
+    // Modelled SM -> L2 and L2 -> SM networks (null for IDEAL)
+    std::unique_ptr<Interconnect> request_network_;
+    std::unique_ptr<Interconnect> reply_network_;
+
+    // Thread-block dispatch (not owned)
+    CtaDispatcher* dispatcher_;
+
+    // Host parallelism
+    std::unique_ptr<utils::ThreadPool> pool_;
+};
+
+} // namespace gpu_simulator
@@ -1,251 +1,529 @@
 // program_loader.cpp
 // Implementation of program loading mechanism for GPU simulator
 
+#include "program_loader.h"
+#include "memory_model.h"
+#include "utils.h"
 #include <fstream>
-#include <vector>
-#include <string>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
-#include <unordered_map>
-#include <cstdint>
 #include <stdexcept>
+#include <cctype>
 #include <algorithm>
-#include <memory>
+#include <cassert>
 
 namespace gpu_simulator {
 
-// Forward declaration
-class MemoryModel;
-
-/**
- * @brief Program Loader class to load and manage GPU programs
- */
-class ProgramLoader {
-public:
-    /**
-     * @brief Constructor
-     * @param memory Pointer to memory model to load program into
-     */
-    ProgramLoader(std::shared_ptr<MemoryModel> memory) 
-        : memory_model_(memory), program_counter_(0) {}
-
-    /**
-     * @brief Load binary program from file
-     * @param filename Path to binary program file
-     * @return Starting address of the loaded program
-     */
-    uint32_t load_binary(const std::string& filename) {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open binary file: " + filename);
-        }
+namespace {
 
-        // Reserve memory for the program
-        std::vector<uint32_t> program_data;
-        uint32_t instruction;
-        
-        // Read binary file in 4-byte chunks (instructions)
-        while (file.read(reinterpret_cast<char*>(&instruction), sizeof(instruction))) {
-            program_data.push_back(instruction);
-        }
-        
-        // Load program into memory starting at program_counter_
-        uint32_t start_address = program_counter_;
-        for (size_t i = 0; i < program_data.size(); ++i) {
-            write_memory(program_counter_, program_data[i]);
-            program_counter_ += 4;  // Each instruction is 4 bytes
+// Data sections start on their own lines, away from the text
+constexpr uint32_t SECTION_ALIGNMENT = 256;
+
+// Instruction type field [31:28], see rtl/core/instruction_decoder.sv
+enum InstrType : uint32_t {
+    TYPE_ALU     = 0x0,
+    TYPE_BRANCH  = 0x1,
+    TYPE_LOAD    = 0x2,
+    TYPE_STORE   = 0x3,
+    TYPE_MOVE    = 0x4,
+    TYPE_SYNC    = 0x5,
+    TYPE_SPECIAL = 0x6,
+    TYPE_CONTROL = 0x7
+};
+
+// Operand layouts accepted by the assembler
+enum class Form {
+    THREE_OP,     // rd, rs1, rs2|imm
+    TWO_REG,      // rd, rs1
+    FOUR_REG,     // rd, rs1, rs2, rs3
+    BRANCH,       // rs1, rs2, label
+    JUMP,         // label
+    JUMP_REG,     // rs1
+    BARRIER_ID,   // [imm]
+    DEST_ONLY,    // rd
+    NONE
+};
+
+struct Mnemonic {
+    Opcode   opcode;
+    Form     form;
+    uint32_t type;
+    uint32_t op;      // Operation field [8:5]
+};
+
+const std::unordered_map<std::string, Mnemonic>& mnemonics() {
+    static const std::unordered_map<std::string, Mnemonic> table = {
+        {"add",   {Opcode::ADD, Form::THREE_OP, TYPE_ALU, 0x0}},
+        {"addi",  {Opcode::ADD, Form::THREE_OP, TYPE_ALU, 0x0}},
+        {"addiu", {Opcode::ADD, Form::THREE_OP, TYPE_ALU, 0x0}},
+        {"sub",   {Opcode::SUB, Form::THREE_OP, TYPE_ALU, 0x1}},
+        {"subi",  {Opcode::SUB, Form::THREE_OP, TYPE_ALU, 0x1}},
+        {"mul",   {Opcode::MUL, Form::THREE_OP, TYPE_ALU, 0x2}},
+        {"muli",  {Opcode::MUL, Form::THREE_OP, TYPE_ALU, 0x2}},
+        {"div",   {Opcode::DIV, Form::THREE_OP, TYPE_ALU, 0x3}},
+        {"divi",  {Opcode::DIV, Form::THREE_OP, TYPE_ALU, 0x3}},
+        {"and",   {Opcode::AND, Form::THREE_OP, TYPE_ALU, 0x4}},
+        {"andi",  {Opcode::AND, Form::THREE_OP, TYPE_ALU, 0x4}},
+        {"or",    {Opcode::OR,  Form::THREE_OP, TYPE_ALU, 0x5}},
+        {"ori",   {Opcode::OR,  Form::THREE_OP, TYPE_ALU, 0x5}},
+        {"xor",   {Opcode::XOR, Form::THREE_OP, TYPE_ALU, 0x6}},
+        {"xori",  {Opcode::XOR, Form::THREE_OP, TYPE_ALU, 0x6}},
+        {"shl",   {Opcode::SHL, Form::THREE_OP, TYPE_ALU, 0x7}},
+        {"shli",  {Opcode::SHL, Form::THREE_OP, TYPE_ALU, 0x7}},
+        {"shr",   {Opcode::SHR, Form::THREE_OP, TYPE_ALU, 0x8}},
+        {"shri",  {Opcode::SHR, Form::THREE_OP, TYPE_ALU, 0x8}},
+        {"cmp",   {Opcode::CMP, Form::THREE_OP, TYPE_ALU, 0x9}},
+        {"cmpi",  {Opcode::CMP, Form::THREE_OP, TYPE_ALU, 0x9}},
+        {"min",   {Opcode::MIN, Form::THREE_OP, TYPE_ALU, 0xA}},
+        {"mini",  {Opcode::MIN, Form::THREE_OP, TYPE_ALU, 0xA}},
+        {"max",   {Opcode::MAX, Form::THREE_OP, TYPE_ALU, 0xB}},
+        {"maxi",  {Opcode::MAX, Form::THREE_OP, TYPE_ALU, 0xB}},
+        {"abs",   {Opcode::ABS, Form::TWO_REG,  TYPE_ALU, 0xC}},
+        {"neg",   {Opcode::NEG, Form::TWO_REG,  TYPE_ALU, 0xD}},
+        {"rem",   {Opcode::REM, Form::THREE_OP, TYPE_ALU, 0xE}},   // Not in the RTL ALU yet
+        {"ld.b",  {Opcode::LD_B, Form::THREE_OP, TYPE_LOAD, 0x0}},
+        {"ld.h",  {Opcode::LD_H, Form::THREE_OP, TYPE_LOAD, 0x1}},
+        {"ld.w",  {Opcode::LD_W, Form::THREE_OP, TYPE_LOAD, 0x2}},
+        {"ld.c",  {Opcode::LD_C, Form::THREE_OP, TYPE_LOAD, 0x6}},     // RTL decodes op[1:0]: ld.w
+        {"ld.nc", {Opcode::LD_NC, Form::THREE_OP, TYPE_LOAD, 0xA}},    // RTL decodes op[1:0]: ld.w
+        {"st.b",  {Opcode::ST_B, Form::THREE_OP, TYPE_STORE, 0x0}},
+        {"st.h",  {Opcode::ST_H, Form::THREE_OP, TYPE_STORE, 0x1}},
+        {"st.w",  {Opcode::ST_W, Form::THREE_OP, TYPE_STORE, 0x2}},
+        {"beq",   {Opcode::BEQ, Form::BRANCH, TYPE_BRANCH, 0x0}},
+        {"bne",   {Opcode::BNE, Form::BRANCH, TYPE_BRANCH, 0x1}},
+        {"blt",   {Opcode::BLT, Form::BRANCH, TYPE_BRANCH, 0x2}},
+        {"ble",   {Opcode::BLE, Form::BRANCH, TYPE_BRANCH, 0x3}},
+        {"bgt",   {Opcode::BGT, Form::BRANCH, TYPE_BRANCH, 0x4}},
+        {"bge",   {Opcode::BGE, Form::BRANCH, TYPE_BRANCH, 0x5}},
+        {"j",     {Opcode::J,   Form::JUMP,   TYPE_BRANCH, 0x6}},      // BR_ALL
+        {"jr",    {Opcode::JR,  Form::JUMP_REG, TYPE_SPECIAL, 0x1}},   // Affects PC
+        {"barrier",  {Opcode::BARRIER,  Form::BARRIER_ID, TYPE_SYNC, 0x0}},
+        {"arrive",   {Opcode::ARRIVE,   Form::BARRIER_ID, TYPE_SYNC, 0x1}},
+        {"wait",     {Opcode::WAIT,     Form::BARRIER_ID, TYPE_SYNC, 0x2}},
+        {"vote.any", {Opcode::VOTE_ANY, Form::TWO_REG,    TYPE_SYNC, 0x3}},
+        {"vote.all", {Opcode::VOTE_ALL, Form::TWO_REG,    TYPE_SYNC, 0x7}},
+        {"atomic.add",  {Opcode::ATOMIC_ADD,  Form::THREE_OP, TYPE_SPECIAL, 0x2}},
+        {"atomic.exch", {Opcode::ATOMIC_EXCH, Form::THREE_OP, TYPE_SPECIAL, 0x4}},
+        {"atomic.cas",  {Opcode::ATOMIC_CAS,  Form::FOUR_REG, TYPE_SPECIAL, 0x6}},
+        {"tid",     {Opcode::TID,     Form::DEST_ONLY, TYPE_MOVE, 0x0}},
+        {"warpid",  {Opcode::WARPID,  Form::DEST_ONLY, TYPE_MOVE, 0x1}},
+        {"blockid", {Opcode::BLOCKID, Form::DEST_ONLY, TYPE_MOVE, 0x2}},
+        {"exit",    {Opcode::EXIT,    Form::NONE,      TYPE_CONTROL, 0x0}},
+    };
+    return table;
+}
+
+// Splits "a, b, c" into trimmed operands
+std::vector<std::string> split_operands(const std::string& text) {
+    std::vector<std::string> operands;
+    if (utils::StringUtils::trim(text).empty()) {
+        return operands;
+    }
+    for (const auto& operand : utils::StringUtils::split(text, ',')) {
+        operands.push_back(utils::StringUtils::trim(operand));
+    }
+    return operands;
+}
+
+uint32_t align_up(uint32_t value, uint32_t alignment) {
+    return alignment == 0 ? value : (value + alignment - 1) / alignment * alignment;
+}
+
+bool is_identifier_start(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+} // namespace
+
+uint32_t ProgramLoader::load_binary(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open binary file: " + filename);
+    }
+
+    // Reserve memory for the program
+    std::vector<uint32_t> program_data;
+    uint32_t instruction;
+
+    // Read binary file in 4-byte chunks (instructions)
+    while (file.read(reinterpret_cast<char*>(&instruction), sizeof(instruction))) {
+        program_data.push_back(instruction);
+    }
+
+    // Load program into memory starting at program_counter_
+    uint32_t start_address = program_counter_;
+    for (size_t i = 0; i < program_data.size(); ++i) {
+        write_memory(program_counter_, program_data[i]);
+        program_counter_ += 4;  // Each instruction is 4 bytes
+    }
+
+    std::cout << "Loaded " << program_data.size() << " instructions starting at 0x"
+             << std::hex << start_address << std::dec << std::endl;
+
+    return start_address;
+}
+
+uint32_t ProgramLoader::load_assembly(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open assembly file: " + filename);
+    }
+
+    std::string line;
+    uint32_t line_num = 0;
+    uint32_t start_address = program_counter_;
+    Section section = Section::TEXT;
+    uint32_t section_size[3] = {0, 0, 0};
+    std::unordered_map<std::string, std::pair<Section, uint32_t>> local_labels;
+    instructions_.clear();
+
+    // First pass: place labels, instructions and data within their sections
+    while (std::getline(file, line)) {
+        line_num++;
+
+        // Strip comments
+        size_t comment = line.find_first_of("#;");
+        if (comment != std::string::npos) {
+            line = line.substr(0, comment);
         }
-        
-        std::cout << "Loaded " << program_data.size() << " instructions starting at 0x" 
-                 << std::hex << start_address << std::dec << std::endl;
-        
-        return start_address;
-    }
-
-    /**
-     * @brief Load assembly program from file
-     * @param filename Path to assembly program file
-     * @return Starting address of the loaded program
-     */
-    uint32_t load_assembly(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open assembly file: " + filename);
+        line = trim(line);
+        if (line.empty()) {
+            continue;
         }
 
-        std::string line;
-        uint32_t line_num = 0;
-        uint32_t start_address = program_counter_;
-        
-        // First pass: collect labels
-        while (std::getline(file, line)) {
-            line_num++;
-            
-            // Skip empty lines and comments
-            if (line.empty() || line[0] == '#' || line[0] == ';') {
-                continue;
-            }
-            
-            // Check for labels
-            size_t label_pos = line.find(':');
-            if (label_pos != std::string::npos) {
-                std::string label = line.substr(0, label_pos);
-                label = trim(label);
-                
-                if (!label.empty()) {
-                    labels_[label] = program_counter_;
-                }
-                
-                // Remove label from line for instruction processing
-                line = line.substr(label_pos + 1);
+        uint32_t& offset = section_size[static_cast<int>(section)];
+
+        // Check for labels
+        size_t label_pos = line.find(':');
+        if (label_pos != std::string::npos) {
+            std::string label = trim(line.substr(0, label_pos));
+
+            if (!label.empty()) {
+                local_labels[label] = {section, offset};
             }
-            
-            // Parse and assemble instruction
-            line = trim(line);
-            if (!line.empty()) {
-                try {
-                    uint32_t instruction = assemble_instruction(line);
-                    instructions_.push_back({program_counter_, instruction, line, line_num});
-                    program_counter_ += 4;  // Each instruction is 4 bytes
-                } catch (const std::exception& e) {
-                    std::cerr << "Error at line " << line_num << ": " << e.what() << std::endl;
-                    std::cerr << "  " << line << std::endl;
-                    throw;
-                }
+
+            // Remove label from line for instruction processing
+            line = trim(line.substr(label_pos + 1));
+            if (line.empty()) {
+                continue;
             }
         }
-        
-        // Second pass: resolve label references and write to memory
-        program_counter_ = start_address;
-        for (const auto& instr : instructions_) {
-            uint32_t resolved_instruction = instr.instruction;
-            
-            // Process label references in the instruction
-            if (instr.source.find('@') != std::string::npos) {
-                resolved_instruction = resolve_labels(instr.instruction, instr.source);
+
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+        std::string rest;
+        std::getline(tokens, rest);
+
+        try {
+            if (keyword == ".text") {
+                section = Section::TEXT;
+            } else if (keyword == ".data") {
+                section = Section::DATA;
+            } else if (keyword == ".shared") {
+                section = Section::SHARED;
+            } else if (keyword == ".global" || keyword == ".globl") {
+                // All labels are visible to the host
+            } else if (keyword == ".align") {
+                offset = align_up(offset, static_cast<uint32_t>(std::stoul(trim(rest), nullptr, 0)));
+            } else if (keyword == ".space") {
+                offset += static_cast<uint32_t>(std::stoul(trim(rest), nullptr, 0));
+            } else if (keyword == ".word") {
+                instructions_.push_back({section, offset, line, line_num});
+                offset += 4 * static_cast<uint32_t>(split_operands(rest).size());
+            } else if (keyword[0] == '.') {
+                throw std::runtime_error("Unknown directive " + keyword);
+            } else if (section != Section::TEXT) {
+                throw std::runtime_error("Instruction outside the .text section");
+            } else {
+                instructions_.push_back({section, offset, line, line_num});
+                offset += 4;  // Each instruction is 4 bytes
             }
-            
-            // Write instruction to memory
-            write_memory(instr.address, resolved_instruction);
-            program_counter_ += 4;
+        } catch (const std::exception& e) {
+            std::cerr << "Error at line " << line_num << ": " << e.what() << std::endl;
+            std::cerr << "  " << line << std::endl;
+            throw;
         }
-        
-        std::cout << "Loaded " << instructions_.size() << " instructions starting at 0x" 
-                 << std::hex << start_address << std::dec << std::endl;
-        
-        // Clear instructions after loading
-        instructions_.clear();
-        
-        return start_address;
-    }
-
-    /**
-     * @brief Get the current program counter
-     * @return Current program counter value
-     */
-    uint32_t get_program_counter() const {
-        return program_counter_;
-    }
-
-    /**
-     * @brief Set the program counter to a specific address
-     * @param address New program counter value
-     */
-    void set_program_counter(uint32_t address) {
-        program_counter_ = address;
-    }
-
-    /**
-     * @brief Print the loaded program
-     * @param start_address Start address to print from
-     * @param num_instructions Number of instructions to print
-     */
-    void print_program(uint32_t start_address, uint32_t num_instructions) {
-        std::cout << "Program listing:" << std::endl;
-        std::cout << "----------------" << std::endl;
-        
-        for (uint32_t addr = start_address; addr < start_address + num_instructions * 4; addr += 4) {
-            uint32_t instruction = read_memory(addr);
-            std::cout << "0x" << std::hex << std::setw(8) << std::setfill('0') << addr 
-                     << ": 0x" << std::hex << std::setw(8) << std::setfill('0') << instruction
-                     << std::dec << "  " << disassemble_instruction(instruction) << std::endl;
+    }
+
+    // Lay out the sections: text at the program counter, then data, then shared
+    uint32_t section_base[3];
+    section_base[0] = start_address;
+    section_base[1] = align_up(start_address + section_size[0], SECTION_ALIGNMENT);
+    section_base[2] = align_up(section_base[1] + section_size[1], SECTION_ALIGNMENT);
+    for (const auto& entry : local_labels) {
+        labels_[entry.first] = section_base[static_cast<int>(entry.second.first)] +
+                               entry.second.second;
+    }
+
+    image_ = std::make_shared<MemoryImage>();
+    auto program = std::make_shared<Program>();
+    program->text_base = start_address;
+    program->text.reserve(section_size[0] / 4);
+
+    // Second pass: assemble with all labels known and write to memory
+    for (const auto& instr : instructions_) {
+        uint32_t address = section_base[static_cast<int>(instr.section)] + instr.offset;
+        try {
+            if (instr.section == Section::TEXT && instr.source[0] != '.') {
+                AssembledInstruction assembled = assemble_instruction(instr.source);
+                program->text.push_back(assembled);
+                count_resources(*program, assembled);
+                write_memory(address, assembled.encoding);
+            } else {
+                std::string values = instr.source.substr(instr.source.find(".word") + 5);
+                for (const auto& value : split_operands(values)) {
+                    write_memory(address, static_cast<uint32_t>(parse_immediate(value)));
+                    address += 4;
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error at line " << instr.line_num << ": " << e.what() << std::endl;
+            std::cerr << "  " << instr.source << std::endl;
+            throw;
         }
     }
+    program_counter_ = section_base[2] + section_size[2];
 
-private:
-    // Instruction representation during assembly
-    struct Instruction {
-        uint32_t address;
-        uint32_t instruction;
-        std::string source;
-        uint32_t line_num;
-    };
+    auto main_label = labels_.find("main");
+    program->entry_point = main_label != labels_.end() ? main_label->second : start_address;
+    program->image = image_;
+    program->symbols = labels_;
+    program->shared_base = section_base[2];
+    program->shared_size = section_size[2];
+    program_ = program;
 
-    // Memory accessor methods
-    void write_memory(uint32_t address, uint32_t data);
-    uint32_t read_memory(uint32_t address);
-
-    // Assembly helpers
-    uint32_t assemble_instruction(const std::string& instruction);
-    uint32_t resolve_labels(uint32_t instruction, const std::string& source);
-    std::string disassemble_instruction(uint32_t instruction);
-
-    // String utilities
-    std::string trim(const std::string& str) {
-        auto start = std::find_if_not(str.begin(), str.end(), 
-            [](unsigned char c) { return std::isspace(c); });
-        auto end = std::find_if_not(str.rbegin(), str.rend(), 
-            [](unsigned char c) { return std::isspace(c); }).base();
-        return (start < end) ? std::string(start, end) : std::string();
-    }
-
-    // Private members
-    std::shared_ptr<MemoryModel> memory_model_;
-    uint32_t program_counter_;
-    std::unordered_map<std::string, uint32_t> labels_;
-    std::vector<Instruction> instructions_;
-};
+    std::cout << "Loaded " << program->text.size() << " instructions starting at 0x"
+             << std::hex << start_address << std::dec << std::endl;
 
-/* Placeholder implementations for memory access methods */
+    // Clear instructions after loading
+    instructions_.clear();
+
+    return start_address;
+}
+
+void ProgramLoader::print_program(uint32_t start_address, uint32_t num_instructions) {
+    std::cout << "Program listing:" << std::endl;
+    std::cout << "----------------" << std::endl;
+
+    for (uint32_t addr = start_address; addr < start_address + num_instructions * 4; addr += 4) {
+        uint32_t instruction = read_memory(addr);
+        std::cout << "0x" << std::hex << std::setw(8) << std::setfill('0') << addr
+                 << ": 0x" << std::hex << std::setw(8) << std::setfill('0') << instruction
+                 << std::dec << std::setfill(' ') << "  "
+                 << disassemble_instruction(instruction) << std::endl;
+    }
+}
+
+/* Memory access methods: program images are written functionally, so
+   loading does not disturb cache statistics or timing. The image keeps a
+   copy so engines can share the program without a memory model. */
 void ProgramLoader::write_memory(uint32_t address, uint32_t data) {
-    // In a real implementation, this would call memory_model_->write()
-    // For now, we'll just use a placeholder
-    std::cout << "Writing 0x" << std::hex << data << " to address 0x" 
-             << address << std::dec << std::endl;
+    if (!image_) {
+        image_ = std::make_shared<MemoryImage>();
+    }
+    (*image_)[address] = data;
+    if (memory_model_) {
+        memory_model_->functional_write(address, data);
+    }
 }
 
 uint32_t ProgramLoader::read_memory(uint32_t address) {
-    // In a real implementation, this would call memory_model_->read()
-    // For now, we'll just use a placeholder
+    if (memory_model_) {
+        return memory_model_->functional_read(address);
+    }
+    if (image_) {
+        auto it = image_->find(address);
+        if (it != image_->end()) {
+            return it->second;
+        }
+    }
     return 0;
 }
 
-/* Placeholder implementations for assembly/disassembly methods */
-uint32_t ProgramLoader::assemble_instruction(const std::string& instruction) {
-    // This is a simplified placeholder for instruction assembly
-    // A real implementation would parse the instruction and convert to binary
-    
-    // For demonstration, we'll return a dummy instruction
-    return 0x12345678;
+/* Assembly methods */
+void ProgramLoader::count_resources(Program& program, const AssembledInstruction& instr) {
+    // Register fields left unused assemble as $r0, which every kernel has.
+    // $ra is the link register, held outside the register file.
+    auto general = [](uint8_t reg) { return reg == NUM_REGISTERS - 1 ? uint8_t{0} : reg; };
+    uint32_t highest = std::max({general(instr.rd), general(instr.rs1), general(instr.rs3),
+                                 instr.use_imm ? uint8_t{0} : general(instr.rs2)});
+    program.registers = std::max(program.registers, highest + 1);
+    if (instr.opcode == Opcode::BARRIER || instr.opcode == Opcode::ARRIVE ||
+        instr.opcode == Opcode::WAIT) {
+        program.barriers = std::max(program.barriers, static_cast<uint32_t>(instr.imm) + 1);
+    }
 }
 
-uint32_t ProgramLoader::resolve_labels(uint32_t instruction, const std::string& source) {
-    // This is a simplified placeholder for label resolution
-    // A real implementation would identify and replace label references
-    
-    // For demonstration, we'll return the original instruction
-    return instruction;
+AssembledInstruction ProgramLoader::assemble_instruction(const std::string& instruction) {
+    std::istringstream tokens(instruction);
+    std::string name;
+    tokens >> name;
+    std::string rest;
+    std::getline(tokens, rest);
+
+    auto it = mnemonics().find(utils::StringUtils::to_lower(name));
+    if (it == mnemonics().end()) {
+        throw std::runtime_error("Unknown instruction " + name);
+    }
+    const Mnemonic& mnemonic = it->second;
+    std::vector<std::string> operands = split_operands(rest);
+
+    auto expect = [&](size_t min_count, size_t max_count) {
+        if (operands.size() < min_count || operands.size() > max_count) {
+            throw std::runtime_error("Wrong number of operands for " + name);
+        }
+    };
+
+    AssembledInstruction result{mnemonic.opcode, 0, 0, 0, 0, false, 0, 0};
+    switch (mnemonic.form) {
+        case Form::THREE_OP:
+            expect(3, 3);
+            result.rd = parse_register(operands[0]);
+            result.rs1 = parse_register(operands[1]);
+            if (is_register(operands[2])) {
+                result.rs2 = parse_register(operands[2]);
+            } else {
+                result.use_imm = true;
+                result.imm = parse_immediate(operands[2]);
+            }
+            break;
+        case Form::TWO_REG:
+            expect(2, 2);
+            result.rd = parse_register(operands[0]);
+            result.rs1 = parse_register(operands[1]);
+            break;
+        case Form::FOUR_REG:
+            expect(4, 4);
+            result.rd = parse_register(operands[0]);
+            result.rs1 = parse_register(operands[1]);
+            result.rs2 = parse_register(operands[2]);
+            result.rs3 = parse_register(operands[3]);
+            break;
+        case Form::BRANCH:
+            expect(3, 3);
+            result.rs1 = parse_register(operands[0]);
+            result.rs2 = parse_register(operands[1]);
+            result.use_imm = true;
+            result.imm = static_cast<int32_t>(resolve_labels(operands[2]));
+            break;
+        case Form::JUMP:
+            expect(1, 1);
+            result.use_imm = true;
+            result.imm = static_cast<int32_t>(resolve_labels(operands[0]));
+            break;
+        case Form::JUMP_REG:
+            expect(1, 1);
+            result.rs1 = parse_register(operands[0]);
+            break;
+        case Form::BARRIER_ID:
+            expect(0, 1);
+            result.use_imm = !operands.empty();
+            result.imm = operands.empty() ? 0 : parse_immediate(operands[0]);
+            break;
+        case Form::DEST_ONLY:
+            expect(1, 1);
+            result.rd = parse_register(operands[0]);
+            break;
+        case Form::NONE:
+            expect(0, 0);
+            break;
+    }
+
+    result.encoding = encode_instruction(result);
+    return result;
+}
+
+uint32_t ProgramLoader::resolve_labels(const std::string& operand) const {
+    auto it = labels_.find(operand);
+    if (it == labels_.end()) {
+        throw std::runtime_error("Undefined label " + operand);
+    }
+    return it->second;
+}
+
+int32_t ProgramLoader::parse_immediate(const std::string& operand) const {
+    if (operand.empty()) {
+        throw std::runtime_error("Missing immediate operand");
+    }
+    if (is_identifier_start(operand[0])) {
+        return static_cast<int32_t>(resolve_labels(operand));
+    }
+    size_t used = 0;
+    long long value = std::stoll(operand, &used, 0);
+    if (used != operand.size()) {
+        throw std::runtime_error("Invalid immediate " + operand);
+    }
+    return static_cast<int32_t>(value);
+}
+
+bool ProgramLoader::is_register(const std::string& operand) {
+    return !operand.empty() && operand[0] == '$';
+}
+
+uint8_t ProgramLoader::parse_register(const std::string& operand) {
+    if (operand == "$ra") {
+        return NUM_REGISTERS - 1;
+    }
+    if (operand == "$zero") {
+        return 0;
+    }
+    if (operand.size() < 3 || operand.compare(0, 2, "$r") != 0) {
+        throw std::runtime_error("Invalid register " + operand);
+    }
+    size_t used = 0;
+    unsigned long index = std::stoul(operand.substr(2), &used, 10);
+    if (used != operand.size() - 2 || index >= NUM_REGISTERS) {
+        throw std::runtime_error("Invalid register " + operand);
+    }
+    return static_cast<uint8_t>(index);
+}
+
+uint32_t ProgramLoader::encode_instruction(const AssembledInstruction& instr) {
+    const Mnemonic* mnemonic = nullptr;
+    for (const auto& entry : mnemonics()) {
+        if (entry.second.opcode == instr.opcode) {
+            mnemonic = &entry.second;
+            break;
+        }
+    }
+    assert(mnemonic != nullptr);
+
+    // [31:28] type, [27:22] rd, [21:16] rs1, [15:10] rs2, [9] use_imm,
+    // [8:5] op; immediate forms carry imm[15:0] over rs2 and op
+    uint32_t word = (mnemonic->type << 28) |
+                    (static_cast<uint32_t>(instr.rd) << 22) |
+                    (static_cast<uint32_t>(instr.rs1) << 16) |
+                    (static_cast<uint32_t>(instr.rs2) << 10) |
+                    (mnemonic->op << 5);
+    if (instr.use_imm) {
+        word = (word & 0xFFFF0000) | (static_cast<uint32_t>(instr.imm) & 0xFFFF) | (1u << 9);
+    }
+    return word;
 }
 
 std::string ProgramLoader::disassemble_instruction(uint32_t instruction) {
-    // This is a simplified placeholder for instruction disassembly
-    // A real implementation would decode the binary and convert to assembly text
-    
-    // For demonstration, we'll return a dummy string
+    static const char* type_names[] = {
+        "alu", "branch", "load", "store", "move", "sync", "special", "control"
+    };
+
+    uint32_t type = instruction >> 28;
+    if (type >= 8) {
+        return ".word " + utils::StringUtils::to_hex(instruction);
+    }
+
     std::stringstream ss;
-    ss << "INSTRUCTION 0x" << std::hex << instruction;
+    ss << type_names[type];
+    uint32_t rd = (instruction >> 22) & 0x3F;
+    uint32_t rs1 = (instruction >> 16) & 0x3F;
+    if (instruction & (1u << 9)) {
+        ss << " r" << rd << ", r" << rs1 << ", #0x" << std::hex << (instruction & 0xFFFF);
+    } else {
+        ss << "." << ((instruction >> 5) & 0xF) << " r" << rd << ", r" << rs1
+           << ", r" << ((instruction >> 10) & 0x3F);
+    }
     return ss.str();
 }
 
-} // namespace gpu_simulator
\ No newline at end of file
+} // namespace gpu_simulator
@@ -0,0 +1,192 @@
+// program_loader.h
+// Program loading mechanism for GPU simulator
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include "memory_model.h"
+
+namespace gpu_simulator {
+
+/**
+ * @brief Operations of the simulator assembly language (see programs/)
+ */
+enum class Opcode : uint8_t {
+    // ALU: rd = rs1 op (rs2 | imm)
+    ADD, SUB, MUL, DIV, REM, AND, OR, XOR, SHL, SHR, CMP, MIN, MAX,
+    // ALU: rd = op rs1
+    ABS, NEG,
+    // Memory: rd = mem[rs1 + (rs2 | imm)] / mem[rs1 + (rs2 | imm)] = rd
+    LD_B, LD_H, LD_W, ST_B, ST_H, ST_W,
+    // Word loads through the constant cache (one fetch per distinct address,
+    // broadcast to its lanes) and the non-coherent read-only cache
+    LD_C, LD_NC,
+    // Atomics: rd = mem[rs1]; mem[rs1] = f(mem[rs1], rs2 | imm [, rs3])
+    ATOMIC_ADD, ATOMIC_EXCH, ATOMIC_CAS,
+    // Control flow: branch to imm when rs1 cmp rs2; jr jumps to rs1
+    BEQ, BNE, BLT, BLE, BGT, BGE, J, JR,
+    // Synchronization and warp-wide votes
+    BARRIER, ARRIVE, WAIT, VOTE_ANY, VOTE_ALL,
+    // Special registers and thread control
+    TID, WARPID, BLOCKID, EXIT
+};
+
+/**
+ * @brief One assembled instruction in decoded form
+ *
+ * The binary encoding follows rtl/core/instruction_decoder.sv. As in the
+ * RTL, a 16-bit immediate overlays rs2 and the operation field, so the
+ * simulator executes the decoded form rather than re-decoding the word.
+ */
+struct AssembledInstruction {
+    Opcode   opcode;
+    uint8_t  rd;          // Destination (data register for stores)
+    uint8_t  rs1;
+    uint8_t  rs2;
+    uint8_t  rs3;         // New value for atomic.cas
+    bool     use_imm;     // Second source is imm instead of rs2
+    int32_t  imm;         // Immediate, memory offset or branch target
+    uint32_t encoding;    // Word written to instruction memory
+};
+
+/**
+ * @brief An assembled program: decoded text, initial memory and symbols
+ */
+struct Program {
+    uint32_t text_base;
+    uint32_t entry_point;                           // "main", else text_base
+    std::vector<AssembledInstruction> text;         // One per word from text_base
+    std::shared_ptr<const MemoryImage> image;       // Text and data words
+    std::unordered_map<std::string, uint32_t> symbols;
+    uint32_t shared_base = 0;                       // .shared section (per thread block)
+    uint32_t shared_size = 0;
+    uint32_t registers = 0;                         // Per thread: highest one but $ra + 1
+    uint32_t barriers = 0;                          // Highest barrier ID used + 1
+
+    /**
+     * @brief Instruction at a program counter
+     * @return nullptr when pc is outside the text section
+     */
+    const AssembledInstruction* at(uint32_t pc) const {
+        uint32_t index = (pc - text_base) / 4;
+        if (pc < text_base || (pc & 3) != 0 || index >= text.size()) {
+            return nullptr;
+        }
+        return &text[index];
+    }
+};
+
+/**
+ * @brief Program Loader class to load and manage GPU programs
+ */
+class ProgramLoader {
+public:
+    // Registers addressable by the 6-bit register fields; $ra is the last
+    static constexpr uint32_t NUM_REGISTERS = 64;
+
+    /**
+     * @brief Constructor
+     * @param memory Pointer to memory model to load program into (may be
+     *        null to only build the program image)
+     */
+    ProgramLoader(std::shared_ptr<MemoryModel> memory)
+        : memory_model_(memory), program_counter_(0) {}
+
+    /**
+     * @brief Load binary program from file
+     * @param filename Path to binary program file
+     * @return Starting address of the loaded program
+     */
+    uint32_t load_binary(const std::string& filename);
+
+    /**
+     * @brief Load assembly program from file
+     *
+     * Text is placed at the program counter; .data and then .shared
+     * follow it, each aligned to a cache-friendly boundary.
+     *
+     * @param filename Path to assembly program file
+     * @return Starting address of the loaded program
+     */
+    uint32_t load_assembly(const std::string& filename);
+
+    /**
+     * @brief The most recently assembled program
+     */
+    std::shared_ptr<const Program> program() const {
+        return program_;
+    }
+
+    /**
+     * @brief Get the current program counter
+     * @return Current program counter value
+     */
+    uint32_t get_program_counter() const {
+        return program_counter_;
+    }
+
+    /**
+     * @brief Set the program counter to a specific address
+     * @param address New program counter value
+     */
+    void set_program_counter(uint32_t address) {
+        program_counter_ = address;
+    }
+
+    /**
+     * @brief Print the loaded program
+     * @param start_address Start address to print from
+     * @param num_instructions Number of instructions to print
+     */
+    void print_program(uint32_t start_address, uint32_t num_instructions);
+
+private:
+    // Sections of an assembly source
+    enum class Section { TEXT, DATA, SHARED };
+
+    // One instruction or data directive, placed during the first pass
+    struct Instruction {
+        Section     section;
+        uint32_t    offset;       // Offset within the section
+        std::string source;
+        uint32_t    line_num;
+    };
+
+    // Memory accessor methods
+    void write_memory(uint32_t address, uint32_t data);
+    uint32_t read_memory(uint32_t address);
+
+    // Assembly helpers
+    AssembledInstruction assemble_instruction(const std::string& instruction);
+    static void count_resources(Program& program, const AssembledInstruction& instr);
+    uint32_t resolve_labels(const std::string& operand) const;
+    int32_t parse_immediate(const std::string& operand) const;
+    static uint8_t parse_register(const std::string& operand);
+    static bool is_register(const std::string& operand);
+    static uint32_t encode_instruction(const AssembledInstruction& instr);
+    std::string disassemble_instruction(uint32_t instruction);
+
+    // String utilities
+    std::string trim(const std::string& str) {
+        auto start = std::find_if_not(str.begin(), str.end(),
+            [](unsigned char c) { return std::isspace(c); });
+        auto end = std::find_if_not(str.rbegin(), str.rend(),
+            [](unsigned char c) { return std::isspace(c); }).base();
+        return (start < end) ? std::string(start, end) : std::string();
+    }
+
+    // Private members
+    std::shared_ptr<MemoryModel> memory_model_;
+    uint32_t program_counter_;
+    std::unordered_map<std::string, uint32_t> labels_;
+    std::vector<Instruction> instructions_;
+    std::shared_ptr<MemoryImage> image_;
+    std::shared_ptr<const Program> program_;
+};
+
+} // namespace gpu_simulator
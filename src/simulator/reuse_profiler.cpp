@@ -0,0 +1,301 @@
+// reuse_profiler.cpp
+// Implementation of sampled reuse-distance and working-set profiling
+
+#include "reuse_profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+void ReuseHistogram::add(double distance, double weight) {
+    uint64_t rounded = static_cast<uint64_t>(distance + 0.5);
+    uint32_t index = rounded == 0 ? 0 : 64 - static_cast<uint32_t>(__builtin_clzll(rounded));
+    buckets_[std::min(index, NUM_BUCKETS - 1)] += weight;
+    total_ += weight;
+    samples_++;
+}
+
+void ReuseHistogram::reset() {
+    std::fill(std::begin(buckets_), std::end(buckets_), 0.0);
+    cold_ = 0.0;
+    total_ = 0.0;
+    samples_ = 0;
+}
+
+double ReuseHistogram::hit_rate(uint64_t lines) const {
+    if (total_ <= 0.0) {
+        return 0.0;
+    }
+    // Distance d hits when d < lines; the bucket straddling the size is
+    // split in proportion to its range
+    double hits = 0.0;
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+        uint64_t low = i == 0 ? 0 : uint64_t{1} << (i - 1);
+        uint64_t high = bucket_high(i);
+        if (high < lines) {
+            hits += buckets_[i];
+        } else if (low < lines) {
+            hits += buckets_[i] * static_cast<double>(lines - low) /
+                    static_cast<double>(high - low + 1);
+        }
+    }
+    return hits / total_;
+}
+
+uint64_t ReuseHistogram::percentile(double percent) const {
+    double reuses = total_ - cold_;
+    if (reuses <= 0.0) {
+        return 0;
+    }
+    double rank = std::clamp(percent, 0.0, 100.0) / 100.0 * reuses;
+    double seen = 0.0;
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank && buckets_[i] > 0.0) {
+            return bucket_high(i);
+        }
+    }
+    return bucket_high(NUM_BUCKETS - 1);
+}
+
+ReuseProfiler::ReuseProfiler(uint32_t line_size, uint32_t num_warps, SimTime interval,
+                             double sample_rate, uint32_t max_tracked)
+    : offset_bits_(0)
+    , max_tracked_(max_tracked)
+    , initial_threshold_(0)
+    , interval_(interval)
+    , warps_(num_warps)
+    , interval_index_(1)
+    , interval_lines_(0.0) {
+    if (line_size == 0 || (line_size & (line_size - 1)) != 0) {
+        throw std::invalid_argument("Line size must be a power of two");
+    }
+    if (!(sample_rate > 0.0 && sample_rate <= 1.0)) {
+        throw std::invalid_argument("Sample rate must be in (0, 1]");
+    }
+    if (interval == 0 || max_tracked == 0) {
+        throw std::invalid_argument("Interval and line budget must be positive");
+    }
+    while ((1u << offset_bits_) < line_size) {
+        offset_bits_++;
+    }
+    initial_threshold_ = std::max<uint32_t>(
+        1, static_cast<uint32_t>(std::lround(sample_rate * HASH_SPACE)));
+    reset();
+}
+
+const ReuseHistogram& ReuseProfiler::warp(uint32_t warp_id) const {
+    if (warp_id >= warps_.size()) {
+        throw std::out_of_range("Warp ID out of range");
+    }
+    return warps_[warp_id].histogram;
+}
+
+double ReuseProfiler::sample_rate() const {
+    return static_cast<double>(global_.threshold) / HASH_SPACE;
+}
+
+uint32_t ReuseProfiler::hash_line(uint32_t line) {
+    // Murmur3 finalizer: neighbouring lines land far apart
+    uint32_t h = line;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h & (HASH_SPACE - 1);
+}
+
+void ReuseProfiler::on_memory_request(const MemoryTransaction& request,
+                                      const MemoryResult& result, SimTime time) {
+    (void)result;
+    record(request.warp_id, request.address, time);
+}
+
+void ReuseProfiler::record(uint32_t warp_id, uint32_t address, SimTime time) {
+    if (time >= interval_index_ * interval_) {
+        advance_interval(time);
+    }
+
+    uint32_t line = address >> offset_bits_;
+    uint32_t hash = hash_line(line);
+    if (hash >= initial_threshold_) {
+        return;     // The common case: one hash and compare
+    }
+
+    if (Tracked* tracked = update(global_, line, hash)) {
+        if (tracked->interval != interval_index_) {
+            tracked->interval = interval_index_;
+            interval_lines_ += static_cast<double>(HASH_SPACE) / global_.threshold;
+        }
+    }
+    if (warp_id < warps_.size()) {
+        update(warps_[warp_id], line, hash);
+    }
+}
+
+ReuseProfiler::Tracked* ReuseProfiler::update(Stream& stream, uint32_t line, uint32_t hash) {
+    if (hash >= stream.threshold) {
+        return nullptr;
+    }
+    double scale = static_cast<double>(HASH_SPACE) / stream.threshold;
+
+    auto [it, inserted] = stream.lines.try_emplace(line, Tracked{0, hash, 0});
+    if (inserted) {
+        stream.histogram.add_cold(scale);
+        stream.by_hash.emplace(hash, line);
+    } else {
+        // Distinct sampled lines touched since the previous access
+        uint32_t previous = it->second.time;
+        int64_t distance = stream.tree.prefix(stream.tree.size()) - stream.tree.prefix(previous);
+        stream.histogram.add(static_cast<double>(distance) * scale, scale);
+        stream.tree.add(previous, -1);
+    }
+    stream.tree.append(1);
+    it->second.time = static_cast<uint32_t>(stream.tree.size());
+
+    if (inserted && stream.lines.size() > max_tracked_) {
+        shrink(stream);
+        it = stream.lines.find(line);
+        if (it == stream.lines.end()) {
+            return nullptr;
+        }
+    }
+    if (stream.tree.size() > 2 * stream.lines.size() + 1024) {
+        compact(stream);
+        it = stream.lines.find(line);
+    }
+    return &it->second;
+}
+
+void ReuseProfiler::shrink(Stream& stream) {
+    // Lower the threshold to the largest tracked hash and drop every line
+    // at or above it; later samples are weighted by the new, lower rate
+    uint32_t threshold = stream.by_hash.top().first;
+    while (!stream.by_hash.empty() && stream.by_hash.top().first >= threshold) {
+        uint32_t line = stream.by_hash.top().second;
+        stream.by_hash.pop();
+        auto it = stream.lines.find(line);
+        stream.tree.add(it->second.time, -1);
+        stream.lines.erase(it);
+    }
+    stream.threshold = std::max<uint32_t>(threshold, 1);
+}
+
+void ReuseProfiler::compact(Stream& stream) {
+    // Renumber live lines 1..n in access order; only their order matters
+    std::vector<std::pair<uint32_t, uint32_t>> order;
+    order.reserve(stream.lines.size());
+    for (const auto& [line, tracked] : stream.lines) {
+        order.emplace_back(tracked.time, line);
+    }
+    std::sort(order.begin(), order.end());
+
+    stream.tree = GrowingFenwickTree{};
+    for (const auto& [time, line] : order) {
+        stream.tree.append(1);
+        stream.lines[line].time = static_cast<uint32_t>(stream.tree.size());
+    }
+}
+
+void ReuseProfiler::advance_interval(SimTime time) {
+    while (time >= interval_index_ * interval_) {
+        working_set_.push_back({(interval_index_ - 1) * interval_, interval_lines_});
+        interval_lines_ = 0.0;
+        interval_index_++;
+    }
+}
+
+void ReuseProfiler::reset_stream(Stream& stream) {
+    stream.lines.clear();
+    stream.tree = GrowingFenwickTree{};
+    stream.by_hash = {};
+    stream.threshold = initial_threshold_;
+    stream.histogram.reset();
+}
+
+void ReuseProfiler::reset() {
+    reset_stream(global_);
+    for (auto& stream : warps_) {
+        reset_stream(stream);
+    }
+    interval_index_ = 1;
+    interval_lines_ = 0.0;
+    working_set_.clear();
+}
+
+std::vector<ReuseProfiler::WorkingSetSample> ReuseProfiler::working_set() const {
+    std::vector<WorkingSetSample> samples = working_set_;
+    if (interval_lines_ > 0.0) {
+        samples.push_back({(interval_index_ - 1) * interval_, interval_lines_});
+    }
+    return samples;
+}
+
+void ReuseProfiler::print(std::ostream& out, bool per_warp) const {
+    const ReuseHistogram& histogram = global_.histogram;
+    out << "\nReuse Distance (lines, sampled):\n"
+        << "================================\n"
+        << "Sample Rate: " << std::fixed << std::setprecision(4) << sample_rate()
+        << ", Sampled Reuses: " << histogram.samples()
+        << ", Est. Accesses: " << std::setprecision(0) << histogram.total()
+        << ", Est. Cold: " << histogram.cold() << "\n"
+        << std::right << std::setw(14) << "Distance <=" << std::setw(10) << "Share"
+        << std::setw(14) << "LRU Hit Rate" << "\n";
+
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < ReuseHistogram::NUM_BUCKETS; ++i) {
+        if (histogram.bucket(i) > 0.0) {
+            last = i;
+        }
+    }
+    for (uint32_t i = 0; i <= last && histogram.total() > 0.0; ++i) {
+        uint64_t high = ReuseHistogram::bucket_high(i);
+        out << std::setw(14) << high << std::setw(9) << std::setprecision(2)
+            << histogram.bucket(i) * 100.0 / histogram.total() << "%"
+            << std::setw(13) << histogram.hit_rate(high + 1) * 100.0 << "%\n";
+    }
+
+    if (per_warp) {
+        out << std::setw(8) << "Warp" << std::setw(12) << "Reuses"
+            << std::setw(10) << "p50" << std::setw(10) << "p90" << "\n";
+        for (uint32_t warp = 0; warp < warps_.size(); ++warp) {
+            const ReuseHistogram& h = warps_[warp].histogram;
+            if (h.samples() > 0) {
+                out << std::setw(8) << warp << std::setw(12) << h.samples()
+                    << std::setw(10) << h.percentile(50.0)
+                    << std::setw(10) << h.percentile(90.0) << "\n";
+            }
+        }
+    }
+
+    auto samples = working_set();
+    if (!samples.empty()) {
+        double peak = 0.0;
+        double sum = 0.0;
+        for (const auto& sample : samples) {
+            peak = std::max(peak, sample.lines);
+            sum += sample.lines;
+        }
+        out << "Working Set per " << interval_ << " cycles: mean "
+            << std::setprecision(1) << sum / samples.size() << " lines, peak "
+            << peak << " lines over " << samples.size() << " interval(s)\n";
+    }
+}
+
+void ReuseProfiler::write_working_set_csv(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open working set output file: " + filename);
+    }
+    file << "start_cycle,lines,bytes\n";
+    for (const auto& sample : working_set()) {
+        file << sample.start << "," << std::fixed << std::setprecision(1) << sample.lines
+             << "," << sample.lines * (1u << offset_bits_) << "\n";
+    }
+}
+
+} // namespace gpu_simulator
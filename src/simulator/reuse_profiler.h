@@ -0,0 +1,137 @@
+// reuse_profiler.h
+// Online sampled reuse-distance and working-set profiling (SHARDS)
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "sim_engine.h"
+#include "stack_distance.h"
+
+namespace gpu_simulator {
+
+// Reuse distances in power-of-two buckets: bucket 0 holds distance 0,
+// bucket b holds [2^(b-1), 2^b). Counts are weighted by the inverse
+// sampling rate, so they estimate totals over all accesses.
+class ReuseHistogram {
+public:
+    static constexpr uint32_t NUM_BUCKETS = 33;
+
+    void add(double distance, double weight);
+    void add_cold(double weight) { cold_ += weight; total_ += weight; }
+    void reset();
+
+    double bucket(uint32_t index) const { return buckets_[index]; }
+    double cold() const { return cold_; }            // First touches
+    double total() const { return total_; }
+    uint64_t samples() const { return samples_; }    // Sampled reuses
+
+    // Estimated hit rate of a fully associative LRU cache of `lines` lines
+    double hit_rate(uint64_t lines) const;
+    // Upper edge of the bucket holding the given percentile of reuses
+    uint64_t percentile(double percent) const;
+
+    static uint64_t bucket_high(uint32_t index) {
+        return index == 0 ? 0 : (uint64_t{1} << index) - 1;
+    }
+
+private:
+    double buckets_[NUM_BUCKETS] = {};
+    double cold_ = 0.0;
+    double total_ = 0.0;
+    uint64_t samples_ = 0;
+};
+
+// SHARDS (Waldspurger et al., FAST'15) fed by the engine's memory requests.
+// A line is sampled when a hash of its address falls below a threshold, so
+// every access to a sampled line is seen and distances measured among
+// sampled lines scale by the inverse rate. Each stream (global and one per
+// warp) tracks at most max_tracked lines: beyond that its threshold drops
+// to evict the highest-hashed lines (fixed-size SHARDS), bounding memory
+// and per-access cost however long the run. The threshold starts at every
+// line, so footprints within the budget are profiled exactly. Working-set size (distinct
+// lines touched) is estimated the same way for every interval of cycles.
+class ReuseProfiler : public MemoryRequestObserver {
+public:
+    static constexpr double   DEFAULT_SAMPLE_RATE = 1.0;
+    static constexpr uint32_t DEFAULT_MAX_TRACKED = 8192;
+    static constexpr SimTime  DEFAULT_INTERVAL = 10000;
+
+    // Constructor
+    ReuseProfiler(uint32_t line_size, uint32_t num_warps,
+                  SimTime interval = DEFAULT_INTERVAL,
+                  double sample_rate = DEFAULT_SAMPLE_RATE,
+                  uint32_t max_tracked = DEFAULT_MAX_TRACKED);
+
+    // Delete copy constructor and assignment
+    ReuseProfiler(const ReuseProfiler&) = delete;
+    ReuseProfiler& operator=(const ReuseProfiler&) = delete;
+
+    void record(uint32_t warp_id, uint32_t address, SimTime time);
+    void on_memory_request(const MemoryTransaction& request, const MemoryResult& result,
+                           SimTime time) override;
+    void reset();
+
+    struct WorkingSetSample {
+        SimTime start;            // First cycle of the interval
+        double  lines;            // Estimated distinct lines touched
+    };
+
+    const ReuseHistogram& global() const { return global_.histogram; }
+    const ReuseHistogram& warp(uint32_t warp_id) const;
+    uint32_t num_warps() const { return static_cast<uint32_t>(warps_.size()); }
+
+    // Completed intervals plus the one in progress
+    std::vector<WorkingSetSample> working_set() const;
+
+    // Current global sampling rate (drops when the line budget is exceeded)
+    double sample_rate() const;
+
+    void print(std::ostream& out, bool per_warp = false) const;
+    void write_working_set_csv(const std::string& filename) const;
+
+private:
+    static constexpr uint32_t HASH_BITS = 24;
+    static constexpr uint32_t HASH_SPACE = 1u << HASH_BITS;
+
+    struct Tracked {
+        uint32_t time;            // Position of the last access in the tree
+        uint32_t hash;
+        uint64_t interval;        // Last interval that counted this line
+    };
+
+    struct Stream {
+        std::unordered_map<uint32_t, Tracked> lines;
+        GrowingFenwickTree tree;                        // One mark per live line
+        std::priority_queue<std::pair<uint32_t, uint32_t>> by_hash;   // (hash, line)
+        uint32_t threshold;
+        ReuseHistogram histogram;
+    };
+
+    static uint32_t hash_line(uint32_t line);
+    // Returns the tracked entry, or nullptr when the line is not sampled
+    Tracked* update(Stream& stream, uint32_t line, uint32_t hash);
+    void shrink(Stream& stream);
+    void compact(Stream& stream);
+    void advance_interval(SimTime time);
+    void reset_stream(Stream& stream);
+
+    uint32_t offset_bits_;
+    uint32_t max_tracked_;
+    uint32_t initial_threshold_;
+    SimTime interval_;
+    Stream global_;
+    std::vector<Stream> warps_;
+
+    // Working set of the interval in progress
+    uint64_t interval_index_;
+    double interval_lines_;
+    std::vector<WorkingSetSample> working_set_;
+};
+
+} // namespace gpu_simulator
@@ -2,22 +2,106 @@
 // Implementation of simulation engine
 
 #include "sim_engine.h"
+#include "checkpoint.h"
+#include "host_profiler.h"
+#include "timeline_trace.h"
+#include "metrics_server.h"
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <cassert>
 #include <cstring>
 #include <algorithm>
 #include <iomanip>
+#include <stdexcept>
+#include <limits>
 
 namespace gpu_simulator {
 
+namespace {
+
+// Fixed-width checkpoint records
+struct WarpRecord {
+    uint64_t last_active;
+    uint32_t pc;
+    uint32_t thread_mask;
+    uint8_t  active;
+    uint8_t  reserved[7];
+};
+
+struct EventRecord {
+    uint64_t time;
+    uint64_t sequence;
+    uint32_t type;
+    uint32_t source;
+    uint32_t has_transaction;
+    uint32_t address;
+    uint32_t data;
+    uint32_t is_write;
+    uint32_t size;
+    uint32_t thread_mask;
+    uint32_t pc;
+    uint8_t  space;
+    uint8_t  level;
+    uint8_t  reserved[2];
+    uint64_t issue_time;
+};
+
+// The configuration with its unified storage split resolved: cache_size
+// becomes the L1's share, shared_carveout the bytes actually carved out
+SimConfig with_carveout(SimConfig config, uint32_t shared_needed) {
+    if (config.unified_storage_size == 0) {
+        return config;
+    }
+    UnifiedStorage storage(config.unified_storage_size, config.cache_line_size);
+    Carveout carveout = config.shared_carveout == SimConfig::AUTO_CARVEOUT
+        ? storage.fit(shared_needed)
+        : storage.carve(config.shared_carveout);
+    if (carveout.shared_size < shared_needed) {
+        throw std::runtime_error("Kernel needs " + std::to_string(shared_needed) +
+                                 " bytes of shared memory, the carveout is " +
+                                 std::to_string(carveout.shared_size));
+    }
+    config.cache_size = carveout.l1_size;
+    config.shared_carveout = carveout.shared_size;
+    return config;
+}
+
+} // namespace
+
 SimulationEngine::SimulationEngine(const SimConfig& config)
-    : config_(config)
+    : config_(with_carveout(config, 0))
     , running_(false)
+    , paused_(false)
     , current_time_(0)
-    , memory_model_(std::make_unique<MemoryModel>(config.cache_size, 
+    , latency_profile_(config.num_warps)
+    , stats_interval_(0)
+    , next_stats_dump_(0)
+    , stats_out_(nullptr)
+    , interval_latency_(0)
+    , interval_start_(0)
+    , stats_epoch_(0)
+    , reported_latency_(&latency_profile_)
+    , memory_model_(std::make_unique<MemoryModel>(config_.cache_size, 
                                                  config.cache_line_size,
-                                                 config.memory_latency)) {
+                                                 config.memory_latency,
+                                                 &stats_registry_, "memory"))
+    , constant_port_free_(0)
+    , shared_base_(0)
+    , shared_size_(0)
+    , requested_carveout_(config.shared_carveout)
+    , timeline_(nullptr)
+    , timeline_pid_(0)
+    , live_metrics_(nullptr)
+    , live_events_(0)
+    , executor_(nullptr)
+    , remote_misses_(false)
+    , outstanding_remote_reads_(0)
+    , next_sequence_(0)
+    , determinism_check_(false)
+    , batch_cycles_(false)
+    , coalescing_(false)
+    , last_event_cycle_(0) {
     // Initialize warp states
     warp_states_.resize(config.num_warps);
     for (auto& state : warp_states_) {
@@ -25,7 +109,23 @@ SimulationEngine::SimulationEngine(const SimConfig& config)
         state.thread_mask = 0xFFFFFFFF;  // All threads active initially
         state.active = true;
         state.last_active = 0;
+        state.pending_reads = 0;
+        state.wait_start = 0;
+    }
+
+    if (config.constant_cache_size > 0) {
+        constant_cache_ = std::make_unique<MemoryModel>(config.constant_cache_size,
+                                                        config.cache_line_size,
+                                                        config.memory_latency,
+                                                        &stats_registry_, "constant_cache");
     }
+    if (config.readonly_cache_size > 0) {
+        readonly_cache_ = std::make_unique<MemoryModel>(config.readonly_cache_size,
+                                                        config.cache_line_size,
+                                                        config.memory_latency,
+                                                        &stats_registry_, "readonly_cache");
+    }
+    register_statistics();
 
     // Reserve space for event queue and trace
     simulation_trace_.reserve(TRACE_RESERVE_SIZE);
@@ -33,103 +133,727 @@ SimulationEngine::SimulationEngine(const SimConfig& config)
 
 SimulationEngine::~SimulationEngine() {
     stop();
+    clear_event_queue();
+    for (auto& request : remote_requests_) {
+        delete request.trans;
+    }
 }
 
 void SimulationEngine::initialize() {
     // Reset simulation state
     current_time_ = 0;
     stats_ = SimStats{};
-    while (!event_queue_.empty()) {
-        event_queue_.pop();
-    }
+    stats_registry_.reset("engine");
+    latency_profile_.reset();
+    next_stats_dump_ = stats_interval_;
+    clear_event_queue();
     simulation_trace_.clear();
+    cycle_hashes_.clear();
+    next_sequence_ = 0;
+    last_event_cycle_ = 0;
+    for (auto& request : remote_requests_) {
+        delete request.trans;
+    }
+    remote_requests_.clear();
+    outstanding_remote_reads_ = 0;
 
     // Initialize memory model
     memory_model_->initialize();
+    for (MemoryModel* cache : {constant_cache_.get(), readonly_cache_.get()}) {
+        if (cache) {
+            cache->initialize();
+        }
+    }
+    constant_port_free_ = 0;
 
     // Schedule initial events
     for (uint32_t warp_id = 0; warp_id < config_.num_warps; ++warp_id) {
         schedule_event(EventType::INSTRUCTION_FETCH, 0, 
                       reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
     }
+    start_stats_interval();
+}
+
+void SimulationEngine::clear_event_queue() {
+    // Memory events own their transaction payloads
+    while (!event_queue_.empty()) {
+        const SimEvent& event = event_queue_.top();
+        if (event.type == EventType::MEMORY_REQUEST ||
+            event.type == EventType::MEMORY_RESPONSE) {
+            delete static_cast<MemoryTransaction*>(event.data);
+        }
+        event_queue_.pop();
+    }
+}
+
+void SimulationEngine::attach_program(std::shared_ptr<const MemoryImage> image) {
+    for (MemoryModel* cache : {constant_cache_.get(), readonly_cache_.get()}) {
+        if (cache) {
+            cache->attach_image(image);
+        }
+    }
+    memory_model_->attach_image(std::move(image));
+}
+
+void SimulationEngine::inject_trace(const std::vector<TraceRecord>& trace) {
+    // Warp IDs are folded onto this configuration's warps so one trace can
+    // drive engines with different warp counts
+    for (const auto& record : trace) {
+        auto* trans = new MemoryTransaction(record.trans);
+        trans->warp_id %= config_.num_warps;
+        schedule_event(EventType::MEMORY_REQUEST, record.time, trans);
+    }
+}
+
+void SimulationEngine::set_shared_memory(uint32_t base, uint32_t size) {
+    SimConfig requested = config_;
+    requested.shared_carveout = requested_carveout_;
+    apply_carveout(with_carveout(requested, size));
+    set_shared_window(base, size);
+}
+
+void SimulationEngine::set_shared_window(uint32_t base, uint32_t size) {
+    shared_base_ = base;
+    shared_size_ = size;
+}
+
+void SimulationEngine::set_carveout(uint32_t shared_size) {
+    SimConfig requested = config_;
+    requested.shared_carveout = shared_size;
+    apply_carveout(with_carveout(requested, 0));
+}
+
+uint32_t SimulationEngine::requested_carveout() const {
+    return requested_carveout_;
+}
+
+void SimulationEngine::apply_carveout(const SimConfig& carved) {
+    if (carved.cache_size != config_.cache_size) {
+        memory_model_->set_capacity(carved.cache_size);
+    }
+    config_ = carved;
+}
+
+Carveout SimulationEngine::carveout() const {
+    return Carveout{config_.unified_storage_size ? config_.shared_carveout : 0,
+                    config_.cache_size};
+}
+
+void SimulationEngine::set_executor(InstructionExecutor* executor) {
+    executor_ = executor;
+    for (uint32_t warp_id = 0; warp_id < config_.num_warps; ++warp_id) {
+        WarpState& warp = warp_states_[warp_id];
+        warp.pc = executor ? executor->entry_point() : 0;
+        warp.active = !executor || executor->starts_warp(warp_id);
+        warp.pending_reads = 0;
+    }
+
+    // Re-arm fetches so a slot launched later never has a stale one queued
+    std::vector<SimEvent> kept;
+    while (!event_queue_.empty()) {
+        if (event_queue_.top().type != EventType::INSTRUCTION_FETCH) {
+            kept.push_back(event_queue_.top());
+        }
+        event_queue_.pop();
+    }
+    for (const auto& event : kept) {
+        event_queue_.push(event);
+    }
+    for (uint32_t warp_id = 0; warp_id < config_.num_warps; ++warp_id) {
+        if (warp_states_[warp_id].active) {
+            schedule_event(EventType::INSTRUCTION_FETCH, 0,
+                          reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
+        }
+    }
+}
+
+void SimulationEngine::start_warp(uint32_t warp_id, uint32_t pc, SimTime time) {
+    if (warp_id >= config_.num_warps || warp_states_[warp_id].active) {
+        throw std::invalid_argument("Warp slot " + std::to_string(warp_id) + " is not idle");
+    }
+    if (time < current_time_) {
+        throw std::invalid_argument("Cannot launch a warp in the past");
+    }
+    WarpState& warp = warp_states_[warp_id];
+    warp.pc = pc;
+    warp.active = true;
+    warp.pending_reads = 0;
+    schedule_event(EventType::INSTRUCTION_FETCH, time - current_time_,
+                  reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
 }
 
 void SimulationEngine::run() {
     running_ = true;
 
+    if (batch_cycles_) {
+        run_batched(std::numeric_limits<SimTime>::max());
+    }
     while (running_ && !event_queue_.empty()) {
-        // Process next event
+        step();
+    }
+
+    // Final statistics update
+    update_statistics();
+    calculate_performance_metrics();
+    if (live_metrics_) {
+        publish_live_metrics();
+    }
+}
+
+bool SimulationEngine::run_until(SimTime end_time) {
+    running_ = true;
+
+    // The executor has answered the retirement that paused the last call;
+    // without new warps the run ends there, as it would have then
+    if (paused_) {
+        paused_ = false;
+        if (std::none_of(warp_states_.begin(), warp_states_.end(),
+                         [](const WarpState& w) { return w.active; })) {
+            running_ = false;
+        }
+    }
+
+    if (batch_cycles_) {
+        run_batched(end_time);
+    }
+    while (running_ && !paused_ && !event_queue_.empty() &&
+           event_queue_.top().time < end_time) {
+        step();
+    }
+
+    if (live_metrics_) {
+        publish_live_metrics();
+    }
+    return running_;
+}
+
+FastForwardResult SimulationEngine::fast_forward(const FastForwardConfig& ff) {
+    if (executor_) {
+        return fast_forward_executed(ff);
+    }
+    FastForwardResult result{0, 0, current_time_, false};
+
+    // Split the queue: trace traffic becomes a time-ordered functional
+    // stream, fetch chains are replaced by the warp loop below, and anything
+    // else is kept for the detailed phase
+    std::vector<SimEvent> memory_events;
+    std::vector<SimEvent> deferred;
+    while (!event_queue_.empty()) {
         SimEvent event = event_queue_.top();
         event_queue_.pop();
+        if (event.type == EventType::MEMORY_REQUEST) {
+            memory_events.push_back(event);
+        } else if (event.type == EventType::MEMORY_RESPONSE) {
+            delete static_cast<MemoryTransaction*>(event.data);  // No latency to wait out
+        } else if (event.type != EventType::INSTRUCTION_FETCH) {
+            deferred.push_back(event);
+        }
+    }
 
-        // Update simulation time
-        current_time_ = event.time;
+    // Every active warp issues once per fetch interval, as in detailed mode
+    constexpr SimTime FETCH_INTERVAL = 4;
+    SimTime time = current_time_;
+    size_t next_memory = 0;
+    bool done = false;
+    uint32_t stopped_warp = 0;    // Warps before it issued in the final cycle
 
-        // Process the event
-        process_event(event);
+    while (!done && time < MAX_SIMULATION_CYCLES) {
+        for (; next_memory < memory_events.size() &&
+               memory_events[next_memory].time <= time; ++next_memory) {
+            auto* trans = static_cast<MemoryTransaction*>(memory_events[next_memory].data);
+            bool shared = trans->address - shared_base_ < shared_size_;
+            if (ff.warm_caches && !shared) {
+                warm_access(*trans);
+            } else if (trans->is_write) {
+                memory_model_->functional_write(trans->address, trans->data);
+            }
+            delete trans;
+            result.memory_requests++;
+        }
+
+        bool any_active = false;
+        for (uint32_t warp_id = 0; warp_id < config_.num_warps; ++warp_id) {
+            WarpState& warp = warp_states_[warp_id];
+            if (!warp.active) {
+                continue;
+            }
+            any_active = true;
+            if (ff.max_instructions != 0 && result.instructions >= ff.max_instructions) {
+                done = true;
+                stopped_warp = warp_id;
+                break;
+            }
+            if (ff.stop_at_pc && warp.pc == ff.marker_pc) {
+                result.reached_marker = true;
+                done = true;
+                stopped_warp = warp_id;
+                break;
+            }
+
+            if (ff.warm_caches) {
+                uint32_t instruction;
+                if (!memory_model_->lookup_cache(warp.pc, instruction)) {
+                    memory_model_->warm(warp.pc, 0, false);
+                }
+            } else {
+                memory_model_->functional_read(warp.pc);
+            }
+            for (InstructionObserver* observer : instruction_observers_) {
+                observer->on_instruction(warp_id, warp.pc);
+            }
+            warp.pc += 4;
+            warp.last_active = time;
+            result.instructions++;
+        }
 
-        // Update statistics periodically
-        if (current_time_ % 1000 == 0) {
-            update_statistics();
+        if (!any_active) {
+            break;
         }
+        if (!done) {
+            time += FETCH_INTERVAL;
+        }
+    }
 
-        // Check for simulation end conditions
-        if (current_time_ >= 1000000 || // Maximum cycle limit
-            std::all_of(warp_states_.begin(), warp_states_.end(),
-                       [](const WarpState& w) { return !w.active; })) {
-            running_ = false;
+    // Hand over to detailed timing at the switch point
+    current_time_ = time;
+    last_event_cycle_ = time;
+    for (size_t i = next_memory; i < memory_events.size(); ++i) {
+        event_queue_.push(memory_events[i]);
+    }
+    for (const auto& event : deferred) {
+        event_queue_.push(event);
+    }
+    for (uint32_t warp_id = 0; warp_id < config_.num_warps; ++warp_id) {
+        if (warp_states_[warp_id].active) {
+            // A warp that already issued at the switch cycle waits its interval
+            SimTime delay = warp_id < stopped_warp ? FETCH_INTERVAL : 0;
+            schedule_event(EventType::INSTRUCTION_FETCH, delay,
+                           reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
         }
     }
 
-    // Final statistics update
+    result.end_time = time;
+    return result;
+}
+
+FastForwardResult SimulationEngine::fast_forward_executed(const FastForwardConfig& ff) {
+    FastForwardResult result{0, 0, current_time_, false};
+
+    // The executor applies an instruction's functional effect when it
+    // executes it, so requests and replies in flight only matter for
+    // warming. Warps waiting on reads resume at once, and warps that
+    // already exited retire before the loop.
+    std::vector<SimEvent> deferred;
+    std::vector<uint32_t> retiring;
+    while (!event_queue_.empty()) {
+        SimEvent event = event_queue_.top();
+        event_queue_.pop();
+        if (event.type == EventType::MEMORY_REQUEST) {
+            auto* trans = static_cast<MemoryTransaction*>(event.data);
+            if (ff.warm_caches) {
+                warm_access(*trans);
+            }
+            delete trans;
+            result.memory_requests++;
+        } else if (event.type == EventType::MEMORY_RESPONSE) {
+            delete static_cast<MemoryTransaction*>(event.data);
+        } else if (event.type == EventType::WARP_COMPLETE) {
+            retiring.push_back(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(event.data)));
+        } else if (event.type != EventType::INSTRUCTION_FETCH &&
+                   event.type != EventType::SIMULATION_END) {
+            deferred.push_back(event);
+        }
+    }
+    for (auto& warp : warp_states_) {
+        warp.pending_reads = 0;
+    }
+
+    auto retire = [&](uint32_t warp_id) {
+        if (warp_states_[warp_id].active) {
+            warp_states_[warp_id].active = false;
+            executor_->warp_retired(warp_id);   // May launch warps into free slots
+        }
+    };
+    for (uint32_t warp_id : retiring) {
+        retire(warp_id);
+    }
+
+    constexpr SimTime FETCH_INTERVAL = 4;
+    SimTime time = current_time_;
+    bool done = false;
+    uint32_t stopped_warp = 0;    // Warps before it issued in the final cycle
+
+    while (!done && time < MAX_SIMULATION_CYCLES) {
+        // Launches made by warp_retired() read the current cycle
+        current_time_ = time;
+        bool any_active = false;
+        for (uint32_t warp_id = 0; warp_id < config_.num_warps; ++warp_id) {
+            WarpState& warp = warp_states_[warp_id];
+            if (!warp.active) {
+                continue;
+            }
+            any_active = true;
+            if (ff.max_instructions != 0 && result.instructions >= ff.max_instructions) {
+                done = true;
+                stopped_warp = warp_id;
+                break;
+            }
+            if (ff.stop_at_pc && warp.pc == ff.marker_pc) {
+                result.reached_marker = true;
+                done = true;
+                stopped_warp = warp_id;
+                break;
+            }
+
+            executor_accesses_.clear();
+            ExecutionStep step = executor_->execute(warp_id, warp.pc, executor_accesses_);
+            if (step.status == ExecStatus::STALLED) {
+                continue;
+            }
+            if (ff.warm_caches) {
+                uint32_t instruction;
+                if (!memory_model_->lookup_cache(warp.pc, instruction)) {
+                    memory_model_->warm(warp.pc, 0, false);
+                }
+            }
+            for (InstructionObserver* observer : instruction_observers_) {
+                observer->on_instruction(warp_id, warp.pc);
+            }
+            for (const auto& access : executor_accesses_) {
+                if (ff.warm_caches) {
+                    warm_access(access);
+                }
+                result.memory_requests++;
+            }
+            warp.pc = step.next_pc;
+            warp.last_active = time;
+            result.instructions++;
+            if (step.status == ExecStatus::EXITED) {
+                retire(warp_id);
+            }
+        }
+
+        if (!any_active) {
+            break;
+        }
+        if (!done) {
+            time += FETCH_INTERVAL;
+        }
+    }
+
+    // Hand over to detailed timing at the switch point. Fetches queued by
+    // launches during the loop are re-armed below with the other warps.
+    current_time_ = time;
+    last_event_cycle_ = time;
+    while (!event_queue_.empty()) {
+        if (event_queue_.top().type != EventType::INSTRUCTION_FETCH) {
+            deferred.push_back(event_queue_.top());
+        }
+        event_queue_.pop();
+    }
+    for (const auto& event : deferred) {
+        event_queue_.push(event);
+    }
+    bool any_active = false;
+    for (uint32_t warp_id = 0; warp_id < config_.num_warps; ++warp_id) {
+        if (warp_states_[warp_id].active) {
+            SimTime delay = warp_id < stopped_warp ? FETCH_INTERVAL : 0;
+            schedule_event(EventType::INSTRUCTION_FETCH, delay,
+                           reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
+            any_active = true;
+        }
+    }
+    if (!any_active) {
+        schedule_event(EventType::SIMULATION_END, 1, nullptr);
+    }
+
+    result.end_time = time;
+    return result;
+}
+
+void SimulationEngine::warm_access(const MemoryTransaction& trans) {
+    // Same routing as process_memory_request, without timing
+    if (trans.address - shared_base_ < shared_size_) {
+        return;
+    }
+    MemoryModel* cache = memory_model_.get();
+    if (!trans.is_write && trans.space == MemorySpace::CONSTANT && constant_cache_) {
+        cache = constant_cache_.get();
+    } else if (!trans.is_write && trans.space == MemorySpace::READ_ONLY && readonly_cache_) {
+        cache = readonly_cache_.get();
+    }
+    cache->warm(trans.address, trans.data, trans.is_write);
+}
+
+bool SimulationEngine::run_instructions(uint64_t count) {
+    running_ = true;
+    uint64_t target = counters_.instructions.value() + count;
+    while (running_ && !event_queue_.empty() && counters_.instructions.value() < target) {
+        step();
+    }
+
+    update_statistics();
     calculate_performance_metrics();
+    if (live_metrics_) {
+        publish_live_metrics();
+    }
+    return running_;
+}
+
+void SimulationEngine::set_cycle_batching(bool enabled) {
+    batch_cycles_ = enabled;
+}
+
+void SimulationEngine::account_idle(SimTime cycle) {
+    if (cycle > last_event_cycle_) {
+        counters_.idle_cycles += cycle - last_event_cycle_ - 1;
+        last_event_cycle_ = cycle;
+    }
+}
+
+void SimulationEngine::run_batched(SimTime end_time) {
+    coalescing_ = true;
+
+    SimTime cycle;
+    while (running_ && !paused_ && next_batched_cycle(cycle) && cycle < end_time) {
+        step_cycle(cycle);
+    }
+
+    // Leave a plain event queue behind for everything outside this loop
+    flush_fetch_ring();
+    coalescing_ = false;
+}
+
+bool SimulationEngine::next_batched_cycle(SimTime& cycle) const {
+    bool found = !event_queue_.empty();
+    cycle = found ? event_queue_.top().time : 0;
+    for (const auto& bucket : fetch_ring_) {
+        if (!bucket.empty() && (!found || bucket.front().time < cycle)) {
+            cycle = bucket.front().time;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void SimulationEngine::step_cycle(SimTime cycle) {
+    account_idle(cycle);
+    current_time_ = cycle;
+    if (stats_interval_ && current_time_ >= next_stats_dump_) {
+        dump_stats_interval();
+    }
+
+    // Buckets fill in sequence order; sort by source to match the heap key
+    std::vector<SimEvent>& bucket = fetch_ring_[cycle % FETCH_RING_SIZE];
+    std::sort(bucket.begin(), bucket.end(),
+              [](const SimEvent& a, const SimEvent& b) { return b > a; });
+
+    // Drain every event due this cycle, merging heap and bucket by key, then
+    // run the per-cycle bookkeeping once. New fetches are at least one cycle
+    // out, so the bucket cannot grow while it is being drained.
+    size_t next = 0;
+    while (running_ && !paused_) {
+        bool heap_ready = !event_queue_.empty() && event_queue_.top().time == cycle;
+        bool bucket_ready = next < bucket.size();
+        if (!heap_ready && !bucket_ready) {
+            break;
+        }
+
+        SimEvent event;
+        {
+            GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::EVENT_POP);
+            if (bucket_ready && (!heap_ready || event_queue_.top() > bucket[next])) {
+                event = bucket[next++];
+            } else {
+                event = event_queue_.top();
+                event_queue_.pop();
+            }
+        }
+
+        if (determinism_check_) {
+            record_event_hash(event);
+        }
+        process_event(event);
+    }
+    for (; next < bucket.size(); ++next) {
+        event_queue_.push(bucket[next]);
+    }
+    bucket.clear();
+
+    if (cycle % 1000 == 0) {
+        update_statistics();
+    }
+
+    if (cycle >= MAX_SIMULATION_CYCLES ||
+        (!paused_ && std::all_of(warp_states_.begin(), warp_states_.end(),
+                                 [](const WarpState& w) { return !w.active; }))) {
+        running_ = false;
+    }
+}
+
+void SimulationEngine::flush_fetch_ring() {
+    for (auto& bucket : fetch_ring_) {
+        for (const auto& event : bucket) {
+            event_queue_.push(event);
+        }
+        bucket.clear();
+    }
+}
+
+void SimulationEngine::step() {
+    // Process next event
+    SimEvent event;
+    {
+        GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::EVENT_POP);
+        event = event_queue_.top();
+        event_queue_.pop();
+    }
+
+    // Update simulation time
+    account_idle(event.time);
+    current_time_ = event.time;
+    if (stats_interval_ && current_time_ >= next_stats_dump_) {
+        dump_stats_interval();
+    }
+
+    if (determinism_check_) {
+        record_event_hash(event);
+    }
+
+    // Process the event
+    process_event(event);
+
+    // Update statistics periodically
+    if (current_time_ % 1000 == 0) {
+        update_statistics();
+    }
+
+    // Check for simulation end conditions; a paused engine may get warps yet
+    if (current_time_ >= MAX_SIMULATION_CYCLES ||
+        (!paused_ && std::all_of(warp_states_.begin(), warp_states_.end(),
+                                 [](const WarpState& w) { return !w.active; }))) {
+        running_ = false;
+    }
 }
 
 void SimulationEngine::process_event(const SimEvent& event) {
     log_event(event);
+    if (live_metrics_ && ++live_events_ % LIVE_PUBLISH_EVENTS == 0) {
+        publish_live_metrics();
+    }
 
     switch (event.type) {
         case EventType::MEMORY_REQUEST: {
+            GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::EVENT_MEMORY_REQUEST);
             auto* trans = static_cast<MemoryTransaction*>(event.data);
             process_memory_request(trans);
             delete trans;
             break;
         }
         case EventType::MEMORY_RESPONSE: {
+            GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::EVENT_MEMORY_RESPONSE);
             auto* trans = static_cast<MemoryTransaction*>(event.data);
             process_memory_response(trans);
             delete trans;
             break;
         }
         case EventType::INSTRUCTION_FETCH: {
+            GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::EVENT_INSTRUCTION_FETCH);
             uint32_t warp_id = reinterpret_cast<uintptr_t>(event.data);
             process_instruction_fetch(warp_id);
             break;
         }
         case EventType::WARP_COMPLETE: {
+            GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::EVENT_WARP_COMPLETE);
             uint32_t warp_id = reinterpret_cast<uintptr_t>(event.data);
             process_warp_complete(warp_id);
             break;
         }
-        case EventType::SIMULATION_END:
-            running_ = false;
+        case EventType::SIMULATION_END: {
+            GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::EVENT_SIMULATION_END);
+            // Warps launched since the last one retired keep the run going
+            running_ = std::any_of(warp_states_.begin(), warp_states_.end(),
+                                   [](const WarpState& w) { return w.active; });
             break;
+        }
     }
 }
 
 void SimulationEngine::process_memory_request(const MemoryTransaction* trans) {
     // Update statistics
-    stats_.memory_requests++;
+    counters_.memory_requests++;
+
+    if (trans->address - shared_base_ < shared_size_) {
+        // Scratchpad: same SRAM as the L1, so its hit latency, and no misses
+        counters_.shared_accesses++;
+        uint32_t latency = memory_model_->min_access_latency();
+        if (trans->is_write) {
+            memory_model_->functional_write(trans->address, trans->data);
+            record_latency(MemoryLevel::L1, true, trans->warp_id, latency);
+        } else {
+            auto* response = new MemoryTransaction(*trans);
+            response->issue_time = current_time_;
+            response->level = MemoryLevel::L1;
+            schedule_event(EventType::MEMORY_RESPONSE, latency, response);
+        }
+        warp_states_[trans->warp_id].last_active = current_time_;
+        return;
+    }
+
+    // Constant and read-only loads sit outside the coherence domain: stores
+    // always go to the L1 and never update or invalidate those copies
+    MemoryModel* cache = memory_model_.get();
+    uint32_t port_wait = 0;
+    if (!trans->is_write && trans->space == MemorySpace::CONSTANT) {
+        // One fetch broadcasts to every lane in thread_mask; divergent
+        // addresses of the same load queue for the port one cycle apart
+        SimTime start = std::max(current_time_, constant_port_free_);
+        port_wait = static_cast<uint32_t>(start - current_time_);
+        constant_port_free_ = start + 1;
+        counters_.constant_fetches++;
+        counters_.constant_lanes += __builtin_popcount(trans->thread_mask);
+        counters_.constant_wait_cycles += port_wait;
+        if (constant_cache_) {
+            cache = constant_cache_.get();
+        }
+    } else if (!trans->is_write && trans->space == MemorySpace::READ_ONLY && readonly_cache_) {
+        cache = readonly_cache_.get();
+    }
 
     // Process through memory model
-    SimTime response_time = memory_model_->process_request(trans->address, 
-                                                         trans->data,
-                                                         trans->is_write);
+    MemoryResult result = trans->is_write || trans->space == MemorySpace::GLOBAL
+        ? memory_model_->access(trans->address, trans->data, trans->is_write)
+        : cache->read_noncoherent(trans->address);
+    result.latency += port_wait;
+    for (MemoryRequestObserver* observer : memory_observers_) {
+        observer->on_memory_request(*trans, result, current_time_);
+    }
 
-    // Schedule response event
-    if (!trans->is_write) {
+    MemoryLevel level = result.hit ? MemoryLevel::L1 : MemoryLevel::DRAM;
+    if (!result.hit && remote_misses_) {
+        // Forward the miss to the shared L2; reads are answered later and
+        // the L2 corrects the level if it misses too
+        auto* forwarded = new MemoryTransaction(*trans);
+        forwarded->issue_time = current_time_;
+        forwarded->level = MemoryLevel::L2;
+        remote_requests_.push_back({current_time_ + port_wait, forwarded});
+        if (!trans->is_write) {
+            outstanding_remote_reads_++;
+        }
+        level = MemoryLevel::L2;
+    } else if (!trans->is_write) {
+        // Schedule response event
         auto* response = new MemoryTransaction(*trans);
-        schedule_event(EventType::MEMORY_RESPONSE, response_time, response);
+        response->issue_time = current_time_;
+        response->level = level;
+        schedule_event(EventType::MEMORY_RESPONSE, result.latency, response);
+    }
+    if (trans->is_write) {
+        record_latency(level, true, trans->warp_id, result.latency);
+        if (timeline_) {
+            timeline_->memory_access(timeline_pid_, trans->warp_id, level, true,
+                                     current_time_, current_time_ + result.latency);
+        }
     }
 
     // Update warp state
@@ -137,10 +861,31 @@ void SimulationEngine::process_memory_request(const MemoryTransaction* trans) {
 }
 
 void SimulationEngine::process_memory_response(const MemoryTransaction* trans) {
+    if (trans->level != MemoryLevel::UNTRACKED) {
+        record_latency(trans->level, false, trans->warp_id,
+                                current_time_ - trans->issue_time);
+        if (timeline_) {
+            timeline_->memory_access(timeline_pid_, trans->warp_id, trans->level, false,
+                                     trans->issue_time, current_time_);
+        }
+    }
+
     // Notify RTL through DPI-C
     memory_request_callback(trans->address, trans->data, false, 
                           trans->warp_id, trans->thread_mask);
 
+    // An executed instruction resumes once all of its reads are back
+    WarpState& warp = warp_states_[trans->warp_id];
+    if (executor_ && warp.pending_reads > 0) {
+        if (--warp.pending_reads > 0) {
+            return;
+        }
+        if (timeline_) {
+            timeline_->span(timeline_pid_, trans->warp_id, "memory_wait",
+                            warp.wait_start, current_time_);
+        }
+    }
+
     // Schedule next instruction fetch
     schedule_event(EventType::INSTRUCTION_FETCH, 1, 
                   reinterpret_cast<void*>(static_cast<uintptr_t>(trans->warp_id)));
@@ -150,16 +895,26 @@ void SimulationEngine::process_instruction_fetch(uint32_t warp_id) {
     if (!warp_states_[warp_id].active) {
         return;
     }
+    if (executor_) {
+        execute_instruction(warp_id);
+        return;
+    }
 
     // Simulate instruction fetch and execution
     WarpState& warp = warp_states_[warp_id];
     uint32_t instruction = memory_model_->read_instruction(warp.pc);
     
     // Update statistics
-    stats_.instructions_executed++;
+    counters_.instructions++;
     
     // Notify RTL through DPI-C
     instruction_complete_callback(warp_id, warp.pc, instruction);
+    for (InstructionObserver* observer : instruction_observers_) {
+        observer->on_instruction(warp_id, warp.pc);
+    }
+    if (timeline_) {
+        timeline_->span(timeline_pid_, warp_id, "issue", current_time_, current_time_ + 1);
+    }
     
     // Update PC and schedule next instruction
     warp.pc += 4;
@@ -167,9 +922,63 @@ void SimulationEngine::process_instruction_fetch(uint32_t warp_id) {
                   reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
 }
 
+void SimulationEngine::execute_instruction(uint32_t warp_id) {
+    WarpState& warp = warp_states_[warp_id];
+    uint32_t pc = warp.pc;
+
+    executor_accesses_.clear();
+    ExecutionStep step = executor_->execute(warp_id, pc, executor_accesses_);
+    if (step.status == ExecStatus::STALLED) {
+        if (timeline_) {
+            timeline_->span(timeline_pid_, warp_id, "stall", current_time_, current_time_ + 4);
+        }
+        schedule_event(EventType::INSTRUCTION_FETCH, 4,
+                      reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
+        return;
+    }
+
+    uint32_t instruction = memory_model_->read_instruction(pc);
+    counters_.instructions++;
+    instruction_complete_callback(warp_id, pc, instruction);
+    for (InstructionObserver* observer : instruction_observers_) {
+        observer->on_instruction(warp_id, pc);
+    }
+    if (timeline_) {
+        timeline_->span(timeline_pid_, warp_id, "issue", current_time_, current_time_ + 1);
+    }
+    warp.pc = step.next_pc;
+    warp.last_active = current_time_;
+
+    if (step.status == ExecStatus::EXITED) {
+        schedule_event(EventType::WARP_COMPLETE, 1,
+                      reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
+        return;
+    }
+
+    // Memory instructions issue their transactions next cycle; the warp
+    // stalls on reads and keeps issuing past writes
+    uint32_t reads = 0;
+    for (const auto& access : executor_accesses_) {
+        auto* request = new MemoryTransaction(access);
+        request->pc = pc;
+        schedule_event(EventType::MEMORY_REQUEST, 1, request);
+        reads += !access.is_write;
+    }
+    warp.pending_reads = reads;
+    warp.wait_start = current_time_;
+    if (reads == 0) {
+        schedule_event(EventType::INSTRUCTION_FETCH, 4,
+                      reinterpret_cast<void*>(static_cast<uintptr_t>(warp_id)));
+    }
+}
+
 void SimulationEngine::process_warp_complete(uint32_t warp_id) {
+    bool retiring = warp_states_[warp_id].active;
     warp_states_[warp_id].active = false;
-    
+    if (executor_ && retiring) {
+        executor_->warp_retired(warp_id);   // May launch warps into free slots
+    }
+
     // Check if all warps are complete
     if (std::all_of(warp_states_.begin(), warp_states_.end(),
                     [](const WarpState& w) { return !w.active; })) {
@@ -181,11 +990,332 @@ void SimulationEngine::schedule_event(EventType type, SimTime delay, void* data)
     SimEvent event{
         .type = type,
         .time = current_time_ + delay,
-        .data = data
+        .data = data,
+        .priority = event_priority(type),
+        .source = event_source(type, data),
+        .sequence = next_sequence_++
     };
+    if (coalescing_ && type == EventType::INSTRUCTION_FETCH && delay > 0 &&
+        delay < FETCH_RING_SIZE) {
+        fetch_ring_[event.time % FETCH_RING_SIZE].push_back(event);
+        return;
+    }
     event_queue_.push(event);
 }
 
+EventPriority SimulationEngine::event_priority(EventType type) {
+    switch (type) {
+        case EventType::MEMORY_RESPONSE:   return EventPriority::RESPONSE;
+        case EventType::MEMORY_REQUEST:    return EventPriority::REQUEST;
+        case EventType::INSTRUCTION_FETCH: return EventPriority::FETCH;
+        case EventType::WARP_COMPLETE:     return EventPriority::COMPLETE;
+        default:                           return EventPriority::CONTROL;
+    }
+}
+
+uint32_t SimulationEngine::event_source(EventType type, const void* data) {
+    switch (type) {
+        case EventType::MEMORY_REQUEST:
+        case EventType::MEMORY_RESPONSE:
+            return data ? static_cast<const MemoryTransaction*>(data)->warp_id : 0;
+        case EventType::INSTRUCTION_FETCH:
+        case EventType::WARP_COMPLETE:
+            return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(data));
+        default:
+            return UINT32_MAX;
+    }
+}
+
+void SimulationEngine::save_checkpoint(const std::string& filename) const {
+    if (executor_) {
+        throw std::runtime_error("Cannot checkpoint executor state");
+    }
+    if (!remote_requests_.empty() || outstanding_remote_reads_ != 0) {
+        throw std::runtime_error("Cannot checkpoint with remote misses in flight");
+    }
+
+    CheckpointWriter writer;
+
+    writer.begin_section(SECTION_ENGINE);
+    writer.put(config_.num_warps);
+    writer.put(static_cast<uint32_t>(running_));
+    writer.put(current_time_);
+    writer.put(next_sequence_);
+    writer.put(constant_port_free_);
+    writer.put(get_statistics());
+    writer.put(counters_.constant_fetches.value());
+    writer.put(counters_.constant_lanes.value());
+    writer.put(counters_.constant_wait_cycles.value());
+    writer.put(counters_.shared_accesses.value());
+    writer.put(shared_base_);
+    writer.put(shared_size_);
+    writer.put(config_.shared_carveout);
+    writer.end_section();
+
+    writer.begin_section(SECTION_WARPS);
+    for (const auto& warp : warp_states_) {
+        writer.put(WarpRecord{warp.last_active, warp.pc, warp.thread_mask,
+                              static_cast<uint8_t>(warp.active), {}});
+    }
+    writer.end_section();
+
+    // Events are written in pop order; restore pushes them back with their
+    // original sequence numbers so the replay order is unchanged
+    auto pending = event_queue_;
+    writer.begin_section(SECTION_EVENTS);
+    writer.put(static_cast<uint64_t>(pending.size()));
+    while (!pending.empty()) {
+        const SimEvent& event = pending.top();
+        EventRecord record{};
+        record.time = event.time;
+        record.sequence = event.sequence;
+        record.type = static_cast<uint32_t>(event.type);
+        record.source = event.source;
+        if (event.data && (event.type == EventType::MEMORY_REQUEST ||
+                           event.type == EventType::MEMORY_RESPONSE)) {
+            auto* trans = static_cast<const MemoryTransaction*>(event.data);
+            record.has_transaction = 1;
+            record.address = trans->address;
+            record.data = trans->data;
+            record.is_write = trans->is_write;
+            record.size = trans->size;
+            record.thread_mask = trans->thread_mask;
+            record.pc = trans->pc;
+            record.space = static_cast<uint8_t>(trans->space);
+            record.level = static_cast<uint8_t>(trans->level);
+            record.issue_time = trans->issue_time;
+        }
+        writer.put(record);
+        pending.pop();
+    }
+    writer.end_section();
+
+    memory_model_->save_state(writer, SECTION_CACHE, SECTION_MEMORY);
+    if (constant_cache_) {
+        constant_cache_->save_state(writer, SECTION_CONSTANT_CACHE, SECTION_CONSTANT_MEMORY);
+    }
+    if (readonly_cache_) {
+        readonly_cache_->save_state(writer, SECTION_READONLY_CACHE, SECTION_READONLY_MEMORY);
+    }
+    writer.write_file(filename);
+}
+
+void SimulationEngine::restore_checkpoint(const std::string& filename) {
+    CheckpointReader reader(filename);
+
+    SectionReader engine = reader.section(SECTION_ENGINE);
+    if (engine.get<uint32_t>() != config_.num_warps) {
+        throw std::runtime_error("Checkpoint warp count does not match this engine");
+    }
+    bool running = engine.get<uint32_t>() != 0;
+    SimTime current_time = engine.get<SimTime>();
+    uint64_t next_sequence = engine.get<uint64_t>();
+    SimTime constant_port_free = engine.get<SimTime>();
+    SimStats stats = engine.get<SimStats>();
+    uint64_t constant_fetches = engine.get<uint64_t>();
+    uint64_t constant_lanes = engine.get<uint64_t>();
+    uint64_t constant_wait_cycles = engine.get<uint64_t>();
+    uint64_t shared_accesses = engine.get<uint64_t>();
+    uint32_t shared_base = engine.get<uint32_t>();
+    uint32_t shared_size = engine.get<uint32_t>();
+    uint32_t shared_carveout = engine.get<uint32_t>();
+
+    // Memory first: it validates cache geometry before engine state changes.
+    // The carveout sizes the L1, so it is applied just before.
+    if (reader.has_section(SECTION_CONSTANT_CACHE) != (constant_cache_ != nullptr) ||
+        reader.has_section(SECTION_READONLY_CACHE) != (readonly_cache_ != nullptr)) {
+        throw std::runtime_error("Checkpoint constant/read-only caches do not match this engine");
+    }
+    set_carveout(shared_carveout);
+    memory_model_->restore_state(reader, SECTION_CACHE, SECTION_MEMORY);
+    if (constant_cache_) {
+        constant_cache_->restore_state(reader, SECTION_CONSTANT_CACHE, SECTION_CONSTANT_MEMORY);
+    }
+    if (readonly_cache_) {
+        readonly_cache_->restore_state(reader, SECTION_READONLY_CACHE, SECTION_READONLY_MEMORY);
+    }
+
+    clear_event_queue();
+    simulation_trace_.clear();
+    cycle_hashes_.clear();
+    for (auto& request : remote_requests_) {
+        delete request.trans;
+    }
+    remote_requests_.clear();
+    outstanding_remote_reads_ = 0;
+    constant_port_free_ = constant_port_free;
+
+    running_ = running;
+    paused_ = false;
+    current_time_ = current_time;
+    last_event_cycle_ = current_time;
+    next_sequence_ = next_sequence;
+    stats_ = stats;
+    counters_.instructions.set(stats.instructions_executed);
+    counters_.memory_requests.set(stats.memory_requests);
+    counters_.idle_cycles.set(stats.idle_cycles);
+    counters_.constant_fetches.set(constant_fetches);
+    counters_.constant_lanes.set(constant_lanes);
+    counters_.constant_wait_cycles.set(constant_wait_cycles);
+    counters_.shared_accesses.set(shared_accesses);
+    set_shared_window(shared_base, shared_size);
+    latency_profile_.reset();
+
+    SectionReader warps = reader.section(SECTION_WARPS);
+    for (auto& warp : warp_states_) {
+        WarpRecord record = warps.get<WarpRecord>();
+        warp.pc = record.pc;
+        warp.thread_mask = record.thread_mask;
+        warp.active = record.active != 0;
+        warp.last_active = record.last_active;
+        warp.pending_reads = 0;
+    }
+
+    SectionReader events = reader.section(SECTION_EVENTS);
+    uint64_t count = events.get<uint64_t>();
+    for (uint64_t i = 0; i < count; ++i) {
+        EventRecord record = events.get<EventRecord>();
+        auto type = static_cast<EventType>(record.type);
+
+        void* data = nullptr;
+        if (record.has_transaction) {
+            auto* trans = new MemoryTransaction{record.address, record.data,
+                                                record.is_write != 0, record.size,
+                                                record.source, record.thread_mask};
+            trans->pc = record.pc;
+            trans->space = static_cast<MemorySpace>(record.space);
+            trans->issue_time = record.issue_time;
+            trans->level = static_cast<MemoryLevel>(record.level);
+            data = trans;
+        } else if (type == EventType::INSTRUCTION_FETCH ||
+                   type == EventType::WARP_COMPLETE) {
+            data = reinterpret_cast<void*>(static_cast<uintptr_t>(record.source));
+        }
+
+        event_queue_.push(SimEvent{type, record.time, data, event_priority(type),
+                                   record.source, record.sequence});
+    }
+    start_stats_interval();
+}
+
+void SimulationEngine::add_instruction_observer(InstructionObserver* observer) {
+    instruction_observers_.push_back(observer);
+}
+
+void SimulationEngine::remove_instruction_observer(InstructionObserver* observer) {
+    instruction_observers_.erase(std::remove(instruction_observers_.begin(),
+                                             instruction_observers_.end(), observer),
+                                 instruction_observers_.end());
+}
+
+void SimulationEngine::set_timeline(TimelineTrace* timeline, uint32_t pid) {
+    timeline_ = timeline;
+    timeline_pid_ = pid;
+}
+
+void SimulationEngine::set_live_metrics(LiveMetrics* metrics) {
+    live_metrics_ = metrics;
+    live_events_ = 0;
+    if (live_metrics_) {
+        publish_live_metrics();
+    }
+}
+
+void SimulationEngine::publish_live_metrics() {
+    // Only this thread's counters are read; the server sees the copy
+    size_t queued = event_queue_.size();
+    for (const auto& bucket : fetch_ring_) {
+        queued += bucket.size();
+    }
+    auto [hits, misses] = memory_model_->get_cache_stats();
+    LiveSnapshot snapshot{};
+    snapshot.cycles = current_time_;
+    snapshot.instructions = counters_.instructions.value();
+    snapshot.memory_requests = counters_.memory_requests.value();
+    snapshot.cache_hits = hits;
+    snapshot.cache_misses = misses;
+    snapshot.events = live_events_;
+    snapshot.queue_depth = queued;
+    snapshot.published_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    snapshot.running = running_;
+    live_metrics_->publish(snapshot);
+}
+
+void SimulationEngine::add_memory_observer(MemoryRequestObserver* observer) {
+    memory_observers_.push_back(observer);
+}
+
+void SimulationEngine::remove_memory_observer(MemoryRequestObserver* observer) {
+    memory_observers_.erase(std::remove(memory_observers_.begin(),
+                                        memory_observers_.end(), observer),
+                            memory_observers_.end());
+}
+
+void SimulationEngine::set_determinism_check(bool enabled) {
+    determinism_check_ = enabled;
+}
+
+const std::vector<CycleHash>& SimulationEngine::cycle_hashes() const {
+    return cycle_hashes_;
+}
+
+void SimulationEngine::record_event_hash(const SimEvent& event) {
+    // FNV-1a over the event's observable content (never its pointer)
+    auto mix = [](uint64_t hash, uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    };
+
+    if (cycle_hashes_.empty() || cycle_hashes_.back().cycle != event.time) {
+        cycle_hashes_.push_back({event.time, 0xcbf29ce484222325ULL});
+    }
+
+    uint64_t hash = cycle_hashes_.back().hash;
+    hash = mix(hash, static_cast<uint64_t>(event.type));
+    hash = mix(hash, event.source);
+    if (event.data && (event.type == EventType::MEMORY_REQUEST ||
+                       event.type == EventType::MEMORY_RESPONSE)) {
+        auto* trans = static_cast<const MemoryTransaction*>(event.data);
+        hash = mix(hash, trans->address);
+        hash = mix(hash, trans->data);
+        hash = mix(hash, trans->is_write);
+    }
+    cycle_hashes_.back().hash = hash;
+}
+
+bool SimulationEngine::has_pending_events() const {
+    return !event_queue_.empty();
+}
+
+SimTime SimulationEngine::next_event_time() const {
+    return event_queue_.empty() ? current_time_ : event_queue_.top().time;
+}
+
+void SimulationEngine::set_remote_misses(bool enabled) {
+    remote_misses_ = enabled;
+}
+
+std::vector<SimulationEngine::RemoteRequest>& SimulationEngine::remote_requests() {
+    return remote_requests_;
+}
+
+void SimulationEngine::deliver_response(SimTime time, MemoryTransaction* trans) {
+    assert(time >= current_time_ && "Remote response cannot arrive in the past");
+    assert(outstanding_remote_reads_ > 0 && "Unexpected remote response");
+
+    outstanding_remote_reads_--;
+    schedule_event(EventType::MEMORY_RESPONSE, time - current_time_, trans);
+}
+
+uint32_t SimulationEngine::outstanding_remote_reads() const {
+    return outstanding_remote_reads_;
+}
+
 void SimulationEngine::update_statistics() {
     stats_.total_cycles = current_time_;
     
@@ -195,7 +1325,7 @@ void SimulationEngine::update_statistics() {
 }
 
 void SimulationEngine::calculate_performance_metrics() {
-    stats_.ipc = static_cast<double>(stats_.instructions_executed) / 
+    stats_.ipc = static_cast<double>(counters_.instructions.value()) / 
                  static_cast<double>(stats_.total_cycles);
     
     stats_.cache_hit_rate = static_cast<double>(stats_.cache_hits) /
@@ -203,21 +1333,176 @@ void SimulationEngine::calculate_performance_metrics() {
 }
 
 SimStats SimulationEngine::get_statistics() const {
-    return stats_;
+    SimStats stats = stats_;
+    stats.instructions_executed = counters_.instructions.value();
+    stats.memory_requests = counters_.memory_requests.value();
+    stats.idle_cycles = counters_.idle_cycles.value();
+    return stats;
 }
 
 void SimulationEngine::print_statistics() const {
+    SimStats stats = get_statistics();
     std::cout << "\nSimulation Statistics:\n"
               << "=====================\n"
-              << "Total Cycles: " << stats_.total_cycles << "\n"
-              << "Instructions Executed: " << stats_.instructions_executed << "\n"
-              << "IPC: " << std::fixed << std::setprecision(2) << stats_.ipc << "\n"
-              << "Memory Requests: " << stats_.memory_requests << "\n"
+              << "Total Cycles: " << stats.total_cycles << "\n"
+              << "Instructions Executed: " << stats.instructions_executed << "\n"
+              << "IPC: " << std::fixed << std::setprecision(2) << stats.ipc << "\n"
+              << "Memory Requests: " << stats.memory_requests << "\n"
+              << "Idle Cycles: " << stats.idle_cycles << "\n"
               << "Cache Hit Rate: " << std::fixed << std::setprecision(2) 
-              << (stats_.cache_hit_rate * 100.0) << "%\n";
+              << (stats.cache_hit_rate * 100.0) << "%\n";
+    if (config_.unified_storage_size > 0) {
+        std::cout << "Unified Storage: " << config_.unified_storage_size << " bytes, "
+                  << config_.shared_carveout << " shared / " << config_.cache_size << " L1\n";
+    }
+    if (counters_.shared_accesses.value() > 0) {
+        std::cout << "Shared Memory Accesses: " << counters_.shared_accesses.value() << "\n";
+    }
+    uint64_t fetches = counters_.constant_fetches.value();
+    if (fetches > 0) {
+        // Broadcast efficiency: lanes per fetch, 32 for a warp-uniform load
+        std::cout << "Constant Fetches: " << fetches << ", "
+                  << static_cast<double>(counters_.constant_lanes.value()) / fetches
+                  << " lanes/fetch, " << counters_.constant_wait_cycles.value()
+                  << " cycles queued at the port\n";
+    }
+    for (const MemoryModel* cache : {constant_cache_.get(), readonly_cache_.get()}) {
+        CacheStats cache_stats = cache ? cache->get_cache_statistics() : CacheStats{};
+        if (cache_stats.hits + cache_stats.misses > 0) {
+            std::cout << (cache == constant_cache_.get() ? "Constant" : "Read-Only")
+                      << " Cache Hit Rate: "
+                      << cache_stats.hits * 100.0 / (cache_stats.hits + cache_stats.misses)
+                      << "%\n";
+        }
+    }
+    if (latency_profile_.total().count() > 0) {
+        latency_profile_.print(std::cout);
+    }
+    if (utils::HostProfiler::enabled()) {
+        utils::HostProfiler::instance().print(std::cout);
+    }
+}
+
+StatsRegistry& SimulationEngine::stats_registry() {
+    return stats_registry_;
+}
+
+const MemoryLatencyProfile& SimulationEngine::latency_profile() const {
+    return latency_profile_;
+}
+
+void SimulationEngine::register_statistics() {
+    StatGroup engine = stats_registry_.group("engine");
+    counters_.instructions = engine.counter("instructions", "Instructions executed");
+    counters_.memory_requests = engine.counter("memory_requests", "Memory requests issued");
+    counters_.idle_cycles = engine.counter("idle_cycles", "Cycles in which no event was due");
+    counters_.constant_fetches = engine.counter("constant_fetches",
+                                                "Constant cache fetches (one per distinct address)");
+    counters_.constant_lanes = engine.counter("constant_lanes",
+                                              "Lanes served by constant cache fetches");
+    counters_.constant_wait_cycles = engine.counter("constant_wait_cycles",
+                                                    "Cycles constant fetches waited for the port");
+    counters_.shared_accesses = engine.counter("shared_accesses",
+                                               "Requests served by shared memory");
+
+    engine.formula("cycles", "Cycles covered (the run, or one interval)", [this]() {
+        return static_cast<double>(current_time_ - stats_epoch_);
+    });
+    engine.formula("ipc", "Instructions per cycle", [this]() {
+        SimTime cycles = current_time_ - stats_epoch_;
+        return cycles ? static_cast<double>(counters_.instructions.value()) / cycles : 0.0;
+    });
+    engine.formula("constant_broadcast", "Lanes served per constant fetch", [this]() {
+        uint64_t fetches = counters_.constant_fetches.value();
+        return fetches ? static_cast<double>(counters_.constant_lanes.value()) / fetches : 0.0;
+    });
+
+    // Tail latency; the histograms themselves are too large for slots
+    StatGroup latency = stats_registry_.group("latency");
+    using Select = const LatencyHistogram& (*)(const MemoryLatencyProfile&);
+    auto add_percentiles = [&](const std::string& scope, Select select) {
+        StatGroup group = latency.group(scope);
+        group.formula("mean", "Mean cycles", [this, select]() {
+            return select(*reported_latency_).mean();
+        });
+        group.formula("p50", "Median cycles", [this, select]() {
+            return static_cast<double>(select(*reported_latency_).percentile(50.0));
+        });
+        group.formula("p99", "99th percentile cycles", [this, select]() {
+            return static_cast<double>(select(*reported_latency_).percentile(99.0));
+        });
+        group.formula("p999", "99.9th percentile cycles", [this, select]() {
+            return static_cast<double>(select(*reported_latency_).percentile(99.9));
+        });
+    };
+    add_percentiles("all", [](const MemoryLatencyProfile& p) -> const LatencyHistogram& {
+        return p.total();
+    });
+    add_percentiles(MemoryLatencyProfile::level_name(MemoryLevel::L1),
+                    [](const MemoryLatencyProfile& p) -> const LatencyHistogram& {
+                        return p.level(MemoryLevel::L1);
+                    });
+    add_percentiles(MemoryLatencyProfile::level_name(MemoryLevel::L2),
+                    [](const MemoryLatencyProfile& p) -> const LatencyHistogram& {
+                        return p.level(MemoryLevel::L2);
+                    });
+    add_percentiles(MemoryLatencyProfile::level_name(MemoryLevel::DRAM),
+                    [](const MemoryLatencyProfile& p) -> const LatencyHistogram& {
+                        return p.level(MemoryLevel::DRAM);
+                    });
+    add_percentiles("reads", [](const MemoryLatencyProfile& p) -> const LatencyHistogram& {
+        return p.reads();
+    });
+    add_percentiles("writes", [](const MemoryLatencyProfile& p) -> const LatencyHistogram& {
+        return p.writes();
+    });
+}
+
+void SimulationEngine::set_stats_interval(SimTime interval, std::ostream* out) {
+    if (interval > 0 && !out) {
+        throw std::invalid_argument("Interval statistics need an output stream");
+    }
+    stats_interval_ = interval;
+    stats_out_ = interval > 0 ? out : nullptr;
+    next_stats_dump_ = current_time_ + interval;
+    if (stats_out_) {
+        stats_registry_.write_csv_header(*stats_out_);
+    }
+    start_stats_interval();
+}
+
+void SimulationEngine::start_stats_interval() {
+    interval_base_ = stats_registry_.snapshot();
+    interval_latency_.reset();
+    interval_start_ = current_time_;
+}
+
+void SimulationEngine::dump_stats_interval() {
+    // One row per elapsed boundary; cycles without events may skip several
+    while (current_time_ >= next_stats_dump_) {
+        stats_epoch_ = interval_start_;
+        reported_latency_ = &interval_latency_;
+        stats_registry_.write_csv_row(*stats_out_, next_stats_dump_, interval_base_);
+        stats_epoch_ = 0;
+        reported_latency_ = &latency_profile_;
+
+        interval_base_ = stats_registry_.snapshot();
+        interval_latency_.reset();
+        interval_start_ = next_stats_dump_;
+        next_stats_dump_ += stats_interval_;
+    }
+}
+
+void SimulationEngine::record_latency(MemoryLevel level, bool is_write, uint32_t warp_id,
+                                      uint64_t latency) {
+    latency_profile_.record(level, is_write, warp_id, latency);
+    if (stats_interval_) {
+        interval_latency_.record(level, is_write, warp_id, latency);
+    }
 }
 
 void SimulationEngine::dump_trace(const std::string& filename) const {
+    GPUSIM_PROFILE_SCOPE_ALWAYS(utils::ProfilePhase::TRACE_WRITE);
     std::ofstream trace_file(filename);
     if (!trace_file) {
         std::cerr << "Error: Could not open trace file: " << filename << "\n";
@@ -235,6 +1520,7 @@ void SimulationEngine::dump_trace(const std::string& filename) const {
 }
 
 void SimulationEngine::log_event(const SimEvent& event) {
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::TRACE_WRITE);
     if (simulation_trace_.size() < TRACE_RESERVE_SIZE) {
         TraceEntry entry{
             .time = event.time,
@@ -270,19 +1556,14 @@ void SimulationEngine::log_event(const SimEvent& event) {
 void SimulationEngine::memory_request_callback(uint32_t address, uint32_t data,
                                              bool is_write, uint32_t warp_id,
                                              uint32_t thread_mask) {
-    // Create new memory transaction
-    auto* trans = new MemoryTransaction{
-        .address = address,
-        .data = data,
-        .is_write = is_write,
-        .size = 4,  // Assuming 32-bit access
-        .warp_id = warp_id,
-        .thread_mask = thread_mask
-    };
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
 
-    // Get singleton instance and schedule event
+    // Get singleton instance and schedule event; without an RTL side there
+    // is no one to hand a transaction to, so none is allocated
     static SimulationEngine* instance = nullptr;
     if (instance) {
+        // 32-bit access
+        auto* trans = new MemoryTransaction{address, data, is_write, 4, warp_id, thread_mask};
         instance->schedule_event(EventType::MEMORY_REQUEST, 1, trans);
     }
 }
@@ -290,6 +1571,7 @@ void SimulationEngine::memory_request_callback(uint32_t address, uint32_t data,
 void SimulationEngine::instruction_complete_callback(uint32_t warp_id,
                                                    uint32_t pc,
                                                    uint32_t instruction) {
+    GPUSIM_PROFILE_SCOPE(utils::ProfilePhase::DPI);
     static SimulationEngine* instance = nullptr;
     if (instance) {
         // Update warp state
@@ -361,8 +1643,17 @@ void SimulationEngine::verify_memory_consistency() const {
     }
 }
 
+void SimulationEngine::pause() {
+    paused_ = true;
+}
+
+bool SimulationEngine::paused() const {
+    return paused_;
+}
+
 void SimulationEngine::stop() {
     running_ = false;
+    update_statistics();
     calculate_performance_metrics();
 }
 
@@ -370,4 +1661,24 @@ bool SimulationEngine::is_running() const {
     return running_;
 }
 
+SimTime SimulationEngine::get_current_time() const {
+    return current_time_;
+}
+
+const SimConfig& SimulationEngine::get_config() const {
+    return config_;
+}
+
+MemoryModel& SimulationEngine::memory_model() {
+    return *memory_model_;
+}
+
+MemoryModel* SimulationEngine::constant_cache() {
+    return constant_cache_.get();
+}
+
+MemoryModel* SimulationEngine::readonly_cache() {
+    return readonly_cache_.get();
+}
+
 } // namespace gpu_simulator
\ No newline at end of file
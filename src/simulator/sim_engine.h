@@ -9,16 +9,29 @@
 #include <functional>
 #include <unordered_map>
 #include <string>
+#include <ostream>
 #include "memory_model.h"
+#include "stats_registry.h"
+#include "latency_histogram.h"
+#include "unified_storage.h"
 
 namespace gpu_simulator {
 
 // Forward declarations
 class MemoryModel;
+class TimelineTrace;
+class LiveMetrics;
 
 // Simulation time
 using SimTime = uint64_t;
 
+// Path a memory transaction takes into the SM
+enum class MemorySpace : uint8_t {
+    GLOBAL,         // L1 data cache
+    CONSTANT,       // Constant cache; one fetch broadcasts to thread_mask
+    READ_ONLY       // Non-coherent read-only cache; stores never update it
+};
+
 // Memory transaction types
 struct MemoryTransaction {
     uint32_t address;
@@ -27,6 +40,18 @@ struct MemoryTransaction {
     uint32_t size;
     uint32_t warp_id;
     uint32_t thread_mask;
+    uint32_t pc = 0;          // Issuing instruction (0 when unknown)
+    MemorySpace space = MemorySpace::GLOBAL;
+
+    // Filled in by the memory system for latency accounting
+    SimTime     issue_time = 0;
+    MemoryLevel level = MemoryLevel::UNTRACKED;
+};
+
+// Timestamped memory transaction for trace-driven workloads
+struct TraceRecord {
+    SimTime           time;
+    MemoryTransaction trans;
 };
 
 // Event types for simulation
@@ -38,18 +63,104 @@ enum class EventType {
     SIMULATION_END
 };
 
+// Tie-break class for events due in the same cycle (lower runs first)
+enum class EventPriority : uint8_t {
+    RESPONSE = 0,   // Data returning to a warp
+    REQUEST  = 1,   // New memory traffic
+    FETCH    = 2,   // Instruction issue
+    COMPLETE = 3,   // Warp retirement
+    CONTROL  = 4    // Simulation control
+};
+
 // Simulation event structure
 struct SimEvent {
-    EventType type;
-    SimTime   time;
-    void*     data;
-    
-    // Comparison operator for priority queue
+    EventType     type;
+    SimTime       time;
+    void*         data;
+    EventPriority priority;
+    uint32_t      source;     // Originating component (warp ID)
+    uint64_t      sequence;   // Scheduling order within the engine
+
+    // Comparison operator for priority queue. The full key makes the pop
+    // order independent of heap layout, so same-cycle events replay
+    // identically however they were produced.
     bool operator>(const SimEvent& other) const {
-        return time > other.time;
+        if (time != other.time) return time > other.time;
+        if (priority != other.priority) return priority > other.priority;
+        if (source != other.source) return source > other.source;
+        return sequence > other.sequence;
     }
 };
 
+// Digest of all events processed in one cycle (determinism checking)
+struct CycleHash {
+    SimTime  cycle;
+    uint64_t hash;
+};
+
+// Fast-forward (functional) execution ahead of a detailed region
+struct FastForwardConfig {
+    uint64_t max_instructions;   // Switch after this many instructions (0 = no limit)
+    bool     stop_at_pc;
+    uint32_t marker_pc;          // Switch when any warp is about to execute this PC
+    bool     warm_caches;        // Keep cache contents and LRU order up to date
+};
+
+struct FastForwardResult {
+    uint64_t instructions;
+    uint64_t memory_requests;
+    SimTime  end_time;
+    bool     reached_marker;
+};
+
+// Receives every executed instruction, detailed or fast-forwarded
+class InstructionObserver {
+public:
+    virtual ~InstructionObserver() = default;
+    virtual void on_instruction(uint32_t warp_id, uint32_t pc) = 0;
+};
+
+// Receives every timed memory request the engine sends to its cache, with
+// the cache's answer, at the cycle it is issued
+class MemoryRequestObserver {
+public:
+    virtual ~MemoryRequestObserver() = default;
+    virtual void on_memory_request(const MemoryTransaction& request,
+                                   const MemoryResult& result, SimTime time) = 0;
+};
+
+// Outcome of executing one warp instruction
+enum class ExecStatus {
+    ISSUED,     // Executed; the warp continues at next_pc
+    STALLED,    // Not executed (e.g. waiting at a barrier); retry later
+    EXITED      // Executed and the warp has no live threads left
+};
+
+struct ExecutionStep {
+    ExecStatus status;
+    uint32_t   next_pc;
+};
+
+// Functional core for execution-driven runs: it decides what each fetched
+// instruction does, the engine models when it happens
+class InstructionExecutor {
+public:
+    virtual ~InstructionExecutor() = default;
+    virtual uint32_t entry_point() const = 0;
+
+    // Execute warp_id's instruction at pc. Memory traffic it causes is
+    // appended to accesses; the warp waits until every read is answered.
+    virtual ExecutionStep execute(uint32_t warp_id, uint32_t pc,
+                                  std::vector<MemoryTransaction>& accesses) = 0;
+
+    // Warp slots that start with the run; the others stay idle until
+    // launched with SimulationEngine::start_warp()
+    virtual bool starts_warp(uint32_t warp_id) const { (void)warp_id; return true; }
+
+    // Called when warp_id retires; may launch warps into free slots
+    virtual void warp_retired(uint32_t warp_id) { (void)warp_id; }
+};
+
 // Configuration structure
 struct SimConfig {
     uint32_t num_warps;
@@ -58,9 +169,19 @@ struct SimConfig {
     uint32_t cache_line_size;
     uint32_t memory_latency;
     std::string trace_file;
+    uint32_t constant_cache_size = 8192;    // Bytes (0 = constant loads use the L1)
+    uint32_t readonly_cache_size = 16384;   // Bytes (0 = read-only loads use the L1)
+
+    // Unified L1 / shared-memory SRAM: when set, cache_size is replaced by
+    // what the shared-memory carveout leaves (see UnifiedStorage)
+    uint32_t unified_storage_size = 0;      // Bytes (0 = cache_size is the L1)
+    uint32_t shared_carveout = AUTO_CARVEOUT;
+
+    // Smallest carveout that holds the kernel's shared memory
+    static constexpr uint32_t AUTO_CARVEOUT = UINT32_MAX;
 };
 
-// Statistics collection
+// Statistics snapshot (the live counters are in the engine's StatsRegistry)
 struct SimStats {
     uint64_t total_cycles;
     uint64_t instructions_executed;
@@ -69,6 +190,7 @@ struct SimStats {
     uint64_t cache_misses;
     double   ipc;
     double   cache_hit_rate;
+    uint64_t idle_cycles;       // Cycles in which no event was due
 };
 
 class SimulationEngine {
@@ -84,12 +206,65 @@ public:
     // Core simulation methods
     void initialize();
     void run();
+    bool run_until(SimTime end_time);
+    bool run_instructions(uint64_t count);
+    void set_cycle_batching(bool enabled);
+    FastForwardResult fast_forward(const FastForwardConfig& ff);
     void stop();
     bool is_running() const;
 
+    // Make run_until() return once the current event is processed, before
+    // the engine decides whether warps are left; an executor calls this from
+    // warp_retired() to launch warps later at the cycle it retired in. The
+    // next run_until() resumes where this one stopped.
+    void pause();
+    bool paused() const;
+
+    // Workload loading
+    void attach_program(std::shared_ptr<const MemoryImage> image);
+    void inject_trace(const std::vector<TraceRecord>& trace);
+
+    // Execution-driven mode (executor not owned; set after initialize()).
+    // Warps the executor starts begin at its entry point and retire when it
+    // reports them exited. Checkpoints are trace-mode only.
+    void set_executor(InstructionExecutor* executor);
+
+    // Launch an idle warp slot at pc; its first fetch is at cycle time,
+    // which must not be in the past
+    void start_warp(uint32_t warp_id, uint32_t pc, SimTime time);
+
     // Event management
     void schedule_event(EventType type, SimTime delay, void* data = nullptr);
     void process_event(const SimEvent& event);
+    bool has_pending_events() const;
+    SimTime next_event_time() const;
+
+    // Kernel shared memory: accesses in [base, base + size) are served by
+    // the on-chip scratchpad at L1 hit latency and never touch the L1. With
+    // unified storage the carveout must hold size bytes (an automatic one
+    // is fitted to it) and the L1 is resized to the rest. Call before run().
+    void set_shared_memory(uint32_t base, uint32_t size);
+    Carveout carveout() const;
+
+    // The two halves of set_shared_memory() for a block dispatcher that
+    // picks the split itself: route [base, base + size) to the scratchpad,
+    // and (unified storage only) resize the L1 for a shared_size carveout
+    void set_shared_window(uint32_t base, uint32_t size);
+    void set_carveout(uint32_t shared_size);
+    // SimConfig::shared_carveout as configured (may be AUTO_CARVEOUT)
+    uint32_t requested_carveout() const;
+
+    // Multi-SM support: when remote misses are enabled, L1 misses are queued
+    // for the shared L2 instead of completing against local DRAM. The owner
+    // drains remote_requests() and hands replies back via deliver_response().
+    struct RemoteRequest {
+        SimTime            time;
+        MemoryTransaction* trans;
+    };
+    void set_remote_misses(bool enabled);
+    std::vector<RemoteRequest>& remote_requests();
+    void deliver_response(SimTime time, MemoryTransaction* trans);
+    uint32_t outstanding_remote_reads() const;
 
     // DPI-C interface methods
     static void memory_request_callback(uint32_t address, uint32_t data, 
@@ -99,24 +274,118 @@ public:
                                            uint32_t pc, 
                                            uint32_t instruction);
 
-    // Statistics and reporting
+    // Statistics and reporting. The registry holds every engine and memory
+    // counter ("engine.*", "memory.*", "constant_cache.*",
+    // "readonly_cache.*"); components may register their own.
     SimStats get_statistics() const;
     void print_statistics() const;
+    StatsRegistry& stats_registry();
+
+    // Memory latency from MEMORY_REQUEST to retirement: reads retire on
+    // their MEMORY_RESPONSE, writes (posted) once the first level accepts
+    // them. Reset with the other statistics.
+    const MemoryLatencyProfile& latency_profile() const;
+
+    // Interval statistics: every `interval` cycles a CSV row of the registry
+    // is written to `out` (header first) holding what changed since the last
+    // row; the counters themselves keep counting the whole run. An interval
+    // of 0 turns this off.
+    void set_stats_interval(SimTime interval, std::ostream* out);
     void dump_trace(const std::string& filename) const;
 
+    // Checkpointing: full engine (with the shared-memory window and
+    // carveout), cache and memory state in one file. Latency distributions
+    // are not saved: after a restore they cover only the restored run.
+    // Only valid between events with no remote misses in flight.
+    void save_checkpoint(const std::string& filename) const;
+    void restore_checkpoint(const std::string& filename);
+
+    // Analysis hooks (observers are not owned)
+    void add_instruction_observer(InstructionObserver* observer);
+    void remove_instruction_observer(InstructionObserver* observer);
+    void add_memory_observer(MemoryRequestObserver* observer);
+    void remove_memory_observer(MemoryRequestObserver* observer);
+
+    // Timeline export: warp spans and memory accesses go to `timeline` as
+    // process `pid` (not owned; nullptr turns it off)
+    void set_timeline(TimelineTrace* timeline, uint32_t pid = 0);
+
+    // Live metrics: a snapshot is published every LIVE_PUBLISH_EVENTS events
+    // and when a run returns (not owned; nullptr turns it off)
+    void set_live_metrics(LiveMetrics* metrics);
+    static constexpr uint64_t LIVE_PUBLISH_EVENTS = 4096;
+
+    // Determinism checking: record a hash of the event stream per cycle
+    void set_determinism_check(bool enabled);
+    const std::vector<CycleHash>& cycle_hashes() const;
+
+    // Accessors
+    SimTime get_current_time() const;
+    const SimConfig& get_config() const;
+    MemoryModel& memory_model();
+    MemoryModel* constant_cache();        // nullptr when the loads use the L1
+    MemoryModel* readonly_cache();
+
+    // Simulation limit applied by run() and run_until()
+    static constexpr SimTime MAX_SIMULATION_CYCLES = 1000000;
+
 private:
     // Internal state
     SimConfig config_;
     SimStats stats_;
     bool running_;
+    bool paused_;
     SimTime current_time_;
 
     // Event queue
     std::priority_queue<SimEvent, std::vector<SimEvent>, 
                        std::greater<SimEvent>> event_queue_;
 
-    // Memory subsystem
+    // Statistics storage; declared before the memory model, which registers
+    // its counters here
+    StatsRegistry stats_registry_;
+    struct EngineCounters {
+        Counter instructions;
+        Counter memory_requests;
+        Counter idle_cycles;
+        Counter constant_fetches;
+        Counter constant_lanes;       // Lanes served by those fetches
+        Counter constant_wait_cycles; // Fetches queued behind the port
+        Counter shared_accesses;
+    };
+    EngineCounters counters_;
+    MemoryLatencyProfile latency_profile_;
+    SimTime stats_interval_;
+    SimTime next_stats_dump_;
+    std::ostream* stats_out_;
+    void register_statistics();
+    void dump_stats_interval();
+    void start_stats_interval();
+    void record_latency(MemoryLevel level, bool is_write, uint32_t warp_id, uint64_t latency);
+
+    // Counters stay cumulative; an interval row is the change since the
+    // last one. Formulas cover the run, or the interval while its row is
+    // written (stats_epoch_ and reported_latency_ point at it then).
+    std::vector<uint64_t> interval_base_;
+    MemoryLatencyProfile interval_latency_;
+    SimTime interval_start_;
+    SimTime stats_epoch_;
+    const MemoryLatencyProfile* reported_latency_;
+
+    // Memory subsystem. Constant and read-only loads have their own caches
+    // (null when sized 0; those loads then read the L1 without a coherence
+    // pass). The constant cache port takes one address per cycle.
     std::unique_ptr<MemoryModel> memory_model_;
+    std::unique_ptr<MemoryModel> constant_cache_;
+    std::unique_ptr<MemoryModel> readonly_cache_;
+    SimTime constant_port_free_;
+
+    // Shared-memory window and the carveout asked for (config_ holds the
+    // one in effect)
+    uint32_t shared_base_;
+    uint32_t shared_size_;
+    uint32_t requested_carveout_;
+    void apply_carveout(const SimConfig& carved);
 
     // Warp state tracking
     struct WarpState {
@@ -124,14 +393,61 @@ private:
         uint32_t thread_mask;
         bool     active;
         SimTime  last_active;
+        uint32_t pending_reads;   // Executor mode: reads the warp waits on
+        SimTime  wait_start;      // Executor mode: when those reads issued
     };
     std::vector<WarpState> warp_states_;
+    std::vector<InstructionObserver*> instruction_observers_;
+    std::vector<MemoryRequestObserver*> memory_observers_;
+    TimelineTrace* timeline_;
+    uint32_t timeline_pid_;
+    LiveMetrics* live_metrics_;
+    uint64_t live_events_;
+    void publish_live_metrics();
+
+    // Execution-driven mode
+    InstructionExecutor* executor_;
+    std::vector<MemoryTransaction> executor_accesses_;
+
+    // Remote (shared L2) miss handling
+    bool remote_misses_;
+    std::vector<RemoteRequest> remote_requests_;
+    uint32_t outstanding_remote_reads_;
+
+    // Event ordering and determinism checking
+    uint64_t next_sequence_;
+    bool determinism_check_;
+    std::vector<CycleHash> cycle_hashes_;
+    void record_event_hash(const SimEvent& event);
+    static EventPriority event_priority(EventType type);
+    static uint32_t event_source(EventType type, const void* data);
+
+    // Run loop: per-event, or one cycle's events at a time. Cycles with no
+    // events are never visited; idle accounting covers them in O(1). While
+    // batching, fetches (the bulk of all events, always due within a few
+    // cycles) bypass the heap and go to per-cycle buckets; they are merged
+    // back in key order, so the processing order is unchanged.
+    static constexpr SimTime FETCH_RING_SIZE = 8;
+    bool batch_cycles_;
+    bool coalescing_;
+    SimTime last_event_cycle_;
+    std::vector<SimEvent> fetch_ring_[FETCH_RING_SIZE];
+    void account_idle(SimTime cycle);
+    void run_batched(SimTime end_time);
+    bool next_batched_cycle(SimTime& cycle) const;
+    void step_cycle(SimTime cycle);
+    void flush_fetch_ring();
 
     // Internal methods
+    void step();
+    void clear_event_queue();
     void process_memory_request(const MemoryTransaction* trans);
     void process_memory_response(const MemoryTransaction* trans);
     void process_instruction_fetch(uint32_t warp_id);
+    void execute_instruction(uint32_t warp_id);
     void process_warp_complete(uint32_t warp_id);
+    FastForwardResult fast_forward_executed(const FastForwardConfig& ff);
+    void warm_access(const MemoryTransaction& trans);
 
     // Statistics tracking
     void update_statistics();
@@ -0,0 +1,425 @@
+// simpoint.cpp
+// Implementation of basic-block profiling, simulation point selection and
+// sampled simulation
+
+#include "simpoint.h"
+#include "thread_pool.h"
+#include "warp_executor.h"
+#include "utils.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+namespace {
+
+// Engine executing a kernel from its first instruction
+class KernelEngine {
+public:
+    KernelEngine(const SimConfig& config, const std::shared_ptr<const Program>& kernel)
+        : engine_(config) {
+        if (kernel->shared_size > 0) {
+            engine_.set_shared_memory(kernel->shared_base, kernel->shared_size);
+        }
+        engine_.initialize();
+        engine_.attach_program(kernel->image);
+        const SimConfig& carved = engine_.get_config();
+        executor_ = std::make_unique<WarpExecutor>(kernel, engine_.memory_model(),
+                                                   carved.num_warps, carved.threads_per_warp,
+                                                   carved.cache_line_size);
+        engine_.set_executor(executor_.get());
+    }
+
+    SimulationEngine& engine() { return engine_; }
+
+private:
+    SimulationEngine engine_;
+    std::unique_ptr<WarpExecutor> executor_;
+};
+
+} // namespace
+
+BasicBlockProfiler::BasicBlockProfiler(uint64_t interval_size, uint32_t block_shift)
+    : interval_size_(interval_size)
+    , block_shift_(block_shift)
+    , interval_count_(0)
+    , total_instructions_(0) {
+    if (interval_size == 0) {
+        throw std::invalid_argument("Profiling interval must be non-zero");
+    }
+}
+
+void BasicBlockProfiler::on_instruction(uint32_t warp_id, uint32_t pc) {
+    (void)warp_id;
+    current_[pc >> block_shift_]++;
+    total_instructions_++;
+    if (++interval_count_ == interval_size_) {
+        close_interval();
+    }
+}
+
+void BasicBlockProfiler::finish() {
+    if (interval_count_ > 0) {
+        close_interval();
+    }
+}
+
+void BasicBlockProfiler::close_interval() {
+    BasicBlockVector bbv(current_.begin(), current_.end());
+    std::sort(bbv.begin(), bbv.end());
+    intervals_.push_back(std::move(bbv));
+    current_.clear();
+    interval_count_ = 0;
+}
+
+SimPointSelector::SimPointSelector(const SimPointConfig& config)
+    : config_(config) {
+}
+
+std::vector<SimPoint> SimPointSelector::select(
+        const std::vector<BasicBlockVector>& intervals) const {
+    if (intervals.empty()) {
+        return {};
+    }
+
+    std::vector<Point> points = project(intervals);
+    uint32_t max_k = std::min<uint32_t>(std::max<uint32_t>(config_.max_clusters, 1),
+                                        static_cast<uint32_t>(points.size()));
+
+    std::vector<Clustering> candidates;
+    for (uint32_t k = 1; k <= max_k; ++k) {
+        candidates.push_back(kmeans(points, k));
+    }
+
+    auto [worst, best] = std::minmax_element(candidates.begin(), candidates.end(),
+        [](const Clustering& a, const Clustering& b) { return a.bic < b.bic; });
+    double threshold = worst->bic + 0.9 * (best->bic - worst->bic);
+    const Clustering* chosen = &*best;
+    for (const auto& candidate : candidates) {
+        if (candidate.bic >= threshold) {
+            chosen = &candidate;
+            break;
+        }
+    }
+
+    // Representative: the interval closest to its cluster centroid
+    size_t k = chosen->centroids.size();
+    std::vector<uint32_t> members(k, 0);
+    std::vector<uint32_t> closest(k, 0);
+    std::vector<double> closest_distance(k, std::numeric_limits<double>::max());
+    for (size_t i = 0; i < points.size(); ++i) {
+        uint32_t c = chosen->assignment[i];
+        members[c]++;
+        double d = distance2(points[i], chosen->centroids[c]);
+        if (d < closest_distance[c]) {
+            closest_distance[c] = d;
+            closest[c] = static_cast<uint32_t>(i);
+        }
+    }
+
+    std::vector<SimPoint> simpoints;
+    for (uint32_t c = 0; c < k; ++c) {
+        if (members[c] > 0) {
+            simpoints.push_back({closest[c], c,
+                                 static_cast<double>(members[c]) / points.size()});
+        }
+    }
+    std::sort(simpoints.begin(), simpoints.end(),
+              [](const SimPoint& a, const SimPoint& b) { return a.interval < b.interval; });
+    return simpoints;
+}
+
+std::vector<SimPointSelector::Point> SimPointSelector::project(
+        const std::vector<BasicBlockVector>& intervals) const {
+    const uint32_t dims = std::max<uint32_t>(config_.projected_dims, 1);
+
+    // Each block gets a fixed random direction, derived from its ID so the
+    // projection does not depend on the order blocks are first seen in
+    std::unordered_map<uint32_t, Point> directions;
+    auto direction = [&](uint32_t block) -> const Point& {
+        auto it = directions.find(block);
+        if (it == directions.end()) {
+            utils::Random random(config_.seed ^ (block * 2654435761u));
+            Point row(dims);
+            for (auto& value : row) {
+                value = random.get_double(-1.0, 1.0);
+            }
+            it = directions.emplace(block, std::move(row)).first;
+        }
+        return it->second;
+    };
+
+    std::vector<Point> points;
+    points.reserve(intervals.size());
+    for (const auto& bbv : intervals) {
+        double total = 0.0;
+        for (const auto& entry : bbv) {
+            total += entry.second;
+        }
+
+        Point point(dims, 0.0);
+        for (const auto& [block, count] : bbv) {
+            const Point& row = direction(block);
+            double weight = count / total;
+            for (uint32_t d = 0; d < dims; ++d) {
+                point[d] += weight * row[d];
+            }
+        }
+        points.push_back(std::move(point));
+    }
+    return points;
+}
+
+SimPointSelector::Clustering SimPointSelector::kmeans(const std::vector<Point>& points,
+                                                      uint32_t k) const {
+    utils::Random random(config_.seed + k);
+    Clustering result;
+
+    // k-means++ seeding
+    result.centroids.push_back(points[random.get_int(0, static_cast<int>(points.size()) - 1)]);
+    std::vector<double> nearest(points.size(), std::numeric_limits<double>::max());
+    while (result.centroids.size() < k) {
+        double total = 0.0;
+        for (size_t i = 0; i < points.size(); ++i) {
+            nearest[i] = std::min(nearest[i], distance2(points[i], result.centroids.back()));
+            total += nearest[i];
+        }
+        if (total == 0.0) {
+            break;  // Fewer distinct points than clusters
+        }
+        double pick = random.get_double(0.0, total);
+        size_t chosen = 0;
+        for (; chosen + 1 < points.size() && pick >= nearest[chosen]; ++chosen) {
+            pick -= nearest[chosen];
+        }
+        result.centroids.push_back(points[chosen]);
+    }
+
+    // Lloyd iterations
+    const size_t dims = points.front().size();
+    result.assignment.assign(points.size(), 0);
+    for (uint32_t iter = 0; iter < std::max<uint32_t>(config_.kmeans_iterations, 1); ++iter) {
+        bool changed = false;
+        for (size_t i = 0; i < points.size(); ++i) {
+            uint32_t best = 0;
+            double best_distance = std::numeric_limits<double>::max();
+            for (uint32_t c = 0; c < result.centroids.size(); ++c) {
+                double d = distance2(points[i], result.centroids[c]);
+                if (d < best_distance) {
+                    best_distance = d;
+                    best = c;
+                }
+            }
+            if (best != result.assignment[i]) {
+                result.assignment[i] = best;
+                changed = true;
+            }
+        }
+        if (!changed && iter > 0) {
+            break;
+        }
+
+        std::vector<Point> sums(result.centroids.size(), Point(dims, 0.0));
+        std::vector<uint32_t> counts(result.centroids.size(), 0);
+        for (size_t i = 0; i < points.size(); ++i) {
+            uint32_t c = result.assignment[i];
+            counts[c]++;
+            for (size_t d = 0; d < dims; ++d) {
+                sums[c][d] += points[i][d];
+            }
+        }
+        for (size_t c = 0; c < result.centroids.size(); ++c) {
+            if (counts[c] > 0) {
+                for (size_t d = 0; d < dims; ++d) {
+                    result.centroids[c][d] = sums[c][d] / counts[c];
+                }
+            }
+        }
+    }
+
+    result.bic = bic(points, result);
+    return result;
+}
+
+double SimPointSelector::bic(const std::vector<Point>& points, const Clustering& clustering) {
+    // Spherical Gaussian likelihood, as in X-means (Pelleg and Moore)
+    constexpr double PI = 3.14159265358979323846;
+    const double R = static_cast<double>(points.size());
+    const double M = static_cast<double>(points.front().size());
+    const double K = static_cast<double>(clustering.centroids.size());
+
+    std::vector<double> sizes(clustering.centroids.size(), 0.0);
+    double distortion = 0.0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        uint32_t c = clustering.assignment[i];
+        sizes[c] += 1.0;
+        distortion += distance2(points[i], clustering.centroids[c]);
+    }
+
+    double variance = R > K ? distortion / (R - K) : 0.0;
+    variance = std::max(variance, 1e-12);
+
+    double likelihood = 0.0;
+    for (double Rn : sizes) {
+        if (Rn == 0.0) {
+            continue;
+        }
+        likelihood += -Rn / 2.0 * std::log(2.0 * PI)
+                      - Rn * M / 2.0 * std::log(variance)
+                      - (Rn - K) / 2.0
+                      + Rn * std::log(Rn)
+                      - Rn * std::log(R);
+    }
+
+    double parameters = (K - 1.0) + M * K + 1.0;
+    return likelihood - parameters / 2.0 * std::log(R);
+}
+
+double SimPointSelector::distance2(const Point& a, const Point& b) {
+    double sum = 0.0;
+    for (size_t d = 0; d < a.size(); ++d) {
+        double diff = a[d] - b[d];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+SampledSimulation::SampledSimulation(const SimConfig& sim_config, const SimPointConfig& config,
+                                     std::shared_ptr<const Program> kernel)
+    : sim_config_(sim_config)
+    , config_(config)
+    , kernel_(std::move(kernel)) {
+    if (!kernel_) {
+        throw std::invalid_argument("Sampled simulation needs a kernel: trace-driven warps "
+                                    "never revisit code, so their intervals cannot be clustered");
+    }
+}
+
+SampledResult SampledSimulation::run() const {
+    SampledResult result{};
+    utils::Timer timer;
+
+    timer.start();
+    std::vector<BasicBlockVector> intervals = profile(result.profiled_instructions);
+    std::vector<SimPoint> points = SimPointSelector(config_).select(intervals);
+    timer.stop();
+    result.profile_ms = timer.elapsed_ms();
+    result.total_intervals = static_cast<uint32_t>(intervals.size());
+
+    // Simulation points warm up in their own engines, so they are
+    // independent jobs; an exception from one reaches the caller
+    timer.start();
+    result.points.resize(points.size());
+    utils::ThreadPool pool(config_.num_threads);
+    pool.parallel_for(points.size(), [this, &points, &result](size_t i) {
+        result.points[i] = simulate_point(points[i]);
+    });
+    timer.stop();
+    result.detailed_ms = timer.elapsed_ms();
+
+    // Weighted per-instruction rates, scaled to the profiled instruction count
+    double cycles = 0.0, requests = 0.0, hits = 0.0, misses = 0.0;
+    for (const auto& stats : result.points) {
+        result.detailed_instructions += stats.instructions;
+        if (stats.instructions == 0) {
+            continue;
+        }
+        double scale = stats.point.weight / static_cast<double>(stats.instructions);
+        cycles += scale * stats.cycles;
+        requests += scale * stats.memory_requests;
+        hits += scale * stats.cache_hits;
+        misses += scale * stats.cache_misses;
+    }
+
+    const double total = static_cast<double>(result.profiled_instructions);
+    SimStats& estimate = result.estimate;
+    estimate.total_cycles = static_cast<uint64_t>(std::llround(cycles * total));
+    estimate.instructions_executed = result.profiled_instructions;
+    estimate.memory_requests = static_cast<uint64_t>(std::llround(requests * total));
+    estimate.cache_hits = static_cast<uint64_t>(std::llround(hits * total));
+    estimate.cache_misses = static_cast<uint64_t>(std::llround(misses * total));
+    estimate.ipc = cycles > 0.0 ? 1.0 / cycles : 0.0;
+    estimate.cache_hit_rate = hits + misses > 0.0 ? hits / (hits + misses) : 0.0;
+
+    return result;
+}
+
+std::vector<BasicBlockVector> SampledSimulation::profile(uint64_t& total_instructions) const {
+    KernelEngine kernel(sim_config_, kernel_);
+    SimulationEngine& engine = kernel.engine();
+
+    BasicBlockProfiler profiler(config_.interval_size, config_.block_shift);
+    engine.add_instruction_observer(&profiler);
+    engine.fast_forward(FastForwardConfig{0, false, 0, false});
+    engine.remove_instruction_observer(&profiler);
+    profiler.finish();
+
+    total_instructions = profiler.total_instructions();
+    return profiler.intervals();
+}
+
+SimPointStats SampledSimulation::simulate_point(const SimPoint& point) const {
+    // Warm the caches on the way to the interval, then switch to detail
+    KernelEngine kernel(sim_config_, kernel_);
+    SimulationEngine& engine = kernel.engine();
+    uint64_t target = static_cast<uint64_t>(point.interval) * config_.interval_size;
+    if (target > 0) {
+        engine.fast_forward(FastForwardConfig{target, false, 0, true});
+    }
+
+    SimTime start_time = engine.get_current_time();
+    SimStats start = engine.get_statistics();
+    auto [start_hits, start_misses] = engine.memory_model().get_cache_stats();
+
+    engine.run_instructions(config_.interval_size);
+
+    SimStats end = engine.get_statistics();
+    auto [end_hits, end_misses] = engine.memory_model().get_cache_stats();
+
+    return SimPointStats{
+        point,
+        engine.get_current_time() - start_time,
+        end.instructions_executed - start.instructions_executed,
+        end.memory_requests - start.memory_requests,
+        end_hits - start_hits,
+        end_misses - start_misses
+    };
+}
+
+void SampledSimulation::print_report(const SampledResult& result) const {
+    std::cout << "\nSampled Simulation:\n"
+              << "===================\n"
+              << "Intervals: " << result.total_intervals << " x "
+              << config_.interval_size << " instructions\n"
+              << "Simulation Points: " << result.points.size() << "\n";
+
+    for (const auto& stats : result.points) {
+        double ipc = stats.cycles > 0
+            ? static_cast<double>(stats.instructions) / stats.cycles : 0.0;
+        std::cout << "  Interval " << std::setw(6) << stats.point.interval
+                  << "  Cluster " << std::setw(3) << stats.point.cluster
+                  << "  Weight " << std::fixed << std::setprecision(2)
+                  << (stats.point.weight * 100.0) << "%"
+                  << "  IPC " << std::fixed << std::setprecision(2) << ipc << "\n";
+    }
+
+    double detailed_fraction = result.profiled_instructions > 0
+        ? static_cast<double>(result.detailed_instructions) / result.profiled_instructions : 0.0;
+    std::cout << "Detailed Instructions: " << result.detailed_instructions << " ("
+              << std::fixed << std::setprecision(2) << (detailed_fraction * 100.0) << "%)\n"
+              << "Profile Time: " << std::fixed << std::setprecision(1)
+              << result.profile_ms << " ms\n"
+              << "Detailed Time: " << std::fixed << std::setprecision(1)
+              << result.detailed_ms << " ms\n"
+              << "Estimated Cycles: " << result.estimate.total_cycles << "\n"
+              << "Estimated IPC: " << std::fixed << std::setprecision(2)
+              << result.estimate.ipc << "\n"
+              << "Estimated Cache Hit Rate: " << std::fixed << std::setprecision(2)
+              << (result.estimate.cache_hit_rate * 100.0) << "%\n";
+}
+
+} // namespace gpu_simulator
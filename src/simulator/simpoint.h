@@ -0,0 +1,131 @@
+// simpoint.h
+// SimPoint-style sampled simulation driven by basic-block vectors
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "sim_engine.h"
+#include "program_loader.h"
+
+namespace gpu_simulator {
+
+// Sparse basic-block vector: (block ID, instructions executed in block)
+using BasicBlockVector = std::vector<std::pair<uint32_t, uint32_t>>;
+
+// Collects one basic-block vector per fixed-length instruction interval.
+// A block is an aligned code region of 2^block_shift bytes rather than a
+// branch-delimited block, so no control-flow analysis is needed.
+class BasicBlockProfiler : public InstructionObserver {
+public:
+    // Constructor
+    BasicBlockProfiler(uint64_t interval_size, uint32_t block_shift);
+
+    void on_instruction(uint32_t warp_id, uint32_t pc) override;
+    void finish();  // Close a trailing partial interval
+
+    const std::vector<BasicBlockVector>& intervals() const { return intervals_; }
+    uint64_t total_instructions() const { return total_instructions_; }
+
+private:
+    void close_interval();
+
+    uint64_t interval_size_;
+    uint32_t block_shift_;
+    uint64_t interval_count_;
+    uint64_t total_instructions_;
+    std::unordered_map<uint32_t, uint32_t> current_;
+    std::vector<BasicBlockVector> intervals_;
+};
+
+struct SimPointConfig {
+    uint64_t    interval_size;       // Instructions per interval
+    uint32_t    max_clusters;        // Upper bound on k
+    uint32_t    projected_dims;      // Random projection width (SimPoint uses 15)
+    uint32_t    block_shift;         // log2 of the code block size in bytes
+    uint32_t    kmeans_iterations;
+    uint32_t    seed;
+    uint32_t    num_threads;         // Detailed simulation threads (0 = hardware)
+};
+
+// Representative interval for one cluster
+struct SimPoint {
+    uint32_t interval;
+    uint32_t cluster;
+    double   weight;                 // Fraction of all intervals in the cluster
+};
+
+// Per-interval detailed measurements of one simulation point
+struct SimPointStats {
+    SimPoint point;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t memory_requests;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+};
+
+struct SampledResult {
+    SimStats                   estimate;           // Extrapolated whole-run statistics
+    std::vector<SimPointStats> points;
+    uint32_t                   total_intervals;
+    uint64_t                   profiled_instructions;
+    uint64_t                   detailed_instructions;
+    double                     profile_ms;
+    double                     detailed_ms;
+};
+
+// Picks simulation points with k-means over randomly projected BBVs and
+// chooses k by the BIC rule SimPoint uses: the smallest k scoring at least
+// 90% of the best BIC
+class SimPointSelector {
+public:
+    explicit SimPointSelector(const SimPointConfig& config);
+
+    std::vector<SimPoint> select(const std::vector<BasicBlockVector>& intervals) const;
+
+private:
+    using Point = std::vector<double>;
+
+    struct Clustering {
+        std::vector<Point>    centroids;
+        std::vector<uint32_t> assignment;
+        double                bic;
+    };
+
+    std::vector<Point> project(const std::vector<BasicBlockVector>& intervals) const;
+    Clustering kmeans(const std::vector<Point>& points, uint32_t k) const;
+    static double bic(const std::vector<Point>& points, const Clustering& clustering);
+    static double distance2(const Point& a, const Point& b);
+
+    SimPointConfig config_;
+};
+
+// Profiles a kernel functionally, simulates only the chosen intervals in
+// detail and extrapolates SimStats. Each point runs in its own engine,
+// fast-forwarded with cache warming to the start of its interval; executor
+// state cannot be checkpointed, so points do not share a warmed snapshot.
+// Trace-driven workloads are rejected: their warps never revisit code, so
+// no two intervals have similar basic-block vectors.
+class SampledSimulation {
+public:
+    // Constructor (invalid_argument without a kernel)
+    SampledSimulation(const SimConfig& sim_config, const SimPointConfig& config,
+                      std::shared_ptr<const Program> kernel);
+
+    SampledResult run() const;
+    void print_report(const SampledResult& result) const;
+
+private:
+    std::vector<BasicBlockVector> profile(uint64_t& total_instructions) const;
+    SimPointStats simulate_point(const SimPoint& point) const;
+
+    SimConfig sim_config_;
+    SimPointConfig config_;
+    std::shared_ptr<const Program> kernel_;
+};
+
+} // namespace gpu_simulator
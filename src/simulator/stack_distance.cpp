@@ -0,0 +1,250 @@
+// stack_distance.cpp
+// Implementation of single-pass LRU stack-distance analysis
+
+#include "stack_distance.h"
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+namespace {
+
+uint32_t log2_exact(uint32_t value) {
+    uint32_t bits = 0;
+    while ((1u << bits) < value) {
+        bits++;
+    }
+    return bits;
+}
+
+} // namespace
+
+void GrowingFenwickTree::append(int32_t value) {
+    // Node n covers (n - lowbit(n), n]; everything before n is already final
+    size_t n = tree_.size() + 1;
+    size_t low = n & (~n + 1);
+    int64_t covered = prefix(n - 1) - prefix(n - low);
+    tree_.push_back(static_cast<int32_t>(value + covered));
+}
+
+void GrowingFenwickTree::add(size_t index, int32_t delta) {
+    for (; index <= tree_.size(); index += index & (~index + 1)) {
+        tree_[index - 1] += delta;
+    }
+}
+
+int64_t GrowingFenwickTree::prefix(size_t index) const {
+    int64_t sum = 0;
+    for (; index > 0; index -= index & (~index + 1)) {
+        sum += tree_[index - 1];
+    }
+    return sum;
+}
+
+StackDistanceAnalyzer::StackDistanceAnalyzer(uint32_t line_size, uint32_t max_cache_size)
+    : line_size_(line_size)
+    , offset_bits_(log2_exact(line_size))
+    , max_lines_(0)
+    , accesses_(0)
+    , cold_misses_(0) {
+    if (line_size == 0 || (line_size & (line_size - 1)) != 0) {
+        throw std::invalid_argument("Line size must be a power of two");
+    }
+    max_lines_ = max_cache_size / line_size;
+    if (max_lines_ == 0) {
+        throw std::invalid_argument("Maximum cache must hold at least one line");
+    }
+
+    // One level per power-of-two set count, from fully associative (1 set)
+    // to direct-mapped at the maximum size
+    for (uint32_t sets = 1; sets <= max_lines_; sets *= 2) {
+        SetLevel level;
+        level.num_sets = sets;
+        level.sets.resize(sets);
+        level.histogram.assign(max_lines_ / sets, 0);
+        level.beyond = 0;
+        level.entries = 0;
+        levels_.push_back(std::move(level));
+    }
+}
+
+void StackDistanceAnalyzer::on_access(uint32_t address, bool is_write, bool hit) {
+    (void)is_write;
+    (void)hit;
+    record(address);
+}
+
+void StackDistanceAnalyzer::record(uint32_t address) {
+    uint32_t line = address >> offset_bits_;
+    const size_t num_levels = levels_.size();
+    accesses_++;
+
+    auto [it, inserted] = line_slot_.try_emplace(
+        line, static_cast<uint32_t>(line_slot_.size()));
+    if (inserted) {
+        last_time_.resize(last_time_.size() + num_levels, 0);
+        cold_misses_++;
+    }
+    uint32_t* last = &last_time_[static_cast<size_t>(it->second) * num_levels];
+
+    for (size_t k = 0; k < num_levels; ++k) {
+        SetLevel& level = levels_[k];
+        GrowingFenwickTree& set = level.sets[line & (level.num_sets - 1)];
+
+        if (!inserted) {
+            // Distinct lines of this set touched since the previous access
+            uint32_t previous = last[k];
+            int64_t distance = set.prefix(set.size()) - set.prefix(previous);
+            if (distance < static_cast<int64_t>(level.histogram.size())) {
+                level.histogram[distance]++;
+            } else {
+                level.beyond++;
+            }
+            set.add(previous, -1);
+        }
+
+        set.append(1);
+        last[k] = static_cast<uint32_t>(set.size());
+
+        // Stale markers outnumbering the live lines trigger a renumbering,
+        // which keeps the trees (and the 32-bit times) bounded on long runs
+        if (++level.entries > 2 * line_slot_.size() + 1024) {
+            compact(k);
+        }
+    }
+}
+
+void StackDistanceAnalyzer::compact(size_t k) {
+    // Renumber each set's live lines 1..n in access order; only their
+    // order matters for the distances
+    SetLevel& level = levels_[k];
+    const size_t num_levels = levels_.size();
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> order(level.num_sets);
+    for (const auto& [line, slot] : line_slot_) {
+        size_t index = static_cast<size_t>(slot) * num_levels + k;
+        order[line & (level.num_sets - 1)].emplace_back(last_time_[index], slot);
+    }
+
+    for (uint32_t s = 0; s < level.num_sets; ++s) {
+        std::sort(order[s].begin(), order[s].end());
+        GrowingFenwickTree& set = level.sets[s];
+        set = GrowingFenwickTree{};
+        for (const auto& [time, slot] : order[s]) {
+            set.append(1);
+            last_time_[static_cast<size_t>(slot) * num_levels + k] =
+                static_cast<uint32_t>(set.size());
+        }
+    }
+    level.entries = line_slot_.size();
+}
+
+void StackDistanceAnalyzer::reset() {
+    for (auto& level : levels_) {
+        level.sets.assign(level.num_sets, GrowingFenwickTree{});
+        std::fill(level.histogram.begin(), level.histogram.end(), 0);
+        level.beyond = 0;
+        level.entries = 0;
+    }
+    line_slot_.clear();
+    last_time_.clear();
+    accesses_ = 0;
+    cold_misses_ = 0;
+}
+
+uint64_t StackDistanceAnalyzer::total_accesses() const {
+    return accesses_;
+}
+
+uint64_t StackDistanceAnalyzer::cold_misses() const {
+    return cold_misses_;
+}
+
+uint64_t StackDistanceAnalyzer::hits(uint32_t cache_size, uint32_t associativity) const {
+    uint32_t lines = cache_size / line_size_;
+    if (associativity == 0) {
+        associativity = lines;
+    }
+    if (lines == 0 || lines > max_lines_ || associativity > lines) {
+        throw std::out_of_range("Cache configuration outside the analyzed range");
+    }
+
+    uint32_t num_sets = lines / associativity;
+    uint32_t k = log2_exact(num_sets);
+    if ((1u << k) != num_sets) {
+        throw std::invalid_argument("Number of sets must be a power of two");
+    }
+
+    // An access hits in an A-way set when fewer than A other lines intervened
+    const SetLevel& level = levels_[k];
+    uint64_t total = 0;
+    for (uint32_t d = 0; d < associativity; ++d) {
+        total += level.histogram[d];
+    }
+    return total;
+}
+
+double StackDistanceAnalyzer::hit_rate(uint32_t cache_size, uint32_t associativity) const {
+    if (accesses_ == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(hits(cache_size, associativity)) /
+           static_cast<double>(accesses_);
+}
+
+std::vector<uint32_t> StackDistanceAnalyzer::cache_sizes() const {
+    std::vector<uint32_t> sizes;
+    for (uint32_t lines = 1; lines <= max_lines_; lines *= 2) {
+        sizes.push_back(lines * line_size_);
+    }
+    return sizes;
+}
+
+void StackDistanceAnalyzer::print_curves(std::ostream& out,
+                                         const std::vector<uint32_t>& associativities) const {
+    out << "\nStack Distance Hit-Rate Curves:\n"
+        << "===============================\n"
+        << "Accesses: " << accesses_ << ", Cold Misses: " << cold_misses_
+        << ", Line Size: " << line_size_ << " bytes\n"
+        << std::setw(12) << "Size";
+    for (uint32_t assoc : associativities) {
+        out << std::setw(10) << (assoc == 0 ? std::string("full")
+                                            : std::to_string(assoc) + "-way");
+    }
+    out << "\n";
+
+    for (uint32_t size : cache_sizes()) {
+        out << std::setw(12) << size;
+        for (uint32_t assoc : associativities) {
+            if (assoc > size / line_size_) {
+                out << std::setw(10) << "-";
+            } else {
+                out << std::setw(9) << std::fixed << std::setprecision(2)
+                    << (hit_rate(size, assoc) * 100.0) << "%";
+            }
+        }
+        out << "\n";
+    }
+}
+
+void StackDistanceAnalyzer::write_csv(const std::string& filename,
+                                      const std::vector<uint32_t>& associativities) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open stack distance output file: " + filename);
+    }
+
+    file << "cache_size,associativity,hits,accesses,hit_rate\n";
+    for (uint32_t size : cache_sizes()) {
+        for (uint32_t assoc : associativities) {
+            if (assoc > size / line_size_) {
+                continue;
+            }
+            file << size << "," << assoc << "," << hits(size, assoc) << ","
+                 << accesses_ << "," << hit_rate(size, assoc) << "\n";
+        }
+    }
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,85 @@
+// stack_distance.h
+// Single-pass LRU stack-distance analysis for cache design sweeps
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include "memory_model.h"
+
+namespace gpu_simulator {
+
+// Fenwick tree that can grow one index at a time. Index i holds a marker
+// for the access at local time i; prefix sums count distinct lines.
+class GrowingFenwickTree {
+public:
+    void append(int32_t value);
+    void add(size_t index, int32_t delta);     // 1-based
+    int64_t prefix(size_t index) const;        // Sum of [1, index]
+    size_t size() const { return tree_.size(); }
+
+private:
+    std::vector<int32_t> tree_;
+};
+
+// Computes per-set LRU stack distances for every power-of-two set count
+// in one pass (Mattson et al.), so the hit rate of any cache size and
+// associativity up to max_cache_size can be read off afterwards without
+// re-simulating. Results match MemoryModel's LRU replacement when fed the
+// same access stream.
+class StackDistanceAnalyzer : public AccessObserver {
+public:
+    // Constructor (invalid_argument unless line_size is a power of two and
+    // max_cache_size holds at least one line)
+    StackDistanceAnalyzer(uint32_t line_size, uint32_t max_cache_size);
+
+    // Delete copy constructor and assignment
+    StackDistanceAnalyzer(const StackDistanceAnalyzer&) = delete;
+    StackDistanceAnalyzer& operator=(const StackDistanceAnalyzer&) = delete;
+
+    // Access stream input
+    void record(uint32_t address);
+    void on_access(uint32_t address, bool is_write, bool hit) override;
+    void reset();
+
+    // Results (associativity 0 = fully associative)
+    uint64_t total_accesses() const;
+    uint64_t cold_misses() const;
+    uint64_t hits(uint32_t cache_size, uint32_t associativity) const;
+    double hit_rate(uint32_t cache_size, uint32_t associativity) const;
+
+    // Hit-rate curves over all power-of-two sizes for the given associativities
+    void print_curves(std::ostream& out, const std::vector<uint32_t>& associativities) const;
+    void write_csv(const std::string& filename,
+                   const std::vector<uint32_t>& associativities) const;
+
+private:
+    // Stack state for one set count
+    struct SetLevel {
+        uint32_t num_sets;
+        std::vector<GrowingFenwickTree> sets;
+        std::vector<uint64_t> histogram;   // histogram[d]: hits needing > d ways
+        uint64_t beyond;                   // Distances past the largest cache
+        uint64_t entries;                  // Tree markers, live and stale
+    };
+
+    uint32_t line_size_;
+    uint32_t offset_bits_;
+    uint32_t max_lines_;
+    std::vector<SetLevel> levels_;         // levels_[k] has 2^k sets
+
+    // Per-line last local access time at every level: slot * levels + k
+    std::unordered_map<uint32_t, uint32_t> line_slot_;
+    std::vector<uint32_t> last_time_;
+
+    uint64_t accesses_;
+    uint64_t cold_misses_;
+
+    void compact(size_t k);
+    std::vector<uint32_t> cache_sizes() const;
+};
+
+} // namespace gpu_simulator
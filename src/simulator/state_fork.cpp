@@ -0,0 +1,272 @@
+// state_fork.cpp
+// Implementation of copy-on-write simulation forking
+
+#include "state_fork.h"
+#include "utils.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cerrno>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#define GPUSIM_HAVE_FORK 1
+#endif
+
+namespace gpu_simulator {
+
+namespace {
+
+#ifdef GPUSIM_HAVE_FORK
+uint64_t minor_faults() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_minflt);
+}
+
+bool read_fully(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::read(fd, bytes, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void write_fully(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd, bytes, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+#endif
+
+// A new file in the temp directory, created exclusively under a random
+// name, so concurrent runs never share one and an existing file (or a
+// planted link) is never opened
+std::string temp_snapshot_path() {
+    std::random_device entropy;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        std::string path = (std::filesystem::temp_directory_path() /
+                            ("gpusim_fork_" + std::to_string(entropy()) + "_" +
+                             std::to_string(entropy()) + ".ckpt")).string();
+        if (std::FILE* file = std::fopen(path.c_str(), "wbx")) {
+            std::fclose(file);
+            return path;
+        }
+    }
+    throw std::runtime_error("Could not create snapshot file in the temp directory");
+}
+
+// Removes the snapshot however the variants finish
+struct SnapshotFile {
+    std::string path;
+    ~SnapshotFile() { std::remove(path.c_str()); }
+};
+
+} // namespace
+
+StateForker::StateForker(uint32_t max_children)
+    : max_children_(max_children)
+    , spawn_ms_(0.0) {
+}
+
+StateForker::ChildReport StateForker::run_child(SimulationEngine& engine,
+                                                const ForkVariant& variant,
+                                                const Continuation& continuation) {
+    utils::Timer timer;
+    timer.start();
+#ifdef GPUSIM_HAVE_FORK
+    uint64_t faults_before = minor_faults();
+#endif
+
+    if (variant.apply) {
+        variant.apply(engine);
+    }
+    if (continuation) {
+        continuation(engine);
+    } else {
+        engine.run();
+    }
+
+    timer.stop();
+    ChildReport report{engine.get_statistics(), 0, timer.elapsed_ms()};
+#ifdef GPUSIM_HAVE_FORK
+    report.copied_pages = minor_faults() - faults_before;
+#endif
+    return report;
+}
+
+std::vector<ForkResult> StateForker::run(SimulationEngine& parent,
+                                         const std::vector<ForkVariant>& variants,
+                                         Continuation continuation) const {
+#ifdef GPUSIM_HAVE_FORK
+    std::vector<ForkResult> results;
+    results.reserve(variants.size());
+    for (const auto& variant : variants) {
+        results.push_back({variant.name, false, SimStats{}, 0, 0.0});
+    }
+
+    // Buffered output would otherwise be emitted once per child
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    struct Child {
+        pid_t  pid;
+        int    fd;
+        size_t index;
+    };
+    std::vector<Child> running;
+    const size_t batch = max_children_ == 0 ? variants.size() : max_children_;
+    spawn_ms_ = 0.0;
+
+    auto reap = [&](const Child& child) {
+        ChildReport report;
+        bool ok = read_fully(child.fd, &report, sizeof(report));
+        ::close(child.fd);
+        int status = 0;
+        while (::waitpid(child.pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        ForkResult& result = results[child.index];
+        result.ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (result.ok) {
+            result.stats = report.stats;
+            result.copied_pages = report.copied_pages;
+            result.wall_ms = report.wall_ms;
+        }
+    };
+
+    // On a failed spawn the children already started are stopped and
+    // waited for, so none is left running or as a zombie
+    auto abandon = [&](const std::string& message) {
+        for (const auto& child : running) {
+            ::kill(child.pid, SIGKILL);
+            ::close(child.fd);
+            while (::waitpid(child.pid, nullptr, 0) < 0 && errno == EINTR) {
+            }
+        }
+        running.clear();
+        throw std::runtime_error(message);
+    };
+
+    for (size_t i = 0; i < variants.size(); ++i) {
+        if (running.size() == batch) {
+            reap(running.front());
+            running.erase(running.begin());
+        }
+
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            abandon("Could not create pipe for forked simulation");
+        }
+
+        utils::Timer timer;
+        timer.start();
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            abandon("fork() failed for simulation variant " + variants[i].name);
+        }
+
+        if (pid == 0) {
+            // Child: continue from the shared snapshot and report back.
+            // _exit skips destructors and atexit handlers owned by the parent.
+            ::close(fds[0]);
+            int code = 0;
+            try {
+                ChildReport report = run_child(parent, variants[i], continuation);
+                write_fully(fds[1], &report, sizeof(report));
+            } catch (const std::exception& e) {
+                std::cerr << "Variant " << variants[i].name << " failed: " << e.what() << "\n";
+                code = 1;
+            }
+            std::cout.flush();
+            std::fflush(nullptr);
+            ::_exit(code);
+        }
+
+        timer.stop();
+        spawn_ms_ += timer.elapsed_ms();
+        ::close(fds[1]);
+        running.push_back({pid, fds[0], i});
+    }
+
+    for (const auto& child : running) {
+        reap(child);
+    }
+    return results;
+#else
+    return run_from_checkpoint(parent, variants, continuation);
+#endif
+}
+
+std::vector<ForkResult> StateForker::run_from_checkpoint(
+        SimulationEngine& parent, const std::vector<ForkVariant>& variants,
+        const Continuation& continuation) const {
+    utils::Timer timer;
+    timer.start();
+    SnapshotFile snapshot{temp_snapshot_path()};
+    parent.save_checkpoint(snapshot.path);
+    timer.stop();
+    spawn_ms_ = timer.elapsed_ms();
+
+    std::vector<ForkResult> results;
+    for (const auto& variant : variants) {
+        SimulationEngine child(parent.get_config());
+        child.initialize();
+        child.restore_checkpoint(snapshot.path);
+
+        ChildReport report = run_child(child, variant, continuation);
+        results.push_back({variant.name, true, report.stats, report.copied_pages, report.wall_ms});
+    }
+    return results;
+}
+
+void StateForker::print_results(const std::vector<ForkResult>& results, std::ostream& out) {
+    out << "\nForked Variant Results:\n"
+        << "=======================\n"
+        << std::setw(20) << "Variant" << std::setw(12) << "Cycles"
+        << std::setw(14) << "Instructions" << std::setw(8) << "IPC"
+        << std::setw(10) << "HitRate" << std::setw(10) << "Pages"
+        << std::setw(11) << "Wall(ms)" << "\n";
+
+    for (const auto& result : results) {
+        out << std::setw(20) << result.name;
+        if (!result.ok) {
+            out << "  failed\n";
+            continue;
+        }
+        out << std::setw(12) << result.stats.total_cycles
+            << std::setw(14) << result.stats.instructions_executed
+            << std::setw(8) << std::fixed << std::setprecision(2) << result.stats.ipc
+            << std::setw(9) << std::fixed << std::setprecision(2)
+            << (result.stats.cache_hit_rate * 100.0) << "%"
+            << std::setw(10) << result.copied_pages
+            << std::setw(11) << std::fixed << std::setprecision(1) << result.wall_ms
+            << "\n";
+    }
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,77 @@
+// state_fork.h
+// Copy-on-write forking of a running simulation for what-if experiments
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include "sim_engine.h"
+
+namespace gpu_simulator {
+
+// One what-if variant: a name and the change applied to the child's copy
+struct ForkVariant {
+    std::string                             name;
+    std::function<void(SimulationEngine&)>  apply;
+};
+
+struct ForkResult {
+    std::string name;
+    bool        ok;              // Child ran to completion and reported back
+    SimStats    stats;
+    uint64_t    copied_pages;    // Pages the child faulted in (copy-on-write copies)
+    double      wall_ms;         // Child run time
+};
+
+// Snapshots a live engine by forking the process: every child starts from
+// the parent's exact state, shares all untouched pages with it, applies its
+// variant and continues. Spawning is a page-table copy, so N variants cost
+// milliseconds plus whatever each child dirties. The parent engine is left
+// untouched. Where fork() is unavailable the snapshot falls back to a
+// checkpoint file and the variants run one after another.
+//
+// Fork from a thread that owns the engine and holds no locks; worker
+// threads of the parent do not exist in the children.
+class StateForker {
+public:
+    // How a child continues after applying its variant (default: run())
+    using Continuation = std::function<void(SimulationEngine&)>;
+
+    // Constructor (max_children 0 = all variants at once)
+    explicit StateForker(uint32_t max_children = 0);
+
+    std::vector<ForkResult> run(SimulationEngine& parent,
+                                const std::vector<ForkVariant>& variants,
+                                Continuation continuation = nullptr) const;
+
+    // What run() falls back to without fork(): the parent is saved to a
+    // checkpoint file and each variant restores it into a fresh engine, one
+    // after another (trace-mode engines only, like every checkpoint)
+    std::vector<ForkResult> run_from_checkpoint(SimulationEngine& parent,
+                                                const std::vector<ForkVariant>& variants,
+                                                const Continuation& continuation = nullptr) const;
+
+    // Time spent creating children (or writing the checkpoint) in the last run
+    double spawn_ms() const { return spawn_ms_; }
+
+    static void print_results(const std::vector<ForkResult>& results, std::ostream& out);
+
+private:
+    // Fixed-size record a child sends back over its pipe
+    struct ChildReport {
+        SimStats stats;
+        uint64_t copied_pages;
+        double   wall_ms;
+    };
+
+    static ChildReport run_child(SimulationEngine& engine, const ForkVariant& variant,
+                                 const Continuation& continuation);
+
+    uint32_t max_children_;
+    mutable double spawn_ms_;
+};
+
+} // namespace gpu_simulator
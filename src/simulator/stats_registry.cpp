@@ -0,0 +1,442 @@
+// stats_registry.cpp
+// Implementation of the central statistics registry
+
+#include "stats_registry.h"
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+namespace {
+
+constexpr std::align_val_t SLOT_ALIGNMENT{64};
+
+// JSON has no NaN or infinity; undefined ratios are written as null
+void write_json_number(std::ostream& out, double value) {
+    if (std::isfinite(value)) {
+        out << value;
+    } else {
+        out << "null";
+    }
+}
+
+std::vector<std::string> split_path(const std::string& name) {
+    return utils::StringUtils::split(name, '.');
+}
+
+} // namespace
+
+double Histogram::mean() const {
+    return samples() == 0 ? 0.0
+                          : static_cast<double>(sum()) / static_cast<double>(samples());
+}
+
+// ---------------------------------------------------------------------------
+// StatGroup
+// ---------------------------------------------------------------------------
+
+StatGroup::StatGroup(StatsRegistry& registry, const std::string& prefix)
+    : registry_(&registry)
+    , prefix_(prefix) {
+    registry_->align_to_line();
+}
+
+std::string StatGroup::path(const std::string& name) const {
+    return prefix_.empty() ? name : prefix_ + "." + name;
+}
+
+Counter StatGroup::counter(const std::string& name, const std::string& description) {
+    return registry_->counter(path(name), description);
+}
+
+Histogram StatGroup::histogram(const std::string& name, const std::string& description,
+                               uint32_t num_buckets, uint64_t bucket_width) {
+    return registry_->histogram(path(name), description, num_buckets, bucket_width);
+}
+
+void StatGroup::formula(const std::string& name, const std::string& description,
+                        std::function<double()> evaluate) {
+    registry_->formula(path(name), description, std::move(evaluate));
+}
+
+StatGroup StatGroup::group(const std::string& name) {
+    return StatGroup(*registry_, path(name));
+}
+
+void StatGroup::reset() {
+    registry_->reset(prefix_);
+}
+
+// ---------------------------------------------------------------------------
+// StatsRegistry
+// ---------------------------------------------------------------------------
+
+StatsRegistry::StatsRegistry(uint32_t capacity)
+    : slots_(nullptr)
+    , capacity_((capacity + SLOTS_PER_LINE - 1) / SLOTS_PER_LINE * SLOTS_PER_LINE)
+    , used_(0) {
+    if (capacity_ == 0) {
+        throw std::invalid_argument("Stats registry needs a non-zero capacity");
+    }
+    slots_ = static_cast<uint64_t*>(
+        ::operator new[](capacity_ * sizeof(uint64_t), SLOT_ALIGNMENT));
+    std::fill(slots_, slots_ + capacity_, 0);
+}
+
+StatsRegistry::~StatsRegistry() {
+    ::operator delete[](slots_, SLOT_ALIGNMENT);
+}
+
+StatGroup StatsRegistry::group(const std::string& prefix) {
+    return StatGroup(*this, prefix);
+}
+
+void StatsRegistry::align_to_line() {
+    used_ = std::min(capacity_, (used_ + SLOTS_PER_LINE - 1) / SLOTS_PER_LINE * SLOTS_PER_LINE);
+}
+
+uint32_t StatsRegistry::allocate(uint32_t count) {
+    // Handles point straight into the array, so it can never grow
+    if (count > capacity_ - used_) {
+        throw std::runtime_error("Stats registry capacity of " +
+                                 std::to_string(capacity_) + " slots exhausted");
+    }
+    uint32_t first = used_;
+    used_ += count;
+    return first;
+}
+
+void StatsRegistry::add_entry(Entry entry) {
+    const std::vector<std::string> parts = split_path(entry.name);
+    if (parts.empty() || entry.name.back() == '.' || std::any_of(parts.begin(), parts.end(),
+                                     [](const std::string& part) { return part.empty(); })) {
+        throw std::invalid_argument("Invalid statistic name '" + entry.name + "'");
+    }
+    // A name may not also be the group of another statistic
+    for (const auto& existing : entries_) {
+        const std::string& shorter = existing.name.size() < entry.name.size() ? existing.name
+                                                                              : entry.name;
+        const std::string& longer = existing.name.size() < entry.name.size() ? entry.name
+                                                                             : existing.name;
+        if (existing.name == entry.name ||
+            (utils::StringUtils::starts_with(longer, shorter) && longer[shorter.size()] == '.')) {
+            throw std::invalid_argument("Statistic '" + entry.name +
+                                        "' clashes with '" + existing.name + "'");
+        }
+    }
+    entries_.push_back(std::move(entry));
+}
+
+Counter StatsRegistry::counter(const std::string& name, const std::string& description) {
+    Entry entry{name, description, Kind::COUNTER, 0, 0, 1, nullptr};
+    entry.first_slot = allocate(1);
+    Counter handle(slots_ + entry.first_slot);
+    add_entry(std::move(entry));
+    return handle;
+}
+
+Histogram StatsRegistry::histogram(const std::string& name, const std::string& description,
+                                   uint32_t num_buckets, uint64_t bucket_width) {
+    if (num_buckets == 0 || bucket_width == 0) {
+        throw std::invalid_argument("Histogram '" + name + "' needs buckets of non-zero width");
+    }
+    // Buckets, overflow, sample count and sum
+    Entry entry{name, description, Kind::HISTOGRAM, 0, num_buckets, bucket_width, nullptr};
+    entry.first_slot = allocate(num_buckets + 3);
+    Histogram handle = histogram_at(entry);
+    add_entry(std::move(entry));
+    return handle;
+}
+
+void StatsRegistry::formula(const std::string& name, const std::string& description,
+                            std::function<double()> evaluate) {
+    if (!evaluate) {
+        throw std::invalid_argument("Formula '" + name + "' has no expression");
+    }
+    add_entry(Entry{name, description, Kind::FORMULA, 0, 0, 1, std::move(evaluate)});
+}
+
+Histogram StatsRegistry::histogram_at(const Entry& entry) const {
+    return Histogram(slots_ + entry.first_slot, entry.num_buckets, entry.bucket_width);
+}
+
+const StatsRegistry::Entry& StatsRegistry::find(const std::string& name) const {
+    for (const auto& entry : entries_) {
+        if (entry.name == name) {
+            return entry;
+        }
+    }
+    throw std::invalid_argument("Unknown statistic '" + name + "'");
+}
+
+bool StatsRegistry::contains(const std::string& name) const {
+    return std::any_of(entries_.begin(), entries_.end(),
+                       [&](const Entry& entry) { return entry.name == name; });
+}
+
+uint64_t StatsRegistry::counter_value(const std::string& name) const {
+    const Entry& entry = find(name);
+    if (entry.kind != Kind::COUNTER) {
+        throw std::invalid_argument("Statistic '" + name + "' is not a counter");
+    }
+    return slots_[entry.first_slot];
+}
+
+double StatsRegistry::scalar(const Entry& entry) const {
+    switch (entry.kind) {
+        case Kind::COUNTER:   return static_cast<double>(slots_[entry.first_slot]);
+        case Kind::HISTOGRAM: return histogram_at(entry).mean();
+        case Kind::FORMULA:   return entry.evaluate();
+    }
+    return 0.0;
+}
+
+double StatsRegistry::value(const std::string& name) const {
+    return scalar(find(name));
+}
+
+void StatsRegistry::reset() {
+    std::fill(slots_, slots_ + used_, 0);
+}
+
+void StatsRegistry::reset(const std::string& prefix) {
+    if (prefix.empty()) {
+        reset();
+        return;
+    }
+    for (const auto& entry : entries_) {
+        bool in_group = entry.name == prefix ||
+                        (utils::StringUtils::starts_with(entry.name, prefix) &&
+                         entry.name[prefix.size()] == '.');
+        if (!in_group || entry.kind == Kind::FORMULA) {
+            continue;
+        }
+        uint32_t count = entry.kind == Kind::HISTOGRAM ? entry.num_buckets + 3 : 1;
+        std::fill(slots_ + entry.first_slot, slots_ + entry.first_slot + count, 0);
+    }
+}
+
+std::vector<const StatsRegistry::Entry*> StatsRegistry::sorted_entries() const {
+    std::vector<const Entry*> sorted;
+    sorted.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Entry* a, const Entry* b) { return a->name < b->name; });
+    return sorted;
+}
+
+void StatsRegistry::dump(std::ostream& out, StatsFormat format) const {
+    switch (format) {
+        case StatsFormat::TEXT:
+            dump_text(out);
+            break;
+        case StatsFormat::JSON:
+            dump_json(out);
+            break;
+        case StatsFormat::CSV:
+            write_csv_header(out);
+            write_csv_row(out, 0);
+            break;
+    }
+}
+
+void StatsRegistry::dump_text(std::ostream& out) const {
+    auto line = [&](const std::string& name, const std::string& value,
+                    const std::string& description) {
+        out << std::left << std::setw(48) << name << " "
+            << std::right << std::setw(16) << value;
+        if (!description.empty()) {
+            out << "  # " << description;
+        }
+        out << "\n";
+    };
+    auto format_double = [](double value) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(6) << value;
+        return text.str();
+    };
+
+    out << "---------- Begin Simulation Statistics ----------\n";
+    for (const Entry* entry : sorted_entries()) {
+        switch (entry->kind) {
+            case Kind::COUNTER:
+                line(entry->name, std::to_string(slots_[entry->first_slot]), entry->description);
+                break;
+            case Kind::FORMULA:
+                line(entry->name, format_double(entry->evaluate()), entry->description);
+                break;
+            case Kind::HISTOGRAM: {
+                Histogram histogram = histogram_at(*entry);
+                line(entry->name + "::samples", std::to_string(histogram.samples()),
+                     entry->description);
+                line(entry->name + "::mean", format_double(histogram.mean()), "");
+                for (uint32_t i = 0; i < histogram.num_buckets(); ++i) {
+                    uint64_t low = i * histogram.bucket_width();
+                    line(entry->name + "::" + std::to_string(low) + "-" +
+                             std::to_string(low + histogram.bucket_width() - 1),
+                         std::to_string(histogram.bucket(i)), "");
+                }
+                line(entry->name + "::overflows", std::to_string(histogram.overflow()), "");
+                break;
+            }
+        }
+    }
+    out << "---------- End Simulation Statistics   ----------\n";
+}
+
+void StatsRegistry::dump_json(std::ostream& out) const {
+    // Sorted dotted names keep every group contiguous, so the nesting can be
+    // written in one pass by closing and opening objects as the path changes
+    std::vector<std::string> open;
+    bool first_in_object = true;
+    auto indent = [&](size_t depth) { out << std::string(2 * (depth + 1), ' '); };
+
+    out << "{";
+    for (const Entry* entry : sorted_entries()) {
+        std::vector<std::string> parts = split_path(entry->name);
+        std::string leaf = parts.back();
+        parts.pop_back();
+
+        size_t common = 0;
+        while (common < open.size() && common < parts.size() && open[common] == parts[common]) {
+            common++;
+        }
+        while (open.size() > common) {
+            open.pop_back();
+            out << "\n";
+            indent(open.size());
+            out << "}";
+            first_in_object = false;
+        }
+        while (open.size() < parts.size()) {
+            out << (first_in_object ? "\n" : ",\n");
+            indent(open.size());
+            out << "\"" << parts[open.size()] << "\": {";
+            open.push_back(parts[open.size()]);
+            first_in_object = true;
+        }
+
+        out << (first_in_object ? "\n" : ",\n");
+        indent(open.size());
+        out << "\"" << leaf << "\": ";
+        first_in_object = false;
+
+        switch (entry->kind) {
+            case Kind::COUNTER:
+                out << slots_[entry->first_slot];
+                break;
+            case Kind::FORMULA:
+                write_json_number(out, entry->evaluate());
+                break;
+            case Kind::HISTOGRAM: {
+                Histogram histogram = histogram_at(*entry);
+                out << "{\"samples\": " << histogram.samples()
+                    << ", \"sum\": " << histogram.sum()
+                    << ", \"mean\": ";
+                write_json_number(out, histogram.mean());
+                out << ", \"bucket_width\": " << histogram.bucket_width()
+                    << ", \"buckets\": [";
+                for (uint32_t i = 0; i < histogram.num_buckets(); ++i) {
+                    out << (i ? ", " : "") << histogram.bucket(i);
+                }
+                out << "], \"overflows\": " << histogram.overflow() << "}";
+                break;
+            }
+        }
+    }
+    while (!open.empty()) {
+        open.pop_back();
+        out << "\n";
+        indent(open.size());
+        out << "}";
+    }
+    out << "\n}\n";
+}
+
+void StatsRegistry::write_csv_header(std::ostream& out) const {
+    out << "tick";
+    for (const Entry* entry : sorted_entries()) {
+        if (entry->kind == Kind::HISTOGRAM) {
+            out << "," << entry->name << "::samples," << entry->name << "::mean";
+        } else {
+            out << "," << entry->name;
+        }
+    }
+    out << "\n";
+}
+
+void StatsRegistry::write_csv_row(std::ostream& out, uint64_t tick) const {
+    write_csv_values(out, tick, slots_);
+}
+
+void StatsRegistry::write_csv_values(std::ostream& out, uint64_t tick,
+                                     const uint64_t* values) const {
+    out << tick;
+    for (const Entry* entry : sorted_entries()) {
+        switch (entry->kind) {
+            case Kind::COUNTER:
+                out << "," << values[entry->first_slot];
+                break;
+            case Kind::FORMULA:
+                out << "," << entry->evaluate();
+                break;
+            case Kind::HISTOGRAM: {
+                Histogram histogram = histogram_at(*entry);
+                out << "," << histogram.samples() << "," << histogram.mean();
+                break;
+            }
+        }
+    }
+    out << "\n";
+}
+
+std::vector<uint64_t> StatsRegistry::snapshot() const {
+    return std::vector<uint64_t>(slots_, slots_ + used_);
+}
+
+void StatsRegistry::write_csv_row(std::ostream& out, uint64_t tick,
+                                  const std::vector<uint64_t>& since) const {
+    // Slots registered after the snapshot count from zero
+    std::vector<uint64_t> interval(slots_, slots_ + used_);
+    size_t count = std::min<size_t>(since.size(), used_);
+    for (size_t i = 0; i < count; ++i) {
+        interval[i] -= since[i];
+    }
+
+    // Histograms and formulas read through handles into slots_
+    detail::SlotView saved = detail::slot_view;
+    detail::slot_view = detail::SlotView{slots_, slots_ + used_, interval.data()};
+    try {
+        write_csv_values(out, tick, interval.data());
+    } catch (...) {
+        detail::slot_view = saved;
+        throw;
+    }
+    detail::slot_view = saved;
+}
+
+void StatsRegistry::dump_to_file(const std::string& filename, StatsFormat format) const {
+    std::ofstream out(filename);
+    if (!out) {
+        throw std::runtime_error("Cannot open stats file: " + filename);
+    }
+    dump(out, format);
+}
+
+StatsFormat StatsRegistry::parse_format(const std::string& name) {
+    std::string key = utils::StringUtils::to_lower(name);
+    if (key == "text" || key == "txt") return StatsFormat::TEXT;
+    if (key == "json")                 return StatsFormat::JSON;
+    if (key == "csv")                  return StatsFormat::CSV;
+    throw std::invalid_argument("Unknown stats format '" + name + "'");
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,206 @@
+// stats_registry.h
+// Central registry of named counters, histograms and formulas
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+namespace gpu_simulator {
+
+class StatsRegistry;
+
+namespace detail {
+
+// While a registry writes an interval row, reads of its slots through
+// handles, and so its formulas, see that thread's private copy of the
+// interval's values; the live slots are never modified
+struct SlotView {
+    const uint64_t* begin = nullptr;
+    const uint64_t* end = nullptr;
+    const uint64_t* values = nullptr;
+};
+
+inline thread_local SlotView slot_view;
+
+inline uint64_t read_slot(const uint64_t* slot) {
+    const SlotView& view = slot_view;
+    std::less<const uint64_t*> before;
+    if (view.values && !before(slot, view.begin) && before(slot, view.end)) {
+        return view.values[slot - view.begin];
+    }
+    return *slot;
+}
+
+} // namespace detail
+
+// Handle to one counter slot. Increments are a plain add on the registry's
+// storage; a default-constructed handle must not be used.
+class Counter {
+public:
+    Counter() : slot_(nullptr) {}
+
+    Counter& operator++() { ++*slot_; return *this; }
+    void operator++(int) { ++*slot_; }
+    Counter& operator+=(uint64_t delta) { *slot_ += delta; return *this; }
+    uint64_t value() const { return detail::read_slot(slot_); }
+    void set(uint64_t value) { *slot_ = value; }
+
+private:
+    friend class StatsRegistry;
+    explicit Counter(uint64_t* slot) : slot_(slot) {}
+
+    uint64_t* slot_;
+};
+
+// Handle to a linear histogram: num_buckets buckets of bucket_width starting
+// at zero, plus an overflow bucket. Sample count and sum share the storage.
+class Histogram {
+public:
+    Histogram() : slots_(nullptr), num_buckets_(0), bucket_width_(1) {}
+
+    void sample(uint64_t value) {
+        uint64_t bucket = value / bucket_width_;
+        ++slots_[bucket < num_buckets_ ? bucket : num_buckets_];
+        ++slots_[num_buckets_ + 1];
+        slots_[num_buckets_ + 2] += value;
+    }
+
+    uint64_t bucket(uint32_t index) const { return detail::read_slot(slots_ + index); }
+    uint64_t overflow() const { return detail::read_slot(slots_ + num_buckets_); }
+    uint64_t samples() const { return detail::read_slot(slots_ + num_buckets_ + 1); }
+    uint64_t sum() const { return detail::read_slot(slots_ + num_buckets_ + 2); }
+    double mean() const;
+    uint32_t num_buckets() const { return num_buckets_; }
+    uint64_t bucket_width() const { return bucket_width_; }
+
+private:
+    friend class StatsRegistry;
+    Histogram(uint64_t* slots, uint32_t num_buckets, uint64_t bucket_width)
+        : slots_(slots), num_buckets_(num_buckets), bucket_width_(bucket_width) {}
+
+    uint64_t* slots_;
+    uint32_t num_buckets_;
+    uint64_t bucket_width_;
+};
+
+// Registration scope: every statistic created through a group is named
+// "<prefix>.<name>", and each group starts on a fresh cache line so the hot
+// counters of different components never share one.
+class StatGroup {
+public:
+    StatGroup(StatsRegistry& registry, const std::string& prefix);
+
+    Counter counter(const std::string& name, const std::string& description);
+    Histogram histogram(const std::string& name, const std::string& description,
+                        uint32_t num_buckets, uint64_t bucket_width);
+    void formula(const std::string& name, const std::string& description,
+                 std::function<double()> evaluate);
+    StatGroup group(const std::string& name);
+
+    const std::string& prefix() const { return prefix_; }
+    void reset();
+
+private:
+    std::string path(const std::string& name) const;
+
+    StatsRegistry* registry_;
+    std::string prefix_;
+};
+
+enum class StatsFormat {
+    TEXT,    // gem5-style "name value # description" lines
+    JSON,    // Nested object following the dotted names
+    CSV      // Header plus one row
+};
+
+// Owns the storage for every statistic of one simulator instance. Slots live
+// in a single fixed-capacity, cache-line-aligned array so handles stay valid
+// for the registry's lifetime. Dumps list statistics sorted by name.
+class StatsRegistry {
+public:
+    static constexpr uint32_t SLOTS_PER_LINE = 8;   // 64-byte cache lines
+    static constexpr uint32_t DEFAULT_CAPACITY = 1024;
+
+    // Constructor and destructor
+    explicit StatsRegistry(uint32_t capacity = DEFAULT_CAPACITY);
+    ~StatsRegistry();
+
+    // Delete copy constructor and assignment
+    StatsRegistry(const StatsRegistry&) = delete;
+    StatsRegistry& operator=(const StatsRegistry&) = delete;
+
+    // Registration (full dotted names; duplicates are rejected)
+    StatGroup group(const std::string& prefix);
+    Counter counter(const std::string& name, const std::string& description);
+    Histogram histogram(const std::string& name, const std::string& description,
+                        uint32_t num_buckets, uint64_t bucket_width);
+    void formula(const std::string& name, const std::string& description,
+                 std::function<double()> evaluate);
+
+    // Lookup by full name (throws if absent)
+    uint64_t counter_value(const std::string& name) const;
+    double value(const std::string& name) const;
+    bool contains(const std::string& name) const;
+
+    // Interval support: zero every counter and histogram, or only those
+    // under a dotted prefix. Formulas follow their inputs.
+    void reset();
+    void reset(const std::string& prefix);
+
+    // Interval support without losing totals: a copy of every slot, and a
+    // CSV row of what changed since one. The differences go to a local copy
+    // that formulas read while the row is written, so the live counters
+    // stay untouched for other readers.
+    std::vector<uint64_t> snapshot() const;
+    void write_csv_row(std::ostream& out, uint64_t tick,
+                       const std::vector<uint64_t>& since) const;
+
+    // Reporting
+    void dump(std::ostream& out, StatsFormat format) const;
+    void dump_text(std::ostream& out) const;
+    void dump_json(std::ostream& out) const;
+    void write_csv_header(std::ostream& out) const;
+    void write_csv_row(std::ostream& out, uint64_t tick) const;
+    void dump_to_file(const std::string& filename, StatsFormat format) const;
+
+    static StatsFormat parse_format(const std::string& name);
+
+    // Storage accounting
+    uint32_t slots_used() const { return used_; }
+    uint32_t capacity() const { return capacity_; }
+
+private:
+    friend class StatGroup;
+
+    enum class Kind { COUNTER, HISTOGRAM, FORMULA };
+
+    struct Entry {
+        std::string name;
+        std::string description;
+        Kind kind;
+        uint32_t first_slot;
+        uint32_t num_buckets;
+        uint64_t bucket_width;
+        std::function<double()> evaluate;
+    };
+
+    uint32_t allocate(uint32_t count);
+    void align_to_line();
+    void add_entry(Entry entry);
+    const Entry& find(const std::string& name) const;
+    std::vector<const Entry*> sorted_entries() const;
+    Histogram histogram_at(const Entry& entry) const;
+    double scalar(const Entry& entry) const;
+    void write_csv_values(std::ostream& out, uint64_t tick, const uint64_t* values) const;
+
+    uint64_t* slots_;
+    uint32_t capacity_;
+    uint32_t used_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace gpu_simulator
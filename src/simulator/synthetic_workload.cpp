@@ -0,0 +1,271 @@
+// synthetic_workload.cpp
+// Implementation of synthetic memory-access streams
+
+#include "synthetic_workload.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+SyntheticConfig SyntheticConfig::defaults(AccessPattern pattern) {
+    SyntheticConfig config{};
+    config.pattern = pattern;
+    config.num_requests = 1000000;
+    config.base_address = 0x100000;
+    config.footprint = 4 * 1024 * 1024;
+    config.line_size = 64;
+    config.stride = 256;
+    config.write_fraction = 0.2;
+    config.hot_fraction = 0.05;
+    config.hot_probability = 0.9;
+    config.zipf_alpha = 0.99;
+    config.num_warps = 32;
+    config.issue_interval = 1;
+    config.seed = 42;
+    return config;
+}
+
+SyntheticWorkloadGenerator::SyntheticWorkloadGenerator(const SyntheticConfig& config)
+    : config_(config)
+    , random_(config.seed)
+    , generated_(0)
+    , num_lines_(0) {
+    if (config.line_size < 4 || (config.line_size & (config.line_size - 1)) != 0) {
+        throw std::invalid_argument("Synthetic line size must be a power of two of at least 4");
+    }
+    if (config.footprint < config.line_size) {
+        throw std::invalid_argument("Synthetic footprint must cover at least one line");
+    }
+    if (config.num_warps == 0) {
+        throw std::invalid_argument("Synthetic workload needs at least one warp");
+    }
+    if (config.pattern == AccessPattern::STRIDED && config.stride == 0) {
+        throw std::invalid_argument("Strided pattern needs a non-zero stride");
+    }
+    num_lines_ = config.footprint / config.line_size;
+    reset();
+}
+
+void SyntheticWorkloadGenerator::reset() {
+    random_ = utils::Random(config_.seed);
+    generated_ = 0;
+    cursor_.assign(config_.num_warps, 0);
+    permutation_.clear();
+    zipf_cdf_.clear();
+
+    if (config_.pattern == AccessPattern::POINTER_CHASE) {
+        build_permutation();
+        // Warps start spread out along the single cycle
+        uint32_t line = 0;
+        uint32_t spacing = std::max<uint32_t>(num_lines_ / config_.num_warps, 1);
+        for (uint32_t warp = 0; warp < config_.num_warps; ++warp) {
+            cursor_[warp] = line;
+            for (uint32_t step = 0; step < spacing; ++step) {
+                line = permutation_[line];
+            }
+        }
+    } else if (config_.pattern == AccessPattern::ZIPFIAN) {
+        build_zipf_table();
+    }
+}
+
+void SyntheticWorkloadGenerator::build_permutation() {
+    // Sattolo's algorithm: a uniformly random permutation with one cycle,
+    // so the chase visits every line before repeating
+    std::vector<uint32_t> order(num_lines_);
+    for (uint32_t i = 0; i < num_lines_; ++i) {
+        order[i] = i;
+    }
+    for (uint32_t i = num_lines_ - 1; i > 0; --i) {
+        uint32_t j = static_cast<uint32_t>(random_.get_int(0, static_cast<int>(i) - 1));
+        std::swap(order[i], order[j]);
+    }
+    permutation_.assign(num_lines_, 0);
+    for (uint32_t i = 0; i < num_lines_; ++i) {
+        permutation_[order[i]] = order[(i + 1) % num_lines_];
+    }
+}
+
+void SyntheticWorkloadGenerator::build_zipf_table() {
+    // Popularity by rank, with ranks scattered over the footprint so hot
+    // lines do not all share a few cache sets
+    zipf_cdf_.resize(num_lines_);
+    double sum = 0.0;
+    for (uint32_t rank = 0; rank < num_lines_; ++rank) {
+        sum += 1.0 / std::pow(static_cast<double>(rank + 1), config_.zipf_alpha);
+        zipf_cdf_[rank] = sum;
+    }
+    for (auto& value : zipf_cdf_) {
+        value /= sum;
+    }
+
+    permutation_.resize(num_lines_);
+    for (uint32_t i = 0; i < num_lines_; ++i) {
+        permutation_[i] = i;
+    }
+    for (uint32_t i = num_lines_ - 1; i > 0; --i) {
+        std::swap(permutation_[i],
+                  permutation_[static_cast<uint32_t>(random_.get_int(0, static_cast<int>(i)))]);
+    }
+}
+
+uint32_t SyntheticWorkloadGenerator::random_line() {
+    return static_cast<uint32_t>(random_.get_int(0, static_cast<int>(num_lines_) - 1));
+}
+
+uint32_t SyntheticWorkloadGenerator::next_address(uint32_t warp) {
+    const uint32_t words_per_line = config_.line_size / 4;
+    auto word_in_line = [&]() {
+        return static_cast<uint32_t>(random_.get_int(0, static_cast<int>(words_per_line) - 1)) * 4;
+    };
+
+    uint32_t offset = 0;
+    switch (config_.pattern) {
+        case AccessPattern::STREAMING:
+            offset = static_cast<uint32_t>((generated_ * 4) % config_.footprint);
+            break;
+        case AccessPattern::STRIDED:
+            offset = static_cast<uint32_t>((generated_ * config_.stride) % config_.footprint) & ~3u;
+            break;
+        case AccessPattern::RANDOM:
+            offset = static_cast<uint32_t>(random_.get_int(0, static_cast<int>(config_.footprint / 4) - 1)) * 4;
+            break;
+        case AccessPattern::POINTER_CHASE:
+            offset = cursor_[warp] * config_.line_size;
+            cursor_[warp] = permutation_[cursor_[warp]];
+            break;
+        case AccessPattern::HOT_SET: {
+            uint32_t hot_lines = std::clamp<uint32_t>(
+                static_cast<uint32_t>(num_lines_ * config_.hot_fraction), 1, num_lines_);
+            uint32_t line;
+            if (hot_lines == num_lines_ || random_.get_bool(config_.hot_probability)) {
+                line = static_cast<uint32_t>(random_.get_int(0, static_cast<int>(hot_lines) - 1));
+            } else {
+                line = static_cast<uint32_t>(random_.get_int(static_cast<int>(hot_lines),
+                                                             static_cast<int>(num_lines_) - 1));
+            }
+            offset = line * config_.line_size + word_in_line();
+            break;
+        }
+        case AccessPattern::ZIPFIAN: {
+            double u = random_.get_double(0.0, 1.0);
+            auto rank = static_cast<uint32_t>(
+                std::lower_bound(zipf_cdf_.begin(), zipf_cdf_.end(), u) - zipf_cdf_.begin());
+            offset = permutation_[std::min(rank, num_lines_ - 1)] * config_.line_size + word_in_line();
+            break;
+        }
+        case AccessPattern::INTERLEAVED: {
+            uint32_t slice = std::max<uint32_t>(num_lines_ / config_.num_warps, 1) * config_.line_size;
+            offset = (warp * slice) % config_.footprint + (cursor_[warp] * 4) % slice;
+            cursor_[warp]++;
+            break;
+        }
+    }
+    return config_.base_address + offset;
+}
+
+std::vector<TraceRecord> SyntheticWorkloadGenerator::next(uint64_t max_records) {
+    uint64_t count = std::min(max_records, config_.num_requests - generated_);
+    std::vector<TraceRecord> records;
+    records.reserve(count);
+
+    for (uint64_t i = 0; i < count; ++i) {
+        uint32_t warp = static_cast<uint32_t>(generated_ % config_.num_warps);
+        SimTime time = (generated_ / config_.num_warps) * config_.issue_interval;
+        uint32_t address = next_address(warp);
+        bool is_write = config_.write_fraction > 0.0 && random_.get_bool(config_.write_fraction);
+
+        records.push_back({time, MemoryTransaction{address, static_cast<uint32_t>(generated_),
+                                                   is_write, 4, warp, 0xFFFFFFFF}});
+        generated_++;
+    }
+    return records;
+}
+
+std::vector<TraceRecord> SyntheticWorkloadGenerator::generate() {
+    reset();
+    return next(config_.num_requests);
+}
+
+uint64_t SyntheticWorkloadGenerator::inject(SimulationEngine& engine, uint64_t chunk_size) {
+    reset();
+    uint64_t injected = 0;
+    while (true) {
+        std::vector<TraceRecord> chunk = next(std::max<uint64_t>(chunk_size, 1));
+        if (chunk.empty()) {
+            break;
+        }
+        engine.inject_trace(chunk);
+        injected += chunk.size();
+    }
+    return injected;
+}
+
+uint64_t SyntheticWorkloadGenerator::run(SimulationEngine& engine, SimTime end_time,
+                                         uint64_t chunk_size) {
+    reset();
+    uint64_t injected = 0;
+    auto truncated = [&] {
+        return std::runtime_error(
+            "Synthetic stream truncated: the engine stopped at cycle " +
+            std::to_string(engine.get_current_time()) + " of " + std::to_string(end_time) +
+            " with " + std::to_string(injected) + " of " +
+            std::to_string(config_.num_requests) + " requests injected (limit " +
+            std::to_string(SimulationEngine::MAX_SIMULATION_CYCLES) + " cycles)");
+    };
+
+    std::vector<TraceRecord> chunk = next(std::max<uint64_t>(chunk_size, 1));
+    while (!chunk.empty() && chunk.front().time < end_time) {
+        if (!engine.run_until(chunk.front().time)) {
+            throw truncated();
+        }
+
+        // Trace times count from the engine's current cycle
+        SimTime now = engine.get_current_time();
+        for (auto& record : chunk) {
+            record.time = record.time > now ? record.time - now : 0;
+        }
+        engine.inject_trace(chunk);
+        injected += chunk.size();
+        chunk = next(std::max<uint64_t>(chunk_size, 1));
+    }
+    if (!engine.run_until(end_time)) {
+        throw truncated();
+    }
+    return injected;
+}
+
+SimTime SyntheticWorkloadGenerator::end_time() const {
+    if (config_.num_requests == 0) {
+        return 0;
+    }
+    return ((config_.num_requests - 1) / config_.num_warps) * config_.issue_interval;
+}
+
+AccessPattern SyntheticWorkloadGenerator::parse_pattern(const std::string& name) {
+    std::string key = utils::StringUtils::to_lower(name);
+    if (key == "streaming")     return AccessPattern::STREAMING;
+    if (key == "strided")       return AccessPattern::STRIDED;
+    if (key == "random")        return AccessPattern::RANDOM;
+    if (key == "pointer_chase") return AccessPattern::POINTER_CHASE;
+    if (key == "hot_set")       return AccessPattern::HOT_SET;
+    if (key == "zipfian")       return AccessPattern::ZIPFIAN;
+    if (key == "interleaved")   return AccessPattern::INTERLEAVED;
+    throw std::invalid_argument("Unknown access pattern '" + name + "'");
+}
+
+const char* SyntheticWorkloadGenerator::pattern_name(AccessPattern pattern) {
+    switch (pattern) {
+        case AccessPattern::STREAMING:     return "streaming";
+        case AccessPattern::STRIDED:       return "strided";
+        case AccessPattern::RANDOM:        return "random";
+        case AccessPattern::POINTER_CHASE: return "pointer_chase";
+        case AccessPattern::HOT_SET:       return "hot_set";
+        case AccessPattern::ZIPFIAN:       return "zipfian";
+        case AccessPattern::INTERLEAVED:   return "interleaved";
+    }
+    return "unknown";
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,90 @@
+// synthetic_workload.h
+// Parameterized synthetic memory-access streams for stress benchmarking
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "sim_engine.h"
+#include "utils.h"
+
+namespace gpu_simulator {
+
+enum class AccessPattern {
+    STREAMING,       // One sequential sweep over the footprint
+    STRIDED,         // Fixed stride, wrapping around the footprint
+    RANDOM,          // Uniform words anywhere in the footprint
+    POINTER_CHASE,   // Walk of a random single-cycle permutation of lines
+    HOT_SET,         // hot_probability of accesses go to the first hot_fraction
+    ZIPFIAN,         // Line popularity follows a Zipf(zipf_alpha) law
+    INTERLEAVED      // Each warp streams through its own slice, round-robin
+};
+
+struct SyntheticConfig {
+    AccessPattern pattern;
+    uint64_t num_requests;
+    uint32_t base_address;
+    uint32_t footprint;          // Bytes covered by the pattern
+    uint32_t line_size;          // Granularity of chase, hot-set and Zipf lines
+    uint32_t stride;             // STRIDED: bytes between accesses
+    double   write_fraction;
+    double   hot_fraction;       // HOT_SET: share of the footprint that is hot
+    double   hot_probability;    // HOT_SET: share of accesses to the hot part
+    double   zipf_alpha;         // ZIPFIAN: skew (0 = uniform)
+    uint32_t num_warps;          // Requests rotate over warps
+    uint32_t issue_interval;     // Cycles between rounds of one request per warp
+    uint32_t seed;
+
+    // Reasonable settings for a pattern (1M requests over 4 MB, 32 warps)
+    static SyntheticConfig defaults(AccessPattern pattern);
+};
+
+// Generates reproducible MemoryTransaction streams: the same configuration
+// and seed always produce the same addresses, data and timing. Every
+// request is a 4-byte access; request i belongs to warp i % num_warps and
+// issues at (i / num_warps) * issue_interval.
+class SyntheticWorkloadGenerator {
+public:
+    // Constructor
+    explicit SyntheticWorkloadGenerator(const SyntheticConfig& config);
+
+    // Next chunk of at most max_records requests (empty once exhausted)
+    std::vector<TraceRecord> next(uint64_t max_records);
+
+    // Whole stream at once: generate() returns it, inject() queues all of
+    // it in the engine (built chunk by chunk, but every request is then
+    // held in the event queue). Returns the number injected.
+    std::vector<TraceRecord> generate();
+    uint64_t inject(SimulationEngine& engine, uint64_t chunk_size = 65536);
+
+    // Run an engine over the stream until end_time while holding about one
+    // chunk of requests: each chunk is queued only when the engine reaches
+    // its first request, so memory stays bounded for millions of requests.
+    // Returns the number injected; runtime_error if the engine stops (at
+    // its cycle limit) before reaching end_time.
+    uint64_t run(SimulationEngine& engine, SimTime end_time, uint64_t chunk_size = 65536);
+
+    // Time of the last request
+    SimTime end_time() const;
+    void reset();
+
+    static AccessPattern parse_pattern(const std::string& name);
+    static const char* pattern_name(AccessPattern pattern);
+
+private:
+    uint32_t next_address(uint32_t warp);
+    uint32_t random_line();
+    void build_permutation();
+    void build_zipf_table();
+
+    SyntheticConfig config_;
+    utils::Random random_;
+    uint64_t generated_;
+    uint32_t num_lines_;
+    std::vector<uint32_t> cursor_;         // Per-warp position (stream, chase)
+    std::vector<uint32_t> permutation_;    // Chase successor / Zipf rank -> line
+    std::vector<double> zipf_cdf_;
+};
+
+} // namespace gpu_simulator
@@ -0,0 +1,241 @@
+// timeline_trace.cpp
+// Implementation of the streaming Chrome Trace Event writer
+
+#include "timeline_trace.h"
+#include <charconv>
+#include <stdexcept>
+
+namespace gpu_simulator {
+
+TimelineTrace::TimelineTrace(std::ostream& out, uint64_t counter_interval)
+    : out_(out)
+    , counter_interval_(counter_interval)
+    , events_(0)
+    , next_async_id_(0)
+    , finished_(false) {
+    if (counter_interval_ == 0) {
+        throw std::invalid_argument("Timeline counter interval must be positive");
+    }
+    buffer_.reserve(FLUSH_THRESHOLD + 1024);
+    append("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"time_unit\":\"cycles\"},"
+           "\"traceEvents\":[");
+}
+
+TimelineTrace::TimelineTrace(const std::string& filename, uint64_t counter_interval)
+    : file_(filename, std::ios::trunc)
+    , out_(file_)
+    , counter_interval_(counter_interval)
+    , events_(0)
+    , next_async_id_(0)
+    , finished_(false) {
+    if (!file_) {
+        throw std::runtime_error("Could not open timeline file: " + filename);
+    }
+    if (counter_interval_ == 0) {
+        throw std::invalid_argument("Timeline counter interval must be positive");
+    }
+    buffer_.reserve(FLUSH_THRESHOLD + 1024);
+    append("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"time_unit\":\"cycles\"},"
+           "\"traceEvents\":[");
+}
+
+TimelineTrace::~TimelineTrace() {
+    finish();
+}
+
+void TimelineTrace::finish() {
+    if (finished_) {
+        return;
+    }
+    for (uint32_t pid = 0; pid < processes_.size(); ++pid) {
+        ProcessTracks& tracks = processes_[pid];
+        if (tracks.window_dirty) {
+            advance_counters(pid, tracks, tracks.window_start + counter_interval_);
+        }
+    }
+    append("\n]}\n");
+    flush_buffer();
+    out_.flush();
+    finished_ = true;
+}
+
+TimelineTrace::ProcessTracks& TimelineTrace::process(uint32_t pid) {
+    if (pid >= processes_.size()) {
+        processes_.resize(pid + 1);
+    }
+    ProcessTracks& tracks = processes_[pid];
+    if (!tracks.named) {
+        name_process(pid, "SM " + std::to_string(pid));
+    }
+    return tracks;
+}
+
+void TimelineTrace::name_process(uint32_t pid, const std::string& name) {
+    if (pid >= processes_.size()) {
+        processes_.resize(pid + 1);
+    }
+    processes_[pid].named = true;
+
+    begin_event();
+    append("\"name\":\"process_name\",\"ph\":\"M\",\"pid\":");
+    append(pid);
+    append(",\"args\":{\"name\":");
+    append_string(name);
+    append("}");
+    end_event();
+}
+
+void TimelineTrace::name_warp(uint32_t pid, ProcessTracks& tracks, uint32_t warp_id) {
+    if (warp_id < tracks.warps_named.size() && tracks.warps_named[warp_id]) {
+        return;
+    }
+    if (warp_id >= tracks.warps_named.size()) {
+        tracks.warps_named.resize(warp_id + 1, false);
+    }
+    tracks.warps_named[warp_id] = true;
+
+    begin_event();
+    append("\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":");
+    append(pid);
+    append(",\"tid\":");
+    append(warp_id);
+    append(",\"args\":{\"name\":\"warp ");
+    append(warp_id);
+    append("\"}");
+    end_event();
+}
+
+void TimelineTrace::span(uint32_t pid, uint32_t warp_id, const char* name,
+                         uint64_t start, uint64_t end) {
+    ProcessTracks& tracks = process(pid);
+    name_warp(pid, tracks, warp_id);
+
+    begin_event();
+    append("\"name\":\"");
+    append(name);
+    append("\",\"ph\":\"X\",\"pid\":");
+    append(pid);
+    append(",\"tid\":");
+    append(warp_id);
+    append(",\"ts\":");
+    append(start);
+    append(",\"dur\":");
+    append(end > start ? end - start : 0);
+    end_event();
+}
+
+void TimelineTrace::memory_access(uint32_t pid, uint32_t warp_id, MemoryLevel level,
+                                  bool is_write, uint64_t start, uint64_t end) {
+    ProcessTracks& tracks = process(pid);
+
+    // Counted when the engine sees them: writes on acceptance, reads on
+    // return, which keeps each process's counter time monotonic
+    uint64_t now = is_write ? start : end;
+    advance_counters(pid, tracks, now);
+    tracks.level_counts[static_cast<uint32_t>(level)]++;
+    tracks.window_dirty = true;
+
+    if (is_write) {
+        return;
+    }
+    name_warp(pid, tracks, warp_id);
+    uint64_t id = next_async_id_++;
+    for (int phase = 0; phase < 2; ++phase) {
+        begin_event();
+        append("\"name\":\"read ");
+        append(MemoryLatencyProfile::level_name(level));
+        append("\",\"cat\":\"memory\",\"ph\":\"");
+        append(phase == 0 ? "b" : "e");
+        append("\",\"id\":");
+        append(id);
+        append(",\"pid\":");
+        append(pid);
+        append(",\"tid\":");
+        append(warp_id);
+        append(",\"ts\":");
+        append(phase == 0 ? start : end);
+        end_event();
+    }
+}
+
+void TimelineTrace::advance_counters(uint32_t pid, ProcessTracks& tracks, uint64_t time) {
+    if (time < tracks.window_start + counter_interval_) {
+        return;
+    }
+    if (tracks.window_dirty) {
+        write_counters(pid, tracks, tracks.window_start);
+        for (auto& count : tracks.level_counts) {
+            count = 0;
+        }
+        tracks.window_dirty = false;
+
+        // Drop the track to zero before a quiet gap instead of drawing a
+        // plateau across it
+        uint64_t next = tracks.window_start + counter_interval_;
+        if (time >= next + counter_interval_) {
+            write_counters(pid, tracks, next);
+        }
+    }
+    tracks.window_start = time - time % counter_interval_;
+}
+
+void TimelineTrace::write_counters(uint32_t pid, const ProcessTracks& tracks, uint64_t time) {
+    begin_event();
+    append("\"name\":\"memory accesses\",\"ph\":\"C\",\"pid\":");
+    append(pid);
+    append(",\"ts\":");
+    append(time);
+    append(",\"args\":{");
+    for (uint32_t i = 1; i < MemoryLatencyProfile::NUM_LEVELS; ++i) {
+        append(i > 1 ? ",\"" : "\"");
+        append(MemoryLatencyProfile::level_name(static_cast<MemoryLevel>(i)));
+        append("\":");
+        append(tracks.level_counts[i]);
+    }
+    append("}");
+    end_event();
+}
+
+void TimelineTrace::begin_event() {
+    append(events_ == 0 ? "\n{" : ",\n{");
+}
+
+void TimelineTrace::end_event() {
+    buffer_.push_back('}');
+    events_++;
+    if (buffer_.size() >= FLUSH_THRESHOLD) {
+        flush_buffer();
+    }
+}
+
+void TimelineTrace::append(const char* text) {
+    buffer_.append(text);
+}
+
+void TimelineTrace::append(uint64_t value) {
+    char digits[20];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer_.append(digits, result.ptr);
+}
+
+void TimelineTrace::append_string(const std::string& text) {
+    buffer_.push_back('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            buffer_.push_back('\\');
+            buffer_.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            buffer_.push_back(' ');
+        } else {
+            buffer_.push_back(c);
+        }
+    }
+    buffer_.push_back('"');
+}
+
+void TimelineTrace::flush_buffer() {
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+} // namespace gpu_simulator
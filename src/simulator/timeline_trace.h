@@ -0,0 +1,89 @@
+// timeline_trace.h
+// Streaming Chrome Trace Event (Perfetto-compatible) timeline of warp activity
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "latency_histogram.h"
+
+namespace gpu_simulator {
+
+// Writes a JSON trace that chrome://tracing and ui.perfetto.dev open
+// directly. Each engine is a process (pid), each warp a thread track with
+// issue, stall and memory-wait spans; reads are async spans named by the
+// level that answered them, and every counter_interval cycles a counter
+// track shows how many accesses each level served. Timestamps are cycles
+// (displayed as microseconds).
+//
+// Events are formatted into a small buffer and streamed out, so memory use
+// does not grow with the length of the run. One writer serves one thread.
+class TimelineTrace {
+public:
+    static constexpr uint64_t DEFAULT_COUNTER_INTERVAL = 100;
+
+    // Constructor and destructor
+    explicit TimelineTrace(std::ostream& out,
+                           uint64_t counter_interval = DEFAULT_COUNTER_INTERVAL);
+    explicit TimelineTrace(const std::string& filename,
+                           uint64_t counter_interval = DEFAULT_COUNTER_INTERVAL);
+    ~TimelineTrace();
+
+    // Delete copy constructor and assignment
+    TimelineTrace(const TimelineTrace&) = delete;
+    TimelineTrace& operator=(const TimelineTrace&) = delete;
+
+    // Track naming (optional; unnamed warps get "warp N" on first use)
+    void name_process(uint32_t pid, const std::string& name);
+
+    // Span on a warp's track; name must be a string literal or outlive the trace
+    void span(uint32_t pid, uint32_t warp_id, const char* name,
+              uint64_t start, uint64_t end);
+
+    // One memory access retiring at `end`; reads also get an async span
+    void memory_access(uint32_t pid, uint32_t warp_id, MemoryLevel level,
+                       bool is_write, uint64_t start, uint64_t end);
+
+    // Close the JSON document (also done by the destructor)
+    void finish();
+
+    uint64_t events_written() const { return events_; }
+
+private:
+    struct ProcessTracks {
+        bool named = false;
+        std::vector<bool> warps_named;
+        uint64_t window_start = 0;             // Counter window being filled
+        uint64_t level_counts[MemoryLatencyProfile::NUM_LEVELS] = {};
+        bool window_dirty = false;
+    };
+
+    ProcessTracks& process(uint32_t pid);
+    void name_warp(uint32_t pid, ProcessTracks& tracks, uint32_t warp_id);
+    void advance_counters(uint32_t pid, ProcessTracks& tracks, uint64_t time);
+    void write_counters(uint32_t pid, const ProcessTracks& tracks, uint64_t time);
+
+    // Event formatting
+    void begin_event();
+    void end_event();
+    void append(const char* text);
+    void append(uint64_t value);
+    void append_string(const std::string& text);
+    void flush_buffer();
+
+    std::ofstream file_;
+    std::ostream& out_;
+    uint64_t counter_interval_;
+    std::vector<ProcessTracks> processes_;
+    std::string buffer_;
+    uint64_t events_;
+    uint64_t next_async_id_;
+    bool finished_;
+
+    static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+};
+
+} // namespace gpu_simulator
@@ -0,0 +1,48 @@
+// unified_storage.cpp
+// Implementation of the L1 / shared-memory carveout
+
+#include "unified_storage.h"
+#include <stdexcept>
+#include <string>
+
+namespace gpu_simulator {
+
+UnifiedStorage::UnifiedStorage(uint32_t total_size, uint32_t line_size)
+    : total_size_(total_size) {
+    if (total_size % GRANULE != 0 || total_size < 2 * GRANULE) {
+        throw std::invalid_argument("Unified storage size must be a multiple of " +
+                                    std::to_string(GRANULE) + " bytes, at least two of them");
+    }
+    if (line_size == 0 || GRANULE % line_size != 0) {
+        throw std::invalid_argument("Cache line size must divide the carveout granule");
+    }
+}
+
+std::vector<uint32_t> UnifiedStorage::split_points() const {
+    std::vector<uint32_t> points;
+    for (uint32_t shared = 0; shared < total_size_; shared += GRANULE) {
+        points.push_back(shared);
+    }
+    return points;
+}
+
+Carveout UnifiedStorage::carve(uint32_t shared_size) const {
+    if (shared_size % GRANULE != 0 || shared_size >= total_size_) {
+        throw std::invalid_argument("Shared-memory carveout of " + std::to_string(shared_size) +
+                                    " bytes is not a split point of " +
+                                    std::to_string(total_size_) + " bytes of storage");
+    }
+    return Carveout{shared_size, total_size_ - shared_size};
+}
+
+Carveout UnifiedStorage::fit(uint32_t shared_needed) const {
+    if (shared_needed > total_size_ - GRANULE) {
+        throw std::runtime_error("Shared memory of " + std::to_string(shared_needed) +
+                                 " bytes does not fit in " + std::to_string(total_size_) +
+                                 " bytes of unified storage");
+    }
+    uint32_t shared = (shared_needed + GRANULE - 1) / GRANULE * GRANULE;
+    return Carveout{shared, total_size_ - shared};
+}
+
+} // namespace gpu_simulator
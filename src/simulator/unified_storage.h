@@ -0,0 +1,44 @@
+// unified_storage.h
+// One SRAM per SM split between the L1 data cache and shared memory
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace gpu_simulator {
+
+// One split of the SRAM
+struct Carveout {
+    uint32_t shared_size;     // Bytes of shared memory (scratchpad)
+    uint32_t l1_size;         // Bytes left to the L1 data cache
+};
+
+// Unified L1 / shared-memory storage. The shared-memory carveout is a
+// multiple of GRANULE and the L1 always keeps at least one granule, so the
+// split points are 0, GRANULE, ..., total - GRANULE bytes of shared memory.
+class UnifiedStorage {
+public:
+    static constexpr uint32_t GRANULE = 4096;
+
+    // Constructor; total_size must be a multiple of GRANULE of at least two
+    // granules, and the granule a multiple of the L1 line size
+    UnifiedStorage(uint32_t total_size, uint32_t line_size);
+
+    uint32_t total_size() const { return total_size_; }
+
+    // Shared-memory sizes the SRAM can be split at, smallest first
+    std::vector<uint32_t> split_points() const;
+
+    // Explicit split (invalid_argument unless shared_size is a split point)
+    Carveout carve(uint32_t shared_size) const;
+
+    // Smallest carveout holding shared_needed bytes, which leaves the L1
+    // as large as possible (runtime_error when even the largest is short)
+    Carveout fit(uint32_t shared_needed) const;
+
+private:
+    uint32_t total_size_;
+};
+
+} // namespace gpu_simulator
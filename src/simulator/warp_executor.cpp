@@ -0,0 +1,368 @@
+// warp_executor.cpp
+// Implementation of functional SIMT execution
+
+#include "warp_executor.h"
+#include "utils.h"
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+
+namespace gpu_simulator {
+
+namespace {
+
+uint32_t alu(Opcode opcode, uint32_t a, uint32_t b) {
+    auto sa = static_cast<int32_t>(a);
+    auto sb = static_cast<int32_t>(b);
+    switch (opcode) {
+        case Opcode::ADD: return a + b;
+        case Opcode::SUB: return a - b;
+        case Opcode::MUL: return a * b;
+        // Division by zero yields zero instead of trapping
+        case Opcode::DIV: return sb == 0 ? 0 : static_cast<uint32_t>(sa / sb);
+        case Opcode::REM: return sb == 0 ? 0 : static_cast<uint32_t>(sa % sb);
+        case Opcode::AND: return a & b;
+        case Opcode::OR:  return a | b;
+        case Opcode::XOR: return a ^ b;
+        case Opcode::SHL: return a << (b & 31);
+        case Opcode::SHR: return a >> (b & 31);
+        case Opcode::CMP: return sa < sb ? 1 : 0;
+        case Opcode::MIN: return static_cast<uint32_t>(std::min(sa, sb));
+        case Opcode::MAX: return static_cast<uint32_t>(std::max(sa, sb));
+        case Opcode::ABS: return sa < 0 ? 0u - a : a;
+        case Opcode::NEG: return 0u - a;
+        default:          return 0;
+    }
+}
+
+bool branch_taken(Opcode opcode, int32_t a, int32_t b) {
+    switch (opcode) {
+        case Opcode::BEQ: return a == b;
+        case Opcode::BNE: return a != b;
+        case Opcode::BLT: return a < b;
+        case Opcode::BLE: return a <= b;
+        case Opcode::BGT: return a > b;
+        case Opcode::BGE: return a >= b;
+        default:          return false;
+    }
+}
+
+// Sub-word accesses are little-endian within their aligned word
+uint32_t extract(uint32_t word, uint32_t address, uint32_t bytes) {
+    uint32_t shift = (address & 3) * 8;
+    uint32_t mask = bytes == 4 ? 0xFFFFFFFF : (1u << (bytes * 8)) - 1;
+    return (word >> shift) & mask;
+}
+
+uint32_t insert(uint32_t word, uint32_t address, uint32_t bytes, uint32_t value) {
+    uint32_t shift = (address & 3) * 8;
+    uint32_t mask = bytes == 4 ? 0xFFFFFFFF : (1u << (bytes * 8)) - 1;
+    return (word & ~(mask << shift)) | ((value & mask) << shift);
+}
+
+} // namespace
+
+WarpExecutor::WarpExecutor(std::shared_ptr<const Program> program, MemoryModel& memory,
+                           uint32_t num_warps, uint32_t threads_per_warp, uint32_t line_size,
+                           uint32_t block_id, uint32_t shared_offset)
+    : program_(std::move(program))
+    , memory_(memory)
+    , threads_per_warp_(threads_per_warp)
+    , line_size_(line_size)
+    , block_id_(block_id)
+    , shared_offset_(shared_offset)
+    , live_warps_(num_warps)
+    , barrier_arrivals_(0)
+    , barrier_generation_(0)
+    , thread_instructions_(0) {
+    if (!program_ || program_->text.empty()) {
+        throw std::invalid_argument("WarpExecutor needs an assembled program");
+    }
+    if (threads_per_warp == 0 || threads_per_warp > 32) {
+        throw std::invalid_argument("threads_per_warp must be between 1 and 32");
+    }
+
+    uint32_t all_threads = threads_per_warp == 32 ? 0xFFFFFFFF : (1u << threads_per_warp) - 1;
+    warps_.resize(num_warps);
+    for (auto& warp : warps_) {
+        warp.regs.assign(threads_per_warp * ProgramLoader::NUM_REGISTERS, 0);
+        warp.pcs.assign(threads_per_warp, program_->entry_point);
+        warp.live_mask = all_threads;
+        warp.at_barrier = false;
+        warp.barrier_generation = 0;
+    }
+}
+
+uint32_t WarpExecutor::entry_point() const {
+    return program_->entry_point;
+}
+
+uint32_t WarpExecutor::read_register(uint32_t warp_id, uint32_t thread, uint32_t reg) const {
+    return warps_.at(warp_id).regs.at(thread * ProgramLoader::NUM_REGISTERS + reg);
+}
+
+uint32_t WarpExecutor::issue_mask(const Warp& warp, uint32_t& pc) const {
+    pc = next_pc(warp);
+    uint32_t mask = 0;
+    for (uint32_t t = 0; t < threads_per_warp_; ++t) {
+        if ((warp.live_mask >> t & 1) && warp.pcs[t] == pc) {
+            mask |= 1u << t;
+        }
+    }
+    return mask;
+}
+
+uint32_t WarpExecutor::next_pc(const Warp& warp) const {
+    uint32_t pc = std::numeric_limits<uint32_t>::max();
+    for (uint32_t t = 0; t < threads_per_warp_; ++t) {
+        if (warp.live_mask >> t & 1) {
+            pc = std::min(pc, warp.pcs[t]);
+        }
+    }
+    return pc;
+}
+
+ExecutionStep WarpExecutor::execute(uint32_t warp_id, uint32_t pc,
+                                    std::vector<MemoryTransaction>& accesses) {
+    Warp& warp = warps_.at(warp_id);
+    if (warp.live_mask == 0) {
+        return {ExecStatus::EXITED, pc};
+    }
+
+    uint32_t mask = issue_mask(warp, pc);
+    const AssembledInstruction* instr = program_->at(pc);
+    if (!instr) {
+        throw std::runtime_error("Warp " + std::to_string(warp_id) +
+                                 " left the program at " + utils::StringUtils::to_hex(pc));
+    }
+
+    // Barriers are the only instructions that do not issue immediately
+    if (instr->opcode == Opcode::BARRIER || instr->opcode == Opcode::WAIT) {
+        if (!arrive_at_barrier(warp)) {
+            return {ExecStatus::STALLED, pc};
+        }
+    }
+
+    auto source2 = [&](uint32_t t) {
+        return instr->use_imm ? static_cast<uint32_t>(instr->imm) : reg(warp, t, instr->rs2);
+    };
+    uint32_t fallthrough = pc + 4;
+
+    switch (instr->opcode) {
+        case Opcode::LD_B: case Opcode::LD_H: case Opcode::LD_W:
+        case Opcode::LD_C: case Opcode::LD_NC:
+        case Opcode::ST_B: case Opcode::ST_H: case Opcode::ST_W:
+        case Opcode::ATOMIC_ADD: case Opcode::ATOMIC_EXCH: case Opcode::ATOMIC_CAS:
+            execute_memory(warp_id, *instr, mask, accesses);
+            break;
+        case Opcode::VOTE_ANY:
+        case Opcode::VOTE_ALL: {
+            bool any = false;
+            bool all = true;
+            for (uint32_t t = 0; t < threads_per_warp_; ++t) {
+                if (mask >> t & 1) {
+                    bool vote = reg(warp, t, instr->rs1) != 0;
+                    any |= vote;
+                    all &= vote;
+                }
+            }
+            uint32_t result = instr->opcode == Opcode::VOTE_ANY ? any : all;
+            for (uint32_t t = 0; t < threads_per_warp_; ++t) {
+                if (mask >> t & 1) {
+                    reg(warp, t, instr->rd) = result;
+                }
+            }
+            break;
+        }
+        default:
+            for (uint32_t t = 0; t < threads_per_warp_; ++t) {
+                if (!(mask >> t & 1)) {
+                    continue;
+                }
+                uint32_t a = reg(warp, t, instr->rs1);
+                switch (instr->opcode) {
+                    case Opcode::BEQ: case Opcode::BNE: case Opcode::BLT:
+                    case Opcode::BLE: case Opcode::BGT: case Opcode::BGE:
+                        warp.pcs[t] = branch_taken(instr->opcode, static_cast<int32_t>(a),
+                                                   static_cast<int32_t>(reg(warp, t, instr->rs2)))
+                                      ? static_cast<uint32_t>(instr->imm) : fallthrough;
+                        continue;
+                    case Opcode::J:
+                        warp.pcs[t] = static_cast<uint32_t>(instr->imm);
+                        continue;
+                    case Opcode::JR:
+                        warp.pcs[t] = a;
+                        continue;
+                    case Opcode::EXIT:
+                        warp.live_mask &= ~(1u << t);
+                        continue;
+                    case Opcode::TID:
+                        reg(warp, t, instr->rd) = t;
+                        break;
+                    case Opcode::WARPID:
+                        reg(warp, t, instr->rd) = warp_id;
+                        break;
+                    case Opcode::BLOCKID:
+                        reg(warp, t, instr->rd) = block_id_;
+                        break;
+                    case Opcode::BARRIER: case Opcode::ARRIVE: case Opcode::WAIT:
+                        break;
+                    default:
+                        reg(warp, t, instr->rd) = alu(instr->opcode, a, source2(t));
+                        break;
+                }
+            }
+            break;
+    }
+
+    // Straight-line instructions advance every issuing thread
+    switch (instr->opcode) {
+        case Opcode::BEQ: case Opcode::BNE: case Opcode::BLT: case Opcode::BLE:
+        case Opcode::BGT: case Opcode::BGE: case Opcode::J: case Opcode::JR:
+        case Opcode::EXIT:
+            break;
+        default:
+            for (uint32_t t = 0; t < threads_per_warp_; ++t) {
+                if (mask >> t & 1) {
+                    warp.pcs[t] = fallthrough;
+                }
+            }
+            break;
+    }
+
+    // $r0 reads as zero whatever was written to it
+    for (uint32_t t = 0; t < threads_per_warp_; ++t) {
+        reg(warp, t, 0) = 0;
+    }
+    thread_instructions_ += __builtin_popcount(mask);
+
+    if (warp.live_mask == 0) {
+        live_warps_--;
+        if (barrier_arrivals_ > 0 && barrier_arrivals_ >= live_warps_) {
+            release_barrier();
+        }
+        return {ExecStatus::EXITED, pc};
+    }
+    return {ExecStatus::ISSUED, next_pc(warp)};
+}
+
+void WarpExecutor::execute_memory(uint32_t warp_id, const AssembledInstruction& instr,
+                                  uint32_t mask, std::vector<MemoryTransaction>& accesses) {
+    Warp& warp = warps_[warp_id];
+    bool is_atomic = instr.opcode == Opcode::ATOMIC_ADD || instr.opcode == Opcode::ATOMIC_EXCH ||
+                     instr.opcode == Opcode::ATOMIC_CAS;
+    bool is_store = instr.opcode == Opcode::ST_B || instr.opcode == Opcode::ST_H ||
+                    instr.opcode == Opcode::ST_W;
+    uint32_t bytes = 4;
+    if (instr.opcode == Opcode::LD_B || instr.opcode == Opcode::ST_B) {
+        bytes = 1;
+    } else if (instr.opcode == Opcode::LD_H || instr.opcode == Opcode::ST_H) {
+        bytes = 2;
+    }
+    MemorySpace space = MemorySpace::GLOBAL;
+    if (instr.opcode == Opcode::LD_C) {
+        space = MemorySpace::CONSTANT;
+    } else if (instr.opcode == Opcode::LD_NC) {
+        space = MemorySpace::READ_ONLY;
+    }
+
+    // Per-line coalescing: one transaction for all threads touching a line.
+    // The constant cache serves one word per fetch, so constant loads group
+    // threads by word instead and divergent addresses become extra fetches.
+    uint32_t line_address[32];
+    uint32_t first_word[32];
+    uint32_t line_mask[32];
+    uint32_t lines = 0;
+
+    for (uint32_t t = 0; t < threads_per_warp_; ++t) {
+        if (!(mask >> t & 1)) {
+            continue;
+        }
+        uint32_t base = reg(warp, t, instr.rs1);
+        uint32_t operand = instr.use_imm ? static_cast<uint32_t>(instr.imm) : reg(warp, t, instr.rs2);
+        uint32_t address = is_atomic ? base : base + operand;
+        if (address - program_->shared_base < program_->shared_size) {
+            address += shared_offset_;
+        }
+        uint32_t word_address = address & ~3u;
+        uint32_t word = memory_.functional_read(word_address);
+
+        switch (instr.opcode) {
+            case Opcode::LD_B: case Opcode::LD_H: case Opcode::LD_W:
+            case Opcode::LD_C: case Opcode::LD_NC:
+                reg(warp, t, instr.rd) = extract(word, address, bytes);
+                break;
+            case Opcode::ST_B: case Opcode::ST_H: case Opcode::ST_W:
+                memory_.functional_write(word_address,
+                                         insert(word, address, bytes, reg(warp, t, instr.rd)));
+                break;
+            case Opcode::ATOMIC_ADD:
+                memory_.functional_write(word_address, word + operand);
+                reg(warp, t, instr.rd) = word;
+                break;
+            case Opcode::ATOMIC_EXCH:
+                memory_.functional_write(word_address, operand);
+                reg(warp, t, instr.rd) = word;
+                break;
+            case Opcode::ATOMIC_CAS:
+                if (word == operand) {
+                    memory_.functional_write(word_address, reg(warp, t, instr.rs3));
+                }
+                reg(warp, t, instr.rd) = word;
+                break;
+            default:
+                break;
+        }
+
+        uint32_t line = space == MemorySpace::CONSTANT ? word_address : address / line_size_;
+        uint32_t i = 0;
+        while (i < lines && line_address[i] != line) {
+            ++i;
+        }
+        if (i == lines) {
+            line_address[lines] = line;
+            first_word[lines] = word_address;
+            line_mask[lines] = 0;
+            lines++;
+        }
+        line_mask[i] |= 1u << t;
+    }
+
+    // Writes carry the word's final value so the timed access leaves memory
+    // as the functional model did
+    for (uint32_t i = 0; i < lines; ++i) {
+        MemoryTransaction trans{first_word[i], 0, false, bytes, warp_id, line_mask[i]};
+        trans.space = space;
+        if (!is_store) {
+            accesses.push_back(trans);
+        }
+        if (is_store || is_atomic) {
+            trans.is_write = true;
+            trans.data = memory_.functional_read(first_word[i]);
+            accesses.push_back(trans);
+        }
+    }
+}
+
+bool WarpExecutor::arrive_at_barrier(Warp& warp) {
+    if (!warp.at_barrier) {
+        warp.at_barrier = true;
+        warp.barrier_generation = barrier_generation_;
+        if (++barrier_arrivals_ >= live_warps_) {
+            release_barrier();
+        }
+    }
+    if (warp.barrier_generation == barrier_generation_) {
+        return false;
+    }
+    warp.at_barrier = false;
+    return true;
+}
+
+void WarpExecutor::release_barrier() {
+    barrier_generation_++;
+    barrier_arrivals_ = 0;
+}
+
+} // namespace gpu_simulator
@@ -0,0 +1,71 @@
+// warp_executor.h
+// Functional SIMT execution of assembled programs for execution-driven runs
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "sim_engine.h"
+#include "program_loader.h"
+
+namespace gpu_simulator {
+
+// Executes an assembled Program for every warp of one thread block. Each
+// thread keeps its own PC; a warp issues for the threads at the lowest PC,
+// so diverged paths run one after another and reconverge where their PCs
+// meet again. Data lives in the memory model (functional reads and writes
+// at issue time); the engine times the coalesced per-line transactions.
+class WarpExecutor : public InstructionExecutor {
+public:
+    // Constructor. A thread block of num_warps warps: block_id is what
+    // blockid returns, and shared_offset moves the program's .shared
+    // section to this block's copy of it.
+    WarpExecutor(std::shared_ptr<const Program> program, MemoryModel& memory,
+                 uint32_t num_warps, uint32_t threads_per_warp, uint32_t line_size,
+                 uint32_t block_id = 0, uint32_t shared_offset = 0);
+
+    uint32_t entry_point() const override;
+    ExecutionStep execute(uint32_t warp_id, uint32_t pc,
+                          std::vector<MemoryTransaction>& accesses) override;
+
+    // Instructions summed over the threads that executed them
+    uint64_t thread_instructions() const { return thread_instructions_; }
+    bool all_exited() const { return live_warps_ == 0; }
+    uint32_t read_register(uint32_t warp_id, uint32_t thread, uint32_t reg) const;
+
+private:
+    struct Warp {
+        std::vector<uint32_t> regs;           // thread * NUM_REGISTERS + reg
+        std::vector<uint32_t> pcs;
+        uint32_t live_mask;                   // Threads that have not exited
+        bool     at_barrier;
+        uint64_t barrier_generation;          // Generation the warp waits on
+    };
+
+    uint32_t issue_mask(const Warp& warp, uint32_t& pc) const;
+    uint32_t next_pc(const Warp& warp) const;
+    void execute_memory(uint32_t warp_id, const AssembledInstruction& instr,
+                        uint32_t mask, std::vector<MemoryTransaction>& accesses);
+    bool arrive_at_barrier(Warp& warp);
+    void release_barrier();
+
+    uint32_t& reg(Warp& warp, uint32_t thread, uint32_t index) {
+        return warp.regs[thread * ProgramLoader::NUM_REGISTERS + index];
+    }
+
+    std::shared_ptr<const Program> program_;
+    MemoryModel& memory_;
+    uint32_t threads_per_warp_;
+    uint32_t line_size_;
+    uint32_t block_id_;
+    uint32_t shared_offset_;
+    std::vector<Warp> warps_;
+
+    uint32_t live_warps_;
+    uint32_t barrier_arrivals_;
+    uint64_t barrier_generation_;
+    uint64_t thread_instructions_;
+};
+
+} // namespace gpu_simulator
@@ -0,0 +1,196 @@
+// host_profiler.cpp
+// Implementation of host-side phase timers
+
+#include "host_profiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+namespace gpu_simulator {
+namespace utils {
+
+std::atomic<bool> HostProfiler::enabled_{false};
+std::atomic<uint32_t> HostProfiler::sample_period_{HostProfiler::DEFAULT_SAMPLE_PERIOD};
+std::atomic<uint64_t> HostProfiler::timer_overhead_{0};
+std::atomic<uint64_t> HostProfiler::preemption_ticks_{~uint64_t{0}};
+thread_local ThreadProfile* HostProfiler::thread_profile_ = nullptr;
+
+HostProfiler& HostProfiler::instance() {
+    static HostProfiler instance;
+    return instance;
+}
+
+HostProfiler::HostProfiler()
+    : wall_start_(std::chrono::steady_clock::now())
+    , tick_start_(now()) {
+}
+
+bool HostProfiler::compiled_in() {
+#ifdef GPUSIM_HOST_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HostProfiler::set_enabled(bool enabled) {
+    if (enabled && !enabled_.load(std::memory_order_relaxed)) {
+        calibrate();
+    }
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void HostProfiler::calibrate() {
+    // Median of back-to-back reads approximates the cost of one
+    std::vector<uint64_t> samples(1001);
+    for (auto& sample : samples) {
+        uint64_t start = now();
+        sample = now() - start;
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    timer_overhead_.store(samples[samples.size() / 2], std::memory_order_relaxed);
+
+    // Tick rate over a short spin, enough to place the preemption limit
+    auto wall_begin = std::chrono::steady_clock::now();
+    uint64_t tick_begin = now();
+    std::chrono::duration<double, std::milli> spun{0.0};
+    while (spun.count() < 2.0) {
+        spun = std::chrono::steady_clock::now() - wall_begin;
+    }
+    double ticks_per_ms = static_cast<double>(now() - tick_begin) / spun.count();
+    preemption_ticks_.store(static_cast<uint64_t>(ticks_per_ms * PREEMPTION_LIMIT_MS),
+                            std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    wall_start_ = std::chrono::steady_clock::now();
+    tick_start_ = now();
+}
+
+void HostProfiler::set_sample_period(uint32_t period) {
+    sample_period_.store(std::max<uint32_t>(period, 1), std::memory_order_relaxed);
+}
+
+ThreadProfile* HostProfiler::register_thread() {
+    // Kept after the thread exits so its time still shows in the report
+    auto profile = std::make_unique<ThreadProfile>();
+    for (uint32_t i = 0; i < ThreadProfile::NUM_PHASES; ++i) {
+        profile->calls[i].store(0, std::memory_order_relaxed);
+        profile->self_ticks[i].store(0, std::memory_order_relaxed);
+        profile->total_ticks[i].store(0, std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.push_back(std::move(profile));
+    return threads_.back().get();
+}
+
+void HostProfiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& profile : threads_) {
+        for (uint32_t i = 0; i < ThreadProfile::NUM_PHASES; ++i) {
+            profile->calls[i].store(0, std::memory_order_relaxed);
+            profile->self_ticks[i].store(0, std::memory_order_relaxed);
+            profile->total_ticks[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    wall_start_ = std::chrono::steady_clock::now();
+    tick_start_ = now();
+}
+
+uint64_t HostProfiler::sum(Field field, ProfilePhase phase) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t total = 0;
+    for (const auto& profile : threads_) {
+        total += ((*profile).*field)[static_cast<uint32_t>(phase)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t HostProfiler::calls(ProfilePhase phase) const {
+    return sum(&ThreadProfile::calls, phase);
+}
+
+double HostProfiler::self_ms(ProfilePhase phase) const {
+    return ticks_to_ms(sum(&ThreadProfile::self_ticks, phase));
+}
+
+double HostProfiler::total_ms(ProfilePhase phase) const {
+    return ticks_to_ms(sum(&ThreadProfile::total_ticks, phase));
+}
+
+double HostProfiler::wall_ms() const {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - wall_start_).count();
+}
+
+double HostProfiler::ticks_to_ms(uint64_t ticks) const {
+#if defined(__x86_64__) || defined(__i386__)
+    // TSC rate from the ticks that elapsed alongside the wall clock
+    double wall = wall_ms();
+    uint64_t elapsed = now() - tick_start_;
+    if (elapsed == 0 || wall <= 0.0) {
+        return 0.0;
+    }
+    return static_cast<double>(ticks) * wall / static_cast<double>(elapsed);
+#else
+    return static_cast<double>(ticks) / 1e6;
+#endif
+}
+
+const char* HostProfiler::phase_name(ProfilePhase phase) {
+    switch (phase) {
+        case ProfilePhase::EVENT_POP:               return "event_pop";
+        case ProfilePhase::EVENT_MEMORY_REQUEST:    return "event.memory_request";
+        case ProfilePhase::EVENT_MEMORY_RESPONSE:   return "event.memory_response";
+        case ProfilePhase::EVENT_INSTRUCTION_FETCH: return "event.instruction_fetch";
+        case ProfilePhase::EVENT_WARP_COMPLETE:     return "event.warp_complete";
+        case ProfilePhase::EVENT_SIMULATION_END:    return "event.simulation_end";
+        case ProfilePhase::MEMORY_MODEL:            return "memory_model";
+        case ProfilePhase::DPI:                     return "dpi";
+        case ProfilePhase::TRACE_WRITE:             return "trace_write";
+        case ProfilePhase::LOGGING:                 return "logging";
+        case ProfilePhase::NUM_PHASES:              break;
+    }
+    return "unknown";
+}
+
+void HostProfiler::print(std::ostream& out) const {
+    double wall = wall_ms();
+    out << "\nHost Profile:\n"
+        << "=============\n";
+    if (!compiled_in()) {
+        out << "(built without GPUSIM_HOST_PROFILING)\n";
+        return;
+    }
+    out << std::left << std::setw(26) << "Phase" << std::right
+        << std::setw(12) << "Calls" << std::setw(12) << "Self ms"
+        << std::setw(12) << "Total ms" << std::setw(10) << "ns/call"
+        << std::setw(9) << "Wall%" << "\n";
+
+    double profiled = 0.0;
+    for (uint32_t i = 0; i < ThreadProfile::NUM_PHASES; ++i) {
+        auto phase = static_cast<ProfilePhase>(i);
+        uint64_t count = calls(phase);
+        if (count == 0) {
+            continue;
+        }
+        double self = self_ms(phase);
+        profiled += self;
+        out << std::left << std::setw(26) << phase_name(phase) << std::right
+            << std::setw(12) << count
+            << std::fixed << std::setprecision(2)
+            << std::setw(12) << self
+            << std::setw(12) << total_ms(phase)
+            << std::setw(10) << (self * 1e6 / static_cast<double>(count))
+            << std::setw(8) << (wall > 0.0 ? self * 100.0 / wall : 0.0) << "%\n";
+    }
+    out << std::fixed << std::setprecision(2)
+        << "Wall time: " << wall << " ms, phases: " << profiled << " ms"
+        << " (1 in ~" << sample_period() << " timed)";
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out << " over " << threads_.size() << " thread(s)\n";
+    }
+}
+
+} // namespace utils
+} // namespace gpu_simulator
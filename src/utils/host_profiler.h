@@ -0,0 +1,257 @@
+// host_profiler.h
+// Built-in wall-time accounting for simulator phases on the host
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace gpu_simulator {
+namespace utils {
+
+// Host-side phases; process_event time is split by event type
+enum class ProfilePhase : uint32_t {
+    EVENT_POP,
+    EVENT_MEMORY_REQUEST,
+    EVENT_MEMORY_RESPONSE,
+    EVENT_INSTRUCTION_FETCH,
+    EVENT_WARP_COMPLETE,
+    EVENT_SIMULATION_END,
+    MEMORY_MODEL,
+    DPI,
+    TRACE_WRITE,
+    LOGGING,
+    NUM_PHASES
+};
+
+class ProfileScope;
+
+// Accumulators of one host thread. Only the owning thread writes; relaxed
+// atomics let a report read them while the thread is still running. Ticks
+// are stored already weighted by the sampling gap they stand for.
+struct ThreadProfile {
+    static constexpr uint32_t NUM_PHASES = static_cast<uint32_t>(ProfilePhase::NUM_PHASES);
+    std::atomic<uint64_t> calls[NUM_PHASES];
+    std::atomic<uint64_t> self_ticks[NUM_PHASES];
+    std::atomic<uint64_t> total_ticks[NUM_PHASES];
+
+    // Owner-only sampling state; a timed nest is buffered until its
+    // outermost scope closes, then committed or dropped as a whole
+    ProfileScope* current = nullptr;
+    uint32_t depth = 0;
+    bool     sampling = false;
+    uint64_t nest_weight = 0;
+    uint32_t countdown = 1;
+    uint32_t rng = 0x9E3779B9u;
+    uint64_t pending_self[NUM_PHASES] = {};
+    uint64_t pending_total[NUM_PHASES] = {};
+};
+
+// Process-wide collector. Timers are compiled in with GPUSIM_HOST_PROFILING
+// and cost one predictable branch per scope until enabled at run time.
+// Reading the clock costs tens of nanoseconds, so timing every event would
+// distort what it measures: every call is counted, but only about one
+// outermost scope in sample_period is timed, together with everything
+// nested in it, and its ticks are weighted by the gap since the previous
+// sample. Nests longer than the preemption limit are dropped so a context
+// switch does not get multiplied by the period. Rare, coarse scopes use
+// GPUSIM_PROFILE_SCOPE_ALWAYS and are timed on every call.
+// Nested scopes are charged exclusively: a memory model access inside a
+// MEMORY_REQUEST event counts as MEMORY_MODEL self time only.
+class HostProfiler {
+public:
+    // Singleton access
+    static HostProfiler& instance();
+
+    // Delete copy constructor and assignment
+    HostProfiler(const HostProfiler&) = delete;
+    HostProfiler& operator=(const HostProfiler&) = delete;
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static bool compiled_in();
+    void set_enabled(bool enabled);
+
+    // Mean number of outermost scopes per timed one (1 times every call)
+    static uint32_t sample_period() { return sample_period_.load(std::memory_order_relaxed); }
+    void set_sample_period(uint32_t period);
+    static constexpr uint32_t DEFAULT_SAMPLE_PERIOD = 64;
+
+    // Ticks one clock read adds to a measurement, and the length beyond
+    // which a sampled nest is taken to include a preemption (calibrated
+    // when enabled)
+    static uint64_t timer_overhead() { return timer_overhead_.load(std::memory_order_relaxed); }
+    static uint64_t preemption_ticks() { return preemption_ticks_.load(std::memory_order_relaxed); }
+    static constexpr double PREEMPTION_LIMIT_MS = 0.5;
+
+    // Zero all threads' accumulators (call while no phase is running)
+    void reset();
+
+    // Summed over all threads; times are estimates unless sample_period is 1
+    uint64_t calls(ProfilePhase phase) const;
+    double self_ms(ProfilePhase phase) const;
+    double total_ms(ProfilePhase phase) const;
+    double wall_ms() const;
+
+    void print(std::ostream& out) const;
+    static const char* phase_name(ProfilePhase phase);
+
+    // Tick source: the TSC where available, otherwise steady_clock ns
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // This thread's accumulators, registered on first use. Initial-exec TLS
+    // keeps the lookup a single load even inside the shared library.
+    static ThreadProfile& thread_profile() {
+        ThreadProfile* profile = thread_profile_;
+        if (!profile) {
+            profile = thread_profile_ = instance().register_thread();
+        }
+        return *profile;
+    }
+
+private:
+    HostProfiler();
+    ThreadProfile* register_thread();
+    using Field = std::atomic<uint64_t> (ThreadProfile::*)[ThreadProfile::NUM_PHASES];
+    uint64_t sum(Field field, ProfilePhase phase) const;
+    double ticks_to_ms(uint64_t ticks) const;
+    void calibrate();
+
+    static std::atomic<bool> enabled_;
+    static std::atomic<uint32_t> sample_period_;
+    static std::atomic<uint64_t> timer_overhead_;
+    static std::atomic<uint64_t> preemption_ticks_;
+    static thread_local ThreadProfile* thread_profile_
+        __attribute__((tls_model("initial-exec")));
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadProfile>> threads_;
+
+    // Calibration of ticks against steady_clock, taken when enabled
+    std::chrono::steady_clock::time_point wall_start_;
+    uint64_t tick_start_;
+};
+
+// Charges the lifetime of a scope to a phase
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePhase phase, bool always = false) : profile_(nullptr) {
+        if (!HostProfiler::enabled()) {
+            return;
+        }
+        ThreadProfile& profile = HostProfiler::thread_profile();
+        profile_ = &profile;
+        phase_ = static_cast<uint32_t>(phase);
+        add(profile.calls[phase_], 1);
+
+        // The outermost scope decides whether this whole nest is timed; the
+        // period is jittered so it cannot lock onto a periodic event pattern
+        if (profile.depth++ == 0) {
+            profile.sampling = --profile.countdown == 0;
+            if (profile.sampling) {
+                profile.rng ^= profile.rng << 13;
+                profile.rng ^= profile.rng >> 17;
+                profile.rng ^= profile.rng << 5;
+                uint32_t period = HostProfiler::sample_period();
+                profile.countdown = period / 2 + 1 + profile.rng % period;
+                profile.nest_weight = profile.countdown;
+            }
+        }
+        always_ = always;
+        timed_ = always || profile.sampling;
+        if (timed_) {
+            parent_ = profile.current;
+            profile.current = this;
+            child_ticks_ = 0;
+            start_ = HostProfiler::now();
+        }
+    }
+
+    ~ProfileScope() {
+        if (!profile_) {
+            return;
+        }
+        ThreadProfile& profile = *profile_;
+        if (timed_) {
+            // Clock reads are not free; take their cost out of this scope
+            // and charge it to the nest rather than to the parent's self time
+            uint64_t raw = HostProfiler::now() - start_;
+            uint64_t overhead = HostProfiler::timer_overhead();
+            uint64_t elapsed = raw > overhead ? raw - overhead : 0;
+            uint64_t self = elapsed > child_ticks_ ? elapsed - child_ticks_ : 0;
+            if (always_) {
+                add(profile.total_ticks[phase_], elapsed);
+                add(profile.self_ticks[phase_], self);
+            } else {
+                profile.pending_total[phase_] += elapsed;
+                profile.pending_self[phase_] += self;
+            }
+            profile.current = parent_;
+            if (parent_) {
+                parent_->child_ticks_ += raw + overhead;
+            }
+            if (profile.depth == 1 && profile.sampling) {
+                commit(profile, raw <= HostProfiler::preemption_ticks());
+            }
+        }
+        profile.depth--;
+    }
+
+    // Delete copy constructor and assignment
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    static void add(std::atomic<uint64_t>& slot, uint64_t value) {
+        slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static void commit(ThreadProfile& profile, bool keep) {
+        for (uint32_t i = 0; i < ThreadProfile::NUM_PHASES; ++i) {
+            if (keep && profile.pending_total[i] != 0) {
+                add(profile.total_ticks[i], profile.pending_total[i] * profile.nest_weight);
+                add(profile.self_ticks[i], profile.pending_self[i] * profile.nest_weight);
+            }
+            profile.pending_total[i] = 0;
+            profile.pending_self[i] = 0;
+        }
+    }
+
+    ThreadProfile* profile_;
+    uint32_t phase_;
+    bool always_;
+    bool timed_;
+    uint64_t start_;
+    uint64_t child_ticks_;
+    ProfileScope* parent_;
+};
+
+} // namespace utils
+} // namespace gpu_simulator
+
+#define GPUSIM_PROFILE_CONCAT_INNER(a, b) a##b
+#define GPUSIM_PROFILE_CONCAT(a, b) GPUSIM_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef GPUSIM_HOST_PROFILING
+#define GPUSIM_PROFILE_SCOPE(phase) \
+    gpu_simulator::utils::ProfileScope GPUSIM_PROFILE_CONCAT(profile_scope_, __LINE__)(phase)
+#define GPUSIM_PROFILE_SCOPE_ALWAYS(phase) \
+    gpu_simulator::utils::ProfileScope GPUSIM_PROFILE_CONCAT(profile_scope_, __LINE__)(phase, true)
+#else
+#define GPUSIM_PROFILE_SCOPE(phase) ((void)0)
+#define GPUSIM_PROFILE_SCOPE_ALWAYS(phase) ((void)0)
+#endif
@@ -12,6 +12,7 @@
 #include <memory>
 #include <chrono>
 #include <iomanip>
+#include "host_profiler.h"
 
 namespace gpu_simulator {
 namespace utils {
@@ -76,6 +77,7 @@ public:
     // Log message with level
     void log(LogLevel level, const std::string& message, 
              const std::string& file = "", int line = 0) {
+        GPUSIM_PROFILE_SCOPE(ProfilePhase::LOGGING);
         std::lock_guard<std::mutex> lock(mutex_);
         
         if (level < min_level_) {
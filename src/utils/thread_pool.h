@@ -0,0 +1,280 @@
+// thread_pool.h
+// Worker pools for parallel simulation phases and independent jobs
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace gpu_simulator {
+namespace utils {
+
+class ThreadPool {
+public:
+    // Create a pool with the given number of workers (0 = hardware concurrency).
+    // The calling thread also participates in parallel_for, so a pool of
+    // size 1 runs everything inline without spawning threads.
+    explicit ThreadPool(size_t num_threads = 0)
+        : stop_(false), generation_(0), pending_(0), next_index_(0), count_(0) {
+        if (num_threads == 0) {
+            num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        workers_.reserve(num_threads - 1);
+        for (size_t i = 1; i < num_threads; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // Delete copy constructor and assignment
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads taking part in parallel_for (workers + caller)
+    size_t size() const {
+        return workers_.size() + 1;
+    }
+
+    // Run fn(i) for every i in [0, count) and block until all calls return.
+    // Indices are handed out dynamically, so uneven work balances itself.
+    // If a call throws, indices not yet handed out are skipped and the
+    // first exception is rethrown once every thread has left the loop.
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+        if (count == 0) {
+            return;
+        }
+        if (workers_.empty() || count == 1) {
+            for (size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &fn;
+            count_ = count;
+            next_index_.store(0, std::memory_order_relaxed);
+            pending_ = workers_.size();
+            ++generation_;
+        }
+        start_cv_.notify_all();
+
+        run_indices(fn, count);
+
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_cv_.wait(lock, [this] { return pending_ == 0; });
+            task_ = nullptr;
+            std::swap(error, error_);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void worker_loop() {
+        uint64_t seen_generation = 0;
+        while (true) {
+            const std::function<void(size_t)>* task;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [&] {
+                    return stop_ || generation_ != seen_generation;
+                });
+                if (stop_) {
+                    return;
+                }
+                seen_generation = generation_;
+                task = task_;
+                count = count_;
+            }
+
+            run_indices(*task, count);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --pending_;
+            }
+            done_cv_.notify_one();
+        }
+    }
+
+    void run_indices(const std::function<void(size_t)>& fn, size_t count) {
+        size_t i;
+        while ((i = next_index_.fetch_add(1, std::memory_order_relaxed)) < count) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                next_index_.store(count, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    bool stop_;
+    uint64_t generation_;
+    size_t pending_;
+    std::atomic<size_t> next_index_;
+    size_t count_;
+    const std::function<void(size_t)>* task_ = nullptr;
+    std::exception_ptr error_;    // First exception of the current parallel_for
+};
+
+// Pool for independent jobs of uneven length. Each worker owns a deque:
+// it pops its own newest job and, when empty, steals the oldest job of
+// another worker, so long jobs never leave cores idle behind them.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t num_threads = 0)
+        : stop_(false), queued_(0), unfinished_(0), next_queue_(0) {
+        if (num_threads == 0) {
+            num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            queues_.push_back(std::make_unique<WorkQueue>());
+        }
+        workers_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // Delete copy constructor and assignment
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const {
+        return workers_.size();
+    }
+
+    // Queue a job; jobs are spread round-robin over the worker deques.
+    // Submit from a single thread.
+    void submit(std::function<void()> job) {
+        WorkQueue& queue = *queues_[next_queue_++ % queues_.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(std::move(job));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++queued_;
+            ++unfinished_;
+        }
+        work_cv_.notify_one();
+    }
+
+    // Block until every submitted job has finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return unfinished_ == 0; });
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    void worker_loop(size_t self) {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [this] { return stop_ || queued_ > 0; });
+                if (stop_ && queued_ == 0) {
+                    return;
+                }
+                --queued_;
+            }
+
+            // A job is reserved for us; find it locally first, then steal
+            std::function<void()> job;
+            while (!take_job(self, job)) {
+                std::this_thread::yield();
+            }
+            job();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --unfinished_;
+            }
+            done_cv_.notify_all();
+        }
+    }
+
+    bool take_job(size_t self, std::function<void()>& job) {
+        {
+            WorkQueue& own = *queues_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty()) {
+                job = std::move(own.jobs.back());
+                own.jobs.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            WorkQueue& victim = *queues_[(self + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool stop_;
+    size_t queued_;        // Jobs submitted but not yet claimed by a worker
+    size_t unfinished_;    // Jobs submitted but not yet completed
+    size_t next_queue_;
+};
+
+} // namespace utils
+} // namespace gpu_simulator
@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <fstream>
+#include <stdexcept>
 #include <iomanip>
 #include <algorithm>
 #include <functional>
@@ -0,0 +1,63 @@
+// test_batch_runner.cpp
+// BatchRunner: sweep points end when their workload does
+
+#include "test_common.h"
+#include "batch_runner.h"
+#include "warp_executor.h"
+
+using namespace gpu_simulator;
+
+namespace {
+
+// A trace point stops once its last request is served, long before the
+// cycle limit, and larger caches never make it slower
+void test_trace_points_drain() {
+    auto workload = std::make_shared<Workload>();
+    for (uint32_t i = 0; i < 256; ++i) {
+        MemoryTransaction trans{0x1000 + (i % 64) * 64, i, i % 4 == 0, 4, i % 8, 0xFFFFFFFF};
+        workload->trace.push_back(TraceRecord{i * 2, trans});
+    }
+
+    SweepSpec spec;
+    spec.base = test::BASE;
+    spec.cache_sizes = {1024, 16 * 1024};
+    std::vector<SweepResult> results = BatchRunner(workload, 2).run(spec);
+
+    CHECK_EQ(results.size(), size_t{2});
+    for (const auto& result : results) {
+        CHECK(result.error.empty());
+        CHECK(result.stats.total_cycles >= 2 * 255);
+        CHECK(result.stats.total_cycles < 2 * 255 + 2 * test::BASE.memory_latency);
+        CHECK_EQ(result.stats.memory_requests, uint64_t{256});
+    }
+    CHECK(results[1].stats.cache_hits >= results[0].stats.cache_hits);
+}
+
+// A kernel point matches the same kernel run on a stand-alone engine
+void test_kernel_points_match_engine() {
+    auto workload = std::make_shared<Workload>();
+    workload->kernel = test::load_program("vector_add");
+
+    SimulationEngine engine(test::BASE);
+    engine.initialize();
+    engine.attach_program(workload->kernel->image);
+    WarpExecutor executor(workload->kernel, engine.memory_model(), test::BASE.num_warps,
+                          test::BASE.threads_per_warp, test::BASE.cache_line_size);
+    engine.set_executor(&executor);
+    engine.run();
+    CHECK(executor.all_exited());
+
+    std::vector<SweepResult> results = BatchRunner(workload, 2).run(std::vector<SimConfig>{test::BASE});
+    CHECK(results[0].error.empty());
+    CHECK_EQ(results[0].stats.total_cycles, engine.get_current_time());
+    CHECK_EQ(results[0].stats.instructions_executed,
+             engine.get_statistics().instructions_executed);
+}
+
+} // namespace
+
+int main() {
+    test_trace_points_drain();
+    test_kernel_points_match_engine();
+    return test::report("test_batch_runner");
+}
@@ -0,0 +1,179 @@
+// test_checkpoint.cpp
+// Checkpoints: a restored engine continues exactly like the original
+
+#include "test_common.h"
+#include "sim_engine.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
+using namespace gpu_simulator;
+
+namespace {
+
+// Reads are profiled when answered and writes when issued, so a trace has
+// drained once the profile holds one sample per request. Trace warps
+// never exit, so give up at limit.
+void drain(SimulationEngine& engine, uint64_t samples, SimTime limit) {
+    while (engine.latency_profile().total().count() < samples &&
+           engine.has_pending_events() && engine.next_event_time() < limit) {
+        engine.run_until(engine.next_event_time() + 1);
+    }
+}
+
+uint64_t latency_sum(const LatencyHistogram& histogram) {
+    return static_cast<uint64_t>(std::llround(histogram.mean() * histogram.count()));
+}
+
+// The constant_test access mix as a trace: uniform and divergent constant
+// loads (which queue for the constant port), read-only input loads and
+// global stores. A checkpoint taken mid-stream holds constant and
+// read-only responses in flight.
+void test_constant_trace_round_trip() {
+    auto program = test::load_program("constant_test");
+    uint32_t params = program->symbols.at("params");
+    uint32_t coefficients = program->symbols.at("coefficients");
+    uint32_t input = program->symbols.at("input_array");
+    uint32_t output = program->symbols.at("output_array");
+
+    std::vector<TraceRecord> trace;
+    auto add = [&](SimTime time, uint32_t address, bool is_write, uint32_t warp,
+                   uint32_t mask, MemorySpace space) {
+        MemoryTransaction trans{address, warp, is_write, 4, warp, mask};
+        trans.pc = 0x100 + static_cast<uint32_t>(space) * 4;
+        trans.space = space;
+        trace.push_back(TraceRecord{time, trans});
+    };
+    for (uint32_t round = 0; round < 64; ++round) {
+        for (uint32_t warp = 0; warp < test::BASE.num_warps; ++warp) {
+            SimTime time = round * 4;
+            uint32_t element = (round * test::BASE.num_warps + warp) * 4 % 4096;
+            add(time, params + (round % 2) * 4, false, warp, 0xFFFFFFFF, MemorySpace::CONSTANT);
+            add(time, coefficients + (warp % 4) * 4, false, warp, 0x11111111,
+                MemorySpace::CONSTANT);
+            add(time, input + element, false, warp, 0xFFFFFFFF, MemorySpace::READ_ONLY);
+            add(time + 1, output + element, true, warp, 0xFFFFFFFF, MemorySpace::GLOBAL);
+        }
+    }
+    uint64_t requests = trace.size();
+
+    auto start = [&](SimulationEngine& engine) {
+        engine.initialize();
+        engine.attach_program(program->image);
+    };
+
+    SimulationEngine reference(test::BASE);
+    start(reference);
+    reference.inject_trace(trace);
+    drain(reference, requests, 100000);
+    CHECK_EQ(reference.latency_profile().total().count(), requests);
+
+    std::string path = (std::filesystem::temp_directory_path() /
+                        "gpusim_test_checkpoint.ckpt").string();
+    SimulationEngine original(test::BASE);
+    start(original);
+    original.inject_trace(trace);
+    original.run_until(128);
+    const MemoryLatencyProfile& before = original.latency_profile();
+    CHECK(before.total().count() > 0);
+    CHECK(before.total().count() < requests);
+    original.save_checkpoint(path);
+
+    // Latency distributions are not checkpointed; even on an engine that
+    // already ran, they restart at the restore point
+    SimulationEngine restored(test::BASE);
+    start(restored);
+    restored.inject_trace(trace);
+    restored.run_until(200);
+    CHECK(restored.stats_registry().value("memory.access_latency") > 0.0);
+    restored.restore_checkpoint(path);
+    std::remove(path.c_str());
+    CHECK_EQ(restored.latency_profile().total().count(), uint64_t{0});
+    CHECK_EQ(restored.stats_registry().value("memory.access_latency"), 0.0);
+    drain(restored, requests - before.total().count(), reference.get_current_time() + 1000);
+
+    CHECK_EQ(restored.get_current_time(), reference.get_current_time());
+    const StatsRegistry& expected = reference.stats_registry();
+    const StatsRegistry& actual = restored.stats_registry();
+    for (const char* name : {"engine.memory_requests", "engine.constant_fetches",
+                             "engine.constant_lanes", "engine.constant_wait_cycles",
+                             "memory.hits", "memory.misses", "constant_cache.hits",
+                             "constant_cache.misses", "readonly_cache.hits",
+                             "readonly_cache.misses"}) {
+        CHECK_EQ(actual.counter_value(name), expected.counter_value(name));
+    }
+    CHECK(expected.counter_value("engine.constant_wait_cycles") > 0);
+
+    // In-flight requests keep their issue time and answering level, so the
+    // profiles before and after the checkpoint add up to the whole run
+    const MemoryLatencyProfile& after = restored.latency_profile();
+    for (MemoryLevel level : {MemoryLevel::L1, MemoryLevel::DRAM}) {
+        const LatencyHistogram& whole = reference.latency_profile().level(level);
+        CHECK_EQ(before.level(level).count() + after.level(level).count(), whole.count());
+        CHECK_EQ(latency_sum(before.level(level)) + latency_sum(after.level(level)),
+                 latency_sum(whole));
+    }
+}
+
+// The shared-memory window and carveout travel with the checkpoint, so an
+// engine built from the plain configuration, as StateForker builds its
+// children, still serves scratchpad addresses without the L1
+void test_shared_window_round_trip() {
+    constexpr uint32_t SHARED_BASE = 0xC0000000;
+    SimConfig config = test::BASE;
+    config.unified_storage_size = 32 * 1024;
+
+    std::vector<TraceRecord> trace;
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t warp = i % config.num_warps;
+        SimTime time = i / config.num_warps * 4;
+        trace.push_back(TraceRecord{time, MemoryTransaction{SHARED_BASE + i * 4 % 8192, i,
+                                                            i % 2 == 0, 4, warp, 0xFFFFFFFF}});
+        trace.push_back(TraceRecord{time, MemoryTransaction{0x10000 + i * 32, 0, false, 4, warp,
+                                                            0xFFFFFFFF}});
+    }
+    uint64_t requests = trace.size();
+
+    SimulationEngine reference(config);
+    reference.initialize();
+    reference.set_shared_memory(SHARED_BASE, 8192);
+    reference.inject_trace(trace);
+    drain(reference, requests, 100000);
+
+    std::string path = (std::filesystem::temp_directory_path() /
+                        "gpusim_test_checkpoint_shared.ckpt").string();
+    SimulationEngine original(config);
+    original.initialize();
+    original.set_shared_memory(SHARED_BASE, 8192);
+    original.inject_trace(trace);
+    original.run_until(64);
+    uint64_t drained = original.latency_profile().total().count();
+    original.save_checkpoint(path);
+
+    for (const SimConfig& restored_config : {config, original.get_config()}) {
+        SimulationEngine restored(restored_config);
+        restored.initialize();
+        restored.restore_checkpoint(path);
+        CHECK_EQ(restored.carveout().shared_size, original.carveout().shared_size);
+        CHECK_EQ(restored.carveout().l1_size, original.carveout().l1_size);
+        drain(restored, requests - drained, reference.get_current_time() + 1000);
+
+        CHECK_EQ(restored.get_current_time(), reference.get_current_time());
+        for (const char* name : {"engine.shared_accesses", "memory.hits", "memory.misses"}) {
+            CHECK_EQ(restored.stats_registry().counter_value(name),
+                     reference.stats_registry().counter_value(name));
+        }
+        CHECK_EQ(restored.memory_model().functional_read(SHARED_BASE + 8),
+                 reference.memory_model().functional_read(SHARED_BASE + 8));
+    }
+    std::remove(path.c_str());
+    CHECK_EQ(reference.stats_registry().counter_value("engine.shared_accesses"), requests / 2);
+}
+
+} // namespace
+
+int main() {
+    test_constant_trace_round_trip();
+    test_shared_window_round_trip();
+    return test::report("test_checkpoint");
+}
@@ -0,0 +1,88 @@
+// test_common.h
+// Minimal checks and fixtures shared by the test executables
+
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "program_loader.h"
+#include "sim_engine.h"
+#include "warp_executor.h"
+
+namespace gpu_simulator {
+namespace test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: "      \
+                      << #condition << "\n";                                    \
+            ++::gpu_simulator::test::failures();                                \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                              \
+    do {                                                                        \
+        auto actual_value = (actual);                                           \
+        auto expected_value = (expected);                                       \
+        if (!(actual_value == expected_value)) {                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: "   \
+                      << #actual << " = " << actual_value << ", expected "      \
+                      << expected_value << "\n";                                \
+            ++::gpu_simulator::test::failures();                                \
+        }                                                                       \
+    } while (0)
+
+// Assemble programs/<name>.asm without the loader's progress output
+inline std::shared_ptr<const Program> load_program(const std::string& name) {
+    std::ostringstream discard;
+    std::streambuf* saved = std::cout.rdbuf(discard.rdbuf());
+    ProgramLoader loader(nullptr);
+    try {
+        loader.load_assembly(std::string(GPUSIM_PROGRAMS_DIR) + "/" + name + ".asm");
+    } catch (...) {
+        std::cout.rdbuf(saved);
+        throw;
+    }
+    std::cout.rdbuf(saved);
+    return loader.program();
+}
+
+// Small SM the tests run on: 8 warps of 32 threads, 16 KB L1
+inline const SimConfig BASE{8, 32, 16 * 1024, 64, 100, ""};
+
+// An engine executing a bundled program, ready to run
+struct KernelRun {
+    explicit KernelRun(const std::string& name, const SimConfig& config = BASE)
+        : program(load_program(name)), engine(config) {
+        engine.initialize();
+        engine.attach_program(program->image);
+        executor = std::make_unique<WarpExecutor>(program, engine.memory_model(),
+                                                  config.num_warps, config.threads_per_warp,
+                                                  config.cache_line_size);
+        engine.set_executor(executor.get());
+    }
+
+    std::shared_ptr<const Program> program;
+    SimulationEngine engine;
+    std::unique_ptr<WarpExecutor> executor;
+};
+
+inline int report(const char* suite) {
+    if (failures() == 0) {
+        std::cout << suite << ": all checks passed\n";
+        return 0;
+    }
+    std::cout << suite << ": " << failures() << " check(s) failed\n";
+    return 1;
+}
+
+} // namespace test
+} // namespace gpu_simulator
@@ -0,0 +1,48 @@
+// test_cta_dispatcher.cpp
+// Occupancy: per-thread register demand
+
+#include "test_common.h"
+#include "cta_dispatcher.h"
+#include <stdexcept>
+
+using namespace gpu_simulator;
+
+namespace {
+
+// $ra (jr $ra) is the link register, not one of the general registers
+void test_link_register_not_counted() {
+    auto program = test::load_program("vector_add");
+    CHECK(program->registers > 0);
+    CHECK(program->registers <= SmResources::REGISTERS_PER_THREAD);
+
+    OccupancyCalculator calculator(SmResources::from_config(test::BASE), test::BASE);
+    Occupancy occupancy = calculator.compute(KernelLaunch{"vector_add", program, 16, 4});
+    CHECK_EQ(occupancy.registers_per_thread, program->registers);
+}
+
+// A thread cannot use more registers than the register file has
+void test_register_file_limit() {
+    auto program = test::load_program("vector_add");
+    OccupancyCalculator calculator(SmResources::from_config(test::BASE), test::BASE);
+
+    KernelLaunch kernel{"vector_add", program, 16, 1};
+    kernel.registers_per_thread = SmResources::REGISTERS_PER_THREAD;
+    CHECK_EQ(calculator.compute(kernel).registers_per_thread, SmResources::REGISTERS_PER_THREAD);
+
+    kernel.registers_per_thread = SmResources::REGISTERS_PER_THREAD + 1;
+    bool rejected = false;
+    try {
+        calculator.compute(kernel);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    CHECK(rejected);
+}
+
+} // namespace
+
+int main() {
+    test_link_register_not_counted();
+    test_register_file_limit();
+    return test::report("test_cta_dispatcher");
+}
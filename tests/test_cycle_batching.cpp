@@ -0,0 +1,60 @@
+// test_cycle_batching.cpp
+// Cycle batching: the fetch-ring merge keeps the per-event results
+
+#include "test_common.h"
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace gpu_simulator;
+
+namespace {
+
+std::vector<std::string> bundled_programs() {
+    std::vector<std::string> names;
+    for (const auto& entry : std::filesystem::directory_iterator(GPUSIM_PROGRAMS_DIR)) {
+        if (entry.path().extension() == ".asm") {
+            names.push_back(entry.path().stem().string());
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// Every bundled program runs to the same statistics with and without
+// batching
+void test_batched_matches_per_event() {
+    std::vector<std::string> programs = bundled_programs();
+    CHECK(!programs.empty());
+    for (const std::string& name : programs) {
+        SimStats expected;
+        SimTime expected_time = 0;
+        for (bool batched : {false, true}) {
+            test::KernelRun run(name);
+            run.engine.set_cycle_batching(batched);
+            run.engine.run();
+            SimStats stats = run.engine.get_statistics();
+            if (!batched) {
+                expected = stats;
+                expected_time = run.engine.get_current_time();
+                CHECK(stats.instructions_executed > 0);
+                continue;
+            }
+            CHECK_EQ(run.engine.get_current_time(), expected_time);
+            CHECK_EQ(stats.total_cycles, expected.total_cycles);
+            CHECK_EQ(stats.instructions_executed, expected.instructions_executed);
+            CHECK_EQ(stats.memory_requests, expected.memory_requests);
+            CHECK_EQ(stats.cache_hits, expected.cache_hits);
+            CHECK_EQ(stats.cache_misses, expected.cache_misses);
+            CHECK_EQ(stats.idle_cycles, expected.idle_cycles);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_batched_matches_per_event();
+    return test::report("test_cycle_batching");
+}
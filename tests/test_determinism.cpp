@@ -0,0 +1,116 @@
+// test_determinism.cpp
+// DeterminismChecker: per-cycle event hashes across host thread counts
+
+#include "test_common.h"
+#include "determinism_checker.h"
+#include "cta_dispatcher.h"
+#include <vector>
+
+using namespace gpu_simulator;
+
+namespace {
+
+MultiSMConfig base_config(SyncMode mode) {
+    MultiSMConfig config{};
+    config.sm_config = test::BASE;
+    config.num_sms = 4;
+    config.num_threads = 1;
+    config.sync_mode = mode;
+    config.quantum = 0;
+    config.l2_size = 256 * 1024;
+    config.l2_line_size = 64;
+    config.num_l2_partitions = 2;
+    config.interconnect_latency = 10;
+    config.noc.topology = NocTopology::IDEAL;
+    return config;
+}
+
+// Every SM runs its own copy of a program; the executors live until the
+// next run replaces them
+struct ProgramWorkload {
+    explicit ProgramWorkload(const std::string& name) : program(test::load_program(name)) {}
+
+    void operator()(MultiSMEngine& engine) {
+        const SimConfig& config = engine.sm(0).get_config();
+        executors.clear();
+        for (uint32_t i = 0; i < engine.num_sms(); ++i) {
+            SimulationEngine& sm = engine.sm(i);
+            sm.attach_program(program->image);
+            executors.push_back(std::make_unique<WarpExecutor>(
+                program, sm.memory_model(), config.num_warps, config.threads_per_warp,
+                config.cache_line_size));
+            sm.set_executor(executors.back().get());
+        }
+    }
+
+    std::shared_ptr<const Program> program;
+    std::vector<std::unique_ptr<WarpExecutor>> executors;
+};
+
+// A grid of blocks refilled through a CtaDispatcher
+struct GridWorkload {
+    explicit GridWorkload(const std::string& name) : program(test::load_program(name)) {}
+
+    void operator()(MultiSMEngine& engine) {
+        std::vector<SimulationEngine*> sms;
+        for (uint32_t i = 0; i < engine.num_sms(); ++i) {
+            sms.push_back(&engine.sm(i));
+        }
+        dispatcher = std::make_unique<CtaDispatcher>(sms);
+        dispatcher->launch(KernelLaunch{"grid", program, 16, 4});
+        dispatcher->start();
+        engine.set_dispatcher(dispatcher.get());
+    }
+
+    std::shared_ptr<const Program> program;
+    std::unique_ptr<CtaDispatcher> dispatcher;
+};
+
+// Identical event streams on 1, 2 and 4 threads in both sync modes
+void test_thread_counts_agree() {
+    for (SyncMode mode : {SyncMode::QUANTUM, SyncMode::CONSERVATIVE}) {
+        for (const char* name : {"vector_add", "matrix_multiply", "memory_test"}) {
+            auto workload = std::make_shared<ProgramWorkload>(name);
+            DeterminismChecker checker(base_config(mode),
+                                       [workload](MultiSMEngine& engine) { (*workload)(engine); });
+            DeterminismReport report = checker.check({1, 2, 4});
+            CHECK(report.deterministic);
+            CHECK(report.cycles_compared > 0);
+        }
+
+        auto grid = std::make_shared<GridWorkload>("vector_add");
+        DeterminismChecker checker(base_config(mode),
+                                   [grid](MultiSMEngine& engine) { (*grid)(engine); });
+        DeterminismReport report = checker.check({1, 2, 4});
+        CHECK(report.deterministic);
+        CHECK(report.cycles_compared > 0);
+    }
+}
+
+// A run that really differs is reported at the SM and cycle it first differs
+void test_divergence_is_reported() {
+    auto workload = std::make_shared<ProgramWorkload>("vector_add");
+    auto runs = std::make_shared<int>(0);
+    DeterminismChecker checker(base_config(SyncMode::QUANTUM),
+                               [workload, runs](MultiSMEngine& engine) {
+                                   (*workload)(engine);
+                                   // The second run's SM 2 has a smaller L1
+                                   if (++*runs == 2) {
+                                       engine.sm(2).memory_model().set_capacity(1024);
+                                   }
+                               });
+    DeterminismReport report = checker.check({1, 4});
+    CHECK(!report.deterministic);
+    CHECK_EQ(report.reference_threads, 1u);
+    CHECK_EQ(report.divergent_threads, 4u);
+    CHECK_EQ(report.divergent_sm, 2u);
+    CHECK(report.divergent_cycle > 0);
+}
+
+} // namespace
+
+int main() {
+    test_thread_counts_agree();
+    test_divergence_is_reported();
+    return test::report("test_determinism");
+}
@@ -0,0 +1,149 @@
+// test_metrics_server.cpp
+// LiveMetrics snapshots and the MetricsServer scrape endpoint
+
+#include "test_common.h"
+#include "metrics_server.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace gpu_simulator;
+
+namespace {
+
+LiveSnapshot snapshot_of(uint64_t k) {
+    return LiveSnapshot{k, 2 * k, 3 * k, 4 * k, 5 * k, 6 * k, 7 * k, 8 * k, k % 2 == 1};
+}
+
+// A reader racing the publisher always sees one whole snapshot
+void test_seqlock_round_trip() {
+    LiveMetrics metrics;
+    metrics.publish(snapshot_of(21));
+    LiveSnapshot read = metrics.read();
+    CHECK_EQ(read.cycles, uint64_t{21});
+    CHECK_EQ(read.cache_misses, uint64_t{105});
+    CHECK_EQ(read.published_ns, uint64_t{168});
+    CHECK(read.running);
+
+    std::atomic<bool> done(false);
+    std::thread publisher([&] {
+        for (uint64_t k = 1; k <= 200000; ++k) {
+            metrics.publish(snapshot_of(k));
+        }
+        done.store(true);
+    });
+    uint64_t torn = 0;
+    while (!done.load()) {
+        LiveSnapshot s = metrics.read();
+        LiveSnapshot expected = snapshot_of(s.cycles);
+        torn += s.instructions != expected.instructions ||
+                s.memory_requests != expected.memory_requests ||
+                s.cache_hits != expected.cache_hits || s.cache_misses != expected.cache_misses ||
+                s.events != expected.events || s.queue_depth != expected.queue_depth ||
+                s.published_ns != expected.published_ns || s.running != expected.running;
+    }
+    publisher.join();
+    CHECK_EQ(torn, uint64_t{0});
+}
+
+int connect_to(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::string read_all(int fd) {
+    std::string response;
+    char chunk[1024];
+    ssize_t n;
+    while ((n = ::recv(fd, chunk, sizeof(chunk), 0)) > 0) {
+        response.append(chunk, static_cast<size_t>(n));
+    }
+    return response;
+}
+
+// A scrape returns the published values in the exposition format
+void test_scrape() {
+    LiveMetrics metrics;
+    metrics.publish(snapshot_of(1000));
+    MetricsServer server;
+    server.add_source("test", &metrics);
+    server.start_tcp(0);
+    CHECK(server.port() != 0);
+
+    int fd = connect_to(server.port());
+    CHECK(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+    CHECK_EQ(::send(fd, request.data(), request.size(), 0),
+             static_cast<ssize_t>(request.size()));
+    std::string response = read_all(fd);
+    ::close(fd);
+    server.stop();
+
+    CHECK(response.rfind("HTTP/1.0 200 OK\r\n", 0) == 0);
+    for (const char* line : {"# TYPE gpusim_cycles counter\n",
+                             "gpusim_cycles{sim=\"test\"} 1000\n",
+                             "gpusim_instructions_total{sim=\"test\"} 2000\n",
+                             "gpusim_cache_misses_total{sim=\"test\"} 5000\n",
+                             "gpusim_event_queue_depth{sim=\"test\"} 7000\n",
+                             "gpusim_ipc{sim=\"test\"} 2\n",
+                             "gpusim_running{sim=\"test\"} 0\n"}) {
+        if (response.find(line) == std::string::npos) {
+            std::cerr << "missing exposition line: " << line;
+            CHECK(false);
+        }
+    }
+}
+
+// A client trickling its request is answered after the read deadline, not
+// held for as long as it keeps sending
+void test_trickling_client_is_cut_off() {
+    LiveMetrics metrics;
+    metrics.publish(snapshot_of(1));
+    MetricsServer server;
+    server.add_source("test", &metrics);
+    server.start_tcp(0);
+
+    int fd = connect_to(server.port());
+    CHECK(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    bool answered = false;
+    for (int i = 0; i < 25 && !answered; ++i) {
+        ::send(fd, "G", 1, MSG_NOSIGNAL);
+        pollfd readable{fd, POLLIN, 0};
+        answered = ::poll(&readable, 1, 200) > 0;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+        .count();
+    CHECK(answered);
+    CHECK(seconds < 3.0);
+    ::close(fd);
+    server.stop();
+}
+
+} // namespace
+
+int main() {
+    test_seqlock_round_trip();
+    test_scrape();
+    test_trickling_client_is_cut_off();
+    return test::report("test_metrics_server");
+}
@@ -0,0 +1,168 @@
+// test_multi_sm.cpp
+// Multi-SM engine: statistics and synchronization
+
+#include "test_common.h"
+#include "multi_sm_engine.h"
+#include "cta_dispatcher.h"
+#include "warp_executor.h"
+#include <vector>
+
+using namespace gpu_simulator;
+
+namespace {
+
+MultiSMConfig base_config(uint32_t num_sms, SyncMode mode) {
+    MultiSMConfig config{};
+    config.sm_config = test::BASE;
+    config.num_sms = num_sms;
+    config.num_threads = 2;
+    config.sync_mode = mode;
+    config.quantum = 0;
+    config.l2_size = 256 * 1024;
+    config.l2_line_size = 64;
+    config.num_l2_partitions = 2;
+    config.interconnect_latency = 10;
+    config.noc.topology = NocTopology::IDEAL;
+    return config;
+}
+
+// Run grid_blocks blocks of a program over the SMs of engine
+void run_grid(MultiSMEngine& engine, const std::string& program, uint32_t grid_blocks) {
+    std::vector<SimulationEngine*> sms;
+    for (uint32_t i = 0; i < engine.num_sms(); ++i) {
+        sms.push_back(&engine.sm(i));
+    }
+    engine.initialize();
+    CtaDispatcher dispatcher(sms);
+    dispatcher.launch(KernelLaunch{program, test::load_program(program), grid_blocks, 4});
+    dispatcher.start();
+    engine.set_dispatcher(&dispatcher);
+    engine.run();
+    engine.set_dispatcher(nullptr);
+    CHECK(dispatcher.done());
+}
+
+// Per-SM statistics describe the whole run, not the last 1000-cycle refresh
+void test_per_sm_statistics() {
+    for (const char* program : {"vector_add", "matrix_multiply"}) {
+        MultiSMEngine engine(base_config(4, SyncMode::QUANTUM));
+        run_grid(engine, program, 16);
+
+        MultiSMStats stats = engine.get_statistics();
+        SimTime latest = 0;
+        for (uint32_t i = 0; i < engine.num_sms(); ++i) {
+            CHECK_EQ(stats.per_sm[i].total_cycles, engine.sm(i).get_current_time());
+            CHECK(stats.per_sm[i].total_cycles > 0);
+            latest = std::max(latest, engine.sm(i).get_current_time());
+        }
+        CHECK_EQ(stats.total.total_cycles, latest);
+    }
+}
+
+// Every SM runs its own copy of a program, without a block dispatcher
+MultiSMStats run_program(MultiSMConfig config, const std::string& name) {
+    auto program = test::load_program(name);
+    MultiSMEngine engine(config);
+    engine.initialize();
+    std::vector<std::unique_ptr<WarpExecutor>> executors;
+    for (uint32_t i = 0; i < engine.num_sms(); ++i) {
+        SimulationEngine& sm = engine.sm(i);
+        sm.attach_program(program->image);
+        executors.push_back(std::make_unique<WarpExecutor>(
+            program, sm.memory_model(), config.sm_config.num_warps,
+            config.sm_config.threads_per_warp, config.sm_config.cache_line_size));
+        sm.set_executor(executors.back().get());
+    }
+    engine.run();
+    return engine.get_statistics();
+}
+
+void check_same_run(const MultiSMStats& actual, const MultiSMStats& expected) {
+    CHECK_EQ(actual.total.total_cycles, expected.total.total_cycles);
+    CHECK_EQ(actual.l2_requests, expected.l2_requests);
+    CHECK_EQ(actual.l2_hits, expected.l2_hits);
+    CHECK_EQ(actual.late_responses, uint64_t{0});
+    for (size_t i = 0; i < expected.per_sm.size(); ++i) {
+        CHECK_EQ(actual.per_sm[i].total_cycles, expected.per_sm[i].total_cycles);
+        CHECK_EQ(actual.per_sm[i].instructions_executed, expected.per_sm[i].instructions_executed);
+        CHECK_EQ(actual.per_sm[i].memory_requests, expected.per_sm[i].memory_requests);
+        CHECK_EQ(actual.per_sm[i].cache_hits, expected.per_sm[i].cache_hits);
+        CHECK_EQ(actual.per_sm[i].cache_misses, expected.per_sm[i].cache_misses);
+    }
+}
+
+// The exact quantum and conservative windows, on any number of threads,
+// give the same run as single-threaded cycle-by-cycle lockstep
+void test_sync_modes_match_sequential() {
+    for (const char* program : {"vector_add", "matrix_multiply", "memory_test"}) {
+        MultiSMConfig sequential = base_config(4, SyncMode::QUANTUM);
+        sequential.num_threads = 1;
+        sequential.quantum = 1;
+        MultiSMStats expected = run_program(sequential, program);
+        CHECK(expected.total.instructions_executed > 0);
+
+        for (uint32_t threads : {1, 4}) {
+            for (SyncMode mode : {SyncMode::QUANTUM, SyncMode::CONSERVATIVE}) {
+                MultiSMConfig config = base_config(4, mode);
+                config.num_threads = threads;
+                check_same_run(run_program(config, program), expected);
+            }
+        }
+    }
+}
+
+// With a modelled network the exact quantum is one link latency, a fixed
+// PDES window, so both sync modes give the cycle-by-cycle result
+void test_network_sync_modes_match_sequential() {
+    for (NocTopology topology : {NocTopology::CROSSBAR, NocTopology::MESH}) {
+        auto network = [topology](SyncMode mode) {
+            MultiSMConfig config = base_config(4, mode);
+            config.noc = InterconnectConfig{topology, 4, 16, 16, 2, 8, 0};
+            return config;
+        };
+        for (const char* program : {"vector_add", "matrix_multiply"}) {
+            MultiSMConfig sequential = network(SyncMode::QUANTUM);
+            sequential.num_threads = 1;
+            sequential.quantum = 1;
+            MultiSMStats expected = run_program(sequential, program);
+
+            for (SyncMode mode : {SyncMode::QUANTUM, SyncMode::CONSERVATIVE}) {
+                check_same_run(run_program(network(mode), program), expected);
+            }
+        }
+    }
+}
+
+// Refills launch LAUNCH_LATENCY after the retirement, not at the next
+// boundary, so a dispatched grid also runs as it does cycle by cycle
+void test_dispatcher_sync_modes_match_sequential() {
+    auto grid = [](MultiSMConfig config, const char* program) {
+        MultiSMEngine engine(config);
+        run_grid(engine, program, 16);
+        return engine.get_statistics();
+    };
+    for (const char* program : {"vector_add", "matrix_multiply"}) {
+        MultiSMConfig sequential = base_config(4, SyncMode::QUANTUM);
+        sequential.num_threads = 1;
+        sequential.quantum = 1;
+        MultiSMStats expected = grid(sequential, program);
+
+        for (uint32_t threads : {1, 4}) {
+            for (SyncMode mode : {SyncMode::QUANTUM, SyncMode::CONSERVATIVE}) {
+                MultiSMConfig config = base_config(4, mode);
+                config.num_threads = threads;
+                check_same_run(grid(config, program), expected);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_per_sm_statistics();
+    test_sync_modes_match_sequential();
+    test_network_sync_modes_match_sequential();
+    test_dispatcher_sync_modes_match_sequential();
+    return test::report("test_multi_sm");
+}
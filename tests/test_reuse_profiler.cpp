@@ -0,0 +1,71 @@
+// test_reuse_profiler.cpp
+// ReuseProfiler: sampled reuse distances against the exact stack analysis
+
+#include "test_common.h"
+#include "reuse_profiler.h"
+#include "stack_distance.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace gpu_simulator;
+
+namespace {
+
+constexpr uint32_t LINE_SIZE = 64;
+
+// Mostly a hot set with a colder tail, 300 lines in all
+std::vector<uint32_t> make_stream() {
+    std::mt19937 random(7);
+    std::vector<uint32_t> addresses;
+    for (uint32_t i = 0; i < 20000; ++i) {
+        uint32_t line = random() % 4 == 0 ? random() % 300 : random() % 40;
+        addresses.push_back(0x40000 + line * LINE_SIZE + random() % LINE_SIZE);
+    }
+    return addresses;
+}
+
+// A footprint within the line budget is profiled exactly from the start
+void test_small_footprint_is_exact() {
+    std::vector<uint32_t> stream = make_stream();
+    ReuseProfiler profiler(LINE_SIZE, 1);
+    StackDistanceAnalyzer exact(LINE_SIZE, 1024 * LINE_SIZE);
+    for (size_t i = 0; i < stream.size(); ++i) {
+        profiler.record(0, stream[i], i);
+        exact.record(stream[i]);
+    }
+
+    const ReuseHistogram& histogram = profiler.global();
+    CHECK_EQ(profiler.sample_rate(), 1.0);
+    CHECK_EQ(histogram.total(), static_cast<double>(exact.total_accesses()));
+    CHECK_EQ(histogram.cold(), static_cast<double>(exact.cold_misses()));
+    CHECK_EQ(histogram.samples(), exact.total_accesses() - exact.cold_misses());
+    for (uint64_t lines = 1; lines <= 512; lines *= 2) {
+        double expected = exact.hit_rate(static_cast<uint32_t>(lines * LINE_SIZE), 0);
+        CHECK(std::fabs(histogram.hit_rate(lines) - expected) < 1e-9);
+    }
+    CHECK(std::fabs(profiler.warp(0).hit_rate(64) - exact.hit_rate(64 * LINE_SIZE, 0)) < 1e-9);
+}
+
+// Past the budget the rate drops, and the estimate stays close
+void test_budget_lowers_rate() {
+    std::vector<uint32_t> stream = make_stream();
+    ReuseProfiler profiler(LINE_SIZE, 1, ReuseProfiler::DEFAULT_INTERVAL, 1.0, 64);
+    StackDistanceAnalyzer exact(LINE_SIZE, 1024 * LINE_SIZE);
+    for (size_t i = 0; i < stream.size(); ++i) {
+        profiler.record(0, stream[i], i);
+        exact.record(stream[i]);
+    }
+    CHECK(profiler.sample_rate() < 1.0);
+    CHECK(profiler.global().samples() > 0);
+    double expected = exact.hit_rate(64 * LINE_SIZE, 0);
+    CHECK(std::fabs(profiler.global().hit_rate(64) - expected) < 0.1);
+}
+
+} // namespace
+
+int main() {
+    test_small_footprint_is_exact();
+    test_budget_lowers_rate();
+    return test::report("test_reuse_profiler");
+}
@@ -0,0 +1,134 @@
+// test_simpoint.cpp
+// Fast-forwarding and sampled simulation
+
+#include "test_common.h"
+#include "simpoint.h"
+#include "warp_executor.h"
+#include <stdexcept>
+
+using namespace gpu_simulator;
+
+namespace {
+
+// Fast-forwarding part of a kernel and simulating the rest executes every
+// instruction once, and the kernel still runs to completion
+void test_executor_fast_forward() {
+    for (const char* name : {"vector_add", "matrix_multiply", "sync_test"}) {
+        test::KernelRun detailed(name);
+        detailed.engine.run();
+        uint64_t total = detailed.engine.get_statistics().instructions_executed;
+        CHECK(detailed.executor->all_exited());
+
+        for (uint64_t skip : {uint64_t{1}, total / 2, total}) {
+            test::KernelRun sampled(name);
+            FastForwardResult ff = sampled.engine.fast_forward(
+                FastForwardConfig{skip, false, 0, true});
+            CHECK_EQ(ff.instructions, skip);
+            sampled.engine.run();
+            CHECK(sampled.executor->all_exited());
+            CHECK_EQ(ff.instructions + sampled.engine.get_statistics().instructions_executed,
+                     total);
+        }
+
+        // Without a limit the kernel finishes functionally
+        test::KernelRun functional(name);
+        CHECK_EQ(functional.engine.fast_forward(FastForwardConfig{0, false, 0, false}).instructions,
+                 total);
+        CHECK(functional.executor->all_exited());
+    }
+}
+
+// Warming fast-forward routes trace requests like detailed mode: constant
+// and read-only loads fill their own caches, and the shared window is
+// served by the scratchpad without touching the L1
+void test_trace_fast_forward_routing() {
+    constexpr uint32_t SHARED_BASE = 0xC0000000;
+    std::vector<TraceRecord> trace;
+    auto add = [&](SimTime time, uint32_t address, bool is_write, MemorySpace space) {
+        MemoryTransaction trans{address, address ^ 0x5A5A, is_write, 4,
+                                static_cast<uint32_t>(trace.size() % test::BASE.num_warps),
+                                0xFFFFFFFF};
+        trans.space = space;
+        trace.push_back(TraceRecord{time, trans});
+    };
+    for (uint32_t i = 0; i < 16; ++i) {
+        SimTime time = i * 4;
+        add(time, 0x10000 + i * 64, i % 4 == 3, MemorySpace::GLOBAL);
+        add(time, 0x20000 + i * 64, false, MemorySpace::CONSTANT);
+        add(time, 0x30000 + i * 64, false, MemorySpace::READ_ONLY);
+        add(time, SHARED_BASE + i * 4, true, MemorySpace::GLOBAL);
+        add(time + 2, SHARED_BASE + i * 4, false, MemorySpace::GLOBAL);
+    }
+
+    auto start = [&](SimulationEngine& engine) {
+        engine.initialize();
+        engine.set_shared_memory(SHARED_BASE, 4096);
+        engine.inject_trace(trace);
+    };
+    constexpr SimTime END = 160;
+    SimulationEngine detailed(test::BASE);
+    start(detailed);
+    detailed.run_until(END);
+    SimulationEngine warmed(test::BASE);
+    start(warmed);
+    warmed.fast_forward(FastForwardConfig{test::BASE.num_warps * END / 4, false, 0, true});
+
+    auto cached = [](MemoryModel* cache, uint32_t address) {
+        uint32_t data;
+        return cache && cache->lookup_cache(address, data);
+    };
+    for (const TraceRecord& record : trace) {
+        uint32_t address = record.trans.address;
+        if (address >= SHARED_BASE) {
+            CHECK(!cached(&detailed.memory_model(), address));
+            CHECK(!cached(&warmed.memory_model(), address));
+            CHECK_EQ(warmed.memory_model().functional_read(address),
+                     detailed.memory_model().functional_read(address));
+            continue;
+        }
+        CHECK_EQ(cached(&warmed.memory_model(), address),
+                 cached(&detailed.memory_model(), address));
+        CHECK_EQ(cached(warmed.constant_cache(), address),
+                 cached(detailed.constant_cache(), address));
+        CHECK_EQ(cached(warmed.readonly_cache(), address),
+                 cached(detailed.readonly_cache(), address));
+    }
+    CHECK(cached(detailed.constant_cache(), 0x20000));
+    CHECK(cached(detailed.readonly_cache(), 0x30000));
+    CHECK_EQ(warmed.memory_model().functional_read(SHARED_BASE + 4), (SHARED_BASE + 4) ^ 0x5A5A);
+}
+
+void test_sampled_simulation() {
+    SimPointConfig config{64, 4, 15, 4, 20, 1, 2};
+    bool rejected = false;
+    try {
+        SampledSimulation(test::BASE, config, nullptr);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    CHECK(rejected);
+
+    test::KernelRun detailed("matrix_multiply");
+    detailed.engine.run();
+    SimStats full = detailed.engine.get_statistics();
+
+    SampledSimulation sampled(test::BASE, config, detailed.program);
+    SampledResult result = sampled.run();
+    CHECK_EQ(result.profiled_instructions, full.instructions_executed);
+    CHECK(!result.points.empty());
+    CHECK(result.points.size() < result.total_intervals);
+    for (const auto& point : result.points) {
+        CHECK(point.instructions > 0);
+        CHECK(point.cycles > 0);
+    }
+    CHECK(result.estimate.total_cycles > 0);
+}
+
+} // namespace
+
+int main() {
+    test_executor_fast_forward();
+    test_trace_fast_forward_routing();
+    test_sampled_simulation();
+    return test::report("test_simpoint");
+}
@@ -0,0 +1,66 @@
+// test_stack_distance.cpp
+// StackDistanceAnalyzer: one-pass hit counts against simulated caches
+
+#include "test_common.h"
+#include "stack_distance.h"
+#include <random>
+#include <vector>
+
+using namespace gpu_simulator;
+
+namespace {
+
+constexpr uint32_t LINE_SIZE = 64;
+
+// A hot set, a colder tail and strided runs that pile onto a few sets
+std::vector<uint32_t> make_stream() {
+    std::mt19937 random(11);
+    std::vector<uint32_t> addresses;
+    for (uint32_t i = 0; i < 20000; ++i) {
+        uint32_t line;
+        switch (random() % 4) {
+            case 0:  line = random() % 400; break;
+            case 1:  line = (random() % 32) * 16; break;
+            default: line = random() % 48; break;
+        }
+        addresses.push_back(0x20000 + line * LINE_SIZE + (random() % (LINE_SIZE / 4)) * 4);
+    }
+    return addresses;
+}
+
+// MemoryModel picks power-of-two sets of at least 8 ways, so these sizes
+// cover 1x8, 2x8, 2x12, 4x10, 8x8 and 8x12 (sets x ways)
+struct Geometry {
+    uint32_t cache_size;
+    uint32_t ways;
+};
+
+// Every geometry misses exactly as often as a MemoryModel run of the stream
+void test_hits_match_memory_model() {
+    std::vector<uint32_t> stream = make_stream();
+    StackDistanceAnalyzer analyzer(LINE_SIZE, 64 * 1024);
+    for (uint32_t address : stream) {
+        analyzer.record(address);
+    }
+    CHECK_EQ(analyzer.total_accesses(), static_cast<uint64_t>(stream.size()));
+
+    for (Geometry geometry : {Geometry{512, 8}, Geometry{1024, 8}, Geometry{1536, 12},
+                              Geometry{2560, 10}, Geometry{4096, 8}, Geometry{6144, 12}}) {
+        MemoryModel memory(geometry.cache_size, LINE_SIZE, 100);
+        for (uint32_t address : stream) {
+            memory.access(address, 0, false);
+        }
+        auto [hits, misses] = memory.get_cache_stats();
+        uint64_t expected = analyzer.hits(geometry.cache_size, geometry.ways);
+        CHECK_EQ(hits, expected);
+        CHECK_EQ(misses, analyzer.total_accesses() - expected);
+        CHECK(misses > analyzer.cold_misses());
+    }
+}
+
+} // namespace
+
+int main() {
+    test_hits_match_memory_model();
+    return test::report("test_stack_distance");
+}
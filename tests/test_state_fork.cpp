@@ -0,0 +1,103 @@
+// test_state_fork.cpp
+// StateForker: forked and checkpointed variants against sequential runs
+
+#include "test_common.h"
+#include "state_fork.h"
+#include <vector>
+
+using namespace gpu_simulator;
+
+namespace {
+
+constexpr SimTime FORK_TIME = 200;
+constexpr SimTime END_TIME = 2000;
+
+// Streaming reads over 16 KB, twice, so a smaller L1 loses the second pass
+std::vector<TraceRecord> make_trace() {
+    std::vector<TraceRecord> trace;
+    for (uint32_t i = 0; i < 512; ++i) {
+        uint32_t warp = i % test::BASE.num_warps;
+        uint32_t address = 0x10000 + (i % 256) * 64;
+        trace.push_back(TraceRecord{i * 2, MemoryTransaction{address, 0, false, 4, warp,
+                                                             0xFFFFFFFF}});
+    }
+    return trace;
+}
+
+void start(SimulationEngine& engine, const std::vector<TraceRecord>& trace) {
+    engine.initialize();
+    engine.inject_trace(trace);
+    engine.run_until(FORK_TIME);
+}
+
+std::vector<ForkVariant> variants() {
+    return {{"baseline", nullptr},
+            {"small_l1", [](SimulationEngine& engine) {
+                 engine.memory_model().set_capacity(2048);
+             }}};
+}
+
+// Trace warps never exit, so every run stops at the same cycle
+void finish(SimulationEngine& engine) {
+    engine.run_until(END_TIME);
+}
+
+void check_same_stats(const SimStats& actual, const SimStats& expected) {
+    CHECK_EQ(actual.instructions_executed, expected.instructions_executed);
+    CHECK_EQ(actual.memory_requests, expected.memory_requests);
+    CHECK_EQ(actual.cache_hits, expected.cache_hits);
+    CHECK_EQ(actual.cache_misses, expected.cache_misses);
+    CHECK_EQ(actual.idle_cycles, expected.idle_cycles);
+}
+
+// Every child reports what the same variant gives when run sequentially,
+// through fork() and through the checkpoint fallback, and the parent is
+// left where it was
+void test_variants_match_sequential_runs() {
+    std::vector<TraceRecord> trace = make_trace();
+    std::vector<SimStats> expected;
+    for (const ForkVariant& variant : variants()) {
+        SimulationEngine engine(test::BASE);
+        start(engine, trace);
+        if (variant.apply) {
+            variant.apply(engine);
+        }
+        finish(engine);
+        expected.push_back(engine.get_statistics());
+    }
+    CHECK(expected[1].cache_misses > expected[0].cache_misses);
+
+    SimulationEngine parent(test::BASE);
+    start(parent, trace);
+    SimStats before = parent.get_statistics();
+    SimTime fork_time = parent.get_current_time();
+    uint64_t requests = parent.stats_registry().counter_value("engine.memory_requests");
+
+    StateForker forker;
+    for (bool forked : {true, false}) {
+        std::vector<ForkResult> results = forked
+            ? forker.run(parent, variants(), finish)
+            : forker.run_from_checkpoint(parent, variants(), finish);
+        CHECK_EQ(results.size(), expected.size());
+        for (size_t i = 0; i < results.size() && i < expected.size(); ++i) {
+            CHECK(results[i].ok);
+            CHECK_EQ(results[i].name, variants()[i].name);
+            check_same_stats(results[i].stats, expected[i]);
+        }
+
+        CHECK_EQ(parent.get_current_time(), fork_time);
+        check_same_stats(parent.get_statistics(), before);
+        CHECK_EQ(parent.stats_registry().counter_value("engine.memory_requests"), requests);
+    }
+
+    // The parent still continues like any sequential run
+    finish(parent);
+    check_same_stats(parent.get_statistics(), expected[0]);
+}
+
+} // namespace
+
+int main() {
+    test_variants_match_sequential_runs();
+    return test::report("test_state_fork");
+}
@@ -0,0 +1,55 @@
+// test_stats_registry.cpp
+// StatsRegistry: interval rows
+
+#include "test_common.h"
+#include "stats_registry.h"
+#include <sstream>
+
+using namespace gpu_simulator;
+
+namespace {
+
+// An interval row reports differences, formulas included, without
+// touching the live counters
+void test_interval_row_is_read_only() {
+    StatsRegistry registry;
+    StatGroup group = registry.group("sim");
+    Counter hits = group.counter("hits", "");
+    Counter accesses = group.counter("accesses", "");
+    Histogram latency = group.histogram("latency", "", 4, 10);
+
+    uint64_t live_hits_in_formula = 0;
+    group.formula("hit_rate", "", [&] {
+        live_hits_in_formula = registry.counter_value("sim.hits");
+        return static_cast<double>(hits.value()) / static_cast<double>(accesses.value());
+    });
+
+    hits += 30;
+    accesses += 40;
+    latency.sample(5);
+    std::vector<uint64_t> since = registry.snapshot();
+
+    hits += 5;
+    accesses += 10;
+    latency.sample(35);
+    latency.sample(15);
+
+    const StatsRegistry& view = registry;
+    std::ostringstream row;
+    view.write_csv_row(row, 100, since);
+
+    // Columns sorted by name: accesses, hit_rate, hits, latency samples and mean
+    CHECK_EQ(row.str(), std::string("100,10,0.5,5,2,25\n"));
+    CHECK_EQ(live_hits_in_formula, uint64_t{35});
+    CHECK_EQ(hits.value(), uint64_t{35});
+    CHECK_EQ(accesses.value(), uint64_t{50});
+    CHECK_EQ(latency.samples(), uint64_t{3});
+    CHECK_EQ(registry.value("sim.hit_rate"), 0.7);
+}
+
+} // namespace
+
+int main() {
+    test_interval_row_is_read_only();
+    return test::report("test_stats_registry");
+}
@@ -0,0 +1,55 @@
+// test_synthetic_workload.cpp
+// Streaming synthetic requests into an engine
+
+#include "test_common.h"
+#include "synthetic_workload.h"
+#include <stdexcept>
+
+using namespace gpu_simulator;
+
+namespace {
+
+// Chunks are injected as the engine reaches them, and all are served
+void test_stream_completes() {
+    SyntheticConfig synthetic = SyntheticConfig::defaults(AccessPattern::RANDOM);
+    synthetic.num_requests = 10000;
+    synthetic.num_warps = 8;
+
+    SimulationEngine engine(test::BASE);
+    engine.initialize();
+    SyntheticWorkloadGenerator generator(synthetic);
+    uint64_t injected = generator.run(engine, generator.end_time() + 2 * test::BASE.memory_latency, 1000);
+    CHECK_EQ(injected, synthetic.num_requests);
+    CHECK_EQ(engine.get_statistics().memory_requests, synthetic.num_requests);
+}
+
+// A stream reaching past the engine's cycle limit is reported, not cut short
+void test_truncation_is_reported() {
+    SyntheticConfig synthetic = SyntheticConfig::defaults(AccessPattern::STREAMING);
+    synthetic.num_warps = 1;
+    synthetic.issue_interval = 400000;
+    synthetic.num_requests = 4;
+
+    SimConfig config = test::BASE;
+    config.num_warps = 1;
+    SimulationEngine engine(config);
+    engine.initialize();
+    SyntheticWorkloadGenerator generator(synthetic);
+    CHECK(generator.end_time() > SimulationEngine::MAX_SIMULATION_CYCLES);
+
+    bool reported = false;
+    try {
+        generator.run(engine, generator.end_time() + 1);
+    } catch (const std::runtime_error&) {
+        reported = true;
+    }
+    CHECK(reported);
+}
+
+} // namespace
+
+int main() {
+    test_stream_completes();
+    test_truncation_is_reported();
+    return test::report("test_synthetic_workload");
+}
@@ -0,0 +1,55 @@
+// test_thread_pool.cpp
+// ThreadPool: coverage of every index and exception propagation
+
+#include "test_common.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace gpu_simulator;
+
+namespace {
+
+void test_every_index_runs_once() {
+    for (size_t threads : {1, 4}) {
+        utils::ThreadPool pool(threads);
+        std::vector<std::atomic<int>> calls(1000);
+        pool.parallel_for(calls.size(), [&](size_t i) { calls[i]++; });
+        for (const auto& count : calls) {
+            CHECK_EQ(count.load(), 1);
+        }
+    }
+}
+
+// A throwing task reaches the caller, and the pool stays usable afterwards
+void test_exception_is_rethrown() {
+    for (size_t threads : {1, 4}) {
+        utils::ThreadPool pool(threads);
+        for (int round = 0; round < 3; ++round) {
+            bool caught = false;
+            try {
+                pool.parallel_for(64, [](size_t i) {
+                    if (i == 5) {
+                        throw std::runtime_error("task 5 failed");
+                    }
+                });
+            } catch (const std::runtime_error& e) {
+                caught = std::string(e.what()) == "task 5 failed";
+            }
+            CHECK(caught);
+
+            std::atomic<size_t> sum{0};
+            pool.parallel_for(100, [&](size_t i) { sum += i; });
+            CHECK_EQ(sum.load(), size_t{4950});
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_every_index_runs_once();
+    test_exception_is_rethrown();
+    return test::report("test_thread_pool");
+}